@@ -0,0 +1,37 @@
+/**
+ * ヘッドレス実行のエントリポイント（`yarn bench`、`node scripts/headless.js --help`）
+ *
+ * src/ のTypeScriptを読み込み時にtypescriptでCommonJSへ変換し、`@/` をsrc/に解決する。
+ * 型検査は行わないため、型の確認は通常のビルド・テストで行う
+ */
+
+const fs = require("fs")
+const Module = require("module")
+const path = require("path")
+const ts = require("typescript")
+
+const SOURCE_ROOT = path.resolve(__dirname, "..", "src")
+
+const compilerOptions = {
+  module: ts.ModuleKind.CommonJS,
+  target: ts.ScriptTarget.ES2022,
+  esModuleInterop: true,
+  sourceMap: false,
+}
+
+// 拡張子を省略したimportも.tsとして解決される
+require.extensions[".ts"] = (module, filename) => {
+  const source = fs.readFileSync(filename, "utf8")
+  const { outputText } = ts.transpileModule(source, { compilerOptions, fileName: filename })
+  module._compile(outputText, filename)
+}
+
+const resolveFilename = Module._resolveFilename
+Module._resolveFilename = function (request, ...rest) {
+  const resolved = request.startsWith("@/") ? path.join(SOURCE_ROOT, request.slice(2)) : request
+  return resolveFilename.call(this, resolved, ...rest)
+}
+
+const { runHeadlessCli } = require(path.join(SOURCE_ROOT, "headless", "headless-cli.ts"))
+
+process.exitCode = runHeadlessCli(process.argv.slice(2))
@@ -4,10 +4,13 @@ import { useEffect, useRef, useState } from "react"
 import * as PIXI from "pixi.js"
 import { GameWorld } from "@/lib/GameWorld"
 import { Viewport } from "@/engine/viewport"
+import { WorldWorkerClient } from "@/engine/world-worker"
+import type { WorldWorkerResponse } from "@/engine/world-worker"
+import type { WorldConfig } from "@/engine/world"
 import type { ObjectId } from "@/types/game"
 import { Vec2 as Vec2Utils } from "@/utils/vec2"
 import { SELF_REPLICATOR_PRESET } from "../engine/presets/self-replicator-preset"
-import { setPresetParameters } from "@/config/game-law-parameters"
+import { getGameLawParameters, setPresetParameters } from "@/config/game-law-parameters"
 
 type GameCanvasProps = {
   width?: number
@@ -16,11 +19,44 @@ type GameCanvasProps = {
   isPaused?: boolean
   targetTPS?: number
   debugMode?: boolean
+  /**
+   * 世界をWorker内で実行するか（既定は実行しない。Workerが使えない環境ではメインスレッドで実行する）
+   * Worker内ではデバッガーとHULLの選択状態もWorker側にあり、HULLの情報は最新のスナップショットのみとなる
+   */
+  useWorker?: boolean
+}
+
+/**
+ * 世界の実行場所に応じてGameWorldを作成する
+ * Worker内で実行する場合、Workerはtick数・FPSの設定に従って世界を進め、描画用スナップショットを送る
+ */
+const createGameWorld = (
+  config: WorldConfig,
+  useWorker: boolean,
+  ticksPerFrame: number,
+  targetFPS: number,
+  isPaused: boolean
+): GameWorld => {
+  if (!useWorker || typeof Worker === "undefined") {
+    return new GameWorld(config)
+  }
+
+  const worker = new Worker(new URL("../engine/world.worker.ts", import.meta.url))
+  const client = new WorldWorkerClient(
+    worker,
+    config,
+    { ticksPerFrame, targetFPS, isPaused },
+    getGameLawParameters()
+  )
+  worker.onmessage = (event: MessageEvent<WorldWorkerResponse>) => {
+    client.handleMessage(event.data)
+  }
+  return new GameWorld(config, client)
 }
 
 /**
  * PixiJSを使用したゲームキャンバスコンポーネント
- * requestAnimationFrameごとにゲームがn tick進む
+ * requestAnimationFrameごとにゲームがn tick進む（Worker内で実行する場合はWorkerが同じ間隔で進める）
  */
 const GameCanvasPixi = ({
   width = 800,
@@ -29,6 +65,7 @@ const GameCanvasPixi = ({
   isPaused = false,
   targetTPS = 60,
   debugMode = false,
+  useWorker = false,
 }: GameCanvasProps) => {
   const containerRef = useRef<HTMLDivElement>(null)
   const appRef = useRef<PIXI.Application | null>(null)
@@ -44,6 +81,7 @@ const GameCanvasPixi = ({
   // isPausedの最新値を保持
   useEffect(() => {
     isPausedRef.current = isPaused
+    gameWorldRef.current?.updateWorkerSettings({ isPaused })
   }, [isPaused])
 
   // targetTPSの最新値を保持とFPS設定
@@ -53,6 +91,7 @@ const GameCanvasPixi = ({
       // PixiJSのtickerのmaxFPSを設定
       appRef.current.ticker.maxFPS = targetTPS
     }
+    gameWorldRef.current?.updateWorkerSettings({ targetFPS: targetTPS })
   }, [targetTPS])
 
   useEffect(() => {
@@ -87,17 +126,24 @@ const GameCanvasPixi = ({
       setPresetParameters(energyPreset)
 
       // GameWorldの初期化
-      const gameWorld = new GameWorld({
-        width,
-        height,
-        debugMode,
-        defaultAgentPresets: [
-          {
-            preset: SELF_REPLICATOR_PRESET,
-            position: Vec2Utils.create(width * 0.3, height * 0.5),
-          },
-        ],
-      })
+      const gameWorld = createGameWorld(
+        {
+          width,
+          height,
+          debugMode,
+          vmExecutionMode: "compiled",
+          defaultAgentPresets: [
+            {
+              preset: SELF_REPLICATOR_PRESET,
+              position: Vec2Utils.create(width * 0.3, height * 0.5),
+            },
+          ],
+        },
+        useWorker,
+        ticksPerFrame,
+        targetTPSRef.current,
+        isPausedRef.current
+      )
       gameWorldRef.current = gameWorld
       console.log("ゲームワールドを初期化しました")
 
@@ -215,7 +261,7 @@ const GameCanvasPixi = ({
       let lastTime = performance.now()
       let frameCount = 0
       let fps = 0
-      let tickCount = 0
+      let lastTickCount = gameWorld.tickCount
       let tps = 0
 
       // ズーム操作（マウスホイール）
@@ -243,23 +289,23 @@ const GameCanvasPixi = ({
         const currentTime = performance.now()
         if (currentTime - lastTime >= 1000) {
           fps = frameCount
-          tps = tickCount
+          tps = gameWorld.tickCount - lastTickCount
           frameCount = 0
-          tickCount = 0
+          lastTickCount = gameWorld.tickCount
           lastTime = currentTime
         }
 
-        // 一時停止中はtickを進めない
-        if (!isPausedRef.current) {
+        // 一時停止中はtickを進めない（Worker内で実行している場合はWorkerが進める）
+        if (!isPausedRef.current && !gameWorld.isRunningInWorker) {
           // ゲームをn tick進める
           for (let i = 0; i < ticksPerFrame; i++) {
             gameWorld.tick()
-            tickCount++
           }
         }
 
         // ゲーム世界をレンダリング（一時停止中も描画は継続）
-        gameWorld.renderPixi(gameContainer)
+        // 表示範囲内のみを、ズームに応じた詳細度で描画する
+        gameWorld.renderPixi(gameContainer, { ...viewport.getVisibleBounds(), zoom: viewport.zoom })
 
         // デバッグ情報更新
         const objectCount = gameWorld.getObjectCount()
@@ -269,7 +315,12 @@ const GameCanvasPixi = ({
         const posY = Math.round(viewportPos.y)
         const heatMapStatus = gameWorld.isHeatMapVisible ? "ON" : "OFF"
         const pauseStatus = isPausedRef.current ? " [PAUSED]" : ""
-        debugText.text = `FPS: ${fps}${pauseStatus}\nTPS: ${tps} / ${targetTPSRef.current}\nTick: ${gameWorld.tickCount}\nObjects: ${objectCount}\nZoom: ${zoom}x\nCamera: (${posX}, ${posY})\nHeat Map: ${heatMapStatus}`
+        const phaseTimes = gameWorld.getTickPhaseTimes()
+        const tickTime =
+          phaseTimes == null
+            ? "OFF"
+            : `phys ${phaseTimes.physics.toFixed(2)} / energy ${phaseTimes.energy.toFixed(2)} / vm ${phaseTimes.vm.toFixed(2)} / heat ${phaseTimes.heat.toFixed(2)} ms`
+        debugText.text = `FPS: ${fps}${pauseStatus}\nTPS: ${tps} / ${targetTPSRef.current}\nTick: ${gameWorld.tickCount}\nTick Time: ${tickTime}\nObjects: ${objectCount}\nZoom: ${zoom}x\nCamera: (${posX}, ${posY})\nHeat Map: ${heatMapStatus}`
       })
     }
 
@@ -281,10 +332,11 @@ const GameCanvasPixi = ({
         appRef.current.destroy(true, { children: true })
         appRef.current = null
       }
+      gameWorldRef.current?.dispose()
       gameWorldRef.current = null
       viewportRef.current = null
     }
-  }, [width, height, ticksPerFrame, energyPreset, debugMode])
+  }, [width, height, ticksPerFrame, energyPreset, debugMode, useWorker])
 
   // 熱マップ表示状態の変更を反映
   useEffect(() => {
@@ -0,0 +1,163 @@
+/**
+ * Broadphase テスト
+ */
+
+import { Broadphase } from "./broadphase"
+import { EntityStore } from "./entity-store"
+import type { GameObject, ObjectId } from "@/types/game"
+import { Vec2 as Vec2Utils } from "@/utils/vec2"
+
+const createTestObject = (id: number, x: number, y: number, radius = 10): GameObject => ({
+  id: id as ObjectId,
+  type: "ENERGY",
+  position: Vec2Utils.create(x, y),
+  velocity: Vec2Utils.create(0, 0),
+  radius,
+  energy: 50,
+  mass: 50,
+})
+
+describe("Broadphase", () => {
+  const cellSize = 100
+  const worldWidth = 1000
+  const worldHeight = 1000
+  let store: EntityStore
+  let broadphase: Broadphase
+  let buffer: Int32Array
+
+  const add = (obj: GameObject): void => {
+    store.add(obj)
+    broadphase.insert(store.indexOf(obj.id))
+  }
+
+  const remove = (id: number): void => {
+    broadphase.remove(store.indexOf(id as ObjectId))
+    store.remove(id as ObjectId)
+  }
+
+  // 近傍のIDを昇順で取得
+  const nearbyIds = (id: number): number[] => {
+    const count = broadphase.getNearbyObjects(store.indexOf(id as ObjectId), buffer)
+    return Array.from(buffer.subarray(0, count))
+      .map(index => store.objectAt(index)?.id ?? -1)
+      .sort((a, b) => a - b)
+  }
+
+  const nearbyIdsAt = (x: number, y: number, radius: number): number[] => {
+    const count = broadphase.getNearbyObjectsAtPosition(x, y, radius, buffer)
+    return Array.from(buffer.subarray(0, count))
+      .map(index => store.objectAt(index)?.id ?? -1)
+      .sort((a, b) => a - b)
+  }
+
+  beforeEach(() => {
+    store = new EntityStore(4)
+    broadphase = new Broadphase(store, cellSize, worldWidth, worldHeight)
+    buffer = new Int32Array(256)
+  })
+
+  test("登録したオブジェクトが中心のセルに入る", () => {
+    add(createTestObject(1, 150, 250))
+
+    const debugInfo = broadphase.getDebugInfo()
+    expect(debugInfo.totalObjects).toBe(1)
+    expect(debugInfo.cellOccupancy.get("1,2")).toBe(1)
+  })
+
+  test("近傍検索は自身を含まない", () => {
+    add(createTestObject(1, 50, 50))
+    add(createTestObject(2, 60, 60))
+    add(createTestObject(3, 550, 550))
+
+    expect(nearbyIds(1)).toEqual([2])
+    expect(nearbyIdsAt(55, 55, 10)).toEqual([1, 2])
+  })
+
+  test("削除で末尾が詰められても検索結果は正しい格納位置を返す", () => {
+    add(createTestObject(1, 50, 50))
+    add(createTestObject(2, 550, 550))
+    add(createTestObject(3, 60, 60))
+
+    remove(1)
+
+    expect(broadphase.count).toBe(2)
+    expect(nearbyIdsAt(55, 55, 10)).toEqual([3])
+    expect(nearbyIdsAt(550, 550, 10)).toEqual([2])
+  })
+
+  test("セルが変わったオブジェクトのみ付け替える", () => {
+    const obj1 = createTestObject(1, 50, 50)
+    const obj2 = createTestObject(2, 60, 60)
+    add(obj1)
+    add(obj2)
+
+    store.replace({ ...obj1, position: Vec2Utils.create(55, 55) })
+    store.replace({ ...obj2, position: Vec2Utils.create(350, 60) })
+    broadphase.refresh()
+
+    const debugInfo = broadphase.getDebugInfo()
+    expect(debugInfo.cellOccupancy.get("0,0")).toBe(1)
+    expect(debugInfo.cellOccupancy.get("3,0")).toBe(1)
+    expect(nearbyIdsAt(350, 60, 5)).toEqual([2])
+  })
+
+  test("単体の更新でセルを付け替える", () => {
+    const obj = createTestObject(1, 50, 50)
+    add(obj)
+
+    store.replace({ ...obj, position: Vec2Utils.create(950, 950) })
+    broadphase.update(store.indexOf(obj.id))
+
+    expect(broadphase.getDebugInfo().cellOccupancy.get("9,9")).toBe(1)
+    expect(nearbyIdsAt(50, 50, 5)).toEqual([])
+  })
+
+  test("refreshで最大半径が再計算される", () => {
+    add(createTestObject(1, 50, 50, 60))
+    add(createTestObject(2, 550, 550, 5))
+    expect(broadphase.maxRadius).toBe(60)
+
+    remove(1)
+    expect(broadphase.maxRadius).toBe(60)
+
+    broadphase.refresh()
+    expect(broadphase.maxRadius).toBe(5)
+  })
+
+  test("世界境界をまたぐ近傍検索", () => {
+    add(createTestObject(1, worldWidth - 5, 50))
+    add(createTestObject(2, 5, 50))
+
+    expect(nearbyIds(2)).toEqual([1])
+  })
+
+  test("再構築でストアの全オブジェクトが登録される", () => {
+    store.add(createTestObject(1, 50, 50))
+    store.add(createTestObject(2, 250, 250))
+
+    broadphase.rebuild()
+
+    const debugInfo = broadphase.getDebugInfo()
+    expect(debugInfo.totalObjects).toBe(2)
+    expect(debugInfo.cellOccupancy.get("0,0")).toBe(1)
+    expect(debugInfo.cellOccupancy.get("2,2")).toBe(1)
+  })
+
+  test("末尾へまとめて追加した範囲を一度に登録する", () => {
+    add(createTestObject(1, 50, 50))
+    const start = store.count
+    store.addAll([
+      createTestObject(2, 60, 60),
+      createTestObject(3, 250, 850, 30),
+      createTestObject(4, 550, 550),
+      createTestObject(5, 560, 560),
+    ])
+
+    broadphase.insertRange(start, store.count)
+
+    expect(broadphase.count).toBe(5)
+    expect(broadphase.maxRadius).toBe(30)
+    expect(nearbyIds(1)).toEqual([2])
+    expect(nearbyIds(4)).toEqual([5])
+  })
+})
@@ -0,0 +1,364 @@
+/**
+ * ブロードフェーズ - ワールドが所有する逐次更新型の空間インデックス
+ *
+ * エンティティストアのスロット番号ごとにセル内の双方向連結リストで管理する。
+ * オブジェクトの所属セルが変わった場合のみリストを付け替えるため、
+ * 毎tickの全再構築は行わない。検索結果はストア上の格納位置で返す
+ */
+
+import type { EntityStore } from "./entity-store"
+import { fillGridAxisRange, gridAxisCellOf } from "./spatial-hash-grid"
+
+const NONE = -1
+
+const growInt32 = (array: Int32Array, capacity: number): Int32Array => {
+  const grown = new Int32Array(capacity).fill(NONE)
+  grown.set(array)
+  return grown
+}
+
+export class Broadphase {
+  private readonly _store: EntityStore
+  private readonly _cellSize: number
+  private readonly _worldWidth: number
+  private readonly _worldHeight: number
+  private readonly _cols: number
+  private readonly _rows: number
+  private readonly _cellHead: Int32Array
+  private readonly _queryCols: Int32Array
+  private readonly _queryRows: Int32Array
+  private _cellOfSlot = new Int32Array(0)
+  private _next = new Int32Array(0)
+  private _prev = new Int32Array(0)
+  private _count = 0
+  private _maxRadius = 0
+
+  /** 登録されているオブジェクト数 */
+  public get count(): number {
+    return this._count
+  }
+
+  /**
+   * 登録されたオブジェクトの最大半径
+   * 削除では減少せず、refresh()で再計算される
+   */
+  public get maxRadius(): number {
+    return this._maxRadius
+  }
+
+  public constructor(
+    store: EntityStore,
+    cellSize: number,
+    worldWidth: number,
+    worldHeight: number
+  ) {
+    this._store = store
+    this._cellSize = cellSize
+    this._worldWidth = worldWidth
+    this._worldHeight = worldHeight
+    this._cols = Math.max(1, Math.ceil(worldWidth / cellSize))
+    this._rows = Math.max(1, Math.ceil(worldHeight / cellSize))
+    this._cellHead = new Int32Array(this._cols * this._rows).fill(NONE)
+    this._queryCols = new Int32Array(this._cols)
+    this._queryRows = new Int32Array(this._rows)
+  }
+
+  /** 座標が属するセルID（row * cols + col）を取得 */
+  public cellIdAt(x: number, y: number): number {
+    const col = gridAxisCellOf(x, this._worldWidth, this._cellSize, this._cols)
+    const row = gridAxisCellOf(y, this._worldHeight, this._cellSize, this._rows)
+    return row * this._cols + col
+  }
+
+  /**
+   * 格納位置のオブジェクトを登録する
+   * @param index ストア上の格納位置
+   */
+  public insert(index: number): void {
+    const slot = this._store.slotAt(index)
+    if (slot < 0) {
+      return
+    }
+    this.ensureSlotCapacity(slot + 1)
+    if ((this._cellOfSlot[slot] ?? NONE) !== NONE) {
+      this.update(index)
+      return
+    }
+
+    this.link(slot, this.cellIdOfIndex(index))
+    this._count++
+    this.expandMaxRadius(this._store.radius[index] ?? 0)
+  }
+
+  /**
+   * 格納位置の範囲のオブジェクトをまとめて登録する
+   * スロットの容量の確保は一度だけ行う
+   * @param start 最初の格納位置
+   * @param end 最後の格納位置の次
+   */
+  public insertRange(start: number, end: number): void {
+    const store = this._store
+    let maxSlot = NONE
+    for (let index = start; index < end; index++) {
+      const slot = store.slotAt(index)
+      if (slot > maxSlot) {
+        maxSlot = slot
+      }
+    }
+    if (maxSlot === NONE) {
+      return
+    }
+    this.ensureSlotCapacity(maxSlot + 1)
+
+    for (let index = start; index < end; index++) {
+      this.insert(index)
+    }
+  }
+
+  /**
+   * 格納位置のオブジェクトを登録解除する
+   * ストアから削除する前に呼び出すこと
+   * @param index ストア上の格納位置
+   */
+  public remove(index: number): void {
+    const slot = this._store.slotAt(index)
+    if (slot < 0 || slot >= this._cellOfSlot.length || this._cellOfSlot[slot] === NONE) {
+      return
+    }
+
+    this.unlink(slot)
+    this._count--
+  }
+
+  /**
+   * 格納位置のオブジェクトの所属セルを更新する
+   * セルが変わっていない場合は何もしない
+   * @param index ストア上の格納位置
+   */
+  public update(index: number): void {
+    const slot = this._store.slotAt(index)
+    if (slot < 0 || slot >= this._cellOfSlot.length) {
+      return
+    }
+    const currentCell = this._cellOfSlot[slot] ?? NONE
+    if (currentCell === NONE) {
+      return
+    }
+
+    this.expandMaxRadius(this._store.radius[index] ?? 0)
+    const cellId = this.cellIdOfIndex(index)
+    if (cellId === currentCell) {
+      return
+    }
+
+    this.unlink(slot)
+    this.link(slot, cellId)
+  }
+
+  /**
+   * 複数の格納位置のオブジェクトの所属セルをまとめて更新する
+   * @param indices ストア上の格納位置
+   * @param count 更新数
+   */
+  public updateMany(indices: ArrayLike<number>, count: number): void {
+    for (let k = 0; k < count; k++) {
+      this.update(indices[k] ?? NONE)
+    }
+  }
+
+  /**
+   * 全オブジェクトの所属セルを確認し、変わったものだけ付け替える
+   * 最大半径も再計算する
+   */
+  public refresh(): void {
+    const store = this._store
+    const positionX = store.positionX
+    const positionY = store.positionY
+    const radius = store.radius
+    let maxRadius = 0
+
+    for (let index = 0; index < store.count; index++) {
+      const slot = store.slotAt(index)
+      const cellId = this.cellIdAt(positionX[index] ?? 0, positionY[index] ?? 0)
+      const currentCell = this._cellOfSlot[slot] ?? NONE
+      if (currentCell !== cellId && currentCell !== NONE) {
+        this.unlink(slot)
+        this.link(slot, cellId)
+      }
+
+      const r = radius[index] ?? 0
+      if (r > maxRadius) {
+        maxRadius = r
+      }
+    }
+
+    this._maxRadius = maxRadius
+  }
+
+  /** ストアの全オブジェクトから再構築する */
+  public rebuild(): void {
+    this._cellHead.fill(NONE)
+    this._cellOfSlot.fill(NONE)
+    this._count = 0
+    this._maxRadius = 0
+    this.insertRange(0, this._store.count)
+  }
+
+  /**
+   * 指定オブジェクトの近傍にあるオブジェクトの格納位置を取得（自身は含まない）
+   * @param index ストア上の格納位置
+   * @param out 結果を書き込むバッファ
+   * @returns 近傍オブジェクト数。outの長さを超えた分は書き込まれない
+   */
+  public getNearbyObjects(index: number, out: Int32Array): number {
+    const x = this._store.positionX[index] ?? 0
+    const y = this._store.positionY[index] ?? 0
+    const range = (this._store.radius[index] ?? 0) + this._maxRadius
+    return this.collectInRange(x, y, range, index, out)
+  }
+
+  /**
+   * 指定位置の近傍にあるオブジェクトの格納位置を取得
+   * 半径radiusの円と重なり得るオブジェクトの候補を返す
+   * @param x X座標
+   * @param y Y座標
+   * @param radius 検索半径
+   * @param out 結果を書き込むバッファ
+   * @returns 近傍オブジェクト数。outの長さを超えた分は書き込まれない
+   */
+  public getNearbyObjectsAtPosition(
+    x: number,
+    y: number,
+    radius: number,
+    out: Int32Array
+  ): number {
+    return this.collectInRange(x, y, radius + this._maxRadius, NONE, out)
+  }
+
+  /** デバッグ用：インデックスの状態を取得 */
+  public getDebugInfo(): {
+    totalCells: number
+    totalObjects: number
+    cellOccupancy: Map<string, number>
+  } {
+    const cellOccupancy = new Map<string, number>()
+
+    for (let cellId = 0; cellId < this._cellHead.length; cellId++) {
+      let count = 0
+      let slot = this._cellHead[cellId] ?? NONE
+      while (slot !== NONE) {
+        count++
+        slot = this._next[slot] ?? NONE
+      }
+      if (count > 0) {
+        cellOccupancy.set(`${cellId % this._cols},${Math.floor(cellId / this._cols)}`, count)
+      }
+    }
+
+    return {
+      totalCells: cellOccupancy.size,
+      totalObjects: this._count,
+      cellOccupancy,
+    }
+  }
+
+  /** 範囲内のセルに登録されたオブジェクトの格納位置を集める */
+  private collectInRange(
+    x: number,
+    y: number,
+    range: number,
+    excludeIndex: number,
+    out: Int32Array
+  ): number {
+    const colCount = fillGridAxisRange(
+      x - range,
+      x + range,
+      this._worldWidth,
+      this._cellSize,
+      this._cols,
+      this._queryCols
+    )
+    const rowCount = fillGridAxisRange(
+      y - range,
+      y + range,
+      this._worldHeight,
+      this._cellSize,
+      this._rows,
+      this._queryRows
+    )
+
+    const capacity = out.length
+    let found = 0
+
+    for (let r = 0; r < rowCount; r++) {
+      const rowOffset = (this._queryRows[r] ?? 0) * this._cols
+      for (let c = 0; c < colCount; c++) {
+        const cellId = rowOffset + (this._queryCols[c] ?? 0)
+        let slot = this._cellHead[cellId] ?? NONE
+        while (slot !== NONE) {
+          const index = this._store.indexAtSlot(slot)
+          if (index !== excludeIndex && index !== NONE) {
+            if (found < capacity) {
+              out[found] = index
+            }
+            found++
+          }
+          slot = this._next[slot] ?? NONE
+        }
+      }
+    }
+
+    return found
+  }
+
+  private cellIdOfIndex(index: number): number {
+    return this.cellIdAt(this._store.positionX[index] ?? 0, this._store.positionY[index] ?? 0)
+  }
+
+  private link(slot: number, cellId: number): void {
+    const head = this._cellHead[cellId] ?? NONE
+    this._cellOfSlot[slot] = cellId
+    this._prev[slot] = NONE
+    this._next[slot] = head
+    if (head !== NONE) {
+      this._prev[head] = slot
+    }
+    this._cellHead[cellId] = slot
+  }
+
+  private unlink(slot: number): void {
+    const cellId = this._cellOfSlot[slot] ?? NONE
+    const prev = this._prev[slot] ?? NONE
+    const next = this._next[slot] ?? NONE
+
+    if (prev !== NONE) {
+      this._next[prev] = next
+    } else if (cellId !== NONE) {
+      this._cellHead[cellId] = next
+    }
+    if (next !== NONE) {
+      this._prev[next] = prev
+    }
+
+    this._cellOfSlot[slot] = NONE
+    this._prev[slot] = NONE
+    this._next[slot] = NONE
+  }
+
+  private expandMaxRadius(radius: number): void {
+    if (radius > this._maxRadius) {
+      this._maxRadius = radius
+    }
+  }
+
+  private ensureSlotCapacity(slotCount: number): void {
+    if (this._cellOfSlot.length >= slotCount) {
+      return
+    }
+
+    const capacity = Math.max(slotCount, this._cellOfSlot.length * 2, 64)
+    this._cellOfSlot = growInt32(this._cellOfSlot, capacity)
+    this._next = growInt32(this._next, capacity)
+    this._prev = growInt32(this._prev, capacity)
+  }
+}
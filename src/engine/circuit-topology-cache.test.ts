@@ -0,0 +1,112 @@
+/**
+ * CircuitTopologyCache テスト
+ */
+
+import { WorldStateManager } from "./world-state"
+import { ObjectFactory } from "./object-factory"
+import { buildCircuitTopology } from "./vm-unit-port"
+import type { Hull, ObjectId, Unit } from "@/types/game"
+import { isUnit } from "@/utils/type-guards"
+import { Vec2 as Vec2Utils } from "@/utils/vec2"
+
+describe("CircuitTopologyCache", () => {
+  const hullId = 1 as ObjectId
+  const computerId = 2 as ObjectId
+  const assemblerId = 3 as ObjectId
+  let stateManager: WorldStateManager
+  let factory: ObjectFactory
+  let hull: Hull
+
+  const getUnitById = (unitId: ObjectId): Unit | null => {
+    const obj = stateManager.getObject(unitId)
+    return obj != null && isUnit(obj) ? obj : null
+  }
+
+  const computer = () => {
+    const obj = stateManager.getObject(computerId)
+    if (obj?.type !== "COMPUTER") {
+      throw new Error("COMPUTER not found")
+    }
+    return obj
+  }
+
+  beforeEach(() => {
+    stateManager = new WorldStateManager(1000, 1000)
+    factory = new ObjectFactory(1000, 1000)
+    const position = Vec2Utils.create(500, 500)
+
+    hull = { ...factory.createHull(hullId, position, 100), attachedUnitIds: [computerId] }
+    stateManager.addObject(hull)
+    stateManager.addObject(factory.createComputer(computerId, position, 1, 64, hullId))
+  })
+
+  test("接続関係が変わらない限り同じポートを返す", () => {
+    const cache = stateManager.circuitTopology
+    const port = cache.getUnitPort(computer())
+
+    // エネルギー量だけの置き換えでは破棄されない
+    stateManager.updateObject({ ...hull, storedEnergy: 500 })
+
+    expect(cache.getUnitPort(computer())).toBe(port)
+    expect(cache.size).toBe(1)
+  })
+
+  test("置き換えたオブジェクトの最新の状態を参照する", () => {
+    const port = stateManager.circuitTopology.getUnitPort(computer())
+
+    expect(port.read("HULL", 0, 0x03)).toBe(0) // エネルギー格納量
+
+    stateManager.updateObject({ ...hull, storedEnergy: 50 })
+
+    expect(port.read("HULL", 0, 0x03)).toBe(50)
+  })
+
+  test("ユニットの接続で表を作り直す", () => {
+    const cache = stateManager.circuitTopology
+    const port = cache.getUnitPort(computer())
+    expect(port.exists("ASSEMBLER", 0)).toBe(false)
+
+    const position = Vec2Utils.create(500, 500)
+    stateManager.updateObject({ ...hull, attachedUnitIds: [computerId, assemblerId] })
+    stateManager.addObject(factory.createAssembler(assemblerId, position, 1, hullId))
+
+    const updatedPort = cache.getUnitPort(computer())
+    expect(updatedPort).not.toBe(port)
+    expect(updatedPort.exists("ASSEMBLER", 0)).toBe(true)
+  })
+
+  test("ユニットの破壊で表を作り直す", () => {
+    const position = Vec2Utils.create(500, 500)
+    stateManager.updateObject({ ...hull, attachedUnitIds: [computerId, assemblerId] })
+    stateManager.addObject(factory.createAssembler(assemblerId, position, 1, hullId))
+    const cache = stateManager.circuitTopology
+    const port = cache.getUnitPort(computer())
+
+    stateManager.removeObject(assemblerId)
+
+    expect(cache.getUnitPort(computer())).not.toBe(port)
+  })
+
+  test("COMPUTER自身の削除で表が破棄される", () => {
+    const cache = stateManager.circuitTopology
+    cache.getUnitPort(computer())
+
+    stateManager.removeObject(computerId)
+
+    expect(cache.size).toBe(0)
+  })
+
+  test("インデックス表は探索結果と一致する", () => {
+    const position = Vec2Utils.create(500, 500)
+    stateManager.updateObject({ ...hull, attachedUnitIds: [computerId, assemblerId] })
+    stateManager.addObject(factory.createAssembler(assemblerId, position, 1, hullId))
+
+    const topology = buildCircuitTopology(computer(), getUnitById)
+    const port = stateManager.circuitTopology.getUnitPort(computer())
+
+    expect(topology.COMPUTER[0]).toBe(computerId)
+    expect(topology.ASSEMBLER).toEqual([assemblerId])
+    topology.HULL.forEach((_, index) => expect(port.exists("HULL", index)).toBe(true))
+    expect(port.exists("HULL", topology.HULL.length)).toBe(false)
+  })
+})
@@ -0,0 +1,109 @@
+/**
+ * 回路トポロジーキャッシュ
+ *
+ * COMPUTERごとに回路接続されたユニットのインデックス表とVMユニットポートを保持し、
+ * VM実行のたびにHULLのグラフを探索しないようにする。
+ * 表はユニットIDで保持し、ユニット本体はアクセス時にIDから解決するため、
+ * オブジェクトの置き換え（エネルギー量の更新など）では破棄しない。
+ * 接続・切断・合体・生産完了・破壊でトポロジーが変わったときは、
+ * 変わったユニットを参照していたCOMPUTERの表のみを破棄する
+ */
+
+import type { Computer, ObjectId, Unit } from "@/types/game"
+import { buildCircuitTopology, VMPhysicalUnitPort, VMUnitPort } from "./vm-unit-port"
+
+export class CircuitTopologyCache {
+  private readonly _getUnitById: (unitId: ObjectId) => Unit | null
+  /** COMPUTERのIDごとのユニットポート */
+  private readonly _ports = new Map<ObjectId, VMPhysicalUnitPort>()
+  /** COMPUTERのIDごとの、表の作成時に参照したユニットID */
+  private readonly _referencedIds = new Map<ObjectId, Set<ObjectId>>()
+  /** ユニットIDごとの、そのユニットを参照している表を持つCOMPUTERのID */
+  private readonly _dependentComputerIds = new Map<ObjectId, Set<ObjectId>>()
+
+  /** キャッシュされている表の数 */
+  public get size(): number {
+    return this._ports.size
+  }
+
+  public constructor(getUnitById: (unitId: ObjectId) => Unit | null) {
+    this._getUnitById = getUnitById
+  }
+
+  /**
+   * COMPUTERのユニットポートを取得（キャッシュになければ探索して作成する）
+   * @param computer 起点のCOMPUTER
+   */
+  public getUnitPort(computer: Computer): VMUnitPort {
+    const cached = this._ports.get(computer.id)
+    if (cached != null) {
+      return cached
+    }
+
+    const referencedIds = new Set<ObjectId>()
+    const topology = buildCircuitTopology(computer, this._getUnitById, referencedIds)
+    const port = new VMPhysicalUnitPort(computer, this._getUnitById, topology)
+
+    this._ports.set(computer.id, port)
+    this._referencedIds.set(computer.id, referencedIds)
+    referencedIds.forEach(unitId => {
+      let dependents = this._dependentComputerIds.get(unitId)
+      if (dependents == null) {
+        dependents = new Set()
+        this._dependentComputerIds.set(unitId, dependents)
+      }
+      dependents.add(computer.id)
+    })
+
+    return port
+  }
+
+  /**
+   * ユニットの接続関係が変わったことを通知する
+   * ユニット自身と所属HULLを参照している表を破棄する
+   * @param unit 追加・削除・接続関係が変わったユニット
+   */
+  public invalidateUnit(unit: Unit): void {
+    this.invalidate(unit.id)
+    if (unit.parentHullId != null) {
+      this.invalidate(unit.parentHullId)
+    }
+  }
+
+  /**
+   * 指定ユニットを参照している表を破棄する
+   * @param unitId ユニットID
+   */
+  public invalidate(unitId: ObjectId): void {
+    const dependents = this._dependentComputerIds.get(unitId)
+    if (dependents != null) {
+      Array.from(dependents).forEach(computerId => this.drop(computerId))
+    }
+    // 削除されたCOMPUTER自身の表
+    this.drop(unitId)
+  }
+
+  /** 全ての表を破棄する */
+  public clear(): void {
+    this._ports.clear()
+    this._referencedIds.clear()
+    this._dependentComputerIds.clear()
+  }
+
+  private drop(computerId: ObjectId): void {
+    const referencedIds = this._referencedIds.get(computerId)
+    if (referencedIds == null) {
+      return
+    }
+
+    referencedIds.forEach(unitId => {
+      const dependents = this._dependentComputerIds.get(unitId)
+      dependents?.delete(computerId)
+      if (dependents?.size === 0) {
+        this._dependentComputerIds.delete(unitId)
+      }
+    })
+    this._referencedIds.delete(computerId)
+    this._ports.delete(computerId)
+  }
+}
@@ -2,9 +2,21 @@
  * 衝突検出システム - 円形オブジェクト専用の効率的な衝突判定
  */
 
-import type { GameObject, ObjectId, Vec2 } from "@/types/game"
+import type { GameObject, ObjectCollection, ObjectId, Vec2 } from "@/types/game"
 import { SpatialHashGrid } from "./spatial-hash-grid"
-import { shortestVector } from "@/utils/torus-math"
+import { EntityStore } from "./entity-store"
+
+const growInt32 = (array: Int32Array, capacity: number): Int32Array => {
+  const grown = new Int32Array(capacity)
+  grown.set(array)
+  return grown
+}
+
+const growFloat64 = (array: Float64Array, capacity: number): Float64Array => {
+  const grown = new Float64Array(capacity)
+  grown.set(array)
+  return grown
+}
 
 /** 衝突ペア */
 export type CollisionPair = {
@@ -21,207 +33,303 @@ export type CollisionResult = {
   readonly actualCollisions: number
 }
 
+/**
+ * 衝突ペアの列データ
+ * CollisionDetector内部で再利用されるため、次の検出呼び出しまでのみ有効
+ */
+export type CollisionBuffer = {
+  /** 衝突ペア数 */
+  count: number
+  /** 判定したペア数 */
+  totalChecks: number
+  /** オブジェクト1の格納位置 */
+  index1: Int32Array
+  /** オブジェクト2の格納位置 */
+  index2: Int32Array
+  /** オブジェクト1からオブジェクト2への最短ベクトルX */
+  deltaX: Float64Array
+  /** オブジェクト1からオブジェクト2への最短ベクトルY */
+  deltaY: Float64Array
+  /** 中心間距離 */
+  distance: Float64Array
+  /** 重なり深度 */
+  overlap: Float64Array
+}
+
+/**
+ * 近傍オブジェクト検索
+ * 検索結果はストア上の格納位置で返す。SpatialHashGridとBroadphaseが満たす
+ */
+export type NearbyObjectQuery = {
+  /** 指定オブジェクトの近傍の格納位置を書き込み、総数を返す（自身は含まない） */
+  getNearbyObjects: (index: number, out: Int32Array) => number
+  /** 指定位置の近傍の格納位置を書き込み、総数を返す */
+  getNearbyObjectsAtPosition: (x: number, y: number, radius: number, out: Int32Array) => number
+}
+
+const INITIAL_BUFFER_CAPACITY = 64
+
 export class CollisionDetector {
   private readonly _worldWidth: number
   private readonly _worldHeight: number
   private readonly _spatialGrid: SpatialHashGrid
+  /** EntityStore以外で渡されたオブジェクトの列（値のみ複製する） */
+  private readonly _scratchStore = new EntityStore()
+  private readonly _collisions: CollisionBuffer
+  private _neighbors = new Int32Array(INITIAL_BUFFER_CAPACITY)
 
   public constructor(cellSize: number, worldWidth: number, worldHeight: number) {
     this._worldWidth = worldWidth
     this._worldHeight = worldHeight
     this._spatialGrid = new SpatialHashGrid(cellSize, worldWidth, worldHeight)
+    this._collisions = {
+      count: 0,
+      totalChecks: 0,
+      index1: new Int32Array(INITIAL_BUFFER_CAPACITY),
+      index2: new Int32Array(INITIAL_BUFFER_CAPACITY),
+      deltaX: new Float64Array(INITIAL_BUFFER_CAPACITY),
+      deltaY: new Float64Array(INITIAL_BUFFER_CAPACITY),
+      distance: new Float64Array(INITIAL_BUFFER_CAPACITY),
+      overlap: new Float64Array(INITIAL_BUFFER_CAPACITY),
+    }
   }
 
   /**
    * 全オブジェクト間の衝突を検出
-   * @param objects ゲームオブジェクトのマップ
+   * @param objects ゲームオブジェクトのコレクション
    * @returns 衝突検出結果
    */
-  public detectCollisions(objects: Map<ObjectId, GameObject>): CollisionResult {
-    // グリッドをクリアして再登録
-    this._spatialGrid.clear()
+  public detectCollisions(objects: ObjectCollection): CollisionResult {
+    const store = this.toEntityStore(objects)
+    const collisions = this.detectCollisionIndices(store)
 
-    // 全オブジェクトをグリッドに登録
-    for (const object of objects.values()) {
-      this._spatialGrid.register(object)
+    const pairs: CollisionPair[] = []
+    for (let k = 0; k < collisions.count; k++) {
+      const object1 = store.objectAt(collisions.index1[k] ?? -1)
+      const object2 = store.objectAt(collisions.index2[k] ?? -1)
+      if (object1 == null || object2 == null) {
+        continue
+      }
+
+      pairs.push({
+        object1,
+        object2,
+        distance: collisions.distance[k] ?? 0,
+        overlap: collisions.overlap[k] ?? 0,
+      })
     }
 
-    // 衝突ペアを検出
-    const pairs: CollisionPair[] = []
-    const processedPairs = new Set<string>()
-    let totalChecks = 0
-    let actualCollisions = 0
+    if (store === this._scratchStore) {
+      store.clear()
+    }
+
+    return {
+      pairs,
+      totalChecks: collisions.totalChecks,
+      actualCollisions: collisions.count,
+    }
+  }
+
+  /**
+   * エンティティストアの全オブジェクト間の衝突を列データとして検出
+   * ペアは格納位置の小さい方をオブジェクト1とする
+   * @param store エンティティストア
+   * @param query ストアと同期済みの近傍検索（省略時は内部グリッドを再構築して使う）
+   * @param active 指定した場合は値が1のオブジェクト同士のペアのみ検出する
+   * @returns 衝突ペアの列データ（次の呼び出しまで有効）
+   */
+  public detectCollisionIndices(
+    store: EntityStore,
+    query?: NearbyObjectQuery,
+    active?: ArrayLike<number>
+  ): CollisionBuffer {
+    const count = store.count
+    const positionX = store.positionX
+    const positionY = store.positionY
+    const radius = store.radius
+    const collisions = this._collisions
+    collisions.count = 0
+    collisions.totalChecks = 0
+
+    const nearby = query ?? this.rebuildGrid(store)
+    this.ensureNeighborCapacity(count)
+    const neighbors = this._neighbors
+
+    for (let i = 0; i < count; i++) {
+      if (active != null && active[i] !== 1) {
+        continue
+      }
+      const neighborCount = nearby.getNearbyObjects(i, neighbors)
+      const x1 = positionX[i] ?? 0
+      const y1 = positionY[i] ?? 0
+      const radius1 = radius[i] ?? 0
 
-    // 各オブジェクトについて近傍オブジェクトとの衝突をチェック
-    for (const object1 of objects.values()) {
-      const nearbyIds = this._spatialGrid.getNearbyObjects(object1)
+      for (let k = 0; k < neighborCount; k++) {
+        const j = neighbors[k] ?? 0
 
-      for (const id2 of nearbyIds) {
-        const object2 = objects.get(id2)
-        if (object2 === undefined) {
+        // ペアの重複チェック（格納位置の小さい方から判定する）
+        if (j <= i || (active != null && active[j] !== 1)) {
           continue
         }
+        collisions.totalChecks++
+
+        // トーラス世界での最短ベクトルを計算
+        const deltaX = this.shortestDelta((positionX[j] ?? 0) - x1, this._worldWidth)
+        const deltaY = this.shortestDelta((positionY[j] ?? 0) - y1, this._worldHeight)
+
+        // 距離の二乗を計算（平方根を避けて高速化）
+        const distanceSq = deltaX * deltaX + deltaY * deltaY
+        const radius2 = radius[j] ?? 0
+        const radiusSum = radius1 + radius2
 
-        // ペアの重複チェック（IDの小さい方を先にして正規化）
-        const pairKey = this.getPairKey(object1.id, object2.id)
-        if (processedPairs.has(pairKey)) {
+        // 衝突していない場合
+        if (distanceSq >= radiusSum * radiusSum) {
           continue
         }
 
-        processedPairs.add(pairKey)
-        totalChecks++
-
-        // 詳細な衝突判定
-        const collision = this.checkCollision(object1, object2)
-        if (collision != null) {
-          pairs.push(collision)
-          actualCollisions++
+        // 半径0のオブジェクトは衝突しない
+        if (radius1 === 0 || radius2 === 0) {
+          continue
         }
+
+        // 実際の距離を計算（衝突している場合のみ）
+        const distance = Math.sqrt(distanceSq)
+        this.pushCollision(i, j, deltaX, deltaY, distance, radiusSum - distance)
       }
     }
 
-    return {
-      pairs,
-      totalChecks,
-      actualCollisions,
-    }
+    return collisions
   }
 
   /**
    * 特定位置での衝突を検出
    * @param position 検査位置
    * @param radius 検査半径
-   * @param objects ゲームオブジェクトのマップ
+   * @param objects ゲームオブジェクトのコレクション
    * @param excludeId 除外するオブジェクトID（オプション）
+   * @param query objectsと同期済みの近傍検索（省略時は内部グリッドを再構築して使う）
    * @returns 衝突しているオブジェクトのリスト
    */
   public detectCollisionsAtPosition(
     position: Vec2,
     radius: number,
-    objects: Map<ObjectId, GameObject>,
-    excludeId?: ObjectId
+    objects: ObjectCollection,
+    excludeId?: ObjectId,
+    query?: NearbyObjectQuery
   ): GameObject[] {
-    // 空間グリッドを更新
-    this._spatialGrid.clear()
-    for (const object of objects.values()) {
-      this._spatialGrid.register(object)
-    }
+    const store = this.toEntityStore(objects)
+    const nearby = query ?? this.rebuildGrid(store)
+    this.ensureNeighborCapacity(store.count)
 
     const collisions: GameObject[] = []
-    const nearbyIds = this._spatialGrid.getNearbyObjectsAtPosition(position, radius)
-
-    for (const id of nearbyIds) {
-      if (id === excludeId) {
-        continue
-      }
+    const nearbyCount = nearby.getNearbyObjectsAtPosition(
+      position.x,
+      position.y,
+      radius,
+      this._neighbors
+    )
 
-      const object = objects.get(id)
-      if (object === undefined) {
+    for (let k = 0; k < nearbyCount; k++) {
+      const index = this._neighbors[k] ?? 0
+      const object = store.objectAt(index)
+      if (object === undefined || object.id === excludeId) {
         continue
       }
 
       // 仮想オブジェクトとの衝突判定
-      const virtualObject: Partial<GameObject> = {
-        position,
-        radius,
+      const otherRadius = store.radius[index] ?? 0
+      if (radius === 0 || otherRadius === 0) {
+        continue
       }
 
-      if (this.checkCollisionBetween(virtualObject as GameObject, object)) {
+      const offsetX = (store.positionX[index] ?? 0) - position.x
+      const offsetY = (store.positionY[index] ?? 0) - position.y
+      const deltaX = this.shortestDelta(offsetX, this._worldWidth)
+      const deltaY = this.shortestDelta(offsetY, this._worldHeight)
+      const radiusSum = radius + otherRadius
+      if (deltaX * deltaX + deltaY * deltaY < radiusSum * radiusSum) {
         collisions.push(object)
       }
     }
 
+    if (store === this._scratchStore) {
+      store.clear()
+    }
+
     return collisions
   }
 
   /**
-   * 2つのオブジェクト間の衝突をチェック
-   * @param object1 オブジェクト1
-   * @param object2 オブジェクト2
-   * @returns 衝突している場合は衝突情報、そうでなければnull
+   * エンティティストア以外のコレクションは一時ストアに格納して扱う
    */
-  private checkCollision(object1: GameObject, object2: GameObject): CollisionPair | null {
-    // トーラス世界での最短ベクトルを計算
-    const delta = shortestVector(
-      object1.position,
-      object2.position,
-      this._worldWidth,
-      this._worldHeight
-    )
-
-    // 距離の二乗を計算（平方根を避けて高速化）
-    const distanceSq = delta.x * delta.x + delta.y * delta.y
-    const radiusSum = object1.radius + object2.radius
-    const radiusSumSq = radiusSum * radiusSum
-
-    // 衝突していない場合
-    if (distanceSq >= radiusSumSq) {
-      return null
+  private toEntityStore(objects: ObjectCollection): EntityStore {
+    if (objects instanceof EntityStore) {
+      return objects
     }
 
-    // 半径0のオブジェクトは衝突しない
-    if (object1.radius === 0 || object2.radius === 0) {
-      return null
+    for (const object of objects.values()) {
+      this._scratchStore.add(object)
     }
+    return this._scratchStore
+  }
 
-    // 実際の距離を計算（衝突している場合のみ）
-    const distance = Math.sqrt(distanceSq)
-    const overlap = radiusSum - distance
+  /** 内部の空間グリッドをストアから再構築する */
+  private rebuildGrid(store: EntityStore): SpatialHashGrid {
+    this._spatialGrid.rebuild(store.positionX, store.positionY, store.radius, store.count)
+    return this._spatialGrid
+  }
 
-    return {
-      object1,
-      object2,
-      distance,
-      overlap,
+  /** トーラス世界での最短の座標差 */
+  private shortestDelta(delta: number, worldSize: number): number {
+    if (Math.abs(delta) > worldSize / 2) {
+      return delta > 0 ? delta - worldSize : delta + worldSize
     }
+    return delta
   }
 
-  /**
-   * 2つのオブジェクト間の衝突判定（単純なboolean返却）
-   */
-  private checkCollisionBetween(object1: GameObject, object2: GameObject): boolean {
-    const delta = shortestVector(
-      object1.position,
-      object2.position,
-      this._worldWidth,
-      this._worldHeight
-    )
-
-    // 半径0のオブジェクトは衝突しない
-    if (object1.radius === 0 || object2.radius === 0) {
-      return false
+  private ensureNeighborCapacity(count: number): void {
+    if (this._neighbors.length < count) {
+      this._neighbors = new Int32Array(Math.max(count, this._neighbors.length * 2))
     }
-
-    const distanceSq = delta.x * delta.x + delta.y * delta.y
-    const radiusSum = object1.radius + object2.radius
-    const radiusSumSq = radiusSum * radiusSum
-
-    return distanceSq < radiusSumSq
   }
 
-  /**
-   * ペアのキーを生成（重複チェック用）
-   */
-  private getPairKey(id1: ObjectId, id2: ObjectId): string {
-    // IDを数値として比較（ObjectIdの内部表現に依存）
-    const numId1 = id1 as unknown as number
-    const numId2 = id2 as unknown as number
-
-    if (numId1 < numId2) {
-      return `${id1},${id2}`
-    } else {
-      return `${id2},${id1}`
+  private pushCollision(
+    index1: number,
+    index2: number,
+    deltaX: number,
+    deltaY: number,
+    distance: number,
+    overlap: number
+  ): void {
+    const collisions = this._collisions
+    if (collisions.count >= collisions.index1.length) {
+      const capacity = collisions.index1.length * 2
+      collisions.index1 = growInt32(collisions.index1, capacity)
+      collisions.index2 = growInt32(collisions.index2, capacity)
+      collisions.deltaX = growFloat64(collisions.deltaX, capacity)
+      collisions.deltaY = growFloat64(collisions.deltaY, capacity)
+      collisions.distance = growFloat64(collisions.distance, capacity)
+      collisions.overlap = growFloat64(collisions.overlap, capacity)
     }
+
+    const k = collisions.count
+    collisions.index1[k] = index1
+    collisions.index2[k] = index2
+    collisions.deltaX[k] = deltaX
+    collisions.deltaY[k] = deltaY
+    collisions.distance[k] = distance
+    collisions.overlap[k] = overlap
+    collisions.count = k + 1
   }
 
   /**
    * 空間グリッドを更新（オブジェクトの移動時に使用）
-   * @param oldObject 移動前のオブジェクト
-   * @param newObject 移動後のオブジェクト
+   * グリッドは検出のたびに列データから再構築されるため、何もしない
+   * @param _oldObject 移動前のオブジェクト
+   * @param _newObject 移動後のオブジェクト
    */
-  public updateObject(oldObject: GameObject, newObject: GameObject): void {
-    this._spatialGrid.unregister(oldObject)
-    this._spatialGrid.register(newObject)
+  public updateObject(_oldObject: GameObject, _newObject: GameObject): void {
+    // 互換性のために残す
   }
 
   /**
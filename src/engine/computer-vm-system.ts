@@ -2,18 +2,46 @@
  * COMPUTERユニットのVM実行を管理するシステム
  */
 
-import type { Computer, ObjectId, Unit } from "@/types/game"
+import type { Computer, ObjectId } from "@/types/game"
 import { InstructionExecutor } from "./vm-executor"
-import { VMPhysicalUnitPort, VMUnitPort } from "./vm-unit-port"
+import { CompiledInstructionExecutor } from "./vm-compiled-executor"
+import { JitInstructionExecutor } from "./vm-jit-executor"
+import { VMUnitPort } from "./vm-unit-port"
+
+/**
+ * VMの実行方式
+ * - interpreter: 命令ごとにニーモニックで分岐するリファレンス実装
+ * - compiled: アドレスごとにコンパイルしたクロージャを再利用する実装（結果・サイクル数は同一）
+ * - jit: 頻繁に実行される基本ブロックをJavaScript関数に変換する実装（結果・サイクル数は同一）
+ */
+export type VMExecutionMode = "interpreter" | "compiled" | "jit"
+
+const EXECUTORS = {
+  interpreter: InstructionExecutor,
+  compiled: CompiledInstructionExecutor,
+  jit: JitInstructionExecutor,
+} as const
 
 export class ComputerVMSystem {
-  public executeVM(computer: Computer, getUnitById: (unitId: ObjectId) => Unit | null): void {
+  protected readonly _executor: (typeof EXECUTORS)[VMExecutionMode]
+
+  public constructor(executionMode: VMExecutionMode = "interpreter") {
+    this._executor = EXECUTORS[executionMode]
+  }
+
+  /**
+   * COMPUTERのVMを1tick分実行する
+   * @param computer 実行するCOMPUTER
+   * @param unitPort 回路接続されたユニットへのポート
+   * @returns このtickに実行したサイクル数
+   */
+  public executeVM(computer: Computer, unitPort: VMUnitPort): number {
     if (computer.computingState.skippingTicks > 0) {
       computer.computingState.skippingTicks -= 1
 
       if (computer.computingState.skippingTicks > 0) {
         // 分数周波数を持つ場合
-        return
+        return 0
       }
     }
 
@@ -34,24 +62,17 @@ export class ComputerVMSystem {
       cycles -= computer.computingState.cycleOverflow
     } else {
       computer.computingState.cycleOverflow -= cycles
-      return
+      return 0
     }
 
-    const unitPort: VMUnitPort = new VMPhysicalUnitPort(computer, getUnitById)
     const { cyclesUsed } = this.run(cycles, computer, unitPort)
 
     computer.computingState.cycleOverflow = cyclesUsed - cycles
+    return cyclesUsed
   }
 
   protected run(cycles: number, computer: Computer, unitPort: VMUnitPort): { cyclesUsed: number } {
-    let cyclesUsed = 0
-
-    while (cyclesUsed < cycles) {
-      const result = InstructionExecutor.step(computer.vm, unitPort)
-      cyclesUsed += result.cycles
-    }
-
-    return { cyclesUsed }
+    return { cyclesUsed: this._executor.run(computer.vm, cycles, unitPort) }
   }
 }
 
@@ -72,7 +93,7 @@ export class DebugComputerVMSystem extends ComputerVMSystem {
 
     while (cyclesUsed < cycles) {
       const programCounter = computer.vm.programCounter
-      const result = InstructionExecutor.step(computer.vm, unitPort)
+      const result = this._executor.step(computer.vm, unitPort)
       cyclesUsed += result.cycles
 
       debugMessages.push(
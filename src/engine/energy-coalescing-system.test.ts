@@ -0,0 +1,174 @@
+/**
+ * エネルギー統合システムのテスト
+ */
+
+import { EnergyCoalescingSystem } from "./energy-coalescing-system"
+import { calculateEnergyRadius } from "./object-factory"
+import { World } from "./world"
+import type { EnergyObject, ObjectId } from "@/types/game"
+import { Vec2 as Vec2Utils } from "@/utils/vec2"
+
+// テスト用のエネルギーオブジェクト生成
+const createTestEnergyObject = (
+  id: number,
+  energy: number,
+  x: number,
+  y: number,
+  vx = 0,
+  vy = 0
+): EnergyObject => {
+  return {
+    id: id as ObjectId,
+    type: "ENERGY",
+    position: Vec2Utils.create(x, y),
+    velocity: Vec2Utils.create(vx, vy),
+    radius: calculateEnergyRadius(energy),
+    energy,
+    mass: energy,
+  }
+}
+
+const sum = (objects: readonly EnergyObject[], value: (obj: EnergyObject) => number): number =>
+  objects.reduce((total, obj) => total + value(obj), 0)
+
+/** 統合結果を適用した後のオブジェクト */
+const applyResult = (
+  objects: readonly EnergyObject[],
+  system: EnergyCoalescingSystem
+): EnergyObject[] => {
+  const result = system.coalesce(objects)
+  const removed = new Set(result.removedIds)
+  const merged = new Map(result.mergedObjects.map(obj => [obj.id, obj]))
+  return objects.filter(obj => !removed.has(obj.id)).map(obj => merged.get(obj.id) ?? obj)
+}
+
+describe("EnergyCoalescingSystem", () => {
+  test("格子内の数が上限以下の場合は統合しない", () => {
+    const system = new EnergyCoalescingSystem(200, 200, {
+      cellSize: 50,
+      maxObjectsPerCell: 3,
+      maxSpeed: 1,
+    })
+    const objects = [
+      createTestEnergyObject(1, 10, 10, 10),
+      createTestEnergyObject(2, 10, 20, 20),
+      createTestEnergyObject(3, 10, 30, 30),
+      createTestEnergyObject(4, 10, 60, 10),
+    ]
+
+    const result = system.coalesce(objects)
+
+    expect(result.removedIds).toEqual([])
+    expect(result.mergedObjects).toEqual([])
+  })
+
+  test("上限を超えた格子では小さいものを統合し、エネルギー量・質量・運動量を保存する", () => {
+    const system = new EnergyCoalescingSystem(200, 200, {
+      cellSize: 50,
+      maxObjectsPerCell: 3,
+      maxSpeed: 1,
+    })
+    const objects = [
+      createTestEnergyObject(1, 100, 10, 10),
+      createTestEnergyObject(2, 50, 20, 20),
+      createTestEnergyObject(3, 30, 30, 30, 0.5, 0),
+      createTestEnergyObject(4, 20, 40, 40, 0, -0.5),
+      createTestEnergyObject(5, 10, 45, 30, -0.5, 0.5),
+    ]
+
+    const after = applyResult(objects, system)
+
+    expect(after.map(obj => obj.id)).toEqual([1, 2, 3])
+    expect(sum(after, obj => obj.energy)).toBe(sum(objects, obj => obj.energy))
+    expect(sum(after, obj => obj.mass)).toBe(sum(objects, obj => obj.mass))
+    expect(sum(after, obj => obj.velocity.x * obj.mass)).toBeCloseTo(
+      sum(objects, obj => obj.velocity.x * obj.mass)
+    )
+    expect(sum(after, obj => obj.velocity.y * obj.mass)).toBeCloseTo(
+      sum(objects, obj => obj.velocity.y * obj.mass)
+    )
+
+    // 統合先は質量中心に置かれ、半径はエネルギー量から求め直す
+    const merged = after[2]
+    expect(merged?.energy).toBe(60)
+    expect(merged?.position.x).toBeCloseTo((30 * 30 + 40 * 20 + 45 * 10) / 60)
+    expect(merged?.position.y).toBeCloseTo((30 * 30 + 40 * 20 + 30 * 10) / 60)
+    expect(merged?.radius).toBe(calculateEnergyRadius(60))
+  })
+
+  test("速いエネルギーオブジェクトは統合しない", () => {
+    const system = new EnergyCoalescingSystem(200, 200, {
+      cellSize: 50,
+      maxObjectsPerCell: 2,
+      maxSpeed: 1,
+    })
+    const objects = [
+      createTestEnergyObject(1, 10, 10, 10),
+      createTestEnergyObject(2, 10, 20, 20, 3, 0),
+      createTestEnergyObject(3, 10, 30, 30, 0, -3),
+    ]
+
+    const result = system.coalesce(objects)
+
+    expect(result.removedIds).toEqual([])
+  })
+
+  test("世界の端をまたぐ格子でも近い側の質量中心に統合する", () => {
+    const system = new EnergyCoalescingSystem(100, 100, {
+      cellSize: 100,
+      maxObjectsPerCell: 2,
+      maxSpeed: 1,
+    })
+    const objects = [
+      createTestEnergyObject(1, 100, 50, 50),
+      createTestEnergyObject(2, 10, 98, 50),
+      createTestEnergyObject(3, 10, 2, 50),
+    ]
+
+    const after = applyResult(objects, system)
+
+    expect(after).toHaveLength(2)
+    const merged = after.find(obj => obj.energy === 20)
+    // 98と2の中心は0（世界の端）
+    expect([0, 100]).toContainEqual(Math.round(merged?.position.x ?? -1))
+  })
+
+  test("毎回上限まで統合するため、格子ごとの数は上限を超えない", () => {
+    const system = new EnergyCoalescingSystem(100, 100, {
+      cellSize: 50,
+      maxObjectsPerCell: 4,
+      maxSpeed: 1,
+    })
+    let objects: EnergyObject[] = []
+    let nextId = 1
+    for (let tick = 0; tick < 20; tick++) {
+      for (let i = 0; i < 5; i++) {
+        objects.push(createTestEnergyObject(nextId++, 5, (i * 23 + tick * 7) % 100, (i * 37) % 100))
+      }
+      objects = applyResult(objects, system)
+    }
+
+    expect(objects.length).toBeLessThanOrEqual(4 * 4)
+    expect(sum(objects, obj => obj.energy)).toBe(20 * 5 * 5)
+  })
+
+  test("Worldでは energyCoalescing を指定した場合のみ統合する", () => {
+    const countAfterTick = (energyCoalescing?: { maxObjectsPerCell: number }) => {
+      const world = new World({
+        width: 200,
+        height: 200,
+        parameters: { energySourceCount: 0 },
+        quiet: true,
+        ...(energyCoalescing != null ? { energyCoalescing } : {}),
+      })
+      for (let i = 0; i < 10; i++) {
+        world.addObject(createTestEnergyObject(1000 + i, 10, 5 + i * 4, 10))
+      }
+      world.tick()
+      return world.state.objects.size
+    }
+
+    expect(countAfterTick()).toBe(10)
+    expect(countAfterTick({ maxObjectsPerCell: 4 })).toBe(4)
+  })
+})
@@ -0,0 +1,164 @@
+/**
+ * エネルギー統合システム
+ *
+ * エネルギーソースの周囲には小さなエネルギーオブジェクトが毎tick生成され、衝突判定・崩壊・収集の
+ * 対象となるオブジェクト数が際限なく増える。世界を格子に分け、格子内の遅いエネルギーオブジェクトが
+ * 上限を超えた場合は小さいものからまとめて1つに統合し、格子ごとの数を上限以下に保つ。
+ * 統合ではエネルギー量・質量・運動量を保存し、位置は質量中心（トーラスの折り返しを考慮）とする。
+ * エネルギーは失われないため熱は発生しない
+ */
+
+import type { EnergyObject, ObjectId } from "@/types/game"
+import { Vec2 as Vec2Utils } from "@/utils/vec2"
+import { shortestVector, wrapPosition } from "@/utils/torus-math"
+import { calculateEnergyRadius } from "./object-factory"
+
+/** エネルギー統合の結果 */
+export type EnergyCoalescingResult = {
+  /** 統合先として更新されたエネルギーオブジェクト */
+  readonly mergedObjects: EnergyObject[]
+  /** 統合されて消滅したオブジェクトのID */
+  readonly removedIds: ObjectId[]
+}
+
+/** エネルギー統合システムのパラメータ */
+export type EnergyCoalescingParameters = {
+  /** 格子の一辺の長さ */
+  readonly cellSize: number
+  /** 格子ごとの遅いエネルギーオブジェクトの上限（2以上） */
+  readonly maxObjectsPerCell: number
+  /** 統合の対象とする速さの上限（これより速いものは統合しない） */
+  readonly maxSpeed: number
+}
+
+/** デフォルトパラメータ */
+export const DEFAULT_COALESCING_PARAMETERS: EnergyCoalescingParameters = {
+  cellSize: 50,
+  maxObjectsPerCell: 8,
+  maxSpeed: 1,
+}
+
+export class EnergyCoalescingSystem {
+  private readonly _parameters: EnergyCoalescingParameters
+  private readonly _gridWidth: number
+  private readonly _gridHeight: number
+  /** 格子ごとの遅いエネルギーオブジェクト（処理ごとに使い回す） */
+  private readonly _cells = new Map<number, EnergyObject[]>()
+
+  public constructor(
+    private readonly _worldWidth: number,
+    private readonly _worldHeight: number,
+    parameters: EnergyCoalescingParameters = DEFAULT_COALESCING_PARAMETERS
+  ) {
+    this._parameters = {
+      ...parameters,
+      maxObjectsPerCell: Math.max(2, Math.floor(parameters.maxObjectsPerCell)),
+    }
+    this._gridWidth = Math.max(1, Math.ceil(_worldWidth / parameters.cellSize))
+    this._gridHeight = Math.max(1, Math.ceil(_worldHeight / parameters.cellSize))
+  }
+
+  /**
+   * 格子ごとの上限を超えた遅いエネルギーオブジェクトを統合する
+   * 格子内でエネルギー量の大きい順に (上限-1) 個を残し、残りを1つに統合する。
+   * 統合先のIDは統合したもののうち最もエネルギー量の大きいもののIDとする
+   * @param energyObjects 処理対象のエネルギーオブジェクト
+   * @returns 統合結果
+   */
+  public coalesce(energyObjects: Iterable<EnergyObject>): EnergyCoalescingResult {
+    const { maxObjectsPerCell, maxSpeed } = this._parameters
+    const maxSpeedSquared = maxSpeed * maxSpeed
+    const cells = this._cells
+    cells.forEach(cell => {
+      cell.length = 0
+    })
+
+    for (const obj of energyObjects) {
+      if (Vec2Utils.magnitudeSquared(obj.velocity) > maxSpeedSquared) {
+        continue
+      }
+      const cellIndex = this.cellIndexOf(obj)
+      const cell = cells.get(cellIndex)
+      if (cell == null) {
+        cells.set(cellIndex, [obj])
+      } else {
+        cell.push(obj)
+      }
+    }
+
+    const mergedObjects: EnergyObject[] = []
+    const removedIds: ObjectId[] = []
+    cells.forEach(cell => {
+      if (cell.length <= maxObjectsPerCell) {
+        return
+      }
+      // 大きいものを残し、小さいものをまとめる（同量はID順で決定的にする）
+      cell.sort((a, b) => b.energy - a.energy || a.id - b.id)
+      const group = cell.slice(maxObjectsPerCell - 1)
+      const merged = this.merge(group)
+      mergedObjects.push(merged)
+      for (const obj of group) {
+        if (obj.id !== merged.id) {
+          removedIds.push(obj.id)
+        }
+      }
+    })
+
+    return { mergedObjects, removedIds }
+  }
+
+  /**
+   * エネルギーオブジェクトを1つに統合する（エネルギー量・質量・運動量を保存）
+   * @param group 統合するエネルギーオブジェクト（先頭が統合先）
+   */
+  public merge(group: readonly EnergyObject[]): EnergyObject {
+    const base = group[0]
+    if (base == null) {
+      throw new Error("統合するエネルギーオブジェクトがありません")
+    }
+
+    let energy = 0
+    let mass = 0
+    let offsetX = 0
+    let offsetY = 0
+    let momentumX = 0
+    let momentumY = 0
+    const { _worldWidth: worldWidth, _worldHeight: worldHeight } = this
+    for (const obj of group) {
+      // 統合先からの最短の変位で重み付けし、世界の端をまたぐ場合も近い側の中心を取る
+      const offset = shortestVector(base.position, obj.position, worldWidth, worldHeight)
+      energy += obj.energy
+      mass += obj.mass
+      offsetX += offset.x * obj.mass
+      offsetY += offset.y * obj.mass
+      momentumX += obj.velocity.x * obj.mass
+      momentumY += obj.velocity.y * obj.mass
+    }
+
+    const position =
+      mass > 0
+        ? wrapPosition(
+            Vec2Utils.create(base.position.x + offsetX / mass, base.position.y + offsetY / mass),
+            worldWidth,
+            worldHeight
+          )
+        : base.position
+    const velocity = mass > 0 ? Vec2Utils.create(momentumX / mass, momentumY / mass) : base.velocity
+
+    return {
+      ...base,
+      position,
+      velocity,
+      energy,
+      mass,
+      radius: calculateEnergyRadius(energy),
+    }
+  }
+
+  private cellIndexOf(obj: EnergyObject): number {
+    const { cellSize } = this._parameters
+    const cellX = Math.min(this._gridWidth - 1, Math.max(0, Math.floor(obj.position.x / cellSize)))
+    const cellY = Math.min(this._gridHeight - 1, Math.max(0, Math.floor(obj.position.y / cellSize)))
+    return cellY * this._gridWidth + cellX
+  }
+}
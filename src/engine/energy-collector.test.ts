@@ -4,6 +4,9 @@
 
 import { EnergyCollector, DEFAULT_COLLECTOR_PARAMETERS } from "./energy-collector"
 import type { EnergyCollectorParameters } from "./energy-collector"
+import { EnergyParticleSystem } from "./energy-particle-system"
+import { EntityStore } from "./entity-store"
+import { DEFAULT_PHYSICS_PARAMETERS } from "./physics-engine"
 import type { ObjectId, EnergyObject, Hull } from "@/types/game"
 import { Vec2 as Vec2Utils } from "@/utils/vec2"
 
@@ -150,6 +153,64 @@ describe("EnergyCollector", () => {
       expect(result.collectedIds).toHaveLength(3) // 最大3つまで
       expect(result.totalEnergy).toBe(150)
     })
+
+    test("最大収集数を超える候補からは近い順に選ばれる", () => {
+      const params: EnergyCollectorParameters = {
+        ...DEFAULT_COLLECTOR_PARAMETERS,
+        maxCollectPerTick: 2,
+      }
+      collector = new EnergyCollector(worldWidth, worldHeight, params)
+
+      const hull = createTestHull("hull1", 500, 500, 20, 1000)
+      const energyObjects = new Map<ObjectId, EnergyObject>()
+
+      // 遠い順に追加する
+      for (const [id, offset] of [
+        ["far", 24],
+        ["middle", 10],
+        ["near", 2],
+        ["second", 5],
+      ] as const) {
+        const energy = createTestEnergyObject(id, 500 + offset, 500, 10)
+        energyObjects.set(energy.id, energy)
+      }
+
+      const result = collector.collectEnergy(hull, energyObjects)
+
+      expect(result.collectedIds).toEqual(["near", "second"])
+    })
+
+    test("エネルギー粒子の一括収集でも近い順に最大収集数まで選ばれる", () => {
+      const params: EnergyCollectorParameters = {
+        ...DEFAULT_COLLECTOR_PARAMETERS,
+        maxCollectPerTick: 2,
+      }
+      collector = new EnergyCollector(worldWidth, worldHeight, params)
+
+      const hull = createTestHull(1, 500, 500, 20, 1000)
+      const store = new EntityStore()
+      for (const [id, offset] of [
+        [2, 24],
+        [3, 10],
+        [4, 2],
+        [5, 5],
+        [6, 40], // 範囲外
+      ] as const) {
+        store.add(createTestEnergyObject(id, 500 + offset, 500, 10 * id))
+      }
+      const particles = new EnergyParticleSystem(
+        worldWidth,
+        worldHeight,
+        DEFAULT_PHYSICS_PARAMETERS
+      ).gather(store)
+      const collected = new Int32Array(params.maxCollectPerTick)
+
+      const result = collector.collectParticles(hull, particles, [0, 1, 2, 3, 4], 5, collected)
+
+      expect(result.count).toBe(2)
+      expect(Array.from(collected).map(particle => particles.id[particle])).toEqual([4, 5])
+      expect(result.totalEnergy).toBe(90)
+    })
   })
 
   describe("容量制限付きの収集", () => {
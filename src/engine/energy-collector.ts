@@ -4,6 +4,8 @@
 
 import type { ObjectId, EnergyObject, Hull } from "@/types/game"
 import { shortestVector } from "@/utils/torus-math"
+import type { EnergyDensityField } from "./energy-density-field"
+import type { EnergyParticleBatch } from "./energy-particle-system"
 
 /** エネルギー収集の結果 */
 export type EnergyCollectionResult = {
@@ -32,6 +34,44 @@ export const DEFAULT_COLLECTOR_PARAMETERS: EnergyCollectorParameters = {
   maxHullCapacity: null, // デフォルトは無制限
 }
 
+/** エネルギー粒子の収集結果 */
+export type EnergyParticleCollectionResult = {
+  /** 収集した粒子数（粒子番号は書き込み先の先頭から並ぶ） */
+  readonly count: number
+  /** 収集された総エネルギー量 */
+  readonly totalEnergy: number
+}
+
+/** 収集候補 */
+type CollectionCandidate = { obj: EnergyObject; distanceSq: number }
+
+/** 収集候補の粒子 */
+type ParticleCandidate = { particle: number; distanceSq: number }
+
+/**
+ * 距離の昇順を保ったまま、上限数までの候補リストに挿入する
+ * 同じ距離の候補は先に挿入されたものを優先する
+ */
+const insertNearest = <T extends { readonly distanceSq: number }>(
+  nearest: T[],
+  candidate: T,
+  limit: number
+): void => {
+  if (nearest.length >= limit) {
+    const farthest = nearest[nearest.length - 1]
+    if (farthest === undefined || candidate.distanceSq >= farthest.distanceSq) {
+      return
+    }
+    nearest.pop()
+  }
+
+  let position = nearest.length
+  while (position > 0 && (nearest[position - 1]?.distanceSq ?? 0) > candidate.distanceSq) {
+    position--
+  }
+  nearest.splice(position, 0, candidate)
+}
+
 export class EnergyCollector {
   private readonly _parameters: EnergyCollectorParameters
   private readonly _worldWidth: number
@@ -47,6 +87,14 @@ export class EnergyCollector {
     this._parameters = parameters
   }
 
+  /**
+   * HULLの収集範囲の半径（HULLの半径 + 収集距離）
+   * @param hull 収集を行うHULL
+   */
+  public getCollectionRadius(hull: Hull): number {
+    return hull.radius + this._parameters.collectionRange
+  }
+
   /**
    * HULLがエネルギーオブジェクトを収集
    * @param hull 収集を行うHULL
@@ -61,11 +109,12 @@ export class EnergyCollector {
     let totalCollected = 0
 
     // 収集可能な範囲
-    const collectionRadius = hull.radius + this._parameters.collectionRange
+    const collectionRadius = this.getCollectionRadius(hull)
     const collectionRadiusSq = collectionRadius * collectionRadius
 
-    // 収集候補を距離順にソート
-    const candidates: { obj: EnergyObject; distanceSq: number }[] = []
+    // 近い順に最大収集数までの候補を選ぶ（全候補のソートは行わない）
+    const limit = this._parameters.maxCollectPerTick
+    const nearest: CollectionCandidate[] = []
 
     for (const energyObj of energyObjects.values()) {
       // トーラス世界での最短距離を計算
@@ -79,24 +128,15 @@ export class EnergyCollector {
 
       // 収集範囲内かチェック
       if (distanceSq <= collectionRadiusSq) {
-        candidates.push({ obj: energyObj, distanceSq })
+        insertNearest(nearest, { obj: energyObj, distanceSq }, limit)
       }
     }
 
-    // 近い順にソート
-    candidates.sort((a, b) => a.distanceSq - b.distanceSq)
-
     // 容量チェック用の現在のエネルギー
     let currentEnergy = hull.energy
 
     // 収集処理
-    for (let i = 0; i < Math.min(candidates.length, this._parameters.maxCollectPerTick); i++) {
-      const candidate = candidates[i]
-      if (candidate === undefined) {
-        continue
-      }
-      const energyObj = candidate.obj
-
+    for (const { obj: energyObj } of nearest) {
       // 容量チェック
       if (this._parameters.maxHullCapacity != null) {
         const remainingCapacity = this._parameters.maxHullCapacity - currentEnergy
@@ -130,6 +170,90 @@ export class EnergyCollector {
     }
   }
 
+  /**
+   * HULLがエネルギー粒子を収集（collectEnergyと同じ規則の一括API）
+   * 候補はブロードフェーズの検索結果から求めた粒子番号で受け取り、HULLは更新しない
+   * @param hull 収集を行うHULL
+   * @param particles エネルギー粒子
+   * @param candidates 候補の粒子番号
+   * @param candidateCount 候補数
+   * @param collected 収集した粒子番号の書き込み先（maxCollectPerTick以上の長さ）
+   * @returns 収集結果
+   */
+  public collectParticles(
+    hull: Hull,
+    particles: EnergyParticleBatch,
+    candidates: ArrayLike<number>,
+    candidateCount: number,
+    collected: Int32Array
+  ): EnergyParticleCollectionResult {
+    const collectionRadius = this.getCollectionRadius(hull)
+    const collectionRadiusSq = collectionRadius * collectionRadius
+    const limit = this._parameters.maxCollectPerTick
+    const nearest: ParticleCandidate[] = []
+
+    for (let c = 0; c < candidateCount; c++) {
+      const particle = candidates[c] ?? -1
+      if (particle < 0 || particle >= particles.count) {
+        continue
+      }
+      const delta = shortestVector(
+        hull.position,
+        { x: particles.positionX[particle] ?? 0, y: particles.positionY[particle] ?? 0 },
+        this._worldWidth,
+        this._worldHeight
+      )
+      const distanceSq = delta.x * delta.x + delta.y * delta.y
+      if (distanceSq <= collectionRadiusSq) {
+        insertNearest(nearest, { particle, distanceSq }, limit)
+      }
+    }
+
+    let count = 0
+    let totalEnergy = 0
+    let currentEnergy = hull.energy
+    for (const { particle } of nearest) {
+      const energy = particles.energy[particle] ?? 0
+
+      // 容量チェック（部分的な収集は行わない）
+      if (this._parameters.maxHullCapacity != null) {
+        const remainingCapacity = this._parameters.maxHullCapacity - currentEnergy
+        if (remainingCapacity <= 0) {
+          break
+        }
+        if (energy > remainingCapacity) {
+          continue
+        }
+      }
+
+      collected[count] = particle
+      count++
+      totalEnergy += energy
+      currentEnergy += energy
+    }
+
+    return { count, totalEnergy }
+  }
+
+  /**
+   * HULLがエネルギー密度場から収集
+   * 収集範囲内のセルの密度を積分し、残り容量まで取り出す（場から取り除き、HULLは更新しない）。
+   * 収集しなかった分は場に残るため、HULLの貯蔵容量も超えないようにする
+   * @param hull 収集を行うHULL
+   * @param field エネルギー密度場
+   * @param collectedEnergy 同じtickに他から収集済みのエネルギー量（残り容量から除く）
+   * @returns 収集したエネルギー量
+   */
+  public collectFromField(hull: Hull, field: EnergyDensityField, collectedEnergy = 0): number {
+    const storage = hull.capacity - hull.storedEnergy
+    const capacity = this.getRemainingCapacity(hull) ?? storage
+    const limit = Math.min(capacity, storage) - collectedEnergy
+    if (limit <= 0) {
+      return 0
+    }
+    return field.harvest(hull.position, this.getCollectionRadius(hull), limit)
+  }
+
   /**
    * 複数のHULLによる同時収集（競合処理付き）
    * @param hulls 収集を行うHULLの配列
@@ -146,15 +270,15 @@ export class EnergyCollector {
     // 各HULLについて収集範囲内のオブジェクトを特定
     type HullCandidate = {
       hull: Hull
-      candidates: { obj: EnergyObject; distanceSq: number }[]
+      candidates: CollectionCandidate[]
     }
 
     const hullCandidates: HullCandidate[] = []
 
     for (const hull of hulls) {
-      const collectionRadius = hull.radius + this._parameters.collectionRange
+      const collectionRadius = this.getCollectionRadius(hull)
       const collectionRadiusSq = collectionRadius * collectionRadius
-      const candidates: { obj: EnergyObject; distanceSq: number }[] = []
+      const candidates: CollectionCandidate[] = []
 
       for (const energyObj of energyObjects.values()) {
         if (claimedObjects.has(energyObj.id)) {
@@ -3,6 +3,9 @@
  */
 
 import { EnergyDecaySystem } from "./energy-decay-system"
+import { EnergyParticleSystem } from "./energy-particle-system"
+import { EntityStore } from "./entity-store"
+import { DEFAULT_PHYSICS_PARAMETERS } from "./physics-engine"
 import type { EnergyDecayParameters } from "./energy-decay-system"
 import type { EnergyObject, ObjectId } from "@/types/game"
 import { Vec2 as Vec2Utils } from "@/utils/vec2"
@@ -118,6 +121,20 @@ describe("EnergyDecaySystem", () => {
       expect(result.totalHeatGenerated).toBe(0)
       expect(result.updatedObjects.size).toBe(0)
     })
+
+    test("エネルギー粒子の一括処理では崩壊後のエネルギー量を列に書き込む", () => {
+      const store = new EntityStore()
+      store.add(createTestEnergyObject(1, 1))
+      store.add(createTestEnergyObject(2, 400))
+      const particles = new EnergyParticleSystem(100, 100, DEFAULT_PHYSICS_PARAMETERS).gather(store)
+
+      const totalHeatGenerated = system.processDecayBatch(particles)
+
+      expect(Array.from(particles.energy.subarray(0, 2))).toEqual([0, 398])
+      expect(totalHeatGenerated).toBe(3) // 1 + 2
+      // ストアの値は変更しない
+      expect(store.energy[1]).toBe(400)
+    })
   })
 
   describe("半減期の推定", () => {
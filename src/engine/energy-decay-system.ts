@@ -3,6 +3,7 @@
  */
 
 import type { ObjectId, EnergyObject } from "@/types/game"
+import type { EnergyParticleBatch } from "./energy-particle-system"
 
 /** エネルギー崩壊の結果 */
 export type EnergyDecayResult = {
@@ -77,6 +78,26 @@ export class EnergyDecaySystem {
     }
   }
 
+  /**
+   * エネルギー粒子の自然崩壊を一括で処理
+   * 崩壊後のエネルギー量を粒子のenergy列に書き込む（0以下は完全に崩壊したもの）
+   * @param particles 処理対象のエネルギー粒子
+   * @returns 崩壊により発生した総熱量
+   */
+  public processDecayBatch(particles: EnergyParticleBatch): number {
+    const energy = particles.energy
+    let totalHeatGenerated = 0
+
+    for (let k = 0; k < particles.count; k++) {
+      const current = energy[k] ?? 0
+      const remaining = current - this.calculateDecayAmount(current)
+      totalHeatGenerated += remaining > 0 ? current - remaining : current
+      energy[k] = remaining
+    }
+
+    return totalHeatGenerated
+  }
+
   /**
    * 崩壊量を計算
    * @param energy 現在のエネルギー量
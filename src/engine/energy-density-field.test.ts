@@ -0,0 +1,175 @@
+/**
+ * エネルギー密度場のテスト
+ */
+
+import { EnergyDensityField } from "./energy-density-field"
+import { EnergyCollector, DEFAULT_COLLECTOR_PARAMETERS } from "./energy-collector"
+import { EnergyDecaySystem } from "./energy-decay-system"
+import { World } from "./world"
+import type { DirectionalForceField, Hull, ObjectId } from "@/types/game"
+import { Vec2 as Vec2Utils } from "@/utils/vec2"
+
+// テスト用のHULL生成
+const createTestHull = (x: number, y: number, energy: number, capacity = 10000): Hull => ({
+  id: 1 as ObjectId,
+  type: "HULL",
+  position: Vec2Utils.create(x, y),
+  velocity: Vec2Utils.create(0, 0),
+  radius: 10,
+  energy,
+  mass: 100 + energy,
+  buildEnergy: 100,
+  currentEnergy: 100,
+  capacity,
+  storedEnergy: energy,
+  attachedUnitIds: [],
+})
+
+describe("EnergyDensityField", () => {
+  test("置いたエネルギーを範囲内の積分で取り出し、取り出す量は整数に切り捨てる", () => {
+    const field = new EnergyDensityField(100, 100, {
+      cellSize: 10,
+      diffusionRate: 0,
+      advectionScale: 1,
+    })
+    field.deposit(Vec2Utils.create(5, 5), 30)
+    field.deposit(Vec2Utils.create(95, 5), 20.5)
+    field.deposit(Vec2Utils.create(55, 55), 100)
+
+    // 世界の端をまたいで隣接するセルも範囲に含む
+    expect(field.integrate(Vec2Utils.create(0, 5), 6)).toBeCloseTo(50.5)
+    expect(field.harvest(Vec2Utils.create(0, 5), 6, Number.POSITIVE_INFINITY)).toBe(50)
+    expect(field.integrate(Vec2Utils.create(0, 5), 6)).toBeCloseTo(0.5)
+
+    // 上限までしか取り出さない
+    expect(field.harvest(Vec2Utils.create(55, 55), 1, 40)).toBe(40)
+    expect(field.totalEnergy).toBeCloseTo(60.5)
+  })
+
+  test("拡散は総量を保存し、隣接セルへ均等に広がる", () => {
+    const field = new EnergyDensityField(100, 100, {
+      cellSize: 10,
+      diffusionRate: 0.1,
+      advectionScale: 1,
+    })
+    field.deposit(Vec2Utils.create(55, 55), 1000)
+
+    field.step(new Map())
+
+    const center = field.cellIndexAt(55, 55)
+    expect(field.density[center]).toBeCloseTo(600)
+    for (const [x, y] of [
+      [45, 55],
+      [65, 55],
+      [55, 45],
+      [55, 65],
+    ] as const) {
+      expect(field.density[field.cellIndexAt(x, y)]).toBeCloseTo(100)
+    }
+
+    for (let i = 0; i < 50; i++) {
+      field.step(new Map())
+    }
+    expect(field.totalEnergy).toBeCloseTo(1000)
+  })
+
+  test("力場の向きに移流し、総量を保存する", () => {
+    const field = new EnergyDensityField(200, 200, {
+      cellSize: 10,
+      diffusionRate: 0,
+      advectionScale: 1,
+    })
+    const forceField: DirectionalForceField = {
+      id: 100 as ObjectId,
+      type: "LINEAR",
+      position: Vec2Utils.create(100, 100),
+      radius: 80,
+      strength: 2,
+      direction: Vec2Utils.create(1, 0),
+    }
+    const forceFields = new Map([[forceField.id, forceField]])
+    field.deposit(Vec2Utils.create(105, 105), 1000)
+
+    for (let i = 0; i < 10; i++) {
+      field.step(forceFields)
+    }
+
+    let weightedX = 0
+    for (let i = 0; i < field.density.length; i++) {
+      weightedX += field.cellCenter(i).x * (field.density[i] ?? 0)
+    }
+    expect(field.totalEnergy).toBeCloseTo(1000)
+    expect(weightedX / field.totalEnergy).toBeGreaterThan(110)
+    expect(field.density[field.cellIndexAt(95, 105)]).toBe(0)
+  })
+
+  test("崩壊したエネルギーは端数を持ち越して熱として加えられ、総量を保存する", () => {
+    const field = new EnergyDensityField(100, 100, {
+      cellSize: 10,
+      diffusionRate: 0.1,
+      advectionScale: 1,
+    })
+    const decaySystem = new EnergyDecaySystem()
+    field.deposit(Vec2Utils.create(55, 55), 500)
+    field.deposit(Vec2Utils.create(15, 85), 37)
+
+    let heat = 0
+    for (let i = 0; i < 30; i++) {
+      field.step(new Map())
+      field.decay(decaySystem, (_position, amount) => {
+        expect(Number.isInteger(amount)).toBe(true)
+        heat += amount
+      })
+    }
+
+    expect(heat).toBeGreaterThan(0)
+    expect(field.totalEnergy + field.pendingHeat + heat).toBeCloseTo(537)
+  })
+
+  test("HULLは収集範囲内の密度を容量まで収集する", () => {
+    const field = new EnergyDensityField(100, 100, {
+      cellSize: 10,
+      diffusionRate: 0,
+      advectionScale: 1,
+    })
+    field.deposit(Vec2Utils.create(50, 50), 300)
+    field.deposit(Vec2Utils.create(90, 90), 300)
+    const collector = new EnergyCollector(100, 100, {
+      ...DEFAULT_COLLECTOR_PARAMETERS,
+      maxHullCapacity: 1200,
+    })
+
+    // 範囲外のセルは収集しない。同じtickに収集済みの分は残り容量から除く
+    const hull = createTestHull(52, 52, 1000)
+    expect(collector.collectFromField(hull, field, 50)).toBe(150)
+    expect(field.totalEnergy).toBeCloseTo(450)
+
+    // HULLの貯蔵容量も超えない
+    const fullHull = createTestHull(52, 52, 1000, 1000)
+    expect(collector.collectFromField(fullHull, field)).toBe(0)
+  })
+
+  test("密度場を指定した世界ではエネルギーソースの出力をオブジェクトにしない", () => {
+    const world = new World({
+      width: 200,
+      height: 200,
+      parameters: { energySourceCount: 2 },
+      energyDensityField: {},
+      quiet: true,
+    })
+
+    world.tick()
+    world.tick()
+
+    const energyPerTick = Array.from(world.state.energySources.values()).reduce(
+      (total, source) => total + source.energyPerTick,
+      0
+    )
+    const energyObjects = Array.from(world.state.objects.values()).filter(
+      obj => obj.type === "ENERGY"
+    )
+    expect(energyObjects).toHaveLength(0)
+    expect(world.energyDensityField?.totalEnergy).toBeGreaterThan(0)
+    expect(world.energyDensityField?.totalEnergy).toBeLessThanOrEqual(2 * energyPerTick)
+  })
+})
@@ -0,0 +1,346 @@
+/**
+ * エネルギー密度場
+ *
+ * 非常に大きな世界ではエネルギーを個々のオブジェクトとして追跡せず、熱グリッドと同様の
+ * 格子上の密度（セルごとのエネルギー量）として扱う。
+ * エネルギーソースの出力はセルに置かれ、毎tick力場に沿って移流し、隣接セルへ拡散する。
+ * 崩壊はEnergyDecaySystemの規則でセルごとに行い、熱グリッドへ熱として加える。
+ * HULLは収集範囲内のセルの密度を積分して収集する（EnergyCollector.collectFromField）。
+ *
+ * 処理量はエネルギー量によらずセル数に比例する。移流・拡散は各セルが更新前の密度から
+ * 自身の更新後の密度を求める（集める）形で計算するため、行の帯ごとに分けて並行に処理できる。
+ * 移流・拡散の前後でエネルギーの総量は（浮動小数点の誤差を除き）保存される
+ */
+
+import type { DirectionalForceField, ObjectId, Vec2 } from "@/types/game"
+import { Vec2 as Vec2Utils } from "@/utils/vec2"
+import { ForceFieldSystem } from "./force-field-system"
+import type { EnergyDecaySystem } from "./energy-decay-system"
+
+/** エネルギー密度場のパラメータ */
+export type EnergyDensityFieldParameters = {
+  /** セルの一辺の長さ */
+  readonly cellSize: number
+  /** 拡散率（1tickで隣接する各セルへ移る割合、0〜0.125） */
+  readonly diffusionRate: number
+  /** 移流の係数（力場の力 × 係数 を流速とする） */
+  readonly advectionScale: number
+}
+
+/** デフォルトパラメータ */
+export const DEFAULT_DENSITY_FIELD_PARAMETERS: EnergyDensityFieldParameters = {
+  cellSize: 20,
+  diffusionRate: 0.05,
+  advectionScale: 1,
+}
+
+/** 1軸あたりの移流で1tickに流出する割合の上限（安定性のため） */
+const MAX_ADVECTION_FRACTION = 0.25
+
+export class EnergyDensityField {
+  private readonly _parameters: EnergyDensityFieldParameters
+  private readonly _width: number
+  private readonly _height: number
+  private readonly _cellWidth: number
+  private readonly _cellHeight: number
+  private _density: Float64Array
+  private _next: Float64Array
+  /** セルごとの1tickの移流の割合（符号は向き。X: 正で東、Y: 正で南） */
+  private readonly _flowX: Float64Array
+  private readonly _flowY: Float64Array
+  /** 流速を求めた力場（変わった場合に求め直す） */
+  private _flowFields: readonly DirectionalForceField[] = []
+  /** 崩壊した量のうち、熱グリッドへ加えていない端数（熱は整数で加えるため） */
+  private readonly _pendingHeat: Float64Array
+  private readonly _forceFieldSystem = new ForceFieldSystem({
+    attenuationStart: 0.5,
+    frictionCoefficient: 1,
+  })
+
+  /** グリッドの幅（セル数） */
+  public get width(): number {
+    return this._width
+  }
+
+  /** グリッドの高さ（セル数） */
+  public get height(): number {
+    return this._height
+  }
+
+  /**
+   * セルごとのエネルギー量（行優先、index = y * width + x）
+   * 読み取り専用として扱うこと
+   */
+  public get density(): Float64Array {
+    return this._density
+  }
+
+  /** 場にあるエネルギーの総量（熱グリッドへ加えていない崩壊分は含まない） */
+  public get totalEnergy(): number {
+    let total = 0
+    for (let i = 0; i < this._density.length; i++) {
+      total += this._density[i] ?? 0
+    }
+    return total
+  }
+
+  /** 崩壊した量のうち、熱グリッドへ加えていない端数の合計 */
+  public get pendingHeat(): number {
+    let total = 0
+    for (let i = 0; i < this._pendingHeat.length; i++) {
+      total += this._pendingHeat[i] ?? 0
+    }
+    return total
+  }
+
+  public constructor(
+    private readonly _worldWidth: number,
+    private readonly _worldHeight: number,
+    parameters: EnergyDensityFieldParameters = DEFAULT_DENSITY_FIELD_PARAMETERS
+  ) {
+    this._parameters = {
+      ...parameters,
+      diffusionRate: Math.min(0.125, Math.max(0, parameters.diffusionRate)),
+    }
+    this._width = Math.max(1, Math.ceil(_worldWidth / parameters.cellSize))
+    this._height = Math.max(1, Math.ceil(_worldHeight / parameters.cellSize))
+    // 世界の大きさがセルの大きさで割り切れない場合も、セルが世界全体を等分するようにする
+    this._cellWidth = _worldWidth / this._width
+    this._cellHeight = _worldHeight / this._height
+
+    const cellCount = this._width * this._height
+    this._density = new Float64Array(cellCount)
+    this._next = new Float64Array(cellCount)
+    this._flowX = new Float64Array(cellCount)
+    this._flowY = new Float64Array(cellCount)
+    this._pendingHeat = new Float64Array(cellCount)
+  }
+
+  /**
+   * 座標のセル番号
+   * @param x X座標
+   * @param y Y座標
+   */
+  public cellIndexAt(x: number, y: number): number {
+    const cellX = this.axisCellOf(x, this._worldWidth, this._cellWidth, this._width)
+    const cellY = this.axisCellOf(y, this._worldHeight, this._cellHeight, this._height)
+    return cellY * this._width + cellX
+  }
+
+  /** セルの中心座標 */
+  public cellCenter(index: number): Vec2 {
+    return Vec2Utils.create(
+      ((index % this._width) + 0.5) * this._cellWidth,
+      (Math.floor(index / this._width) + 0.5) * this._cellHeight
+    )
+  }
+
+  /**
+   * 座標のセルにエネルギーを置く
+   * @param position 座標
+   * @param amount エネルギー量
+   */
+  public deposit(position: Vec2, amount: number): void {
+    if (amount <= 0) {
+      return
+    }
+    const index = this.cellIndexAt(position.x, position.y)
+    this._density[index] = (this._density[index] ?? 0) + amount
+  }
+
+  /**
+   * 範囲内のセルのエネルギー量の合計（セルの中心が範囲内のもの。範囲が狭い場合も中心のセルは含む）
+   * @param position 範囲の中心
+   * @param radius 範囲の半径
+   */
+  public integrate(position: Vec2, radius: number): number {
+    let total = 0
+    this.forEachCellInRange(position, radius, index => {
+      total += this._density[index] ?? 0
+    })
+    return total
+  }
+
+  /**
+   * 範囲内のセルからエネルギーを取り出す
+   * 取り出す量は整数に切り捨て、範囲内の各セルから量に比例して取り出す
+   * @param position 範囲の中心
+   * @param radius 範囲の半径
+   * @param limit 取り出す量の上限
+   * @returns 取り出したエネルギー量
+   */
+  public harvest(position: Vec2, radius: number, limit: number): number {
+    const total = this.integrate(position, radius)
+    const amount = Math.floor(Math.min(total, limit))
+    if (amount <= 0) {
+      return 0
+    }
+
+    const remainingRatio = 1 - amount / total
+    this.forEachCellInRange(position, radius, index => {
+      this._density[index] = (this._density[index] ?? 0) * remainingRatio
+    })
+    return amount
+  }
+
+  /**
+   * 移流・拡散を1ステップ実行
+   * @param forceFields 力場（流速を求める。前回と同じ力場の場合は求め直さない）
+   */
+  public step(forceFields: ReadonlyMap<ObjectId, DirectionalForceField>): void {
+    this.updateFlow(forceFields)
+    this.stepRows(0, this._height)
+
+    const density = this._density
+    this._density = this._next
+    this._next = density
+  }
+
+  /**
+   * 各セルをEnergyDecaySystemの規則で崩壊させ、崩壊した量を熱として加える
+   * 熱は整数で加えるため、端数はセルごとに持ち越す
+   * @param decaySystem 崩壊量の規則
+   * @param addHeat 熱の追加（セルの中心座標と熱量）
+   */
+  public decay(
+    decaySystem: EnergyDecaySystem,
+    addHeat: (position: Vec2, amount: number) => void
+  ): void {
+    const density = this._density
+    const pendingHeat = this._pendingHeat
+    for (let i = 0; i < density.length; i++) {
+      const energy = density[i] ?? 0
+      if (energy <= 0) {
+        continue
+      }
+
+      const amount = Math.min(energy, decaySystem.calculateDecayAmount(energy))
+      density[i] = energy - amount
+
+      const heat = (pendingHeat[i] ?? 0) + amount
+      const wholeHeat = Math.floor(heat)
+      pendingHeat[i] = heat - wholeHeat
+      if (wholeHeat > 0) {
+        addHeat(this.cellCenter(i), wholeHeat)
+      }
+    }
+  }
+
+  /**
+   * 行の範囲のセルについて、移流・拡散後の密度を書き込む
+   * 各セルは更新前の密度のみを読み、自身のセルにのみ書き込む
+   * @param rowStart 先頭の行
+   * @param rowEnd 末尾の次の行
+   */
+  private stepRows(rowStart: number, rowEnd: number): void {
+    const { _width: width, _height: height, _density: density, _next: next } = this
+    const flowX = this._flowX
+    const flowY = this._flowY
+    const rate = this._parameters.diffusionRate
+
+    for (let y = rowStart; y < rowEnd; y++) {
+      const row = y * width
+      const northRow = (y === 0 ? height - 1 : y - 1) * width
+      const southRow = (y + 1 === height ? 0 : y + 1) * width
+
+      for (let x = 0; x < width; x++) {
+        const i = row + x
+        const west = row + (x === 0 ? width - 1 : x - 1)
+        const east = row + (x + 1 === width ? 0 : x + 1)
+        const north = northRow + x
+        const south = southRow + x
+
+        const value = density[i] ?? 0
+        const westValue = density[west] ?? 0
+        const eastValue = density[east] ?? 0
+        const northValue = density[north] ?? 0
+        const southValue = density[south] ?? 0
+        const ownFlowX = flowX[i] ?? 0
+        const ownFlowY = flowY[i] ?? 0
+
+        // 拡散: 各隣接セルへ rate ずつ流出し、各隣接セルから rate ずつ流入する
+        let result =
+          value * (1 - 4 * rate - Math.abs(ownFlowX) - Math.abs(ownFlowY)) +
+          rate * (westValue + eastValue + northValue + southValue)
+
+        // 移流: 自身へ向かう流れを持つ隣接セルから流入する
+        result += westValue * Math.max(0, flowX[west] ?? 0)
+        result += eastValue * Math.max(0, -(flowX[east] ?? 0))
+        result += northValue * Math.max(0, flowY[north] ?? 0)
+        result += southValue * Math.max(0, -(flowY[south] ?? 0))
+
+        next[i] = result
+      }
+    }
+  }
+
+  /** 力場から各セルの移流の割合を求める */
+  private updateFlow(forceFields: ReadonlyMap<ObjectId, DirectionalForceField>): void {
+    const fields = Array.from(forceFields.values())
+    if (
+      fields.length === this._flowFields.length &&
+      fields.every((field, k) => field === this._flowFields[k])
+    ) {
+      return
+    }
+    this._flowFields = fields
+
+    const scale = this._parameters.advectionScale
+    for (let i = 0; i < this._flowX.length; i++) {
+      const center = this.cellCenter(i)
+      let forceX = 0
+      let forceY = 0
+      for (const field of fields) {
+        const force = this._forceFieldSystem.calculateForceFromField(center, field)
+        if (force != null) {
+          forceX += force.x
+          forceY += force.y
+        }
+      }
+      this._flowX[i] = this.clampFlow((forceX * scale) / this._cellWidth)
+      this._flowY[i] = this.clampFlow((forceY * scale) / this._cellHeight)
+    }
+  }
+
+  private clampFlow(fraction: number): number {
+    return Math.max(-MAX_ADVECTION_FRACTION, Math.min(MAX_ADVECTION_FRACTION, fraction))
+  }
+
+  /** 範囲内のセル（トーラス境界をまたぐ場合は折り返す）を1度ずつ列挙する */
+  private forEachCellInRange(
+    position: Vec2,
+    radius: number,
+    callback: (index: number) => void
+  ): void {
+    const centerIndex = this.cellIndexAt(position.x, position.y)
+    const columnCount = Math.min(this._width, 2 * Math.ceil(radius / this._cellWidth) + 1)
+    const rowCount = Math.min(this._height, 2 * Math.ceil(radius / this._cellHeight) + 1)
+    const centerX = centerIndex % this._width
+    const centerY = Math.floor(centerIndex / this._width)
+    const firstX = centerX - Math.floor(columnCount / 2)
+    const firstY = centerY - Math.floor(rowCount / 2)
+    const radiusSq = radius * radius
+
+    for (let row = 0; row < rowCount; row++) {
+      const cellY = (((firstY + row) % this._height) + this._height) % this._height
+      // 範囲の中心からセルの中心までの距離（折り返す前の位置で測る）
+      const dy = (firstY + row + 0.5) * this._cellHeight - position.y
+      for (let column = 0; column < columnCount; column++) {
+        const cellX = (((firstX + column) % this._width) + this._width) % this._width
+        const index = cellY * this._width + cellX
+        const dx = (firstX + column + 0.5) * this._cellWidth - position.x
+        if (index === centerIndex || dx * dx + dy * dy <= radiusSq) {
+          callback(index)
+        }
+      }
+    }
+  }
+
+  private axisCellOf(value: number, worldSize: number, cellSize: number, cells: number): number {
+    let wrapped = value % worldSize
+    if (wrapped < 0) {
+      wrapped += worldSize
+    }
+    return Math.min(cells - 1, Math.floor(wrapped / cellSize))
+  }
+}
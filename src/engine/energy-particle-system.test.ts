@@ -0,0 +1,154 @@
+/**
+ * エネルギー粒子システムのテスト
+ */
+
+import { EnergyParticleSystem } from "./energy-particle-system"
+import { EntityStore } from "./entity-store"
+import { DEFAULT_PHYSICS_PARAMETERS } from "./physics-engine"
+import { WorldCommandBuffer } from "./world-command-buffer"
+import { WorldStateManager } from "./world-state"
+import type { DirectionalForceField, GameObject, ObjectId } from "@/types/game"
+import { Vec2 as Vec2Utils } from "@/utils/vec2"
+
+const createObject = (
+  id: number,
+  type: "ENERGY" | "HULL",
+  x: number,
+  y: number,
+  vx = 0,
+  vy = 0
+): GameObject => ({
+  id: id as ObjectId,
+  type,
+  position: Vec2Utils.create(x, y),
+  velocity: Vec2Utils.create(vx, vy),
+  radius: 10,
+  energy: 50,
+  mass: 50,
+})
+
+const PARAMETERS = { ...DEFAULT_PHYSICS_PARAMETERS, frictionCoefficient: 0.5 }
+
+describe("EnergyParticleSystem", () => {
+  test("エネルギーオブジェクトのみを格納位置の順に詰めて集める", () => {
+    const store = new EntityStore()
+    store.add(createObject(1, "HULL", 10, 10))
+    store.add(createObject(2, "ENERGY", 20, 30))
+    store.add(createObject(3, "HULL", 40, 40))
+    store.add(createObject(4, "ENERGY", 50, 60))
+    const system = new EnergyParticleSystem(100, 100, PARAMETERS)
+
+    const particles = system.gather(store)
+
+    expect(particles.count).toBe(2)
+    expect(Array.from(particles.index.subarray(0, 2))).toEqual([1, 3])
+    expect(Array.from(particles.id.subarray(0, 2))).toEqual([2, 4])
+    expect(Array.from(particles.positionY.subarray(0, 2))).toEqual([30, 60])
+    expect([0, 1, 2, 3].map(index => system.particleAt(index))).toEqual([-1, 0, -1, 1])
+  })
+
+  test("漂流・摩擦・ラップアラウンドで運動を更新し、ストアへ書き戻す", () => {
+    const store = new EntityStore()
+    const hull = createObject(1, "HULL", 50, 50, 4, 0)
+    const energy = createObject(2, "ENERGY", 95, 50, 20, -4)
+    store.add(hull)
+    store.add(energy)
+    const system = new EnergyParticleSystem(100, 100, PARAMETERS)
+
+    expect(system.integrate(store, new Map(), 1)).toBe(1)
+
+    // v = v0 × 0.5, x = x0 + v（世界の端でラップアラウンド）
+    expect(energy.velocity).toEqual({ x: 10, y: -2 })
+    expect(energy.position).toEqual({ x: 5, y: 48 })
+    // エネルギー以外のオブジェクトは更新しない
+    expect(hull.position).toEqual({ x: 50, y: 50 })
+    expect(hull.velocity).toEqual({ x: 4, y: 0 })
+  })
+
+  test("影響範囲内の力場の力のみを受ける", () => {
+    const store = new EntityStore()
+    const inside = createObject(1, "ENERGY", 50, 50)
+    const outside = createObject(2, "ENERGY", 90, 90)
+    store.add(inside)
+    store.add(outside)
+    const field: DirectionalForceField = {
+      id: 100 as ObjectId,
+      type: "LINEAR",
+      position: Vec2Utils.create(50, 50),
+      radius: 20,
+      strength: 100,
+      direction: Vec2Utils.create(100, 0),
+    }
+    const system = new EnergyParticleSystem(200, 200, PARAMETERS)
+
+    system.integrate(store, new Map([[field.id, field]]), 1)
+
+    // a = F / m = 100 / 50, v = a × 0.5
+    expect(inside.velocity.x).toBeCloseTo(1)
+    expect(outside.velocity).toEqual({ x: 0, y: 0 })
+  })
+
+  test("世界の端をまたいだ力場の影響範囲内の粒子も最短距離の向きに力を受ける", () => {
+    const store = new EntityStore()
+    const energy = createObject(1, "ENERGY", 5, 50)
+    store.add(energy)
+    const field: DirectionalForceField = {
+      id: 100 as ObjectId,
+      type: "RADIAL",
+      position: Vec2Utils.create(195, 50),
+      radius: 20,
+      strength: 100,
+      direction: Vec2Utils.create(0, 0),
+    }
+    const system = new EnergyParticleSystem(200, 200, PARAMETERS)
+
+    system.integrate(store, new Map([[field.id, field]]), 1)
+
+    // 中心から外向き（端をまたいで+x方向）に押し出される
+    expect(energy.velocity.x).toBeGreaterThan(0)
+    expect(energy.velocity.y).toBeCloseTo(0)
+  })
+
+  test("集めた列は粒子の追加・削除があるまで集め直さない", () => {
+    const manager = new WorldStateManager(1000, 800)
+    const first = createObject(manager.generateObjectId(), "ENERGY", 100, 100)
+    const second = createObject(manager.generateObjectId(), "ENERGY", 200, 100)
+    manager.addObject(first)
+    manager.addObject(second)
+    const particles = manager.gatherEnergyParticles()
+    expect(particles.count).toBe(2)
+
+    // ストアの列へ直接書き込んでも、エネルギー以外の追加では集め直さない
+    manager.entities.energy[0] = 999
+    const hull = createObject(manager.generateObjectId(), "HULL", 300, 100)
+    manager.addObject(hull)
+    expect(manager.gatherEnergyParticles().energy[0]).toBe(50)
+    expect(particles.particleAt(manager.entities.indexOf(hull.id))).toBe(-1)
+
+    // 削除を反映すると集め直す
+    const commands = new WorldCommandBuffer()
+    commands.despawn(first.id)
+    manager.commit(commands)
+    expect(manager.gatherEnergyParticles().count).toBe(1)
+    expect(particles.idAt(0)).toBe(second.id)
+    expect(particles.index[0]).toBe(manager.entities.indexOf(second.id))
+  })
+
+  test("世界の物理演算ではエネルギーはユニットと反発せず、ユニット同士は反発する", () => {
+    const manager = new WorldStateManager(1000, 800)
+    const hull1 = createObject(manager.generateObjectId(), "HULL", 100, 100)
+    const hull2 = createObject(manager.generateObjectId(), "HULL", 110, 100)
+    const energy = createObject(manager.generateObjectId(), "ENERGY", 105, 100)
+    manager.addObject(hull1)
+    manager.addObject(hull2)
+    manager.addObject(energy)
+
+    const result = manager.updatePhysics(1.0)
+
+    expect(result.objectCount).toBe(3)
+    expect(result.collisionCount).toBe(1)
+    expect(hull1.position.x).toBeLessThan(100)
+    expect(hull2.position.x).toBeGreaterThan(110)
+    expect(energy.position).toEqual({ x: 105, y: 100 })
+  })
+})
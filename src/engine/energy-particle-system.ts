@@ -0,0 +1,298 @@
+/**
+ * エネルギー粒子システム
+ *
+ * エネルギーオブジェクトは数が多い一方で、ユニットとの反発や衝突は必要としない。
+ * 汎用の物理演算（衝突検出・反発力）から外し、エンティティストアから詰めて集めた専用の列に対して
+ * 漂流・摩擦・力場・トーラス境界のラップアラウンドのみを行う簡易な積分を行う。
+ * ユニットとの相互作用（HULLによる収集）はブロードフェーズの検索のみで行う。
+ * 集めた列は崩壊・収集・描画用スナップショットへ一括で渡す（EnergyParticleBatch）
+ *
+ * 集めた列は invalidate されるまで保持し、gather を繰り返し呼んでもストアを走査し直さない。
+ * エネルギーオブジェクトの追加・削除・置き換えなど格納位置や値が変わる操作の後は invalidate を呼ぶこと
+ */
+
+import type { DirectionalForceField, ObjectId } from "@/types/game"
+import { Vec2 as Vec2Utils } from "@/utils/vec2"
+import { shortestVector, wrapCoordinate } from "@/utils/torus-math"
+import { ENTITY_KIND } from "./entity-store"
+import type { EntityStore } from "./entity-store"
+import { ForceFieldSystem } from "./force-field-system"
+import type { PhysicsParameters } from "./physics-engine"
+
+/**
+ * エネルギー粒子の列
+ * 粒子番号（0〜count-1）はエンティティストア上の格納位置の昇順。
+ * 次にストアから集め直すまで有効で、列への書き込みはストアへ反映されない（ストアにも書き込むこと）
+ */
+export type EnergyParticleBatch = {
+  readonly count: number
+  /** エンティティストア上の格納位置 */
+  readonly index: Int32Array
+  readonly id: Float64Array
+  readonly positionX: Float64Array
+  readonly positionY: Float64Array
+  readonly velocityX: Float64Array
+  readonly velocityY: Float64Array
+  readonly radius: Float64Array
+  readonly mass: Float64Array
+  readonly energy: Float64Array
+}
+
+/** 初期容量 */
+const DEFAULT_CAPACITY = 256
+
+const growFloat64 = (array: Float64Array, capacity: number): Float64Array => {
+  const grown = new Float64Array(capacity)
+  grown.set(array)
+  return grown
+}
+
+export class EnergyParticleSystem implements EnergyParticleBatch {
+  private readonly _worldWidth: number
+  private readonly _worldHeight: number
+  private readonly _parameters: PhysicsParameters
+  private readonly _forceFieldSystem: ForceFieldSystem
+  private _capacity = DEFAULT_CAPACITY
+  private _count = 0
+  /** 集めた時点のストアのオブジェクト数 */
+  private _storeCount = 0
+  /** 集めた列がストアと食い違っている可能性があるか */
+  private _stale = true
+  private _index = new Int32Array(DEFAULT_CAPACITY)
+  private _id = new Float64Array(DEFAULT_CAPACITY)
+  private _positionX = new Float64Array(DEFAULT_CAPACITY)
+  private _positionY = new Float64Array(DEFAULT_CAPACITY)
+  private _velocityX = new Float64Array(DEFAULT_CAPACITY)
+  private _velocityY = new Float64Array(DEFAULT_CAPACITY)
+  private _radius = new Float64Array(DEFAULT_CAPACITY)
+  private _mass = new Float64Array(DEFAULT_CAPACITY)
+  private _energy = new Float64Array(DEFAULT_CAPACITY)
+  /** ストア上の格納位置ごとの粒子番号（粒子でない場合は-1） */
+  private _particleOfIndex = new Int32Array(DEFAULT_CAPACITY)
+
+  /** 粒子数 */
+  public get count(): number {
+    return this._count
+  }
+
+  public get index(): Int32Array {
+    return this._index
+  }
+
+  public get id(): Float64Array {
+    return this._id
+  }
+
+  public get positionX(): Float64Array {
+    return this._positionX
+  }
+
+  public get positionY(): Float64Array {
+    return this._positionY
+  }
+
+  public get velocityX(): Float64Array {
+    return this._velocityX
+  }
+
+  public get velocityY(): Float64Array {
+    return this._velocityY
+  }
+
+  public get radius(): Float64Array {
+    return this._radius
+  }
+
+  public get mass(): Float64Array {
+    return this._mass
+  }
+
+  public get energy(): Float64Array {
+    return this._energy
+  }
+
+  /**
+   * @param worldWidth 世界の幅
+   * @param worldHeight 世界の高さ
+   * @param parameters 物理演算のパラメータ（物理演算エンジンと共有し、摩擦係数などの変更を反映する）
+   */
+  public constructor(worldWidth: number, worldHeight: number, parameters: PhysicsParameters) {
+    this._worldWidth = worldWidth
+    this._worldHeight = worldHeight
+    this._parameters = parameters
+    this._forceFieldSystem = new ForceFieldSystem({
+      attenuationStart: 0.5,
+      frictionCoefficient: parameters.frictionCoefficient,
+    })
+  }
+
+  /** 集めた列を破棄し、次の gather でストアから集め直す */
+  public invalidate(): void {
+    this._stale = true
+  }
+
+  /**
+   * エンティティストアからエネルギー粒子を集める
+   * invalidate されていない場合は前回集めた列をそのまま返す
+   * @param store エンティティストア
+   * @returns 集めた粒子（このシステム自身）
+   */
+  public gather(store: EntityStore): EnergyParticleBatch {
+    if (!this._stale) {
+      return this
+    }
+
+    const storeCount = store.count
+    if (this._particleOfIndex.length < storeCount) {
+      this._particleOfIndex = new Int32Array(Math.max(storeCount, this._particleOfIndex.length * 2))
+    }
+
+    const kind = store.kind
+    const particleOfIndex = this._particleOfIndex
+    let count = 0
+    for (let index = 0; index < storeCount; index++) {
+      if (kind[index] !== ENTITY_KIND.ENERGY) {
+        particleOfIndex[index] = -1
+        continue
+      }
+      particleOfIndex[index] = count
+      count++
+    }
+    this.reserve(count)
+
+    let k = 0
+    for (let index = 0; index < storeCount; index++) {
+      if ((particleOfIndex[index] ?? -1) < 0) {
+        continue
+      }
+      this._index[k] = index
+      this._id[k] = store.id[index] ?? 0
+      this._positionX[k] = store.positionX[index] ?? 0
+      this._positionY[k] = store.positionY[index] ?? 0
+      this._velocityX[k] = store.velocityX[index] ?? 0
+      this._velocityY[k] = store.velocityY[index] ?? 0
+      this._radius[k] = store.radius[index] ?? 0
+      this._mass[k] = store.mass[index] ?? 0
+      this._energy[k] = store.energy[index] ?? 0
+      k++
+    }
+    this._count = count
+    this._storeCount = storeCount
+    this._stale = false
+    return this
+  }
+
+  /**
+   * ストア上の格納位置の粒子番号（直前のgatherの時点）
+   * @returns 粒子番号。粒子でない場合は-1
+   */
+  public particleAt(index: number): number {
+    if (index < 0 || index >= this._storeCount) {
+      return -1
+    }
+    return this._particleOfIndex[index] ?? -1
+  }
+
+  /** 粒子のID */
+  public idAt(particle: number): ObjectId {
+    return (this._id[particle] ?? 0) as ObjectId
+  }
+
+  /**
+   * エネルギー粒子の運動を更新し、位置・速度を粒子の列・ストア・オブジェクトへ書き込む
+   * 物理演算エンジンの運動の更新と同じ式（v = (v0 + at) × 摩擦、x = x0 + vt）を用いる。
+   * 力場との距離はトーラス世界での最短距離で求める
+   * @param store エンティティストア
+   * @param forceFields 力場のマップ
+   * @param deltaTime 時間ステップ
+   * @returns 更新した粒子数
+   */
+  public integrate(
+    store: EntityStore,
+    forceFields: ReadonlyMap<ObjectId, DirectionalForceField>,
+    deltaTime: number
+  ): number {
+    this.gather(store)
+    const count = this._count
+    const positionX = this._positionX
+    const positionY = this._positionY
+    const velocityX = this._velocityX
+    const velocityY = this._velocityY
+    const { frictionCoefficient: friction, emergencyVelocityLimit, minMass } = this._parameters
+    const worldWidth = this._worldWidth
+    const worldHeight = this._worldHeight
+    const fields = forceFields.size > 0 ? Array.from(forceFields.values()) : null
+
+    for (let k = 0; k < count; k++) {
+      let accelerationX = 0
+      let accelerationY = 0
+      if (fields != null) {
+        const x = positionX[k] ?? 0
+        const y = positionY[k] ?? 0
+        for (const field of fields) {
+          // 世界の端をまたいだ最短距離で影響範囲外の力場を除外し、
+          // 力場の中心に最も近い位置（端をまたいだ像）で力を求める
+          const offset = shortestVector(field.position, { x, y }, worldWidth, worldHeight)
+          if (offset.x * offset.x + offset.y * offset.y > field.radius * field.radius) {
+            continue
+          }
+          const position = Vec2Utils.add(field.position, offset)
+          const force = this._forceFieldSystem.calculateForceFromField(position, field)
+          if (force != null) {
+            accelerationX += force.x
+            accelerationY += force.y
+          }
+        }
+        const mass = Math.max(this._mass[k] ?? 0, minMass)
+        accelerationX /= mass
+        accelerationY /= mass
+      }
+
+      let vx = ((velocityX[k] ?? 0) + accelerationX * deltaTime) * friction
+      let vy = ((velocityY[k] ?? 0) + accelerationY * deltaTime) * friction
+      const speed = Math.sqrt(vx * vx + vy * vy)
+      if (speed > emergencyVelocityLimit) {
+        const scale = emergencyVelocityLimit / speed
+        vx = vx * scale
+        vy = vy * scale
+      }
+
+      // 位置の更新とトーラス境界でのラップアラウンド
+      const x = wrapCoordinate((positionX[k] ?? 0) + vx * deltaTime, worldWidth)
+      const y = wrapCoordinate((positionY[k] ?? 0) + vy * deltaTime, worldHeight)
+
+      velocityX[k] = vx
+      velocityY[k] = vy
+      positionX[k] = x
+      positionY[k] = y
+
+      const index = this._index[k] ?? 0
+      store.velocityX[index] = vx
+      store.velocityY[index] = vy
+      store.positionX[index] = x
+      store.positionY[index] = y
+      store.writeBackMotion(index)
+    }
+
+    return count
+  }
+
+  private reserve(count: number): void {
+    if (count <= this._capacity) {
+      return
+    }
+    const capacity = Math.max(count, this._capacity * 2)
+    const index = new Int32Array(capacity)
+    index.set(this._index)
+    this._index = index
+    this._id = growFloat64(this._id, capacity)
+    this._positionX = growFloat64(this._positionX, capacity)
+    this._positionY = growFloat64(this._positionY, capacity)
+    this._velocityX = growFloat64(this._velocityX, capacity)
+    this._velocityY = growFloat64(this._velocityY, capacity)
+    this._radius = growFloat64(this._radius, capacity)
+    this._mass = growFloat64(this._mass, capacity)
+    this._energy = growFloat64(this._energy, capacity)
+    this._capacity = capacity
+  }
+}
@@ -34,13 +34,22 @@ export const DEFAULT_SOURCE_PARAMETERS: EnergySourceParameters = {
 export class EnergySourceManager {
   private readonly _energySystem: EnergySystem
   private readonly _parameters: EnergySourceParameters
+  private readonly _random: () => number
 
+  /**
+   * @param worldWidth 世界の幅
+   * @param worldHeight 世界の高さ
+   * @param parameters エネルギーソース管理のパラメータ
+   * @param random 生成量の分割・生成位置・初速に使う乱数（[0, 1)）
+   */
   public constructor(
     worldWidth: number,
     worldHeight: number,
-    parameters: EnergySourceParameters = DEFAULT_SOURCE_PARAMETERS
+    parameters: EnergySourceParameters = DEFAULT_SOURCE_PARAMETERS,
+    random: () => number = Math.random
   ) {
     this._parameters = parameters
+    this._random = random
     this._energySystem = new EnergySystem(worldWidth, worldHeight)
   }
 
@@ -79,11 +88,11 @@ export class EnergySourceManager {
       } else {
         // ランダムに分割（最低10E、最大で残りの半分）
         const maxAmount = Math.min(remainingEnergy / 2, 1000)
-        amount = Math.floor(10 + Math.random() * (maxAmount - 10))
+        amount = Math.floor(10 + this._random() * (maxAmount - 10))
       }
 
       // 生成位置（ソースの周囲にランダム配置）
-      const angle = Math.random() * 2 * Math.PI
+      const angle = this._random() * 2 * Math.PI
       const distance = this._parameters.spawnDistance
       const position = Vec2Utils.create(
         source.position.x + Math.cos(angle) * distance,
@@ -91,7 +100,7 @@ export class EnergySourceManager {
       )
 
       // 初期速度（外向き）
-      const speed = Math.random() * this._parameters.spawnVelocityRange
+      const speed = this._random() * this._parameters.spawnVelocityRange
       const velocity = Vec2Utils.create(Math.cos(angle) * speed, Math.sin(angle) * speed)
 
       // エネルギーオブジェクトを生成
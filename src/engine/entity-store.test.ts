@@ -0,0 +1,216 @@
+/**
+ * エンティティストアのテスト
+ */
+
+import { EntityStore, ENTITY_KIND } from "./entity-store"
+import type { GameObject, ObjectId } from "@/types/game"
+import { Vec2 as Vec2Utils } from "@/utils/vec2"
+
+const createTestObject = (id: number, x: number, y: number): GameObject => ({
+  id: id as ObjectId,
+  type: "ENERGY",
+  position: Vec2Utils.create(x, y),
+  velocity: Vec2Utils.create(1, 2),
+  radius: 5,
+  energy: 50,
+  mass: 50,
+})
+
+describe("EntityStore", () => {
+  let store: EntityStore
+
+  beforeEach(() => {
+    store = new EntityStore(2)
+  })
+
+  test("追加したオブジェクトの値が列に格納される", () => {
+    const obj = createTestObject(1, 100, 200)
+    store.add(obj)
+
+    const index = store.indexOf(obj.id)
+    expect(store.count).toBe(1)
+    expect(store.positionX[index]).toBe(100)
+    expect(store.positionY[index]).toBe(200)
+    expect(store.velocityX[index]).toBe(1)
+    expect(store.velocityY[index]).toBe(2)
+    expect(store.radius[index]).toBe(5)
+    expect(store.mass[index]).toBe(50)
+    expect(store.energy[index]).toBe(50)
+    expect(store.kind[index]).toBe(ENTITY_KIND.ENERGY)
+    expect(store.get(obj.id)).toBe(obj)
+  })
+
+  test("格納したオブジェクトのプロパティは置き換えない", () => {
+    const obj = createTestObject(1, 100, 200)
+    const position = obj.position
+    store.add(obj)
+
+    expect(obj.position).toBe(position)
+    expect(Object.getOwnPropertyDescriptor(obj, "position")).toEqual({
+      value: position,
+      writable: true,
+      enumerable: true,
+      configurable: true,
+    })
+    expect(Object.getOwnPropertyDescriptor(obj, "energy")?.value).toBe(50)
+  })
+
+  test("列の更新は書き戻すまでオブジェクトに反映されない", () => {
+    const obj = createTestObject(1, 100, 200)
+    store.add(obj)
+
+    const index = store.indexOf(obj.id)
+    store.positionX[index] = 150
+    store.energy[index] = 30
+    store.mass[index] = 30
+    expect(obj.position).toEqual({ x: 100, y: 200 })
+    expect(obj.energy).toBe(50)
+
+    store.writeBackMotion(index)
+    store.writeBackEnergy(index)
+    expect(obj.position).toEqual({ x: 150, y: 200 })
+    expect(obj.velocity).toEqual({ x: 1, y: 2 })
+    expect(obj.energy).toBe(30)
+    expect(obj.mass).toBe(30)
+  })
+
+  test("オブジェクトの変更は同じオブジェクトでの置き換えで列に反映される", () => {
+    const obj = createTestObject(1, 100, 200)
+    store.add(obj)
+
+    obj.position = Vec2Utils.create(10, 20)
+    obj.mass = 80
+    const index = store.indexOf(obj.id)
+    expect(store.positionX[index]).toBe(100)
+
+    expect(store.replace(obj)).toBe(true)
+    expect(store.positionX[index]).toBe(10)
+    expect(store.positionY[index]).toBe(20)
+    expect(store.mass[index]).toBe(80)
+  })
+
+  test("スプレッドで複製したオブジェクトは書き戻しの影響を受けない", () => {
+    const obj = createTestObject(1, 100, 200)
+    store.add(obj)
+
+    const copy = { ...obj }
+    const updated = { ...obj, energy: 10 }
+    const index = store.indexOf(obj.id)
+    store.positionX[index] = 0
+    store.velocityY[index] = 0
+    store.energy[index] = 0
+    store.writeBackMotion(index)
+    store.writeBackEnergy(index)
+
+    expect(obj.position).toEqual({ x: 0, y: 200 })
+    expect(copy).toEqual(createTestObject(1, 100, 200))
+    expect(updated.position).toEqual({ x: 100, y: 200 })
+    expect(updated.velocity).toEqual({ x: 1, y: 2 })
+    expect(updated.energy).toBe(10)
+  })
+
+  test("複数のストアに格納しても互いの列を変更しない", () => {
+    const obj = createTestObject(1, 100, 200)
+    store.add(obj)
+    const scratch = new EntityStore()
+
+    scratch.add(obj)
+    scratch.positionX[0] = 0
+    scratch.writeBackMotion(0)
+    scratch.clear()
+
+    expect(obj.position).toEqual({ x: 0, y: 200 })
+    expect(store.positionX[store.indexOf(obj.id)]).toBe(100)
+    expect(store.id[store.indexOf(obj.id)]).toBe(1)
+  })
+
+  test("削除すると末尾のオブジェクトが詰められる", () => {
+    const obj1 = createTestObject(1, 10, 10)
+    const obj2 = createTestObject(2, 20, 20)
+    const obj3 = createTestObject(3, 30, 30)
+    store.add(obj1)
+    store.add(obj2)
+    store.add(obj3)
+
+    expect(store.remove(obj1.id)).toBe(true)
+
+    expect(store.count).toBe(2)
+    expect(store.has(obj1.id)).toBe(false)
+    expect(store.indexOf(obj3.id)).toBe(0)
+    expect(obj3.position).toEqual({ x: 30, y: 30 })
+    expect(Array.from(store.values())).toEqual([obj3, obj2])
+  })
+
+  test("格納位置の大きい順に削除すると未処理の格納位置は変わらない", () => {
+    const objects = [1, 2, 3, 4, 5].map(id => createTestObject(id, id * 10, id * 10))
+    for (const obj of objects) {
+      store.add(obj)
+    }
+
+    expect(store.removeAt(3)).toBe(true)
+    expect(store.removeAt(1)).toBe(true)
+    expect(store.removeAt(5)).toBe(false)
+
+    expect(store.count).toBe(3)
+    expect(Array.from(store.values()).map(obj => obj.id)).toEqual([1, 5, 3])
+    expect(store.has(2 as ObjectId)).toBe(false)
+    expect(store.has(4 as ObjectId)).toBe(false)
+    expect(store.positionX[1]).toBe(50)
+  })
+
+  test("削除したオブジェクトは最後の値を保持する", () => {
+    const obj = createTestObject(1, 100, 200)
+    store.add(obj)
+    obj.position = Vec2Utils.create(1, 2)
+
+    store.remove(obj.id)
+    store.add(createTestObject(2, 0, 0))
+
+    expect(obj.position).toEqual({ x: 1, y: 2 })
+  })
+
+  test("再利用されたスロットの古いハンドルは無効になる", () => {
+    const obj1 = createTestObject(1, 10, 10)
+    const handle1 = store.add(obj1)
+    store.remove(obj1.id)
+
+    const handle2 = store.add(createTestObject(2, 20, 20))
+
+    expect(store.isAlive(handle1)).toBe(false)
+    expect(store.isAlive(handle2)).toBe(true)
+    expect(store.indexOfHandle(handle1)).toBe(-1)
+  })
+
+  test("同じIDの別オブジェクトで置き換えられる", () => {
+    const obj = createTestObject(1, 10, 10)
+    const handle = store.add(obj)
+
+    const updated = { ...obj, energy: 5 }
+    store.replace(updated)
+
+    expect(store.get(obj.id)).toBe(updated)
+    expect(store.energy[store.indexOfHandle(handle)]).toBe(5)
+    expect(obj.energy).toBe(50)
+  })
+
+  test("容量を超えて追加すると拡張される", () => {
+    for (let i = 0; i < 10; i++) {
+      store.add(createTestObject(i + 1, i, i))
+    }
+
+    expect(store.count).toBe(10)
+    for (let i = 0; i < 10; i++) {
+      expect(store.get((i + 1) as ObjectId)?.position).toEqual({ x: i, y: i })
+    }
+  })
+
+  test("clearで全てのハンドルが無効になる", () => {
+    const handle = store.add(createTestObject(1, 10, 10))
+
+    store.clear()
+    store.add(createTestObject(2, 20, 20))
+
+    expect(store.count).toBe(1)
+    expect(store.isAlive(handle)).toBe(false)
+  })
+})
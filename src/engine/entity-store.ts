@@ -0,0 +1,466 @@
+/**
+ * エンティティストア - ゲームオブジェクトの構造体配列（SoA）管理
+ *
+ * 位置・速度・半径・質量・エネルギーを型付き配列の列として密に保持する。
+ * 物理演算などのホットループは列を直接走査し、オブジェクトの生成を行わない。
+ * 格納したGameObjectは通常のデータプロパティを持つオブジェクトのまま保持する。
+ *
+ * 列とオブジェクトの同期は明示的に行う。
+ * - オブジェクトの値を変更した場合は replace（WorldStateManager.updateObject）で列へ反映する
+ * - 列を直接更新した処理は writeBackMotion / writeBackEnergy でオブジェクトへ書き戻す
+ * 書き戻しでは位置・速度に新しいVec2を代入するため、スプレッドなどで複製したオブジェクトは
+ * 複製した時点の値を保持し、ストアの変更の影響を受けない
+ */
+
+import type { GameObject, ObjectCollection, ObjectId, ObjectType } from "@/types/game"
+
+/**
+ * 世代付きエンティティハンドル
+ * スロット番号と世代を1つの数値に格納する。削除されたスロットが再利用されても
+ * 古いハンドルは世代の不一致により無効と判定される
+ */
+export type EntityHandle = number & { readonly __brand: "EntityHandle" }
+
+/** スロット番号の上限（ハンドル内のスロット部分の範囲） */
+const SLOT_LIMIT = 0x1000000
+
+/** 初期容量 */
+const DEFAULT_CAPACITY = 256
+
+/** オブジェクト種別の列挙値（kind列に格納） */
+export const ENTITY_KIND: Readonly<Record<ObjectType, number>> = {
+  ENERGY: 0,
+  HULL: 1,
+  ASSEMBLER: 2,
+  COMPUTER: 3,
+}
+
+const growFloat64 = (array: Float64Array, capacity: number): Float64Array => {
+  const grown = new Float64Array(capacity)
+  grown.set(array)
+  return grown
+}
+
+const growInt32 = (array: Int32Array, capacity: number, fill: number): Int32Array => {
+  const grown = new Int32Array(capacity)
+  grown.fill(fill)
+  grown.set(array)
+  return grown
+}
+
+/**
+ * ゲームオブジェクトのSoAストア
+ * 密な配列上の添字（index）は削除時の詰め直しで変化するため、
+ * tickをまたいで参照を保持する場合はEntityHandleを使用すること
+ */
+export class EntityStore implements ObjectCollection {
+  private _capacity: number
+  private _count = 0
+  private _id: Float64Array
+  private _positionX: Float64Array
+  private _positionY: Float64Array
+  private _velocityX: Float64Array
+  private _velocityY: Float64Array
+  private _radius: Float64Array
+  private _mass: Float64Array
+  private _energy: Float64Array
+  private _kind: Uint8Array
+  private readonly _objects: GameObject[] = []
+  private _denseToSlot: Int32Array
+  private _slotToDense: Int32Array
+  private _slotGeneration: Uint32Array
+  private _slotCount = 0
+  private readonly _freeSlots: number[] = []
+  private readonly _handles = new Map<ObjectId, EntityHandle>()
+
+  /** 格納しているオブジェクト数 */
+  public get count(): number {
+    return this._count
+  }
+
+  /** 格納しているオブジェクト数（ObjectCollection互換） */
+  public get size(): number {
+    return this._count
+  }
+
+  /** オブジェクトIDの列 */
+  public get id(): Float64Array {
+    return this._id
+  }
+
+  /** X座標の列 */
+  public get positionX(): Float64Array {
+    return this._positionX
+  }
+
+  /** Y座標の列 */
+  public get positionY(): Float64Array {
+    return this._positionY
+  }
+
+  /** X方向速度の列 */
+  public get velocityX(): Float64Array {
+    return this._velocityX
+  }
+
+  /** Y方向速度の列 */
+  public get velocityY(): Float64Array {
+    return this._velocityY
+  }
+
+  /** 半径の列 */
+  public get radius(): Float64Array {
+    return this._radius
+  }
+
+  /** 質量の列 */
+  public get mass(): Float64Array {
+    return this._mass
+  }
+
+  /** エネルギー量の列 */
+  public get energy(): Float64Array {
+    return this._energy
+  }
+
+  /** オブジェクト種別の列（ENTITY_KIND） */
+  public get kind(): Uint8Array {
+    return this._kind
+  }
+
+  /**
+   * @param initialCapacity 初期容量
+   */
+  public constructor(initialCapacity = DEFAULT_CAPACITY) {
+    const capacity = Math.max(1, initialCapacity)
+    this._capacity = capacity
+    this._id = new Float64Array(capacity)
+    this._positionX = new Float64Array(capacity)
+    this._positionY = new Float64Array(capacity)
+    this._velocityX = new Float64Array(capacity)
+    this._velocityY = new Float64Array(capacity)
+    this._radius = new Float64Array(capacity)
+    this._mass = new Float64Array(capacity)
+    this._energy = new Float64Array(capacity)
+    this._kind = new Uint8Array(capacity)
+    this._denseToSlot = new Int32Array(capacity).fill(-1)
+    this._slotToDense = new Int32Array(capacity).fill(-1)
+    this._slotGeneration = new Uint32Array(capacity)
+  }
+
+  /**
+   * オブジェクトを追加する
+   * 同じIDのオブジェクトが既に存在する場合は置き換える
+   * @returns 追加したオブジェクトのハンドル
+   */
+  public add(object: GameObject): EntityHandle {
+    const existing = this._handles.get(object.id)
+    if (existing != null) {
+      this.replace(object)
+      return existing
+    }
+
+    if (this._count >= this._capacity) {
+      this.grow(this._capacity * 2)
+    }
+
+    const slot = this.allocateSlot()
+    const index = this._count
+    this._count++
+
+    this._denseToSlot[index] = slot
+    this._slotToDense[slot] = index
+    this._objects[index] = object
+    this.writeColumns(index, object)
+
+    const handle = this.makeHandle(slot)
+    this._handles.set(object.id, handle)
+    return handle
+  }
+
+  /**
+   * オブジェクトを削除する
+   * 末尾のオブジェクトを空いた位置に移動して配列を密に保つ
+   * @returns 削除した場合true
+   */
+  public remove(id: ObjectId): boolean {
+    const index = this.indexOf(id)
+    if (index < 0) {
+      return false
+    }
+    return this.removeAt(index)
+  }
+
+  /**
+   * 格納位置のオブジェクトを削除する（removeと同じく末尾のオブジェクトで詰める）
+   * 複数を削除する場合は格納位置の大きい順に呼び出すと、未処理の格納位置は変わらない
+   * @returns 削除した場合true
+   */
+  public removeAt(index: number): boolean {
+    const object = this.objectAt(index)
+    if (object == null) {
+      return false
+    }
+
+    const slot = this._denseToSlot[index] ?? 0
+
+    const lastIndex = this._count - 1
+    if (index !== lastIndex) {
+      this.moveEntity(lastIndex, index)
+    }
+
+    this._objects.length = lastIndex
+    this._denseToSlot[lastIndex] = -1
+    this._count = lastIndex
+
+    this._slotToDense[slot] = -1
+    this._slotGeneration[slot] = ((this._slotGeneration[slot] ?? 0) + 1) % SLOT_LIMIT
+    this._freeSlots.push(slot)
+    this._handles.delete(object.id)
+    return true
+  }
+
+  /**
+   * 複数のオブジェクトを末尾へまとめて追加する
+   * 容量の確保は一度だけ行う。格納済みのIDのオブジェクトは add と同じく置き換える
+   * @param objects 追加するオブジェクト
+   */
+  public addAll(objects: readonly GameObject[]): void {
+    this.reserve(this._count + objects.length)
+    for (const object of objects) {
+      this.add(object)
+    }
+  }
+
+  /**
+   * 同じIDの格納済みオブジェクトを置き換える
+   * 同じオブジェクトを渡した場合は、オブジェクト側で変更した値を列へ反映する。
+   * ハンドルと格納位置は維持される
+   * @returns 置き換えた場合true
+   */
+  public replace(object: GameObject): boolean {
+    const index = this.indexOf(object.id)
+    if (index < 0) {
+      return false
+    }
+
+    this._objects[index] = object
+    this.writeColumns(index, object)
+    return true
+  }
+
+  /**
+   * 格納位置の位置・速度の列の値をオブジェクトへ書き戻す
+   * 新しいVec2を代入するため、以前の位置・速度を参照する複製は変更されない
+   */
+  public writeBackMotion(index: number): void {
+    const object = this.objectAt(index)
+    if (object == null) {
+      return
+    }
+    object.position = { x: this._positionX[index] ?? 0, y: this._positionY[index] ?? 0 }
+    object.velocity = { x: this._velocityX[index] ?? 0, y: this._velocityY[index] ?? 0 }
+  }
+
+  /** 格納位置のエネルギー量・質量の列の値をオブジェクトへ書き戻す */
+  public writeBackEnergy(index: number): void {
+    const object = this.objectAt(index)
+    if (object == null) {
+      return
+    }
+    object.energy = this._energy[index] ?? 0
+    object.mass = this._mass[index] ?? 0
+  }
+
+  /** 全オブジェクトを削除する */
+  public clear(): void {
+    // 既存のハンドルを全て無効化する
+    for (let slot = 0; slot < this._slotCount; slot++) {
+      this._slotGeneration[slot] = ((this._slotGeneration[slot] ?? 0) + 1) % SLOT_LIMIT
+    }
+
+    this._objects.length = 0
+    this._handles.clear()
+    this._freeSlots.length = 0
+    this._denseToSlot.fill(-1)
+    this._slotToDense.fill(-1)
+    this._count = 0
+    for (let slot = this._slotCount - 1; slot >= 0; slot--) {
+      this._freeSlots.push(slot)
+    }
+  }
+
+  /** IDからハンドルを取得 */
+  public handleOf(id: ObjectId): EntityHandle | undefined {
+    return this._handles.get(id)
+  }
+
+  /** ハンドルが有効か（削除済みでないか） */
+  public isAlive(handle: EntityHandle): boolean {
+    return this.indexOfHandle(handle) >= 0
+  }
+
+  /**
+   * ハンドルから現在の格納位置を取得
+   * @returns 格納位置。無効なハンドルの場合は-1
+   */
+  public indexOfHandle(handle: EntityHandle): number {
+    const slot = this.slotOf(handle)
+    if (slot >= this._slotCount) {
+      return -1
+    }
+    if (this._slotGeneration[slot] !== Math.floor(handle / SLOT_LIMIT)) {
+      return -1
+    }
+    return this._slotToDense[slot] ?? -1
+  }
+
+  /**
+   * IDから現在の格納位置を取得
+   * @returns 格納位置。存在しない場合は-1
+   */
+  public indexOf(id: ObjectId): number {
+    const handle = this._handles.get(id)
+    if (handle == null) {
+      return -1
+    }
+    return this.indexOfHandle(handle)
+  }
+
+  /** 格納位置のオブジェクトを取得 */
+  public objectAt(index: number): GameObject | undefined {
+    if (index < 0 || index >= this._count) {
+      return undefined
+    }
+    return this._objects[index]
+  }
+
+  /**
+   * 格納位置のスロット番号を取得
+   * スロット番号はオブジェクトが格納されている間は変化しない
+   * @returns スロット番号。範囲外の場合は-1
+   */
+  public slotAt(index: number): number {
+    if (index < 0 || index >= this._count) {
+      return -1
+    }
+    return this._denseToSlot[index] ?? -1
+  }
+
+  /**
+   * スロット番号から現在の格納位置を取得
+   * @returns 格納位置。空きスロットの場合は-1
+   */
+  public indexAtSlot(slot: number): number {
+    if (slot < 0 || slot >= this._slotCount) {
+      return -1
+    }
+    return this._slotToDense[slot] ?? -1
+  }
+
+  /** 格納位置のハンドルを取得 */
+  public handleAt(index: number): EntityHandle | undefined {
+    if (index < 0 || index >= this._count) {
+      return undefined
+    }
+    return this.makeHandle(this._denseToSlot[index] ?? 0)
+  }
+
+  public get(id: ObjectId): GameObject | undefined {
+    const index = this.indexOf(id)
+    if (index < 0) {
+      return undefined
+    }
+    return this._objects[index]
+  }
+
+  public has(id: ObjectId): boolean {
+    return this._handles.has(id)
+  }
+
+  /** 格納順にオブジェクトを列挙する */
+  public values(): IterableIterator<GameObject> {
+    return this._objects.values()
+  }
+
+  /** 指定容量以上を確保する */
+  public reserve(capacity: number): void {
+    if (capacity > this._capacity) {
+      this.grow(capacity)
+    }
+  }
+
+  private allocateSlot(): number {
+    const reused = this._freeSlots.pop()
+    if (reused != null) {
+      return reused
+    }
+    return this._slotCount++
+  }
+
+  private slotOf(handle: EntityHandle): number {
+    return handle % SLOT_LIMIT
+  }
+
+  private makeHandle(slot: number): EntityHandle {
+    return ((this._slotGeneration[slot] ?? 0) * SLOT_LIMIT + slot) as EntityHandle
+  }
+
+  private grow(capacity: number): void {
+    this._id = growFloat64(this._id, capacity)
+    this._positionX = growFloat64(this._positionX, capacity)
+    this._positionY = growFloat64(this._positionY, capacity)
+    this._velocityX = growFloat64(this._velocityX, capacity)
+    this._velocityY = growFloat64(this._velocityY, capacity)
+    this._radius = growFloat64(this._radius, capacity)
+    this._mass = growFloat64(this._mass, capacity)
+    this._energy = growFloat64(this._energy, capacity)
+
+    const kind = new Uint8Array(capacity)
+    kind.set(this._kind)
+    this._kind = kind
+
+    this._denseToSlot = growInt32(this._denseToSlot, capacity, -1)
+    this._slotToDense = growInt32(this._slotToDense, capacity, -1)
+
+    const generation = new Uint32Array(capacity)
+    generation.set(this._slotGeneration)
+    this._slotGeneration = generation
+
+    this._capacity = capacity
+  }
+
+  /** from位置のエンティティをto位置へ移動する（削除時の詰め直し用） */
+  private moveEntity(from: number, to: number): void {
+    this._id[to] = this._id[from] ?? 0
+    this._positionX[to] = this._positionX[from] ?? 0
+    this._positionY[to] = this._positionY[from] ?? 0
+    this._velocityX[to] = this._velocityX[from] ?? 0
+    this._velocityY[to] = this._velocityY[from] ?? 0
+    this._radius[to] = this._radius[from] ?? 0
+    this._mass[to] = this._mass[from] ?? 0
+    this._energy[to] = this._energy[from] ?? 0
+    this._kind[to] = this._kind[from] ?? 0
+
+    const slot = this._denseToSlot[from] ?? 0
+    this._denseToSlot[to] = slot
+    this._slotToDense[slot] = to
+
+    const object = this._objects[from]
+    if (object != null) {
+      this._objects[to] = object
+    }
+  }
+
+  private writeColumns(index: number, object: GameObject): void {
+    this._id[index] = object.id
+    this._positionX[index] = object.position.x
+    this._positionY[index] = object.position.y
+    this._velocityX[index] = object.velocity.x
+    this._velocityY[index] = object.velocity.y
+    this._radius[index] = object.radius
+    this._mass[index] = object.mass
+    this._energy[index] = object.energy
+    this._kind[index] = ENTITY_KIND[object.type]
+  }
+}
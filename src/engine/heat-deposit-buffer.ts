@@ -0,0 +1,76 @@
+/**
+ * 熱の追加の一時バッファ
+ *
+ * 多数のオブジェクトから熱を加える処理（エネルギーの崩壊など）で、熱グリッドのセルごとに
+ * 追加量を累積し、HeatSystem.applyDeposits でまとめて反映する。
+ * 熱量は HeatSystem.addHeat と同じく追加ごとに整数に切り捨てて累積するため、個別に加えた場合と結果は変わらない。
+ * 累積先の配列と、追加のあったセルの一覧を使い回すため、反映時は追加のあったセルのみを走査する
+ */
+
+/** 初期容量（追加のあったセル数） */
+const DEFAULT_CAPACITY = 256
+
+export class HeatDepositBuffer {
+  /** セルごとの累積量（追加のあったセル以外は常に0） */
+  private readonly _amounts: Float64Array
+  /** セルごとの追加の有無（切り捨てて0になった追加も含む） */
+  private readonly _added: Uint8Array
+  private _cells = new Int32Array(DEFAULT_CAPACITY)
+  private _count = 0
+
+  /** 追加のあったセル数 */
+  public get count(): number {
+    return this._count
+  }
+
+  /**
+   * @param cellCount 熱グリッドのセル数
+   */
+  public constructor(cellCount: number) {
+    this._amounts = new Float64Array(cellCount)
+    this._added = new Uint8Array(cellCount)
+  }
+
+  /**
+   * セルに熱を整数に切り捨てて累積する
+   * @param cell セルの格納位置（HeatSystem.cellIndexAt で求めたもの）
+   * @param amount 追加する熱量
+   */
+  public add(cell: number, amount: number): void {
+    if (amount <= 0 || cell < 0 || cell >= this._amounts.length) {
+      return
+    }
+
+    if (this._added[cell] !== 1) {
+      this._added[cell] = 1
+      if (this._count === this._cells.length) {
+        const cells = new Int32Array(this._cells.length * 2)
+        cells.set(this._cells)
+        this._cells = cells
+      }
+      this._cells[this._count] = cell
+      this._count++
+    }
+    this._amounts[cell] = (this._amounts[cell] ?? 0) + Math.floor(amount)
+  }
+
+  /** 追加のあったk番目のセルの格納位置 */
+  public cellAt(k: number): number {
+    return this._cells[k] ?? -1
+  }
+
+  /** 追加のあったk番目のセルの累積量 */
+  public amountAt(k: number): number {
+    return this._amounts[this._cells[k] ?? -1] ?? 0
+  }
+
+  /** 累積をすべて破棄する */
+  public clear(): void {
+    for (let k = 0; k < this._count; k++) {
+      const cell = this._cells[k] ?? 0
+      this._amounts[cell] = 0
+      this._added[cell] = 0
+    }
+    this._count = 0
+  }
+}
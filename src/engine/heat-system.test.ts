@@ -4,6 +4,7 @@
 
 import { HeatSystem, createHeatParametersFromGameLaws } from "./heat-system"
 import type { HeatSystemParameters } from "./heat-system"
+import { HeatDepositBuffer } from "./heat-deposit-buffer"
 import { Vec2 as Vec2Utils } from "@/utils/vec2"
 
 describe("HeatSystem", () => {
@@ -51,6 +52,30 @@ describe("HeatSystem", () => {
       heatSystem.addHeat(0, 0, 50.7)
       expect(heatSystem.getHeat(0, 0)).toBe(50)
     })
+
+    test("一時バッファに累積した熱をセルごとにまとめて追加し、追加ごとに切り捨てる", () => {
+      const deposits = new HeatDepositBuffer(width * height)
+      const cell = heatSystem.cellIndexAt(Vec2Utils.create(55, 55))
+      deposits.add(cell, 0.6)
+      deposits.add(cell, 0.6)
+      deposits.add(cell, 2.5)
+      deposits.add(heatSystem.cellIndexAt(Vec2Utils.create(-5, 15)), 30)
+      expect(deposits.count).toBe(2)
+
+      const individual = new HeatSystem(width, height)
+      for (const amount of [0.6, 0.6, 2.5]) {
+        individual.addHeatAt(Vec2Utils.create(55, 55), amount)
+      }
+
+      heatSystem.applyDeposits(deposits)
+
+      // addHeat を追加ごとに呼んだ場合と同じく、追加ごとに切り捨てて加える
+      expect(heatSystem.getHeat(5, 5)).toBe(2)
+      expect(heatSystem.getHeat(5, 5)).toBe(individual.getHeat(5, 5))
+      expect(heatSystem.getHeat(9, 1)).toBe(30)
+      expect(deposits.count).toBe(0)
+      expect(deposits.amountAt(0)).toBe(0)
+    })
   })
 
   describe("トーラス境界での熱操作", () => {
@@ -356,4 +381,219 @@ describe("HeatSystem", () => {
       expect(heatSystem.getHeat(6, 5)).toBeLessThan(500)
     })
   })
+
+  describe("整数規則の互換性", () => {
+    // 2次元配列で各ペアを順に処理する従来の拡散規則
+    const referenceDiffusion = (grid: number[][], params: HeatSystemParameters): number[][] => {
+      const h = grid.length
+      const w = grid[0]?.length ?? 0
+      const next = grid.map(row => [...row])
+      const exchange = (x1: number, y1: number, x2: number, y2: number): void => {
+        const heat1 = grid[y1]![x1]!
+        const heat2 = grid[y2]![x2]!
+        const base = params.heatDiffusionBase
+        const diff = Math.floor(heat2 / base) - Math.floor(heat1 / base)
+        let flow = Math.floor(diff / params.heatFlowRate)
+        const maxFlow = Math.floor(Math.abs(diff) / params.heatFlowLimitRatio) - 1
+        if (maxFlow > 0 && Math.abs(flow) > maxFlow) {
+          flow = Math.sign(flow) * maxFlow
+        }
+        if (flow > 0 && flow > heat2) {
+          flow = heat2
+        } else if (flow < 0 && Math.abs(flow) > heat1) {
+          flow = -heat1
+        }
+        next[y1]![x1]! += flow
+        next[y2]![x2]! -= flow
+      }
+      for (let y = 0; y < h; y++) {
+        for (let x = 0; x < w; x++) {
+          exchange(x, y, (x + 1) % w, y)
+          exchange(x, y, x, (y + 1) % h)
+        }
+      }
+      return next
+    }
+
+    // 全セルを処理する従来の放熱規則
+    const referenceRadiation = (grid: number[][], params: HeatSystemParameters): void => {
+      for (const row of grid) {
+        row.forEach((heat, x) => {
+          const environmentHeat = Math.floor(heat * params.radiationEnvRatio)
+          const base = params.heatDiffusionBase
+          const difference = Math.floor(heat / base) - Math.floor(environmentHeat / base)
+          if (heat === 0 || difference <= 0) {
+            return
+          }
+          let amount = Math.floor(difference / params.heatFlowRate)
+          const maxRadiation = Math.floor(difference / params.heatFlowLimitRatio) - 1
+          if (maxRadiation > 0 && amount > maxRadiation) {
+            amount = maxRadiation
+          }
+          row[x] = heat - Math.min(amount, heat)
+        })
+      }
+    }
+
+    test("疎な熱源でもアクティブタイルのみの処理が全セル処理と一致する", () => {
+      const params = createHeatParametersFromGameLaws()
+      const w = 30
+      const h = 21
+      const system = new HeatSystem(w, h, params)
+      let grid: number[][] = Array.from({ length: h }, () => new Array<number>(w).fill(0))
+
+      // タイル境界とトーラス境界の付近に熱源を置く
+      const sources: [number, number, number][] = [
+        [0, 0, 50000],
+        [29, 20, 30000],
+        [7, 8, 20000],
+        [16, 15, 100],
+      ]
+      for (const [x, y, heat] of sources) {
+        grid[y]![x] = heat
+        system.addHeat(x, y, heat)
+      }
+
+      for (let tick = 0; tick < 60; tick++) {
+        grid = referenceDiffusion(grid, params)
+        referenceRadiation(grid, params)
+        system.updateDiffusion()
+        system.updateRadiation()
+      }
+
+      expect(Array.from(system.heatValues)).toEqual(([] as number[]).concat(...grid))
+    })
+
+    test.each([
+      [7, 5],
+      [2, 2],
+      [1, 4],
+      [13, 1],
+    ])("%i x %i のグリッドで従来の規則と同じ結果になる", (w, h) => {
+      const params = createHeatParametersFromGameLaws()
+      const system = new HeatSystem(w, h, params)
+      let grid: number[][] = Array.from({ length: h }, () => new Array<number>(w).fill(0))
+
+      // 決定的な疑似乱数で熱を配置
+      let seed = 12345
+      for (let y = 0; y < h; y++) {
+        for (let x = 0; x < w; x++) {
+          seed = (seed * 1103515245 + 12345) % 2147483648
+          const heat = seed % 3000
+          grid[y]![x] = heat
+          system.addHeat(x, y, heat)
+        }
+      }
+
+      for (let tick = 0; tick < 20; tick++) {
+        grid = referenceDiffusion(grid, params)
+        system.updateDiffusion()
+      }
+
+      for (let y = 0; y < h; y++) {
+        for (let x = 0; x < w; x++) {
+          expect(system.getHeat(x, y)).toBe(grid[y]![x])
+        }
+      }
+      expect(Array.from(system.heatValues)).toEqual(([] as number[]).concat(...grid))
+    })
+  })
+
+  describe("アクティブタイル", () => {
+    test("熱を追加したタイルがアクティブになる", () => {
+      const system = new HeatSystem(64, 64)
+      expect(system.activeTileCount).toBe(0)
+
+      system.addHeat(10, 10, 5000)
+      expect(system.activeTileCount).toBe(1)
+    })
+
+    test("基準熱量未満になったタイルは低温に戻る", () => {
+      const params = createHeatParametersFromGameLaws()
+      const system = new HeatSystem(64, 64, params)
+
+      system.addHeat(10, 10, params.heatDiffusionBase - 1)
+      system.updateDiffusion()
+
+      expect(system.activeTileCount).toBe(0)
+      expect(system.getHeat(10, 10)).toBe(params.heatDiffusionBase - 1)
+    })
+
+    test("熱が隣接タイルに広がるとそのタイルもアクティブになる", () => {
+      const system = new HeatSystem(64, 64)
+      system.addHeat(7, 3, 100000)
+
+      for (let i = 0; i < 5; i++) {
+        system.updateDiffusion()
+      }
+
+      expect(system.getHeat(8, 3)).toBeGreaterThan(0)
+      expect(system.activeTileCount).toBeGreaterThan(1)
+    })
+  })
+
+  describe("タイル単位の処理とグリッド全体の処理", () => {
+    // 同じ熱源を置いた、常にタイル単位で処理するものと常にグリッド全体で処理するもの
+    const createPair = (w: number, h: number, sources: [number, number, number][]) => {
+      const params = createHeatParametersFromGameLaws()
+      const sparse = new HeatSystem(w, h, params, Infinity)
+      const dense = new HeatSystem(w, h, params, 0)
+      for (const [x, y, heat] of sources) {
+        sparse.addHeat(x, y, heat)
+        dense.addHeat(x, y, heat)
+      }
+      return { sparse, dense }
+    }
+
+    const stepBoth = (systems: { sparse: HeatSystem; dense: HeatSystem }, ticks: number) => {
+      for (let tick = 0; tick < ticks; tick++) {
+        for (const system of [systems.sparse, systems.dense]) {
+          system.updateDiffusion()
+          system.updateRadiation()
+        }
+        expect(Array.from(systems.sparse.heatValues)).toEqual(Array.from(systems.dense.heatValues))
+        expect(systems.sparse.activeTileCount).toBe(systems.dense.activeTileCount)
+      }
+    }
+
+    test("疎な熱源で同じ結果になる", () => {
+      // タイル境界とトーラス境界の付近に熱源を置く
+      const systems = createPair(37, 26, [
+        [0, 0, 60000],
+        [36, 25, 40000],
+        [8, 7, 20000],
+        [20, 13, 500],
+      ])
+
+      stepBoth(systems, 80)
+    })
+
+    test("全セルが高温のグリッドで同じ結果になる", () => {
+      const w = 35
+      const h = 19
+      const sources: [number, number, number][] = []
+      for (let y = 0; y < h; y++) {
+        for (let x = 0; x < w; x++) {
+          sources.push([x, y, 1000 + ((x * 7919 + y * 104729) % 50000)])
+        }
+      }
+      const systems = createPair(w, h, sources)
+
+      stepBoth(systems, 40)
+    })
+
+    test("アクティブなタイルが多い場合はグリッド全体の処理に切り替わっても結果が変わらない", () => {
+      const params = createHeatParametersFromGameLaws()
+      const sparse = new HeatSystem(32, 32, params, Infinity)
+      const adaptive = new HeatSystem(32, 32, params)
+      for (let y = 0; y < 32; y += 4) {
+        for (let x = 0; x < 32; x += 4) {
+          sparse.addHeat(x, y, 30000)
+          adaptive.addHeat(x, y, 30000)
+        }
+      }
+
+      stepBoth({ sparse, dense: adaptive }, 40)
+    })
+  })
 })
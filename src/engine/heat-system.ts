@@ -1,9 +1,18 @@
 /**
  * 熱拡散システム - セルオートマトンによる熱の拡散・平衡化
+ *
+ * 熱グリッドは行優先の1次元Float64Array（index = y * width + x）で保持する。
+ * 熱量は常に整数で、全ての演算は整数規則に従う
+ *
+ * 基準熱量（heatDiffusionBase）未満のセル同士では熱流も放熱も0になるため、
+ * 基準熱量以上のセルを含むタイルだけをアクティブとして拡散・放熱を行う。
+ * アクティブなタイルが多い場合はタイル単位の処理をやめ、グリッド全体を連続した範囲として処理する。
+ * どちらの場合も結果は全セルを処理した場合と一致する
  */
 
 import type { Vec2 } from "@/types/game"
 import { getGameLawParameters } from "@/config/game-law-parameters"
+import type { HeatDepositBuffer } from "./heat-deposit-buffer"
 
 /** 熱システムのパラメータ */
 export type HeatSystemParameters = {
@@ -54,34 +63,115 @@ export type HeatGridStats = {
   readonly hotCellCount: number
 }
 
+/** アクティブ領域を管理するタイルの一辺のセル数 */
+export const HEAT_TILE_SIZE = 8
+
+const TILE_COLD = 0
+const TILE_ACTIVE = 1
+
+/** アクティブなタイルの割合がこれ以上の場合はグリッド全体をまとめて処理する */
+const DEFAULT_DENSE_TILE_RATIO = 0.5
+
+/**
+ * 隣接する2セル間の熱流量を計算する（セル2からセル1への方向を正とする）
+ * 熱量は両セルの拡散前の値を使うため、ペアの処理順序に結果は依存しない
+ */
+const calculateHeatFlow = (
+  heat1: number,
+  heat2: number,
+  diffusionBase: number,
+  flowRate: number,
+  flowLimitRatio: number
+): number => {
+  // 基準熱量の差
+  const diff = Math.floor(heat2 / diffusionBase) - Math.floor(heat1 / diffusionBase)
+
+  // 熱流量
+  let flow = Math.floor(diff / flowRate)
+
+  // 流量制限
+  const maxFlow = Math.floor(Math.abs(diff) / flowLimitRatio) - 1
+  if (maxFlow > 0 && Math.abs(flow) > maxFlow) {
+    flow = Math.sign(flow) * maxFlow
+  }
+
+  // 流出元のセルが十分な熱を持っているか確認
+  if (flow > 0 && flow > heat2) {
+    return heat2 // セル2から流出できる最大量に制限
+  }
+  if (flow < 0 && -flow > heat1) {
+    return -heat1 // セル1から流出できる最大量に制限
+  }
+  return flow
+}
+
 export class HeatSystem {
   private readonly _width: number
   private readonly _height: number
   private readonly _parameters: HeatSystemParameters
-  private _currentHeat: number[][]
-  private _nextHeat: number[][]
+  private readonly _heat: Float64Array
+  /** 拡散中の熱流の累積（拡散の前後で常に0） */
+  private readonly _flow: Float64Array
+  private readonly _tileCols: number
+  private readonly _tileRows: number
+  private readonly _tileState: Uint8Array
+  private _activeTiles: Int32Array
+  private _nextActiveTiles: Int32Array
+  private _activeTileCount = 0
+  private readonly _denseTileRatio: number
+
+  /** グリッドの幅（セル数） */
+  public get width(): number {
+    return this._width
+  }
 
+  /** グリッドの高さ（セル数） */
+  public get height(): number {
+    return this._height
+  }
+
+  /**
+   * 現在の熱グリッド（行優先、index = y * width + x）
+   * 読み取り専用として扱うこと
+   */
+  public get heatValues(): Float64Array {
+    return this._heat
+  }
+
+  /** 拡散・放熱の対象となっているタイル数 */
+  public get activeTileCount(): number {
+    return this._activeTileCount
+  }
+
+  /**
+   * @param width グリッドの幅（セル数）
+   * @param height グリッドの高さ（セル数）
+   * @param parameters 熱システムのパラメータ
+   * @param denseTileRatio アクティブなタイルの割合がこれ以上の場合はグリッド全体をまとめて処理する
+   *   （0で常にグリッド全体、Infinityで常にタイル単位）
+   */
   public constructor(
     width: number,
     height: number,
-    parameters?: HeatSystemParameters
+    parameters?: HeatSystemParameters,
+    denseTileRatio = DEFAULT_DENSE_TILE_RATIO
   ) {
     this._width = width
     this._height = height
     this._parameters = parameters ?? createHeatParametersFromGameLaws()
+    this._denseTileRatio = denseTileRatio
 
     // 熱グリッドの初期化
-    this._currentHeat = new Array<number[]>(height)
-    this._nextHeat = new Array<number[]>(height)
-    for (let i = 0; i < height; i++) {
-      this._currentHeat[i] = new Array<number>(width).fill(0)
-      this._nextHeat[i] = new Array<number>(width).fill(0)
-    }
-  }
-
-  // eslint-disable-next-line @typescript-eslint/member-ordering
-  public get heatGrid(): readonly (readonly number[])[] {
-    return this._currentHeat
+    this._heat = new Float64Array(width * height)
+    this._flow = new Float64Array(width * height)
+
+    // タイルの初期化（全て低温）
+    this._tileCols = Math.ceil(width / HEAT_TILE_SIZE)
+    this._tileRows = Math.ceil(height / HEAT_TILE_SIZE)
+    const tileCount = this._tileCols * this._tileRows
+    this._tileState = new Uint8Array(tileCount)
+    this._activeTiles = new Int32Array(tileCount)
+    this._nextActiveTiles = new Int32Array(tileCount)
   }
 
   /**
@@ -91,10 +181,7 @@ export class HeatSystem {
    * @returns 熱量
    */
   public getHeat(x: number, y: number): number {
-    // トーラス境界でラップ
-    const wrappedX = ((x % this._width) + this._width) % this._width
-    const wrappedY = ((y % this._height) + this._height) % this._height
-    return this._currentHeat[wrappedY]?.[wrappedX] ?? 0
+    return this._heat[this.cellIndexOf(x, y)] ?? 0
   }
 
   /**
@@ -108,11 +195,10 @@ export class HeatSystem {
       return
     }
 
-    const wrappedX = ((x % this._width) + this._width) % this._width
-    const wrappedY = ((y % this._height) + this._height) % this._height
-    const row = this._currentHeat[wrappedY]
-    if (row !== undefined) {
-      row[wrappedX] = (row[wrappedX] ?? 0) + Math.floor(amount)
+    const index = this.cellIndexOf(x, y)
+    if (index >= 0) {
+      this._heat[index] = (this._heat[index] ?? 0) + Math.floor(amount)
+      this.activateTileOf(index)
     }
   }
 
@@ -129,82 +215,93 @@ export class HeatSystem {
   }
 
   /**
-   * 熱拡散を1ステップ実行
+   * 座標が属するセルの格納位置（addHeatAtと同じ対応）
+   * @param position 位置
+   * @returns 格納位置（行優先、index = y * width + x）
    */
-  public updateDiffusion(): void {
-    // まず全セルを現在の値で初期化
-    for (let y = 0; y < this._height; y++) {
-      const row = this._currentHeat[y]
-      if (row !== undefined) {
-        this._nextHeat[y] = [...row]
-      }
-    }
+  public cellIndexAt(position: Vec2): number {
+    return this.cellIndexOf(Math.floor(position.x / 10), Math.floor(position.y / 10))
+  }
 
-    // 各セルペア間の熱流を計算（重複を避けるため、各ペアを1回だけ処理）
-    for (let y = 0; y < this._height; y++) {
-      for (let x = 0; x < this._width; x++) {
-        // 東と南の隣接セルとのみ熱交換を計算（西と北は既に計算済み）
-        this.calculateHeatExchange(x, y, (x + 1) % this._width, y) // 東
-        this.calculateHeatExchange(x, y, x, (y + 1) % this._height) // 南
+  /**
+   * 一時バッファに累積した熱をまとめて追加し、バッファを空にする
+   * 累積量は追加ごとに切り捨て済みのため、addHeat を追加ごとに呼んだ場合と同じ結果になる
+   * @param deposits 熱の追加の一時バッファ
+   */
+  public applyDeposits(deposits: HeatDepositBuffer): void {
+    for (let k = 0; k < deposits.count; k++) {
+      const index = deposits.cellAt(k)
+      if (index < 0) {
+        continue
       }
+      this._heat[index] = (this._heat[index] ?? 0) + deposits.amountAt(k)
+      this.activateTileOf(index)
     }
-
-    // バッファをスワップ
-    const temp = this._currentHeat
-    this._currentHeat = this._nextHeat
-    this._nextHeat = temp
+    deposits.clear()
   }
 
   /**
-   * 放熱処理を実行
+   * 熱拡散を1ステップ実行
+   * 各セルは東と南の隣接セルとのペアを受け持つ。熱流は拡散前の値から計算して累積し、
+   * 最後にまとめて反映する。
+   * アクティブなタイルが少ない場合は、アクティブなタイルのセルが受け持つペアに加え、
+   * 低温のタイルからアクティブなタイルに接するペアを処理する
    */
-  public updateRadiation(): void {
-    const { radiationEnvRatio, heatDiffusionBase, heatFlowRate, heatFlowLimitRatio } =
-      this._parameters
+  public updateDiffusion(): void {
+    if (this._activeTileCount === 0) {
+      return
+    }
 
-    for (let y = 0; y < this._height; y++) {
-      for (let x = 0; x < this._width; x++) {
-        const row = this._currentHeat[y]
-        if (row === undefined) {
-          continue
-        }
-        const currentHeat = row[x] ?? 0
-        if (currentHeat === 0) {
-          continue
-        }
+    if (this.shouldProcessWholeGrid()) {
+      this.activateAllTiles()
+      this.accumulateGridFlow()
+      this.applyGridFlow()
+      this.retireColdTiles()
+      return
+    }
 
-        // 仮想的な環境温度
-        const environmentHeat = Math.floor(currentHeat * radiationEnvRatio)
+    const activeCount = this._activeTileCount
+    for (let k = 0; k < activeCount; k++) {
+      this.accumulateTileFlow(this._activeTiles[k] ?? 0)
+    }
 
-        // 環境との熱量差による放熱
-        const baseHeat = Math.floor(currentHeat / heatDiffusionBase)
-        const envBaseHeat = Math.floor(environmentHeat / heatDiffusionBase)
-        const heatDifference = baseHeat - envBaseHeat
+    // 熱流の反映（隣接タイルと重なる境界は2回目以降0が加算される）
+    for (let k = 0; k < activeCount; k++) {
+      this.applyTileFlow(this._activeTiles[k] ?? 0)
+    }
 
-        if (heatDifference <= 0) {
-          continue
-        }
+    this.retireColdTiles()
+  }
 
-        // 放熱量
-        let radiationAmount = Math.floor(heatDifference / heatFlowRate)
+  /**
+   * 放熱処理を実行
+   */
+  public updateRadiation(): void {
+    if (this._activeTileCount === 0) {
+      return
+    }
 
-        // 放熱量の制限
-        const maxRadiation = Math.floor(heatDifference / heatFlowLimitRatio) - 1
-        if (maxRadiation > 0 && radiationAmount > maxRadiation) {
-          radiationAmount = maxRadiation
-        }
+    if (this.shouldProcessWholeGrid()) {
+      this.activateAllTiles()
+      this.radiateRange(0, this._heat.length)
+      this.retireColdTiles()
+      return
+    }
 
-        // 負の熱量にならないように制限
-        if (radiationAmount > currentHeat) {
-          radiationAmount = currentHeat
-        }
+    const width = this._width
+    for (let k = 0; k < this._activeTileCount; k++) {
+      const tile = this._activeTiles[k] ?? 0
+      const x0 = (tile % this._tileCols) * HEAT_TILE_SIZE
+      const y0 = Math.floor(tile / this._tileCols) * HEAT_TILE_SIZE
+      const x1 = Math.min(x0 + HEAT_TILE_SIZE, width)
+      const y1 = Math.min(y0 + HEAT_TILE_SIZE, this._height)
 
-        const currentRow = this._currentHeat[y]
-        if (currentRow?.[x] !== undefined) {
-          currentRow[x] = currentHeat - radiationAmount
-        }
+      for (let y = y0; y < y1; y++) {
+        this.radiateRange(y * width + x0, y * width + x1)
       }
     }
+
+    this.retireColdTiles()
   }
 
   /**
@@ -237,30 +334,28 @@ export class HeatSystem {
    * 熱グリッドの統計情報を取得
    */
   public getStats(): HeatGridStats {
+    const heat = this._heat
+    const cellCount = heat.length
+    const threshold = this._parameters.heatDamageThreshold
     let totalHeat = 0
     let maxHeat = 0
     let minHeat = Number.MAX_SAFE_INTEGER
     let hotCellCount = 0
 
-    for (let y = 0; y < this._height; y++) {
-      const row = this._currentHeat[y]
-      if (row === undefined) {
-        continue
+    for (let i = 0; i < cellCount; i++) {
+      const value = heat[i] ?? 0
+      totalHeat += value
+      if (value > maxHeat) {
+        maxHeat = value
       }
-
-      for (let x = 0; x < this._width; x++) {
-        const heat = row[x] ?? 0
-        totalHeat += heat
-        maxHeat = Math.max(maxHeat, heat)
-        minHeat = Math.min(minHeat, heat)
-
-        if (heat > this._parameters.heatDamageThreshold) {
-          hotCellCount++
-        }
+      if (value < minHeat) {
+        minHeat = value
+      }
+      if (value > threshold) {
+        hotCellCount++
       }
     }
 
-    const cellCount = this._width * this._height
     const averageHeat = cellCount > 0 ? totalHeat / cellCount : 0
 
     return {
@@ -276,83 +371,391 @@ export class HeatSystem {
    * 熱グリッドをリセット
    */
   public reset(): void {
+    this._heat.fill(0)
+    this._flow.fill(0)
+    this._tileState.fill(TILE_COLD)
+    this._activeTileCount = 0
+  }
+
+  /**
+   * デバッグ用：熱マップを文字列で表現
+   */
+  public toDebugString(): string {
+    const chars = [" ", ".", ":", "-", "=", "+", "*", "#", "@", "█"]
+    const maxChar = chars.length - 1
+
+    let result = ""
     for (let y = 0; y < this._height; y++) {
+      const rowStart = y * this._width
       for (let x = 0; x < this._width; x++) {
-        const currentRow = this._currentHeat[y]
-        const nextRow = this._nextHeat[y]
-        if (currentRow !== undefined) {
-          currentRow[x] = 0
-        }
-        if (nextRow !== undefined) {
-          nextRow[x] = 0
-        }
+        const heat = this._heat[rowStart + x] ?? 0
+        const index = Math.min(Math.floor(heat / 50), maxChar)
+        result += chars[index] ?? " "
       }
+      result += "\n"
     }
+
+    return result
+  }
+
+  /** アクティブなタイルの割合から、グリッド全体をまとめて処理するか判定する */
+  private shouldProcessWholeGrid(): boolean {
+    return this._activeTileCount >= this._tileState.length * this._denseTileRatio
   }
 
   /**
-   * 2つのセル間の熱交換を計算
+   * 全てのタイルをアクティブにする
+   * グリッド全体を処理した後、基準熱量以上のセルを含まないタイルは低温に戻す
    */
-  private calculateHeatExchange(x1: number, y1: number, x2: number, y2: number): void {
-    const heat1 = this._currentHeat[y1]?.[x1] ?? 0
-    const heat2 = this._currentHeat[y2]?.[x2] ?? 0
+  private activateAllTiles(): void {
+    for (let tile = 0; tile < this._tileState.length; tile++) {
+      if (this._tileState[tile] !== TILE_ACTIVE) {
+        this._tileState[tile] = TILE_ACTIVE
+        this._activeTiles[this._activeTileCount] = tile
+        this._activeTileCount++
+      }
+    }
+  }
 
-    // 基準熱量
-    const baseHeat1 = Math.floor(heat1 / this._parameters.heatDiffusionBase)
-    const baseHeat2 = Math.floor(heat2 / this._parameters.heatDiffusionBase)
+  /**
+   * グリッド全体のペアの熱流を累積する
+   * トーラス境界をまたぐペアは内側のペアと分けて処理し、内側のループから剰余演算と分岐を除いている
+   */
+  private accumulateGridFlow(): void {
+    const { heatDiffusionBase, heatFlowRate, heatFlowLimitRatio } = this._parameters
+    const width = this._width
+    const height = this._height
+    const heat = this._heat
+    const flow = this._flow
+
+    // 東方向のペア
+    for (let y = 0; y < height; y++) {
+      const rowStart = y * width
+      const rowEnd = rowStart + width - 1
+
+      for (let i = rowStart; i < rowEnd; i++) {
+        const east = calculateHeatFlow(
+          heat[i] ?? 0,
+          heat[i + 1] ?? 0,
+          heatDiffusionBase,
+          heatFlowRate,
+          heatFlowLimitRatio
+        )
+        flow[i] = (flow[i] ?? 0) + east
+        flow[i + 1] = (flow[i + 1] ?? 0) - east
+      }
+
+      // 行末と行頭（トーラス境界）
+      const wrap = calculateHeatFlow(
+        heat[rowEnd] ?? 0,
+        heat[rowStart] ?? 0,
+        heatDiffusionBase,
+        heatFlowRate,
+        heatFlowLimitRatio
+      )
+      flow[rowEnd] = (flow[rowEnd] ?? 0) + wrap
+      flow[rowStart] = (flow[rowStart] ?? 0) - wrap
+    }
 
-    // 熱量差（セル2からセル1への方向を正とする）
-    const diff = baseHeat2 - baseHeat1
+    // 南方向のペア（最終行以外は連続した範囲として処理）
+    const lastRowStart = (height - 1) * width
+    for (let i = 0; i < lastRowStart; i++) {
+      const south = i + width
+      const southFlow = calculateHeatFlow(
+        heat[i] ?? 0,
+        heat[south] ?? 0,
+        heatDiffusionBase,
+        heatFlowRate,
+        heatFlowLimitRatio
+      )
+      flow[i] = (flow[i] ?? 0) + southFlow
+      flow[south] = (flow[south] ?? 0) - southFlow
+    }
 
-    // 熱流量
-    let flow = Math.floor(diff / this._parameters.heatFlowRate)
+    // 最終行と先頭行（トーラス境界）
+    for (let x = 0; x < width; x++) {
+      const i = lastRowStart + x
+      const wrap = calculateHeatFlow(
+        heat[i] ?? 0,
+        heat[x] ?? 0,
+        heatDiffusionBase,
+        heatFlowRate,
+        heatFlowLimitRatio
+      )
+      flow[i] = (flow[i] ?? 0) + wrap
+      flow[x] = (flow[x] ?? 0) - wrap
+    }
+  }
 
-    // 流量制限
-    const maxFlow = Math.floor(Math.abs(diff) / this._parameters.heatFlowLimitRatio) - 1
-    if (maxFlow > 0 && Math.abs(flow) > maxFlow) {
-      flow = Math.sign(flow) * maxFlow
+  /** グリッド全体に累積した熱流を反映する（全タイルがアクティブな状態で呼ぶ） */
+  private applyGridFlow(): void {
+    const heat = this._heat
+    const flow = this._flow
+    for (let i = 0; i < heat.length; i++) {
+      heat[i] = (heat[i] ?? 0) + (flow[i] ?? 0)
     }
+    flow.fill(0)
+  }
+
+  /**
+   * タイルに関わるペアの熱流を累積する
+   * タイル内の各セルの東・南のペアと、低温の隣接タイルから西端・北端に接するペア
+   */
+  private accumulateTileFlow(tile: number): void {
+    const { heatDiffusionBase, heatFlowRate, heatFlowLimitRatio } = this._parameters
+    const width = this._width
+    const height = this._height
+    const heat = this._heat
+    const flow = this._flow
+    const tileX = tile % this._tileCols
+    const tileY = Math.floor(tile / this._tileCols)
+    const x0 = tileX * HEAT_TILE_SIZE
+    const y0 = tileY * HEAT_TILE_SIZE
+    const x1 = Math.min(x0 + HEAT_TILE_SIZE, width)
+    const y1 = Math.min(y0 + HEAT_TILE_SIZE, height)
+
+    // 東端が世界の右端の場合、東のペアは行頭に回り込む
+    const eastEnd = x1 === width ? x1 - 1 : x1
+
+    for (let y = y0; y < y1; y++) {
+      const rowStart = y * width
+      const southOffset = (y + 1 === height ? 0 : y + 1) * width - rowStart
+      const rowEnd = rowStart + eastEnd
+
+      for (let i = rowStart + x0; i < rowEnd; i++) {
+        const current = heat[i] ?? 0
+        const east = calculateHeatFlow(
+          current,
+          heat[i + 1] ?? 0,
+          heatDiffusionBase,
+          heatFlowRate,
+          heatFlowLimitRatio
+        )
+        const south = i + southOffset
+        const southFlow = calculateHeatFlow(
+          current,
+          heat[south] ?? 0,
+          heatDiffusionBase,
+          heatFlowRate,
+          heatFlowLimitRatio
+        )
+        flow[i] = (flow[i] ?? 0) + east + southFlow
+        flow[i + 1] = (flow[i + 1] ?? 0) - east
+        flow[south] = (flow[south] ?? 0) - southFlow
+      }
 
-    // 流出元のセルが十分な熱を持っているか確認
-    if (flow > 0 && flow > heat2) {
-      flow = heat2 // セル2から流出できる最大量に制限
-    } else if (flow < 0 && Math.abs(flow) > heat1) {
-      flow = -heat1 // セル1から流出できる最大量に制限
+      if (eastEnd !== x1) {
+        // 行末と行頭（トーラス境界）
+        this.exchangeHeat(rowEnd, rowStart)
+        this.exchangeHeat(rowEnd, rowEnd + southOffset)
+      }
     }
 
-    // 熱を移動（対称的に適用）
-    const row1 = this._nextHeat[y1]
-    const row2 = this._nextHeat[y2]
-    if (row1?.[x1] !== undefined) {
-      row1[x1] += flow
+    // 西隣のタイルが低温の場合、西隣の列から西端の列へのペア
+    const westX = x0 === 0 ? width - 1 : x0 - 1
+    if (!this.isTileActiveAt(westX, y0)) {
+      for (let y = y0; y < y1; y++) {
+        this.exchangeHeat(y * width + westX, y * width + x0)
+      }
     }
-    if (row2?.[x2] !== undefined) {
-      row2[x2] -= flow
+
+    // 北隣のタイルが低温の場合、北隣の行から北端の行へのペア
+    const northY = y0 === 0 ? height - 1 : y0 - 1
+    if (!this.isTileActiveAt(x0, northY)) {
+      const northStart = northY * width
+      const rowStart = y0 * width
+      for (let x = x0; x < x1; x++) {
+        this.exchangeHeat(northStart + x, rowStart + x)
+      }
     }
   }
 
   /**
-   * デバッグ用：熱マップを文字列で表現
+   * タイルと隣接する境界のセルに累積した熱流を反映する
+   * 境界のセルが基準熱量以上になった場合はそのタイルをアクティブにする
    */
-  public toDebugString(): string {
-    const chars = [" ", ".", ":", "-", "=", "+", "*", "#", "@", "█"]
-    const maxChar = chars.length - 1
+  private applyTileFlow(tile: number): void {
+    const width = this._width
+    const height = this._height
+    const heat = this._heat
+    const flow = this._flow
+    const x0 = (tile % this._tileCols) * HEAT_TILE_SIZE
+    const y0 = Math.floor(tile / this._tileCols) * HEAT_TILE_SIZE
+    const x1 = Math.min(x0 + HEAT_TILE_SIZE, width)
+    const y1 = Math.min(y0 + HEAT_TILE_SIZE, height)
+
+    // タイル内のセル（タイルはアクティブなため状態の更新は不要）
+    for (let y = y0; y < y1; y++) {
+      const rowEnd = y * width + x1
+      for (let i = y * width + x0; i < rowEnd; i++) {
+        heat[i] = (heat[i] ?? 0) + (flow[i] ?? 0)
+        flow[i] = 0
+      }
+    }
 
-    let result = ""
-    for (let y = 0; y < this._height; y++) {
-      const row = this._currentHeat[y]
-      if (row === undefined) {
+    // 東西の境界の列
+    const westX = x0 === 0 ? width - 1 : x0 - 1
+    const eastX = x1 === width ? 0 : x1
+    for (let y = y0; y < y1; y++) {
+      this.applyCellFlow(y * width + westX)
+      this.applyCellFlow(y * width + eastX)
+    }
+
+    // 南北の境界の行
+    const northStart = (y0 === 0 ? height - 1 : y0 - 1) * width
+    const southStart = (y1 === height ? 0 : y1) * width
+    for (let x = x0; x < x1; x++) {
+      this.applyCellFlow(northStart + x)
+      this.applyCellFlow(southStart + x)
+    }
+  }
+
+  /** タイル外の境界のセルに累積した熱流を反映する */
+  private applyCellFlow(index: number): void {
+    const flow = this._flow[index] ?? 0
+    if (flow === 0) {
+      return
+    }
+
+    const heat = (this._heat[index] ?? 0) + flow
+    this._heat[index] = heat
+    this._flow[index] = 0
+    if (heat >= this._parameters.heatDiffusionBase) {
+      this.activateTileOf(index)
+    }
+  }
+
+  /** タイルの境界をまたぐ2セル間の熱流を累積する */
+  private exchangeHeat(index1: number, index2: number): void {
+    const { heatDiffusionBase, heatFlowRate, heatFlowLimitRatio } = this._parameters
+    const flow = calculateHeatFlow(
+      this._heat[index1] ?? 0,
+      this._heat[index2] ?? 0,
+      heatDiffusionBase,
+      heatFlowRate,
+      heatFlowLimitRatio
+    )
+    if (flow !== 0) {
+      this._flow[index1] = (this._flow[index1] ?? 0) + flow
+      this._flow[index2] = (this._flow[index2] ?? 0) - flow
+    }
+  }
+
+  /** 格納位置の範囲[start, end)のセルの放熱 */
+  private radiateRange(start: number, end: number): void {
+    const { radiationEnvRatio, heatDiffusionBase, heatFlowRate, heatFlowLimitRatio } =
+      this._parameters
+    const heat = this._heat
+
+    for (let i = start; i < end; i++) {
+      const currentHeat = heat[i] ?? 0
+      if (currentHeat === 0) {
         continue
       }
 
-      for (let x = 0; x < this._width; x++) {
-        const heat = row[x] ?? 0
-        const index = Math.min(Math.floor(heat / 50), maxChar)
-        result += chars[index] ?? " "
+      // 仮想的な環境温度
+      const environmentHeat = Math.floor(currentHeat * radiationEnvRatio)
+
+      // 環境との熱量差による放熱
+      const baseHeat = Math.floor(currentHeat / heatDiffusionBase)
+      const envBaseHeat = Math.floor(environmentHeat / heatDiffusionBase)
+      const heatDifference = baseHeat - envBaseHeat
+
+      if (heatDifference <= 0) {
+        continue
       }
-      result += "\n"
+
+      // 放熱量
+      let radiationAmount = Math.floor(heatDifference / heatFlowRate)
+
+      // 放熱量の制限
+      const maxRadiation = Math.floor(heatDifference / heatFlowLimitRatio) - 1
+      if (maxRadiation > 0 && radiationAmount > maxRadiation) {
+        radiationAmount = maxRadiation
+      }
+
+      // 負の熱量にならないように制限
+      if (radiationAmount > currentHeat) {
+        radiationAmount = currentHeat
+      }
+
+      heat[i] = currentHeat - radiationAmount
     }
+  }
 
-    return result
+  /**
+   * 基準熱量以上のセルを含まないタイルを低温に戻す
+   * 低温のタイルでは熱流も放熱も発生しない
+   */
+  private retireColdTiles(): void {
+    const threshold = this._parameters.heatDiffusionBase
+    const width = this._width
+    const heat = this._heat
+    const next = this._nextActiveTiles
+    let nextCount = 0
+
+    for (let k = 0; k < this._activeTileCount; k++) {
+      const tile = this._activeTiles[k] ?? 0
+      const x0 = (tile % this._tileCols) * HEAT_TILE_SIZE
+      const y0 = Math.floor(tile / this._tileCols) * HEAT_TILE_SIZE
+      const x1 = Math.min(x0 + HEAT_TILE_SIZE, width)
+      const y1 = Math.min(y0 + HEAT_TILE_SIZE, this._height)
+
+      let hot = false
+      for (let y = y0; y < y1 && !hot; y++) {
+        const rowEnd = y * width + x1
+        for (let i = y * width + x0; i < rowEnd; i++) {
+          if ((heat[i] ?? 0) >= threshold) {
+            hot = true
+            break
+          }
+        }
+      }
+
+      if (hot) {
+        next[nextCount] = tile
+        nextCount++
+      } else {
+        this._tileState[tile] = TILE_COLD
+      }
+    }
+
+    this._nextActiveTiles = this._activeTiles
+    this._activeTiles = next
+    this._activeTileCount = nextCount
+  }
+
+  private activateTileOf(index: number): void {
+    const x = index % this._width
+    const tile = this.tileAt(x, (index - x) / this._width)
+    if (this._tileState[tile] === TILE_ACTIVE) {
+      return
+    }
+
+    this._tileState[tile] = TILE_ACTIVE
+    this._activeTiles[this._activeTileCount] = tile
+    this._activeTileCount++
+  }
+
+  private isTileActiveAt(x: number, y: number): boolean {
+    return this._tileState[this.tileAt(x, y)] === TILE_ACTIVE
+  }
+
+  /** セル座標が属するタイル番号 */
+  private tileAt(x: number, y: number): number {
+    return Math.floor(y / HEAT_TILE_SIZE) * this._tileCols + Math.floor(x / HEAT_TILE_SIZE)
+  }
+
+  /**
+   * トーラス境界でラップしたセルの格納位置を取得
+   * 整数でない座標はどのセルにも対応しないため-1を返す
+   */
+  private cellIndexOf(x: number, y: number): number {
+    if (!Number.isInteger(x) || !Number.isInteger(y)) {
+      return -1
+    }
+    const wrappedX = ((x % this._width) + this._width) % this._width
+    const wrappedY = ((y % this._height) + this._height) % this._height
+    return wrappedY * this._width + wrappedX
   }
 }
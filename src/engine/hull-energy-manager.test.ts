@@ -4,6 +4,7 @@
 
 import { HullEnergyManager, DEFAULT_HULL_ENERGY_PARAMETERS } from "./hull-energy-manager"
 import type { HullEnergyParameters } from "./hull-energy-manager"
+import { WorldStateManager } from "./world-state"
 import type { Hull, ObjectId, GameObject } from "@/types/game"
 import { Vec2 as Vec2Utils } from "@/utils/vec2"
 
@@ -319,4 +320,24 @@ describe("HullEnergyManager", () => {
       expect(manager.getDamageRate(destroyedHull)).toBe(1)
     })
   })
+
+  describe("ワールドに格納したHULL", () => {
+    test("更新後のHULLは物理演算の書き戻しの影響を受けない", () => {
+      const stateManager = new WorldStateManager(1000, 1000)
+      const hull = {
+        ...createTestHull("hull1", 1000, 300),
+        position: Vec2Utils.create(100, 100),
+        velocity: Vec2Utils.create(10, 0),
+      }
+      stateManager.addObject(hull)
+
+      const { updatedHull } = manager.addEnergy(hull, 100)
+      stateManager.updatePhysics(1.0)
+
+      expect(hull.position.x).toBeGreaterThan(100)
+      expect(updatedHull.position).toEqual({ x: 100, y: 100 })
+      expect(updatedHull.velocity).toEqual({ x: 10, y: 0 })
+      expect(updatedHull.storedEnergy).toBe(400)
+    })
+  })
 })
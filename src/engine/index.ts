@@ -4,18 +4,45 @@
 
 export { World } from "./world"
 export type { WorldConfig } from "./world"
+export {
+  TickInstrumentation,
+  TICK_PHASES,
+  TICK_PHASE_GROUPS,
+  TICK_COUNTERS,
+  DEFAULT_TICK_HISTORY_SIZE,
+} from "./tick-instrumentation"
+export type {
+  TickPhase,
+  TickPhaseGroup,
+  TickCounter,
+  TickMetric,
+  TickMetricSummary,
+  TickMetricHistogram,
+  TickInstrumentationSnapshot,
+} from "./tick-instrumentation"
 export { WorldStateManager, DEFAULT_PARAMETERS, SPATIAL_CELL_SIZE } from "./world-state"
+export { WorldCommandBuffer } from "./world-command-buffer"
 export {
   ObjectFactory,
   calculateEnergyRadius,
   calculateUnitRadius,
   calculateHullRadius,
 } from "./object-factory"
+export { EntityStore, ENTITY_KIND } from "./entity-store"
+export type { EntityHandle } from "./entity-store"
 export { SpatialHashGrid } from "./spatial-hash-grid"
+export { Broadphase } from "./broadphase"
+export { CircuitTopologyCache } from "./circuit-topology-cache"
 export { CollisionDetector } from "./collision-detector"
-export type { CollisionPair, CollisionResult } from "./collision-detector"
+export type {
+  CollisionPair,
+  CollisionResult,
+  CollisionBuffer,
+  NearbyObjectQuery,
+} from "./collision-detector"
 export {
   calculateSeparationForce,
+  calculateSeparationForceMagnitude,
   calculateTotalSeparationForce,
   DEFAULT_SEPARATION_PARAMETERS,
 } from "./separation-force"
@@ -26,14 +53,50 @@ export type {
   PhysicsParametersUpdate,
   PhysicsUpdateResult,
 } from "./physics-engine"
+export { HeatDepositBuffer } from "./heat-deposit-buffer"
+export {
+  RENDER_OBJECT_COLUMNS,
+  RENDER_OBJECT_TYPES,
+  RENDER_FLAG_ATTACHED,
+  RENDER_FLAG_ASSEMBLING,
+  RENDER_GRID_CELL_SIZE,
+  findRenderSnapshotHullAt,
+  queryRenderSnapshotRect,
+  renderSnapshotViews,
+  writeRenderSnapshot,
+} from "./render-snapshot"
+export type {
+  RenderObjectColumn,
+  RenderRect,
+  RenderSnapshot,
+  RenderSnapshotViews,
+} from "./render-snapshot"
+export { WorldWorkerClient, WorldWorkerHost } from "./world-worker"
+export type {
+  WorldWorkerConfig,
+  WorldWorkerHandle,
+  WorldWorkerRequest,
+  WorldWorkerResponse,
+  WorldWorkerSettings,
+} from "./world-worker"
 export { EnergySystem, DEFAULT_ENERGY_PARAMETERS } from "./energy-system"
 export type { EnergyCombineResult, EnergySystemParameters } from "./energy-system"
 export { EnergySourceManager, DEFAULT_SOURCE_PARAMETERS } from "./energy-source-manager"
 export type { EnergyGenerationResult, EnergySourceParameters } from "./energy-source-manager"
 export { EnergyCollector, DEFAULT_COLLECTOR_PARAMETERS } from "./energy-collector"
-export type { EnergyCollectionResult, EnergyCollectorParameters } from "./energy-collector"
+export type {
+  EnergyCollectionResult,
+  EnergyCollectorParameters,
+  EnergyParticleCollectionResult,
+} from "./energy-collector"
 export { EnergyDecaySystem, DEFAULT_DECAY_PARAMETERS } from "./energy-decay-system"
 export type { EnergyDecayResult, EnergyDecayParameters } from "./energy-decay-system"
+export { EnergyParticleSystem } from "./energy-particle-system"
+export type { EnergyParticleBatch } from "./energy-particle-system"
+export { EnergyCoalescingSystem, DEFAULT_COALESCING_PARAMETERS } from "./energy-coalescing-system"
+export type { EnergyCoalescingResult, EnergyCoalescingParameters } from "./energy-coalescing-system"
+export { EnergyDensityField, DEFAULT_DENSITY_FIELD_PARAMETERS } from "./energy-density-field"
+export type { EnergyDensityFieldParameters } from "./energy-density-field"
 export { HullEnergyManager } from "./hull-energy-manager"
 export {
   AssemblerConstructionSystem,
@@ -63,6 +126,10 @@ export { InstructionDecoder } from "./vm-decoder"
 export type { DecodedInstruction } from "./vm-decoded-instructions"
 export { InstructionExecutor } from "./vm-executor"
 export type { ExecutionResult } from "./vm-executor"
+export { CompiledInstructionExecutor } from "./vm-compiled-executor"
+export type { CompiledInstruction } from "./vm-compiled-executor"
+export { JitInstructionExecutor } from "./vm-jit-executor"
 export { ComputerVMSystem } from "./computer-vm-system"
+export type { VMExecutionMode } from "./computer-vm-system"
 export { UnitEnergyControlSystem, ENERGY_SUBCOMMANDS } from "./unit-energy-control"
 export type { EnergyOperationResult } from "./unit-energy-control"
@@ -4,6 +4,7 @@
 
 import { PhysicsEngine, DEFAULT_PHYSICS_PARAMETERS } from "./physics-engine"
 import type { PhysicsParameters } from "./physics-engine"
+import { EntityStore } from "./entity-store"
 import type { GameObject, ObjectId, DirectionalForceField } from "@/types/game"
 import { Vec2 as Vec2Utils } from "@/utils/vec2"
 
@@ -317,6 +318,48 @@ describe("PhysicsEngine", () => {
       expect(updated.position.x).toBeCloseTo(100 + 10 * friction * deltaTime, 5)
       expect(updated.position.y).toBeCloseTo(100 + 10 * friction * deltaTime, 5)
     })
+
+    test("完全に重なったオブジェクトはIDから決まる方向に離れる", () => {
+      const run = () => {
+        const objects = new Map<ObjectId, GameObject>()
+        const obj1 = createTestObject(1, 100, 100, 20)
+        const obj2 = createTestObject(2, 100, 100, 20)
+        objects.set(obj1.id, obj1)
+        objects.set(obj2.id, obj2)
+        new PhysicsEngine(cellSize, worldWidth, worldHeight).update(
+          objects,
+          new Map<ObjectId, DirectionalForceField>(),
+          1.0
+        )
+        return [objects.get(obj1.id)!.position, objects.get(obj2.id)!.position]
+      }
+
+      const [first1, first2] = run()
+      const [second1, second2] = run()
+
+      // 作用・反作用で逆向きに離れ、同じ状態からは同じ結果になる
+      expect(first1!.x - 100).toBeCloseTo(-(first2!.x - 100), 10)
+      expect(first1!.y - 100).toBeCloseTo(-(first2!.y - 100), 10)
+      expect(Math.hypot(first1!.x - first2!.x, first1!.y - first2!.y)).toBeGreaterThan(0)
+      expect(second1).toEqual(first1)
+      expect(second2).toEqual(first2)
+    })
+  })
+
+  describe("Mapで渡したオブジェクトの書き戻し", () => {
+    test("位置・速度は新しい値で置き換え、以前に複製したオブジェクトや他のストアの列は変更しない", () => {
+      const store = new EntityStore()
+      const obj = createTestObject(1, 100, 100, 10, 10, 0)
+      store.add(obj)
+      const copy = { ...obj }
+      const objects = new Map<ObjectId, GameObject>([[obj.id, obj]])
+
+      engine.update(objects, new Map<ObjectId, DirectionalForceField>(), 1.0)
+
+      expect(obj.position.x).toBeGreaterThan(100)
+      expect(copy.position).toEqual({ x: 100, y: 100 })
+      expect(store.positionX[store.indexOf(obj.id)]).toBe(100)
+    })
   })
 
   describe("衝突検出の委譲", () => {
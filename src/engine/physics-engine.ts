@@ -2,13 +2,25 @@
  * 物理演算エンジン - 衝突検出と物理シミュレーションの統合
  */
 
-import type { GameObject, ObjectId, Vec2, DirectionalForceField } from "@/types/game"
+import type {
+  GameObject,
+  ObjectCollection,
+  ObjectId,
+  Vec2,
+  DirectionalForceField,
+} from "@/types/game"
 import { Vec2 as Vec2Utils } from "@/utils/vec2"
-import { wrapPosition } from "@/utils/torus-math"
+import { wrapCoordinate } from "@/utils/torus-math"
 import { CollisionDetector } from "./collision-detector"
-import { calculateSeparationForce, DEFAULT_SEPARATION_PARAMETERS } from "./separation-force"
+import type { CollisionBuffer, NearbyObjectQuery } from "./collision-detector"
+import {
+  calculateSeparationForceMagnitude,
+  DEFAULT_SEPARATION_PARAMETERS,
+} from "./separation-force"
 import type { SeparationForceParameters } from "./separation-force"
 import { ForceFieldSystem } from "./force-field-system"
+import { EntityStore } from "./entity-store"
+import type { Broadphase } from "./broadphase"
 
 /** 物理演算のパラメータ */
 export type PhysicsParameters = {
@@ -52,8 +64,16 @@ export type PhysicsUpdateResult = {
   readonly elapsedTime: number
 }
 
-/** オブジェクトの加速度マップ */
-type AccelerationMap = Map<ObjectId, Vec2>
+/**
+ * 完全に重なったペアの反発方向を決める[0, 1)の値
+ * 乱数の代わりにIDから決定的に求め、同じ状態からは常に同じ結果になるようにする
+ */
+const overlapDirectionSeed = (id1: number, id2: number): number => {
+  let hash = Math.imul(id1 ^ 0x9e3779b9, 0x85ebca6b) ^ Math.imul(id2 ^ 0xc2b2ae35, 0x27d4eb2f)
+  hash = Math.imul(hash ^ (hash >>> 15), 0x2c1b3c6d)
+  hash = Math.imul(hash ^ (hash >>> 12), 0x297a2d39)
+  return ((hash ^ (hash >>> 15)) >>> 0) / 0x100000000
+}
 
 export class PhysicsEngine {
   private readonly _worldWidth: number
@@ -61,6 +81,12 @@ export class PhysicsEngine {
   private readonly _collisionDetector: CollisionDetector
   private readonly _parameters: PhysicsParameters
   private _forceFieldSystem: ForceFieldSystem
+  /** Mapで渡されたオブジェクトの列 */
+  private readonly _scratchStore = new EntityStore()
+  private _accelerationX = new Float64Array(0)
+  private _accelerationY = new Float64Array(0)
+  /** 種別を除外する場合の対象オブジェクト（1: 対象, 0: 除外） */
+  private _active = new Uint8Array(0)
 
   public constructor(
     cellSize: number,
@@ -80,6 +106,7 @@ export class PhysicsEngine {
 
   /**
    * 物理演算の更新
+   * オブジェクトは新しいオブジェクトに置き換えず、その場で更新する
    * @param objects ゲームオブジェクトのマップ
    * @param forceFields 力場のマップ
    * @param deltaTime 時間ステップ
@@ -87,164 +114,250 @@ export class PhysicsEngine {
    */
   public update(
     objects: Map<ObjectId, GameObject>,
-    forceFields: Map<ObjectId, DirectionalForceField>,
+    forceFields: ReadonlyMap<ObjectId, DirectionalForceField>,
     deltaTime: number
+  ): PhysicsUpdateResult {
+    // 一時ストアに値を複製して列ベースの演算を行い、結果をオブジェクトに書き戻す
+    const store = this._scratchStore
+    for (const object of objects.values()) {
+      store.add(object)
+    }
+
+    const result = this.updateEntities(store, forceFields, deltaTime)
+    store.clear()
+
+    return result
+  }
+
+  /**
+   * エンティティストアに対する物理演算の更新
+   * 位置・速度の列を直接更新し、更新したオブジェクトへ書き戻す
+   * @param store エンティティストア
+   * @param forceFields 力場のマップ
+   * @param deltaTime 時間ステップ
+   * @param broadphase ストアと同期済みのブロードフェーズ（省略時は毎回グリッドを再構築する）
+   * @param excludedKind 指定した種別（ENTITY_KIND）のオブジェクトは力・衝突・運動の対象から除外する
+   * @returns 物理演算の結果
+   */
+  public updateEntities(
+    store: EntityStore,
+    forceFields: ReadonlyMap<ObjectId, DirectionalForceField>,
+    deltaTime: number,
+    broadphase?: Broadphase,
+    excludedKind?: number
   ): PhysicsUpdateResult {
     const startTime = performance.now()
+    const active = excludedKind == null ? undefined : this.markActive(store, excludedKind)
 
     // 1. 加速度の初期化
-    const accelerations = this.initializeAccelerations(objects)
+    this.resetAccelerations(store.count)
 
     // 2. 外部力の適用（力場システム）
-    this.applyForceFieldForces(objects, forceFields, accelerations)
+    this.applyForceFieldForces(store, forceFields, active?.mask)
 
     // 3. 衝突検出
-    const collisionResult = this._collisionDetector.detectCollisions(objects)
+    const collisions = this._collisionDetector.detectCollisionIndices(
+      store,
+      broadphase,
+      active?.mask
+    )
+    const collisionCount = collisions.count
 
     // 4. 反発力の計算と適用
-    this.applySeparationForces(objects, collisionResult.pairs, accelerations)
+    this.applySeparationForces(store, collisions)
 
     // 5. 運動の更新
-    this.updateMotion(objects, accelerations, deltaTime)
+    this.updateMotion(store, deltaTime, active?.mask)
+    for (let i = 0; i < store.count; i++) {
+      if (active == null || active.mask[i] === 1) {
+        store.writeBackMotion(i)
+      }
+    }
+
+    // 6. 所属セルが変わったオブジェクトのみブロードフェーズを更新
+    broadphase?.refresh()
 
     const elapsedTime = performance.now() - startTime
 
     return {
-      collisionCount: collisionResult.actualCollisions,
-      objectCount: objects.size,
+      collisionCount,
+      objectCount: active?.count ?? store.count,
       elapsedTime,
     }
   }
 
   /**
-   * 加速度マップの初期化
+   * 除外する種別以外のオブジェクトを対象として記録する
+   * @returns 対象の記録と対象オブジェクト数
    */
-  private initializeAccelerations(objects: Map<ObjectId, GameObject>): AccelerationMap {
-    const accelerations = new Map<ObjectId, Vec2>()
+  private markActive(
+    store: EntityStore,
+    excludedKind: number
+  ): { mask: Uint8Array; count: number } {
+    if (this._active.length < store.count) {
+      this._active = new Uint8Array(Math.max(store.count, this._active.length * 2))
+    }
+    const mask = this._active
+    const kind = store.kind
+    let count = 0
+    for (let i = 0; i < store.count; i++) {
+      const isActive = kind[i] !== excludedKind
+      mask[i] = isActive ? 1 : 0
+      if (isActive) {
+        count++
+      }
+    }
+    return { mask, count }
+  }
 
-    for (const object of objects.values()) {
-      accelerations.set(object.id, Vec2Utils.create(0, 0))
+  /**
+   * 加速度バッファの初期化
+   */
+  private resetAccelerations(count: number): void {
+    if (this._accelerationX.length < count) {
+      const capacity = Math.max(count, this._accelerationX.length * 2)
+      this._accelerationX = new Float64Array(capacity)
+      this._accelerationY = new Float64Array(capacity)
+      return
     }
 
-    return accelerations
+    this._accelerationX.fill(0, 0, count)
+    this._accelerationY.fill(0, 0, count)
   }
 
   /**
    * 反発力の計算と適用
    */
-  private applySeparationForces(
-    _objects: Map<ObjectId, GameObject>,
-    collisionPairs: { readonly object1: GameObject; readonly object2: GameObject }[],
-    accelerations: AccelerationMap
-  ): void {
-    for (const pair of collisionPairs) {
-      // 反発力を計算
-      const force = calculateSeparationForce(
-        pair.object1,
-        pair.object2,
-        this._worldWidth,
-        this._worldHeight,
+  private applySeparationForces(store: EntityStore, collisions: CollisionBuffer): void {
+    for (let k = 0; k < collisions.count; k++) {
+      const index1 = collisions.index1[k] ?? -1
+      const index2 = collisions.index2[k] ?? -1
+
+      const distance = collisions.distance[k] ?? 0
+      const forceMagnitude = calculateSeparationForceMagnitude(
+        collisions.overlap[k] ?? 0,
         this._parameters.separationForce
       )
 
+      // 反発方向の計算（オブジェクト1から見た場合）
+      let directionX: number
+      let directionY: number
+
+      if (distance > 0.001) {
+        // 通常の場合：オブジェクト2からオブジェクト1への方向（反発）
+        directionX = -(collisions.deltaX[k] ?? 0) / distance
+        directionY = -(collisions.deltaY[k] ?? 0) / distance
+      } else {
+        // 完全に重なっている場合：IDから決まる方向
+        const seed = overlapDirectionSeed(store.id[index1] ?? 0, store.id[index2] ?? 0)
+        const angle = seed * 2 * Math.PI
+        directionX = Math.cos(angle)
+        directionY = Math.sin(angle)
+      }
+
+      const forceX = forceMagnitude * directionX
+      const forceY = forceMagnitude * directionY
+
       // 作用・反作用の法則
-      this.applyForce(pair.object1, force, accelerations)
-      this.applyForce(pair.object2, Vec2Utils.create(-force.x, -force.y), accelerations)
+      this.applyForce(store, index1, forceX, forceY)
+      this.applyForce(store, index2, -forceX, -forceY)
     }
   }
 
   /**
-   * オブジェクトに力を適用
+   * 格納位置のオブジェクトに力を適用
    */
-  private applyForce(object: GameObject, force: Vec2, accelerations: AccelerationMap): void {
-    // F = ma より a = F/m
-    const mass = Math.max(object.mass, this._parameters.minMass)
-    const accelerationDelta = Vec2Utils.create(force.x / mass, force.y / mass)
-
-    const currentAcceleration = accelerations.get(object.id)
-    if (currentAcceleration === undefined) {
+  private applyForce(store: EntityStore, index: number, forceX: number, forceY: number): void {
+    if (index < 0) {
       return
     }
 
+    // F = ma より a = F/m
+    const mass = Math.max(store.mass[index] ?? 0, this._parameters.minMass)
+
     // 加速度を蓄積
-    accelerations.set(
-      object.id,
-      Vec2Utils.create(
-        currentAcceleration.x + accelerationDelta.x,
-        currentAcceleration.y + accelerationDelta.y
-      )
-    )
+    this._accelerationX[index] = (this._accelerationX[index] ?? 0) + forceX / mass
+    this._accelerationY[index] = (this._accelerationY[index] ?? 0) + forceY / mass
   }
 
   /**
    * 力場からの力を適用
+   * @param active 指定した場合は値が1のオブジェクトのみ対象とする
    */
   private applyForceFieldForces(
-    objects: Map<ObjectId, GameObject>,
-    forceFields: Map<ObjectId, DirectionalForceField>,
-    accelerations: AccelerationMap
+    store: EntityStore,
+    forceFields: ReadonlyMap<ObjectId, DirectionalForceField>,
+    active?: ArrayLike<number>
   ): void {
-    for (const object of objects.values()) {
-      const totalForce = this._forceFieldSystem.calculateTotalForce(object, forceFields)
-      if (totalForce.x !== 0 || totalForce.y !== 0) {
-        this.applyForce(object, totalForce, accelerations)
+    if (forceFields.size === 0) {
+      return
+    }
+
+    const positionX = store.positionX
+    const positionY = store.positionY
+
+    for (let i = 0; i < store.count; i++) {
+      if (active != null && active[i] !== 1) {
+        continue
+      }
+      const position = Vec2Utils.create(positionX[i] ?? 0, positionY[i] ?? 0)
+      let totalForceX = 0
+      let totalForceY = 0
+
+      for (const field of forceFields.values()) {
+        const force = this._forceFieldSystem.calculateForceFromField(position, field)
+        if (force != null) {
+          totalForceX += force.x
+          totalForceY += force.y
+        }
+      }
+
+      if (totalForceX !== 0 || totalForceY !== 0) {
+        this.applyForce(store, i, totalForceX, totalForceY)
       }
     }
   }
 
   /**
    * 運動の更新
+   * @param active 指定した場合は値が1のオブジェクトのみ対象とする
    */
-  private updateMotion(
-    objects: Map<ObjectId, GameObject>,
-    accelerations: AccelerationMap,
-    deltaTime: number
-  ): void {
-    for (const object of objects.values()) {
-      const acceleration = accelerations.get(object.id)
-      if (acceleration === undefined) {
+  private updateMotion(store: EntityStore, deltaTime: number, active?: ArrayLike<number>): void {
+    const positionX = store.positionX
+    const positionY = store.positionY
+    const velocityX = store.velocityX
+    const velocityY = store.velocityY
+    const accelerationX = this._accelerationX
+    const accelerationY = this._accelerationY
+
+    // 摩擦の適用（力場システムから取得）
+    const friction = this._forceFieldSystem.frictionCoefficient
+    const velocityLimit = this._parameters.emergencyVelocityLimit
+    const worldWidth = this._worldWidth
+    const worldHeight = this._worldHeight
+
+    for (let i = 0; i < store.count; i++) {
+      if (active != null && active[i] !== 1) {
         continue
       }
 
-      // 速度の更新（v = v0 + at）
-      const newVelocityX = object.velocity.x + acceleration.x * deltaTime
-      const newVelocityY = object.velocity.y + acceleration.y * deltaTime
-
-      // 摩擦の適用（力場システムから取得）
-      const friction = this._forceFieldSystem.frictionCoefficient
-      const velocityX = newVelocityX * friction
-      const velocityY = newVelocityY * friction
+      // 速度の更新（v = v0 + at）と摩擦の適用
+      let vx = ((velocityX[i] ?? 0) + (accelerationX[i] ?? 0) * deltaTime) * friction
+      let vy = ((velocityY[i] ?? 0) + (accelerationY[i] ?? 0) * deltaTime) * friction
 
       // 数値的安定性のための緊急速度制限
-      const speed = Math.sqrt(velocityX * velocityX + velocityY * velocityY)
-      let finalVelocity: Vec2
-
-      if (speed > this._parameters.emergencyVelocityLimit) {
-        const scale = this._parameters.emergencyVelocityLimit / speed
-        finalVelocity = Vec2Utils.create(velocityX * scale, velocityY * scale)
-      } else {
-        finalVelocity = Vec2Utils.create(velocityX, velocityY)
+      const speed = Math.sqrt(vx * vx + vy * vy)
+      if (speed > velocityLimit) {
+        const scale = velocityLimit / speed
+        vx = vx * scale
+        vy = vy * scale
       }
 
-      // 位置の更新（x = x0 + vt）
-      const newPositionX = object.position.x + finalVelocity.x * deltaTime
-      const newPositionY = object.position.y + finalVelocity.y * deltaTime
-
-      // トーラス境界でのラップアラウンド
-      const wrappedPosition = wrapPosition(
-        Vec2Utils.create(newPositionX, newPositionY),
-        this._worldWidth,
-        this._worldHeight
-      )
-
-      // オブジェクトの更新（イミュータブル）
-      const updatedObject: GameObject = {
-        ...object,
-        position: wrappedPosition,
-        velocity: finalVelocity,
-      }
-
-      objects.set(object.id, updatedObject)
+      velocityX[i] = vx
+      velocityY[i] = vy
+      // 位置の更新（x = x0 + vt）とトーラス境界でのラップアラウンド
+      positionX[i] = wrapCoordinate((positionX[i] ?? 0) + vx * deltaTime, worldWidth)
+      positionY[i] = wrapCoordinate((positionY[i] ?? 0) + vy * deltaTime, worldHeight)
     }
   }
 
@@ -252,17 +365,25 @@ export class PhysicsEngine {
    * 特定位置での衝突を検出
    * @param position 検査位置
    * @param radius 検査半径
-   * @param objects ゲームオブジェクトのマップ
+   * @param objects ゲームオブジェクトのコレクション
    * @param excludeId 除外するオブジェクトID（オプション）
+   * @param query objectsと同期済みの近傍検索（オプション）
    * @returns 衝突しているオブジェクトのリスト
    */
   public detectCollisionsAtPosition(
     position: Vec2,
     radius: number,
-    objects: Map<ObjectId, GameObject>,
-    excludeId?: ObjectId
+    objects: ObjectCollection,
+    excludeId?: ObjectId,
+    query?: NearbyObjectQuery
   ): GameObject[] {
-    return this._collisionDetector.detectCollisionsAtPosition(position, radius, objects, excludeId)
+    return this._collisionDetector.detectCollisionsAtPosition(
+      position,
+      radius,
+      objects,
+      excludeId,
+      query
+    )
   }
 
   /**
@@ -0,0 +1,416 @@
+/**
+ * 描画用スナップショット
+ *
+ * 描画に必要な世界の状態を1つのArrayBufferにまとめる。
+ * Workerで実行中の世界からメインスレッドへ、複製せずに転送（transfer）して受け渡すための形式。
+ * 数値データは [オブジェクトの列データ, HULLの接続ユニット, 熱グリッド, 格子ごとの開始位置,
+ * 格子順のオブジェクト位置] の順に置く。
+ * 格子は世界を一辺がおよそRENDER_GRID_CELL_SIZEの区画に分けたもので、可視範囲のオブジェクトの
+ * 検索（queryRenderSnapshotRect）と、縮小表示時の密度の表示に使う。
+ * 力場・エネルギーソースは数が少ないため、通常のオブジェクトとして持つ
+ */
+
+import type {
+  DirectionalForceField,
+  EnergySource,
+  GameObject,
+  ObjectId,
+  ObjectType,
+} from "@/types/game"
+import { hasParentHull, isAssembler, isHull, isUnit } from "@/utils/type-guards"
+import type { TickPhaseGroup } from "./tick-instrumentation"
+import type { World } from "./world"
+
+/**
+ * オブジェクトの列
+ * energyはエネルギーオブジェクトではenergy、ユニットではcurrentEnergy。
+ * attachStart・attachCountはHULLの接続ユニットのattachments内の範囲
+ */
+export const RENDER_OBJECT_COLUMNS = [
+  "id",
+  "type",
+  "x",
+  "y",
+  "radius",
+  "energy",
+  "buildEnergy",
+  "mass",
+  "flags",
+  "attachStart",
+  "attachCount",
+  "storedEnergy",
+  "capacity",
+] as const
+
+export type RenderObjectColumn = (typeof RENDER_OBJECT_COLUMNS)[number]
+
+/** type列の値 */
+export const RENDER_OBJECT_TYPES: readonly ObjectType[] = [
+  "ENERGY",
+  "HULL",
+  "ASSEMBLER",
+  "COMPUTER",
+]
+
+/** 格子の一辺のおおよその長さ（世界の幅・高さを割り切れるよう、格子ごとに調整する） */
+export const RENDER_GRID_CELL_SIZE = 64
+
+/** flags列のビット */
+export const RENDER_FLAG_ATTACHED = 1
+export const RENDER_FLAG_ASSEMBLING = 2
+
+export type RenderSnapshot = {
+  readonly tick: number
+  readonly width: number
+  readonly height: number
+  readonly objectCount: number
+  /** HULLの接続ユニットの総数 */
+  readonly attachmentCount: number
+  readonly heatWidth: number
+  readonly heatHeight: number
+  /** 格子の列数・行数（各格子の大きさは width / gridWidth × height / gridHeight） */
+  readonly gridWidth: number
+  readonly gridHeight: number
+  /** オブジェクトの半径の最大値（格子による検索の余白） */
+  readonly maxObjectRadius: number
+  readonly forceFields: readonly DirectionalForceField[]
+  readonly energySources: readonly EnergySource[]
+  /** 直近のtick処理時間（サブシステム別の平均、ミリ秒。計測が無効な場合はnull） */
+  readonly phaseTimes: Readonly<Record<TickPhaseGroup, number>> | null
+  /** 数値データ（先頭から使用し、末尾は未使用の場合がある） */
+  readonly buffer: ArrayBuffer
+}
+
+/** スナップショットの数値データの参照 */
+export type RenderSnapshotViews = {
+  readonly objects: Readonly<Record<RenderObjectColumn, Float64Array>>
+  /** 接続ユニットのオブジェクト位置（HULLのattachedUnitIdsの順） */
+  readonly attachments: Float64Array
+  readonly heat: Float64Array
+  /** 格子ごとのcellObjects内の開始位置（格子数+1。末尾は終端） */
+  readonly cellStart: Float64Array
+  /** 格子順に並べたオブジェクト位置 */
+  readonly cellObjects: Float64Array
+}
+
+/** 世界座標の矩形 */
+export type RenderRect = {
+  readonly left: number
+  readonly top: number
+  readonly right: number
+  readonly bottom: number
+}
+
+/** 世界の大きさに合わせた格子の列数・行数 */
+const gridSizeOf = (width: number, height: number): { gridWidth: number; gridHeight: number } => ({
+  gridWidth: Math.max(1, Math.ceil(width / RENDER_GRID_CELL_SIZE)),
+  gridHeight: Math.max(1, Math.ceil(height / RENDER_GRID_CELL_SIZE)),
+})
+
+/** 格子への振り分けに使う作業領域（スナップショットの作成ごとに確保しないよう使い回す） */
+let cellCursorScratch = new Int32Array(0)
+
+const requiredBytesOf = (
+  objectCount: number,
+  attachmentCount: number,
+  heatCellCount: number,
+  gridCellCount: number
+): number =>
+  ((RENDER_OBJECT_COLUMNS.length + 1) * objectCount +
+    attachmentCount +
+    heatCellCount +
+    gridCellCount +
+    1) *
+  Float64Array.BYTES_PER_ELEMENT
+
+const viewsOf = (
+  buffer: ArrayBuffer,
+  objectCount: number,
+  attachmentCount: number,
+  heatCellCount: number,
+  gridCellCount: number
+): RenderSnapshotViews => {
+  const objects = {} as Record<RenderObjectColumn, Float64Array>
+  RENDER_OBJECT_COLUMNS.forEach((name, column) => {
+    objects[name] = new Float64Array(buffer, column * objectCount * 8, objectCount)
+  })
+  const attachmentOffset = RENDER_OBJECT_COLUMNS.length * objectCount * 8
+  const heatOffset = attachmentOffset + attachmentCount * 8
+  const cellStartOffset = heatOffset + heatCellCount * 8
+  const cellObjectsOffset = cellStartOffset + (gridCellCount + 1) * 8
+  return {
+    objects,
+    attachments: new Float64Array(buffer, attachmentOffset, attachmentCount),
+    heat: new Float64Array(buffer, heatOffset, heatCellCount),
+    cellStart: new Float64Array(buffer, cellStartOffset, gridCellCount + 1),
+    cellObjects: new Float64Array(buffer, cellObjectsOffset, objectCount),
+  }
+}
+
+/** 座標の格子の列（行）番号 */
+const cellCoordinateOf = (position: number, cellLength: number, cellCount: number): number =>
+  Math.max(0, Math.min(cellCount - 1, Math.floor(position / cellLength)))
+
+/** オブジェクトを格子順に並べる（計数ソート） */
+const writeCellIndex = (
+  views: RenderSnapshotViews,
+  objectCount: number,
+  width: number,
+  height: number,
+  gridWidth: number,
+  gridHeight: number
+): void => {
+  const { objects, cellStart, cellObjects } = views
+  const cellWidth = width / gridWidth
+  const cellHeight = height / gridHeight
+  const cellCount = gridWidth * gridHeight
+  if (cellCursorScratch.length < cellCount) {
+    cellCursorScratch = new Int32Array(cellCount)
+  }
+  const cursor = cellCursorScratch
+  cursor.fill(0, 0, cellCount)
+
+  for (let index = 0; index < objectCount; index++) {
+    const cellX = cellCoordinateOf(objects.x[index] ?? 0, cellWidth, gridWidth)
+    const cellY = cellCoordinateOf(objects.y[index] ?? 0, cellHeight, gridHeight)
+    const cell = cellY * gridWidth + cellX
+    cursor[cell] = (cursor[cell] ?? 0) + 1
+  }
+  let offset = 0
+  for (let cell = 0; cell < cellCount; cell++) {
+    cellStart[cell] = offset
+    const count = cursor[cell] ?? 0
+    cursor[cell] = offset
+    offset += count
+  }
+  cellStart[cellCount] = offset
+
+  for (let index = 0; index < objectCount; index++) {
+    const cellX = cellCoordinateOf(objects.x[index] ?? 0, cellWidth, gridWidth)
+    const cellY = cellCoordinateOf(objects.y[index] ?? 0, cellHeight, gridHeight)
+    const cell = cellY * gridWidth + cellX
+    const position = cursor[cell] ?? 0
+    cellObjects[position] = index
+    cursor[cell] = position + 1
+  }
+}
+
+/**
+ * スナップショットの数値データの参照を作成する
+ * @param snapshot スナップショット
+ */
+export const renderSnapshotViews = (snapshot: RenderSnapshot): RenderSnapshotViews =>
+  viewsOf(
+    snapshot.buffer,
+    snapshot.objectCount,
+    snapshot.attachmentCount,
+    snapshot.heatWidth * snapshot.heatHeight,
+    snapshot.gridWidth * snapshot.gridHeight
+  )
+
+/**
+ * 世界の現在の状態からスナップショットを作成する
+ * @param world 世界
+ * @param buffer 再利用する領域（足りない場合、nullの場合は新たに確保する）
+ */
+export const writeRenderSnapshot = (world: World, buffer: ArrayBuffer | null): RenderSnapshot => {
+  const state = world.state
+  const heatSystem = world.heatSystem
+  // オブジェクトは格納順に並べる。エネルギー粒子は粒子の列から一括で書き込む
+  const objects: GameObject[] = Array.from(state.objects.values())
+  const particles = world.gatherEnergyParticles()
+  const snapshotIndex = new Map<ObjectId, number>()
+
+  let attachmentCount = 0
+  objects.forEach((obj, index) => {
+    if (isUnit(obj)) {
+      snapshotIndex.set(obj.id, index)
+    }
+    if (isHull(obj)) {
+      attachmentCount += obj.attachedUnitIds.length
+    }
+  })
+
+  const heatValues = heatSystem.heatValues
+  const { gridWidth, gridHeight } = gridSizeOf(state.width, state.height)
+  const gridCellCount = gridWidth * gridHeight
+  const requiredBytes = requiredBytesOf(
+    objects.length,
+    attachmentCount,
+    heatValues.length,
+    gridCellCount
+  )
+  const target =
+    buffer != null && buffer.byteLength >= requiredBytes
+      ? buffer
+      : new ArrayBuffer(Math.ceil(requiredBytes * 1.5))
+  const views = viewsOf(target, objects.length, attachmentCount, heatValues.length, gridCellCount)
+  const columns = views.objects
+
+  let attachmentIndex = 0
+  let maxObjectRadius = 0
+  objects.forEach((obj, index) => {
+    if (obj.type === "ENERGY") {
+      return
+    }
+    maxObjectRadius = Math.max(maxObjectRadius, obj.radius)
+    columns.id[index] = obj.id
+    columns.type[index] = RENDER_OBJECT_TYPES.indexOf(obj.type)
+    columns.x[index] = obj.position.x
+    columns.y[index] = obj.position.y
+    columns.radius[index] = obj.radius
+    columns.energy[index] = isUnit(obj) ? obj.currentEnergy : obj.energy
+    columns.buildEnergy[index] = isUnit(obj) ? obj.buildEnergy : 0
+    columns.mass[index] = obj.mass
+
+    let flags = 0
+    if (isUnit(obj) && hasParentHull(obj)) {
+      flags |= RENDER_FLAG_ATTACHED
+    }
+    if (isAssembler(obj) && obj.isAssembling) {
+      flags |= RENDER_FLAG_ASSEMBLING
+    }
+    columns.flags[index] = flags
+
+    columns.attachStart[index] = attachmentIndex
+    if (isHull(obj)) {
+      obj.attachedUnitIds.forEach(unitId => {
+        views.attachments[attachmentIndex] = snapshotIndex.get(unitId) ?? -1
+        attachmentIndex++
+      })
+      columns.storedEnergy[index] = obj.storedEnergy
+      columns.capacity[index] = obj.capacity
+    } else {
+      columns.storedEnergy[index] = 0
+      columns.capacity[index] = 0
+    }
+    columns.attachCount[index] = attachmentIndex - (columns.attachStart[index] ?? 0)
+  })
+  const energyType = RENDER_OBJECT_TYPES.indexOf("ENERGY")
+  for (let k = 0; k < particles.count; k++) {
+    const index = particles.index[k] ?? 0
+    const radius = particles.radius[k] ?? 0
+    maxObjectRadius = Math.max(maxObjectRadius, radius)
+    columns.id[index] = particles.id[k] ?? 0
+    columns.type[index] = energyType
+    columns.x[index] = particles.positionX[k] ?? 0
+    columns.y[index] = particles.positionY[k] ?? 0
+    columns.radius[index] = radius
+    columns.energy[index] = particles.energy[k] ?? 0
+    columns.buildEnergy[index] = 0
+    columns.mass[index] = particles.mass[k] ?? 0
+    columns.flags[index] = 0
+    columns.attachStart[index] = 0
+    columns.attachCount[index] = 0
+    columns.storedEnergy[index] = 0
+    columns.capacity[index] = 0
+  }
+  views.heat.set(heatValues)
+  writeCellIndex(views, objects.length, state.width, state.height, gridWidth, gridHeight)
+
+  const instrumentation = world.instrumentation
+  return {
+    tick: state.tick,
+    width: state.width,
+    height: state.height,
+    objectCount: objects.length,
+    attachmentCount,
+    heatWidth: heatSystem.width,
+    heatHeight: heatSystem.height,
+    gridWidth,
+    gridHeight,
+    maxObjectRadius,
+    forceFields: Array.from(state.forceFields.values()),
+    energySources: Array.from(state.energySources.values()),
+    phaseTimes:
+      instrumentation == null
+        ? null
+        : {
+            physics: instrumentation.groupMean("physics"),
+            energy: instrumentation.groupMean("energy"),
+            vm: instrumentation.groupMean("vm"),
+            heat: instrumentation.groupMean("heat"),
+          },
+    buffer: target,
+  }
+}
+
+/**
+ * 矩形と重なりうるオブジェクトの位置を集める
+ * 格子単位で判定するため、矩形の近くにある矩形外のオブジェクトを含む場合がある。
+ * 世界はトーラスのため、世界の外にはみ出した部分は反対側の端として扱う
+ * @param snapshot スナップショット
+ * @param views スナップショットの数値データ
+ * @param rect 世界座標の矩形
+ * @param out 結果を書き込む配列（先頭から上書きする）
+ * @returns out
+ */
+export const queryRenderSnapshotRect = (
+  snapshot: RenderSnapshot,
+  views: RenderSnapshotViews,
+  rect: RenderRect,
+  out: number[]
+): number[] => {
+  out.length = 0
+  const { gridWidth, gridHeight, maxObjectRadius } = snapshot
+  const { cellStart, cellObjects } = views
+  const cellWidth = snapshot.width / gridWidth
+  const cellHeight = snapshot.height / gridHeight
+
+  // オブジェクトの半径の分だけ広げる（中心が矩形外でも描画範囲が重なるもの）
+  const firstColumn = Math.floor((rect.left - maxObjectRadius) / cellWidth)
+  const lastColumn = Math.floor((rect.right + maxObjectRadius) / cellWidth)
+  const firstRow = Math.floor((rect.top - maxObjectRadius) / cellHeight)
+  const lastRow = Math.floor((rect.bottom + maxObjectRadius) / cellHeight)
+  // 世界より広い場合も各格子を1度だけ調べる
+  const columnCount = Math.min(gridWidth, lastColumn - firstColumn + 1)
+  const rowCount = Math.min(gridHeight, lastRow - firstRow + 1)
+
+  for (let row = 0; row < rowCount; row++) {
+    const cellY = (((firstRow + row) % gridHeight) + gridHeight) % gridHeight
+    for (let column = 0; column < columnCount; column++) {
+      const cellX = (((firstColumn + column) % gridWidth) + gridWidth) % gridWidth
+      const cell = cellY * gridWidth + cellX
+      const end = cellStart[cell + 1] ?? 0
+      for (let k = cellStart[cell] ?? 0; k < end; k++) {
+        out.push(cellObjects[k] ?? 0)
+      }
+    }
+  }
+  return out
+}
+
+/**
+ * 指定位置を含むHULLのうち、中心が最も近いもののオブジェクト位置（なければ-1）
+ * @param snapshot スナップショット
+ * @param x ワールドX座標
+ * @param y ワールドY座標
+ */
+export const findRenderSnapshotHullAt = (
+  snapshot: RenderSnapshot,
+  x: number,
+  y: number
+): number => {
+  const views = renderSnapshotViews(snapshot)
+  const { objects } = views
+  const hullType = RENDER_OBJECT_TYPES.indexOf("HULL")
+  const candidates = queryRenderSnapshotRect(
+    snapshot,
+    views,
+    { left: x, top: y, right: x, bottom: y },
+    []
+  )
+  let found = -1
+  let minDistance = Infinity
+  for (const index of candidates) {
+    if (objects.type[index] !== hullType) {
+      continue
+    }
+    const distance = Math.hypot((objects.x[index] ?? 0) - x, (objects.y[index] ?? 0) - y)
+    if (distance <= (objects.radius[index] ?? 0) && distance < minDistance) {
+      found = index
+      minDistance = distance
+    }
+  }
+  return found
+}
@@ -23,6 +23,23 @@ export const DEFAULT_SEPARATION_PARAMETERS: SeparationForceParameters = {
   minForce: 1,
 }
 
+/**
+ * 重なり深度から反発力の大きさを計算
+ * @param overlap 重なり深度（正の値）
+ * @param parameters 反発力パラメータ
+ * @returns 反発力の大きさ
+ */
+export const calculateSeparationForceMagnitude = (
+  overlap: number,
+  parameters: SeparationForceParameters = DEFAULT_SEPARATION_PARAMETERS
+): number => {
+  // tanh関数により滑らかに上限に漸近する反発力の大きさ
+  const forceMagnitude = parameters.maxForce * Math.tanh(overlap / parameters.forceScale)
+
+  // 最小反発力の適用（数値誤差対策）
+  return Math.max(forceMagnitude, parameters.minForce)
+}
+
 /**
  * 2つのオブジェクト間の反発力を計算
  * @param obj1 オブジェクト1
@@ -60,11 +77,7 @@ export const calculateSeparationForce = (
     return Vec2Utils.create(0, 0)
   }
 
-  // tanh関数により滑らかに上限に漸近する反発力の大きさ
-  const forceMagnitude = parameters.maxForce * Math.tanh(overlap / parameters.forceScale)
-
-  // 最小反発力の適用（数値誤差対策）
-  const actualForceMagnitude = Math.max(forceMagnitude, parameters.minForce)
+  const actualForceMagnitude = calculateSeparationForceMagnitude(overlap, parameters)
 
   // 反発方向の計算（obj1から見た場合）
   let directionX: number
@@ -3,30 +3,11 @@
  */
 
 import { SpatialHashGrid } from "./spatial-hash-grid"
-import type { GameObject, ObjectId } from "@/types/game"
-import { Vec2 as Vec2Utils } from "@/utils/vec2"
 
-// テスト用のObjectId生成関数
-const createTestObjectId = (value: string | number): ObjectId => {
-  return value as unknown as ObjectId
-}
-
-// テスト用のGameObject生成
-const createTestObject = (
-  id: string | number,
-  x: number,
-  y: number,
+type TestObject = {
+  x: number
+  y: number
   radius: number
-): GameObject => {
-  return {
-    id: createTestObjectId(id),
-    type: "ENERGY",
-    position: Vec2Utils.create(x, y),
-    velocity: Vec2Utils.create(0, 0),
-    radius,
-    energy: 100,
-    mass: 100,
-  }
 }
 
 describe("SpatialHashGrid", () => {
@@ -34,9 +15,29 @@ describe("SpatialHashGrid", () => {
   const worldWidth = 1000
   const worldHeight = 1000
   let grid: SpatialHashGrid
+  let buffer: Int32Array
+
+  // テスト用の列データでグリッドを構築
+  const build = (objects: TestObject[]): void => {
+    const positionX = new Float64Array(objects.map(obj => obj.x))
+    const positionY = new Float64Array(objects.map(obj => obj.y))
+    const radius = new Float64Array(objects.map(obj => obj.radius))
+    grid.rebuild(positionX, positionY, radius, objects.length)
+  }
+
+  const nearby = (index: number): number[] => {
+    const count = grid.getNearbyObjects(index, buffer)
+    return Array.from(buffer.subarray(0, count)).sort((a, b) => a - b)
+  }
+
+  const nearbyAt = (x: number, y: number, radius: number): number[] => {
+    const count = grid.getNearbyObjectsAtPosition(x, y, radius, buffer)
+    return Array.from(buffer.subarray(0, count)).sort((a, b) => a - b)
+  }
 
   beforeEach(() => {
     grid = new SpatialHashGrid(cellSize, worldWidth, worldHeight)
+    buffer = new Int32Array(1000)
   })
 
   describe("基本機能", () => {
@@ -47,229 +48,208 @@ describe("SpatialHashGrid", () => {
     })
 
     test("オブジェクトの登録", () => {
-      const obj = createTestObject("obj1", 50, 50, 10)
-      grid.register(obj)
+      build([{ x: 50, y: 50, radius: 10 }])
 
       const debugInfo = grid.getDebugInfo()
       expect(debugInfo.totalCells).toBe(1)
       expect(debugInfo.totalObjects).toBe(1)
+      expect(debugInfo.cellOccupancy.get("0,0")).toBe(1)
     })
 
-    test("オブジェクトの削除", () => {
-      const obj = createTestObject("obj1", 50, 50, 10)
-      grid.register(obj)
-      grid.unregister(obj)
+    test("グリッドのクリア", () => {
+      build([
+        { x: 50, y: 50, radius: 10 },
+        { x: 250, y: 250, radius: 10 },
+      ])
+
+      grid.clear()
 
       const debugInfo = grid.getDebugInfo()
       expect(debugInfo.totalCells).toBe(0)
       expect(debugInfo.totalObjects).toBe(0)
     })
 
-    test("グリッドのクリア", () => {
-      const obj1 = createTestObject("obj1", 50, 50, 10)
-      const obj2 = createTestObject("obj2", 250, 250, 10)
-      grid.register(obj1)
-      grid.register(obj2)
+    test("セルIDは行優先の整数", () => {
+      expect(grid.cellIdAt(50, 50)).toBe(0)
+      expect(grid.cellIdAt(150, 50)).toBe(1)
+      expect(grid.cellIdAt(50, 150)).toBe(10)
+      expect(grid.cellIdAt(-50, -50)).toBe(99)
+    })
 
-      grid.clear()
+    test("再構築で以前の登録が置き換わる", () => {
+      build([
+        { x: 50, y: 50, radius: 10 },
+        { x: 60, y: 60, radius: 10 },
+      ])
+      build([{ x: 550, y: 550, radius: 10 }])
 
       const debugInfo = grid.getDebugInfo()
-      expect(debugInfo.totalCells).toBe(0)
-      expect(debugInfo.totalObjects).toBe(0)
+      expect(debugInfo.totalObjects).toBe(1)
+      expect(debugInfo.cellOccupancy.get("5,5")).toBe(1)
     })
   })
 
   describe("近傍オブジェクト検索", () => {
     test("同じセル内のオブジェクトを検出", () => {
-      const obj1 = createTestObject("obj1", 50, 50, 10)
-      const obj2 = createTestObject("obj2", 60, 60, 10)
-      grid.register(obj1)
-      grid.register(obj2)
-
-      const nearbyIds = grid.getNearbyObjects(obj1)
-      expect(nearbyIds.size).toBe(1)
-      expect(nearbyIds.has(createTestObjectId("obj2"))).toBe(true)
+      build([
+        { x: 50, y: 50, radius: 10 },
+        { x: 60, y: 60, radius: 10 },
+      ])
+
+      expect(nearby(0)).toEqual([1])
     })
 
-    test("異なるセルのオブジェクトは検出しない", () => {
-      const obj1 = createTestObject("obj1", 50, 50, 10)
-      const obj2 = createTestObject("obj2", 250, 250, 10)
-      grid.register(obj1)
-      grid.register(obj2)
+    test("離れたセルのオブジェクトは検出しない", () => {
+      build([
+        { x: 50, y: 50, radius: 10 },
+        { x: 250, y: 250, radius: 10 },
+      ])
 
-      const nearbyIds = grid.getNearbyObjects(obj1)
-      expect(nearbyIds.size).toBe(0)
+      expect(nearby(0)).toEqual([])
     })
 
     test("自身は近傍リストに含まれない", () => {
-      const obj = createTestObject("obj1", 50, 50, 10)
-      grid.register(obj)
+      build([{ x: 50, y: 50, radius: 10 }])
 
-      const nearbyIds = grid.getNearbyObjects(obj)
-      expect(nearbyIds.has(obj.id)).toBe(false)
+      expect(nearby(0)).toEqual([])
     })
 
     test("位置指定での近傍検索", () => {
-      const obj1 = createTestObject("obj1", 50, 50, 10)
-      const obj2 = createTestObject("obj2", 60, 60, 10)
-      const obj3 = createTestObject("obj3", 250, 250, 10)
-      grid.register(obj1)
-      grid.register(obj2)
-      grid.register(obj3)
-
-      const nearbyIds = grid.getNearbyObjectsAtPosition(Vec2Utils.create(55, 55), 20)
-      expect(nearbyIds.size).toBe(2)
-      expect(nearbyIds.has(createTestObjectId("obj1"))).toBe(true)
-      expect(nearbyIds.has(createTestObjectId("obj2"))).toBe(true)
-      expect(nearbyIds.has(createTestObjectId("obj3"))).toBe(false)
+      build([
+        { x: 50, y: 50, radius: 10 },
+        { x: 60, y: 60, radius: 10 },
+        { x: 250, y: 250, radius: 10 },
+      ])
+
+      expect(nearbyAt(55, 55, 20)).toEqual([0, 1])
+    })
+
+    test("バッファを超えた分は書き込まず件数のみ返す", () => {
+      build([
+        { x: 50, y: 50, radius: 10 },
+        { x: 55, y: 50, radius: 10 },
+        { x: 60, y: 50, radius: 10 },
+      ])
+
+      const small = new Int32Array(1)
+      expect(grid.getNearbyObjectsAtPosition(50, 50, 10, small)).toBe(3)
     })
   })
 
-  describe("複数セル占有", () => {
-    test("大きなオブジェクトが複数セルを占有", () => {
-      // セルサイズ100に対して、半径60のオブジェクトをセル境界付近に配置
-      const obj = createTestObject("obj1", 95, 95, 60)
-      grid.register(obj)
+  describe("大きなオブジェクト", () => {
+    test("最大半径分だけ検索範囲が広がる", () => {
+      build([
+        { x: 95, y: 95, radius: 60 },
+        { x: 140, y: 140, radius: 5 },
+      ])
 
-      const debugInfo = grid.getDebugInfo()
-      expect(debugInfo.totalCells).toBe(4) // 4つのセルにまたがる
-      expect(debugInfo.totalObjects).toBe(4) // 各セルに1つずつ登録
+      expect(grid.maxRadius).toBe(60)
+      expect(nearby(1)).toEqual([0])
     })
 
     test("セル境界をまたぐオブジェクトの近傍検索", () => {
-      // セル(0,0)とセル(1,0)の境界
-      const obj1 = createTestObject("obj1", 95, 50, 10)
-      // セル(1,0)
-      const obj2 = createTestObject("obj2", 105, 50, 10)
-      grid.register(obj1)
-      grid.register(obj2)
-
-      const nearbyIds = grid.getNearbyObjects(obj1)
-      expect(nearbyIds.size).toBe(1)
-      expect(nearbyIds.has(createTestObjectId("obj2"))).toBe(true)
+      build([
+        { x: 95, y: 50, radius: 10 },
+        { x: 105, y: 50, radius: 10 },
+      ])
+
+      expect(nearby(0)).toEqual([1])
+    })
+
+    test("世界より大きな検索範囲でも重複しない", () => {
+      build([
+        { x: 500, y: 500, radius: worldWidth * 2 },
+        { x: 50, y: 50, radius: 10 },
+      ])
+
+      expect(nearby(1)).toEqual([0])
     })
   })
 
   describe("トーラス境界", () => {
-    test("世界境界を超えるオブジェクトの登録", () => {
-      // x座標が世界幅を超える位置
-      const obj = createTestObject("obj1", worldWidth - 10, 50, 20)
-      grid.register(obj)
-
-      // 左端のセルにも登録されているはず
-      const leftObj = createTestObject("obj2", 10, 50, 10)
-      grid.register(leftObj)
-
-      const nearbyIds = grid.getNearbyObjects(leftObj)
-      expect(nearbyIds.size).toBe(1)
-      expect(nearbyIds.has(createTestObjectId("obj1"))).toBe(true)
+    test("世界境界をまたぐ近傍検索", () => {
+      build([
+        { x: worldWidth - 10, y: 50, radius: 20 },
+        { x: 10, y: 50, radius: 10 },
+      ])
+
+      expect(nearby(1)).toEqual([0])
+      expect(nearby(0)).toEqual([1])
     })
 
-    test("負の座標でのセル計算", () => {
-      // 内部的に負の座標を処理（トーラスラップ前）
-      const obj1 = createTestObject("obj1", 10, 10, 20)
-      const obj2 = createTestObject("obj2", worldWidth - 10, 10, 20)
-      grid.register(obj1)
-      grid.register(obj2)
-
-      // obj2の近傍にobj1が検出される
-      const nearbyIds = grid.getNearbyObjects(obj2)
-      expect(nearbyIds.size).toBe(1)
-      expect(nearbyIds.has(createTestObjectId("obj1"))).toBe(true)
+    test("4隅にまたがる近傍検索", () => {
+      build([
+        { x: worldWidth - 10, y: worldHeight - 10, radius: 20 },
+        { x: 5, y: 5, radius: 5 },
+      ])
+
+      expect(nearby(1)).toEqual([0])
     })
 
-    test("コーナーケース：4隅にまたがるオブジェクト", () => {
-      // 世界の右下隅
-      const obj = createTestObject("obj1", worldWidth - 10, worldHeight - 10, 20)
-      grid.register(obj)
+    test("世界外の座標はラップしてセルに登録される", () => {
+      build([{ x: -50, y: worldHeight + 50, radius: 10 }])
 
-      const debugInfo = grid.getDebugInfo()
-      expect(debugInfo.totalCells).toBe(4) // 4隅すべてのセルに登録
+      expect(grid.getDebugInfo().cellOccupancy.get("9,0")).toBe(1)
+    })
+
+    test("セルサイズで割り切れない世界幅", () => {
+      grid = new SpatialHashGrid(cellSize, 1050, 1050)
+      build([
+        { x: 1040, y: 50, radius: 10 },
+        { x: 5, y: 50, radius: 10 },
+      ])
+
+      expect(nearby(1)).toEqual([0])
     })
   })
 
   describe("パフォーマンステスト", () => {
     test("多数のオブジェクトの登録と検索", () => {
-      const objects: GameObject[] = []
+      const objects: TestObject[] = []
       const objectCount = 1000
 
       // ランダムに配置
       for (let i = 0; i < objectCount; i++) {
-        const obj = createTestObject(
-          `obj${i}`,
-          Math.random() * worldWidth,
-          Math.random() * worldHeight,
-          5 + Math.random() * 20
-        )
-        objects.push(obj)
-        grid.register(obj)
+        objects.push({
+          x: Math.random() * worldWidth,
+          y: Math.random() * worldHeight,
+          radius: 5 + Math.random() * 20,
+        })
       }
+      build(objects)
 
-      // デバッグ情報を確認
-      const debugInfo = grid.getDebugInfo()
-      expect(debugInfo.totalObjects).toBeGreaterThan(0)
+      expect(grid.getDebugInfo().totalObjects).toBe(objectCount)
 
-      // いくつかのオブジェクトで近傍検索
+      // 検索結果に接触し得る全てのオブジェクトが含まれる
       for (let i = 0; i < 10; i++) {
-        const nearbyIds = grid.getNearbyObjects(objects[i]!)
-        // 少なくとも自分以外のオブジェクトが近くにある可能性
-        expect(nearbyIds).toBeDefined()
-      }
-    })
-
-    test("大量の登録・削除操作", () => {
-      const objects: GameObject[] = []
-
-      // 登録
-      for (let i = 0; i < 100; i++) {
-        const obj = createTestObject(`obj${i}`, i * 10, i * 10, 10)
-        objects.push(obj)
-        grid.register(obj)
-      }
-
-      // 削除
-      for (const obj of objects) {
-        grid.unregister(obj)
+        const found = new Set(nearby(i))
+        const self = objects[i]!
+        objects.forEach((other, j) => {
+          if (j === i) {
+            return
+          }
+          const dx = Math.abs(other.x - self.x)
+          const dy = Math.abs(other.y - self.y)
+          const distance = Math.hypot(Math.min(dx, worldWidth - dx), Math.min(dy, worldHeight - dy))
+          if (distance < self.radius + other.radius) {
+            expect(found.has(j)).toBe(true)
+          }
+        })
       }
-
-      const debugInfo = grid.getDebugInfo()
-      expect(debugInfo.totalCells).toBe(0)
-      expect(debugInfo.totalObjects).toBe(0)
     })
   })
 
   describe("エッジケース", () => {
     test("半径0のオブジェクト", () => {
-      const obj = createTestObject("obj1", 50, 50, 0)
-      grid.register(obj)
+      build([{ x: 50, y: 50, radius: 0 }])
 
-      const debugInfo = grid.getDebugInfo()
-      expect(debugInfo.totalCells).toBe(1)
+      expect(grid.getDebugInfo().totalCells).toBe(1)
     })
 
-    test("非常に大きな半径のオブジェクト", () => {
-      // 世界サイズより大きな半径
-      const obj = createTestObject("obj1", 500, 500, worldWidth * 2)
-      grid.register(obj)
-
-      const debugInfo = grid.getDebugInfo()
-      // すべてのセルに登録される
-      expect(debugInfo.totalCells).toBe(100) // 10x10グリッド
-    })
-
-    test("同じオブジェクトの重複登録", () => {
-      const obj = createTestObject("obj1", 50, 50, 10)
-      grid.register(obj)
-      grid.register(obj) // 重複登録
-
-      const debugInfo = grid.getDebugInfo()
-      expect(debugInfo.totalObjects).toBe(1) // Setなので重複しない
-    })
+    test("オブジェクト数0での検索", () => {
+      build([])
 
-    test("存在しないオブジェクトの削除", () => {
-      const obj = createTestObject("obj1", 50, 50, 10)
-      // 登録せずに削除を試みる
-      expect(() => grid.unregister(obj)).not.toThrow()
+      expect(nearbyAt(50, 50, 10)).toEqual([])
     })
   })
 })
@@ -1,12 +1,76 @@
 /**
  * 空間ハッシュグリッド - 効率的な衝突検出のための空間分割データ構造
+ *
+ * セルIDは整数（row * cols + col）で表し、各セルの開始オフセットと
+ * 詰めたオブジェクト番号の配列によるカウンティングソート形式で保持する。
+ * 再構築はO(n)で行い、バッファ容量が足りている限り割り当ては発生しない。
+ * オブジェクトは中心位置のセルにのみ登録し、検索時に最大半径分だけ範囲を広げる
  */
 
-import type { GameObject, ObjectId, Vec2 } from "@/types/game"
-import { wrapPosition } from "@/utils/torus-math"
+/**
+ * トーラス境界でラップした座標が属する列（行）番号を取得
+ * @param value 座標
+ * @param worldSize 世界の幅（高さ）
+ * @param cellSize セルサイズ
+ * @param cellCount 列（行）数
+ */
+export const gridAxisCellOf = (
+  value: number,
+  worldSize: number,
+  cellSize: number,
+  cellCount: number
+): number => {
+  let wrapped = value % worldSize
+  if (wrapped < 0) {
+    wrapped += worldSize
+  }
+
+  // 浮動小数点誤差やNaNで範囲外になったセル番号を丸める
+  const cell = Math.floor(wrapped / cellSize)
+  if (cell >= cellCount) {
+    return cellCount - 1
+  }
+  if (!(cell >= 0)) {
+    return 0
+  }
+  return cell
+}
 
-/** グリッドセル */
-type GridCell = Set<ObjectId>
+/**
+ * 座標範囲[min, max]に重なる列（行）番号をトーラス境界を考慮して重複なく書き込む
+ * @param out 書き込み先（列（行）数以上の長さが必要）
+ * @returns 書き込んだ数
+ */
+export const fillGridAxisRange = (
+  min: number,
+  max: number,
+  worldSize: number,
+  cellSize: number,
+  cellCount: number,
+  out: Int32Array
+): number => {
+  // 範囲が世界全体を覆う場合は全セル（両端が同じセルに回り込む場合を含む）
+  if (max - min + cellSize >= worldSize) {
+    for (let i = 0; i < cellCount; i++) {
+      out[i] = i
+    }
+    return cellCount
+  }
+
+  const first = gridAxisCellOf(min, worldSize, cellSize, cellCount)
+  const last = gridAxisCellOf(max, worldSize, cellSize, cellCount)
+
+  let written = 0
+  let cell = first
+  for (;;) {
+    out[written] = cell
+    written++
+    if (cell === last || written >= cellCount) {
+      return written
+    }
+    cell = cell + 1 === cellCount ? 0 : cell + 1
+  }
+}
 
 export class SpatialHashGrid {
   private readonly _cellSize: number
@@ -14,136 +78,204 @@ export class SpatialHashGrid {
   private readonly _worldHeight: number
   private readonly _cols: number
   private readonly _rows: number
-  private readonly _grid: Map<string, GridCell>
+  private readonly _cellStart: Int32Array
+  private readonly _cellCursor: Int32Array
+  private readonly _queryCols: Int32Array
+  private readonly _queryRows: Int32Array
+  private _cellOfObject = new Int32Array(0)
+  private _packedIndices = new Int32Array(0)
+  private _positionX = new Float64Array(0)
+  private _positionY = new Float64Array(0)
+  private _radius = new Float64Array(0)
+  private _count = 0
+  private _maxRadius = 0
+
+  /** 登録されているオブジェクト数 */
+  public get count(): number {
+    return this._count
+  }
+
+  /** 登録されているオブジェクトの最大半径 */
+  public get maxRadius(): number {
+    return this._maxRadius
+  }
+
+  /** 列数 */
+  public get cols(): number {
+    return this._cols
+  }
+
+  /** 行数 */
+  public get rows(): number {
+    return this._rows
+  }
 
   public constructor(cellSize: number, worldWidth: number, worldHeight: number) {
     this._cellSize = cellSize
     this._worldWidth = worldWidth
     this._worldHeight = worldHeight
-    this._cols = Math.ceil(worldWidth / cellSize)
-    this._rows = Math.ceil(worldHeight / cellSize)
-    this._grid = new Map()
+    this._cols = Math.max(1, Math.ceil(worldWidth / cellSize))
+    this._rows = Math.max(1, Math.ceil(worldHeight / cellSize))
+    this._cellStart = new Int32Array(this._cols * this._rows + 1)
+    this._cellCursor = new Int32Array(this._cols * this._rows)
+    this._queryCols = new Int32Array(this._cols)
+    this._queryRows = new Int32Array(this._rows)
   }
 
   /** グリッドをクリア */
   public clear(): void {
-    this._grid.clear()
-  }
-
-  /** セルキーを生成 */
-  private getCellKey(col: number, row: number): string {
-    return `${col},${row}`
+    this._cellStart.fill(0)
+    this._count = 0
+    this._maxRadius = 0
   }
 
-  /** オブジェクトが占有する全セルを取得 */
-  private getOccupiedCells(object: GameObject): { col: number; row: number }[] {
-    const cells: { col: number; row: number }[] = []
-
-    // オブジェクトのバウンディングボックスを計算
-    const minX = object.position.x - object.radius
-    const maxX = object.position.x + object.radius
-    const minY = object.position.y - object.radius
-    const maxY = object.position.y + object.radius
-
-    // 占有する全セルを列挙
-    const minCol = Math.floor(minX / this._cellSize)
-    const maxCol = Math.floor(maxX / this._cellSize)
-    const minRow = Math.floor(minY / this._cellSize)
-    const maxRow = Math.floor(maxY / this._cellSize)
-
-    for (let col = minCol; col <= maxCol; col++) {
-      for (let row = minRow; row <= maxRow; row++) {
-        // トーラス境界を考慮してラップ
-        const wrappedCol = ((col % this._cols) + this._cols) % this._cols
-        const wrappedRow = ((row % this._rows) + this._rows) % this._rows
-        cells.push({ col: wrappedCol, row: wrappedRow })
-      }
+  /**
+   * 列データからグリッドを再構築する
+   * 渡した列は次の再構築まで参照されるため、その間に書き換えないこと
+   * @param positionX X座標の列
+   * @param positionY Y座標の列
+   * @param radius 半径の列
+   * @param count オブジェクト数
+   */
+  public rebuild(
+    positionX: Float64Array,
+    positionY: Float64Array,
+    radius: Float64Array,
+    count: number
+  ): void {
+    this._positionX = positionX
+    this._positionY = positionY
+    this._radius = radius
+    this._count = count
+
+    if (this._cellOfObject.length < count) {
+      const capacity = Math.max(count, this._cellOfObject.length * 2)
+      this._cellOfObject = new Int32Array(capacity)
+      this._packedIndices = new Int32Array(capacity)
     }
 
-    return cells
-  }
-
-  /** オブジェクトをグリッドに登録 */
-  public register(object: GameObject): void {
-    const cells = this.getOccupiedCells(object)
-
-    for (const { col, row } of cells) {
-      const key = this.getCellKey(col, row)
-      let cell = this._grid.get(key)
-
-      if (cell === undefined) {
-        cell = new Set()
-        this._grid.set(key, cell)
+    const cellStart = this._cellStart
+    const cellOfObject = this._cellOfObject
+    const cellCount = this._cols * this._rows
+    cellStart.fill(0)
+
+    // セルごとのオブジェクト数を数える
+    let maxRadius = 0
+    for (let i = 0; i < count; i++) {
+      const cellId = this.cellIdAt(positionX[i] ?? 0, positionY[i] ?? 0)
+      cellOfObject[i] = cellId
+      cellStart[cellId + 1] = (cellStart[cellId + 1] ?? 0) + 1
+
+      const r = radius[i] ?? 0
+      if (r > maxRadius) {
+        maxRadius = r
       }
-
-      cell.add(object.id)
     }
-  }
+    this._maxRadius = maxRadius
 
-  /** オブジェクトをグリッドから削除 */
-  public unregister(object: GameObject): void {
-    const cells = this.getOccupiedCells(object)
-
-    for (const { col, row } of cells) {
-      const key = this.getCellKey(col, row)
-      const cell = this._grid.get(key)
-
-      if (cell !== undefined) {
-        cell.delete(object.id)
-
-        // 空のセルは削除
-        if (cell.size === 0) {
-          this._grid.delete(key)
-        }
-      }
+    // 累積和で各セルの開始オフセットを求める
+    for (let cellId = 0; cellId < cellCount; cellId++) {
+      cellStart[cellId + 1] = (cellStart[cellId + 1] ?? 0) + (cellStart[cellId] ?? 0)
     }
-  }
-
-  /** 指定オブジェクトの近傍にあるオブジェクトIDを取得 */
-  public getNearbyObjects(object: GameObject): Set<ObjectId> {
-    const nearbyIds = new Set<ObjectId>()
-    const cells = this.getOccupiedCells(object)
 
-    for (const { col, row } of cells) {
-      const key = this.getCellKey(col, row)
-      const cell = this._grid.get(key)
-
-      if (cell !== undefined) {
-        for (const id of cell) {
-          if (id !== object.id) {
-            nearbyIds.add(id)
-          }
-        }
-      }
+    // オブジェクト番号をセル順に詰める（セル内は番号の昇順）
+    const cursor = this._cellCursor
+    cursor.set(cellStart.subarray(0, cellCount))
+    const packed = this._packedIndices
+    for (let i = 0; i < count; i++) {
+      const cellId = cellOfObject[i] ?? 0
+      const offset = cursor[cellId] ?? 0
+      packed[offset] = i
+      cursor[cellId] = offset + 1
     }
-
-    return nearbyIds
   }
 
-  /** 指定位置の近傍にあるオブジェクトIDを取得 */
-  public getNearbyObjectsAtPosition(position: Vec2, radius: number): Set<ObjectId> {
-    const nearbyIds = new Set<ObjectId>()
-
-    // 仮想的なオブジェクトとして扱う
-    const virtualObject: Partial<GameObject> = {
-      position: wrapPosition(position, this._worldWidth, this._worldHeight),
-      radius,
-    }
+  /** 座標が属するセルID（row * cols + col）を取得 */
+  public cellIdAt(x: number, y: number): number {
+    const col = gridAxisCellOf(x, this._worldWidth, this._cellSize, this._cols)
+    const row = gridAxisCellOf(y, this._worldHeight, this._cellSize, this._rows)
+    return row * this._cols + col
+  }
 
-    const cells = this.getOccupiedCells(virtualObject as GameObject)
+  /**
+   * 指定オブジェクトの近傍にあるオブジェクト番号を取得（自身は含まない）
+   * @param index 再構築時の列上の番号
+   * @param out 結果を書き込むバッファ
+   * @returns 近傍オブジェクト数。outの長さを超えた分は書き込まれない
+   */
+  public getNearbyObjects(index: number, out: Int32Array): number {
+    const x = this._positionX[index] ?? 0
+    const y = this._positionY[index] ?? 0
+    const range = (this._radius[index] ?? 0) + this._maxRadius
+    return this.collectInRange(x, y, range, index, out)
+  }
 
-    for (const { col, row } of cells) {
-      const key = this.getCellKey(col, row)
-      const cell = this._grid.get(key)
+  /**
+   * 指定位置の近傍にあるオブジェクト番号を取得
+   * @param x X座標
+   * @param y Y座標
+   * @param radius 検索半径
+   * @param out 結果を書き込むバッファ
+   * @returns 近傍オブジェクト数。outの長さを超えた分は書き込まれない
+   */
+  public getNearbyObjectsAtPosition(
+    x: number,
+    y: number,
+    radius: number,
+    out: Int32Array
+  ): number {
+    return this.collectInRange(x, y, radius + this._maxRadius, -1, out)
+  }
 
-      if (cell !== undefined) {
-        for (const id of cell) {
-          nearbyIds.add(id)
+  /** 範囲内のセルに登録されたオブジェクト番号を集める */
+  private collectInRange(
+    x: number,
+    y: number,
+    range: number,
+    excludeIndex: number,
+    out: Int32Array
+  ): number {
+    const colCount = fillGridAxisRange(
+      x - range,
+      x + range,
+      this._worldWidth,
+      this._cellSize,
+      this._cols,
+      this._queryCols
+    )
+    const rowCount = fillGridAxisRange(
+      y - range,
+      y + range,
+      this._worldHeight,
+      this._cellSize,
+      this._rows,
+      this._queryRows
+    )
+
+    const cellStart = this._cellStart
+    const packed = this._packedIndices
+    const capacity = out.length
+    let found = 0
+
+    for (let r = 0; r < rowCount; r++) {
+      const rowOffset = (this._queryRows[r] ?? 0) * this._cols
+      for (let c = 0; c < colCount; c++) {
+        const cellId = rowOffset + (this._queryCols[c] ?? 0)
+        const end = cellStart[cellId + 1] ?? 0
+        for (let p = cellStart[cellId] ?? 0; p < end; p++) {
+          const other = packed[p] ?? 0
+          if (other === excludeIndex) {
+            continue
+          }
+          if (found < capacity) {
+            out[found] = other
+          }
+          found++
         }
       }
     }
 
-    return nearbyIds
+    return found
   }
 
   /** デバッグ用：グリッドの状態を取得 */
@@ -152,18 +284,21 @@ export class SpatialHashGrid {
     totalObjects: number
     cellOccupancy: Map<string, number>
   } {
-    let totalObjects = 0
     const cellOccupancy = new Map<string, number>()
 
-    for (const [key, cell] of this._grid) {
-      const count = cell.size
-      cellOccupancy.set(key, count)
-      totalObjects += count
+    for (let row = 0; row < this._rows; row++) {
+      for (let col = 0; col < this._cols; col++) {
+        const cellId = row * this._cols + col
+        const count = (this._cellStart[cellId + 1] ?? 0) - (this._cellStart[cellId] ?? 0)
+        if (count > 0) {
+          cellOccupancy.set(`${col},${row}`, count)
+        }
+      }
     }
 
     return {
-      totalCells: this._grid.size,
-      totalObjects,
+      totalCells: cellOccupancy.size,
+      totalObjects: this._count,
       cellOccupancy,
     }
   }
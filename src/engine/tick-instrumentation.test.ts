@@ -0,0 +1,95 @@
+/**
+ * TickInstrumentation テスト
+ */
+
+import { TickInstrumentation } from "./tick-instrumentation"
+import { World } from "./world"
+
+describe("TickInstrumentation", () => {
+  /** 呼び出すたびに指定の間隔だけ進む時計 */
+  const createClock = (steps: number[]): (() => number) => {
+    let time = 0
+    let call = 0
+    return () => {
+      time += steps[call % steps.length] ?? 0
+      call++
+      return time
+    }
+  }
+
+  test("フェーズの区切りごとに経過時間を加算する", () => {
+    // beginTick, physics, vm の順に 0 → 2 → 5
+    const instrumentation = new TickInstrumentation(10, createClock([0, 2, 3]))
+
+    instrumentation.beginTick()
+    instrumentation.endPhase("physics")
+    instrumentation.endPhase("vm")
+    instrumentation.count("vmCycles", 40)
+    instrumentation.count("vmCycles", 2)
+    instrumentation.endTick()
+
+    expect(instrumentation.last("physics")).toBe(2)
+    expect(instrumentation.last("vm")).toBe(3)
+    expect(instrumentation.last("heatDiffusion")).toBe(0)
+    expect(instrumentation.last("vmCycles")).toBe(42)
+    expect(instrumentation.groupMean("physics")).toBe(2)
+  })
+
+  test("履歴は直近のtickのみ保持し、累計は全tickを数える", () => {
+    const instrumentation = new TickInstrumentation(3)
+
+    for (let tick = 1; tick <= 5; tick++) {
+      instrumentation.beginTick()
+      instrumentation.count("objectsAllocated", tick)
+      instrumentation.endTick()
+    }
+
+    expect(instrumentation.ticks).toBe(5)
+    expect(Array.from(instrumentation.history("objectsAllocated"))).toEqual([3, 4, 5])
+    expect(instrumentation.mean("objectsAllocated")).toBe(4)
+    expect(instrumentation.total("objectsAllocated")).toBe(15)
+
+    const summary = instrumentation.summarize("objectsAllocated")
+    expect(summary).toMatchObject({ last: 5, min: 3, max: 5, p50: 4, total: 15 })
+  })
+
+  test("ヒストグラムは最小値〜最大値を等幅に分割して数える", () => {
+    const instrumentation = new TickInstrumentation(10)
+    ;[0, 1, 1, 2, 9, 10].forEach(value => {
+      instrumentation.beginTick()
+      instrumentation.count("collisionPairs", value)
+      instrumentation.endTick()
+    })
+
+    const histogram = instrumentation.histogram("collisionPairs", 2)
+
+    expect(histogram).toEqual({ min: 0, max: 10, counts: [4, 2] })
+  })
+
+  test("Worldのtickごとに計測値が記録される", () => {
+    const world = new World({
+      width: 200,
+      height: 200,
+      parameters: { energySourceCount: 1 },
+      quiet: true,
+    })
+
+    world.tick()
+    world.tick()
+
+    const snapshot = world.instrumentation?.snapshot()
+    expect(snapshot?.ticks).toBe(2)
+    expect(snapshot?.windowSize).toBe(2)
+    // エネルギーソースから生成されたエネルギー粒子
+    expect(snapshot?.counters.objectsAllocated.total).toBe(world.state.objects.size)
+    expect(snapshot?.counters.objectsProcessed.last).toBeGreaterThan(0)
+  })
+
+  test("instrumentation: false で計測を無効にできる", () => {
+    const world = new World({ width: 100, height: 100, instrumentation: false, quiet: true })
+
+    world.tick()
+
+    expect(world.instrumentation).toBeNull()
+  })
+})
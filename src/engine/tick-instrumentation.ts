@@ -0,0 +1,300 @@
+/**
+ * tick処理の計測
+ *
+ * World.tickのフェーズ別処理時間とカウンタ（処理オブジェクト数・衝突ペア数・VMサイクル数など）を
+ * tickごとに記録し、累計と直近数百tickの履歴を保持する。
+ * 値は事前確保した配列に書き込むだけなので、本番でも有効にしたまま使える。
+ * 集計（平均・パーセンタイル・ヒストグラム）は読み出し側の呼び出し時にのみ行う
+ */
+
+/** 計測対象のフェーズ（World.tickでの実行順） */
+export type TickPhase =
+  | "physics"
+  | "energyGeneration"
+  | "energyCoalescing"
+  | "energyField"
+  | "energyDecay"
+  | "energyCollection"
+  | "vm"
+  | "heatDiffusion"
+  | "heatRadiation"
+  | "heatDamage"
+
+export const TICK_PHASES: readonly TickPhase[] = [
+  "physics",
+  "energyGeneration",
+  "energyCoalescing",
+  "energyField",
+  "energyDecay",
+  "energyCollection",
+  "vm",
+  "heatDiffusion",
+  "heatRadiation",
+  "heatDamage",
+]
+
+/** サブシステム単位のフェーズのまとまり */
+export type TickPhaseGroup = "physics" | "energy" | "vm" | "heat"
+
+export const TICK_PHASE_GROUPS: Readonly<Record<TickPhaseGroup, readonly TickPhase[]>> = {
+  physics: ["physics"],
+  energy: [
+    "energyGeneration",
+    "energyCoalescing",
+    "energyField",
+    "energyDecay",
+    "energyCollection",
+  ],
+  vm: ["vm"],
+  heat: ["heatDiffusion", "heatRadiation", "heatDamage"],
+}
+
+/** tickごとに数えるカウンタ */
+export type TickCounter =
+  | "objectsProcessed"
+  | "collisionPairs"
+  | "vmCycles"
+  | "heatCellsTouched"
+  | "objectsAllocated"
+  | "objectsRemoved"
+
+export const TICK_COUNTERS: readonly TickCounter[] = [
+  "objectsProcessed",
+  "collisionPairs",
+  "vmCycles",
+  "heatCellsTouched",
+  "objectsAllocated",
+  "objectsRemoved",
+]
+
+/** 計測値の種類（フェーズの処理時間、またはカウンタ） */
+export type TickMetric = TickPhase | TickCounter
+
+/** 直近の履歴の要約 */
+export type TickMetricSummary = {
+  /** 直前のtickの値 */
+  readonly last: number
+  readonly mean: number
+  readonly min: number
+  readonly max: number
+  readonly p50: number
+  readonly p95: number
+  /** 計測開始からの累計 */
+  readonly total: number
+}
+
+/** 直近の履歴のヒストグラム */
+export type TickMetricHistogram = {
+  readonly min: number
+  readonly max: number
+  /** [min, max] を等幅に分割した各区間の度数 */
+  readonly counts: readonly number[]
+}
+
+export type TickInstrumentationSnapshot = {
+  /** 計測したtick数 */
+  readonly ticks: number
+  /** 要約の対象となった直近のtick数 */
+  readonly windowSize: number
+  /** フェーズごとの処理時間（ミリ秒） */
+  readonly phases: Readonly<Record<TickPhase, TickMetricSummary>>
+  readonly counters: Readonly<Record<TickCounter, TickMetricSummary>>
+}
+
+/** 既定の履歴長（tick） */
+export const DEFAULT_TICK_HISTORY_SIZE = 300
+
+const METRICS: readonly TickMetric[] = [...TICK_PHASES, ...TICK_COUNTERS]
+const METRIC_COUNT = METRICS.length
+const METRIC_INDEX = new Map<TickMetric, number>(METRICS.map((metric, index) => [metric, index]))
+
+const indexOf = (metric: TickMetric): number => METRIC_INDEX.get(metric) ?? 0
+
+export class TickInstrumentation {
+  private readonly _now: () => number
+  private readonly _historySize: number
+  /** 計測中のtickの値 */
+  private readonly _current = new Float64Array(METRIC_COUNT)
+  private readonly _totals = new Float64Array(METRIC_COUNT)
+  /** tickごとの値のリングバッファ（index = slot * METRIC_COUNT + metric） */
+  private readonly _history: Float64Array
+  private _historyHead = 0
+  private _historyCount = 0
+  private _ticks = 0
+  private _lapStartedAt = 0
+
+  /** 計測したtick数 */
+  public get ticks(): number {
+    return this._ticks
+  }
+
+  /** 履歴に保持しているtick数 */
+  public get windowSize(): number {
+    return this._historyCount
+  }
+
+  /**
+   * @param historySize 履歴に保持するtick数
+   * @param now 現在時刻（ミリ秒）を返す関数
+   */
+  public constructor(
+    historySize = DEFAULT_TICK_HISTORY_SIZE,
+    now: () => number = () => performance.now()
+  ) {
+    this._historySize = Math.max(1, Math.floor(historySize))
+    this._history = new Float64Array(this._historySize * METRIC_COUNT)
+    this._now = now
+  }
+
+  /** tickの計測を開始する */
+  public beginTick(): void {
+    this._current.fill(0)
+    this._lapStartedAt = this._now()
+  }
+
+  /**
+   * 直前の区切りからの経過時間をフェーズに加算する
+   * @param phase 終了したフェーズ
+   */
+  public endPhase(phase: TickPhase): void {
+    const now = this._now()
+    const index = indexOf(phase)
+    this._current[index] = (this._current[index] ?? 0) + now - this._lapStartedAt
+    this._lapStartedAt = now
+  }
+
+  /**
+   * カウンタを加算する
+   * @param counter 対象のカウンタ
+   * @param amount 加算量
+   */
+  public count(counter: TickCounter, amount: number): void {
+    const index = indexOf(counter)
+    this._current[index] = (this._current[index] ?? 0) + amount
+  }
+
+  /** tickの計測を終了し、値を累計と履歴に反映する */
+  public endTick(): void {
+    const offset = this._historyHead * METRIC_COUNT
+    for (let metric = 0; metric < METRIC_COUNT; metric++) {
+      const value = this._current[metric] ?? 0
+      this._totals[metric] = (this._totals[metric] ?? 0) + value
+      this._history[offset + metric] = value
+    }
+    this._historyHead = (this._historyHead + 1) % this._historySize
+    this._historyCount = Math.min(this._historyCount + 1, this._historySize)
+    this._ticks++
+  }
+
+  /** 計測開始からの累計 */
+  public total(metric: TickMetric): number {
+    return this._totals[indexOf(metric)] ?? 0
+  }
+
+  /** 直前のtickの値 */
+  public last(metric: TickMetric): number {
+    if (this._historyCount === 0) {
+      return 0
+    }
+    const slot = (this._historyHead + this._historySize - 1) % this._historySize
+    return this._history[slot * METRIC_COUNT + indexOf(metric)] ?? 0
+  }
+
+  /** 直近の履歴の平均 */
+  public mean(metric: TickMetric): number {
+    if (this._historyCount === 0) {
+      return 0
+    }
+    const index = indexOf(metric)
+    let sum = 0
+    for (let slot = 0; slot < this._historyCount; slot++) {
+      sum += this._history[slot * METRIC_COUNT + index] ?? 0
+    }
+    return sum / this._historyCount
+  }
+
+  /** 直近の履歴でのフェーズのまとまりの平均処理時間（ミリ秒） */
+  public groupMean(group: TickPhaseGroup): number {
+    return TICK_PHASE_GROUPS[group].reduce((sum, phase) => sum + this.mean(phase), 0)
+  }
+
+  /** 直近の履歴（古い順） */
+  public history(metric: TickMetric): Float64Array {
+    const index = indexOf(metric)
+    const values = new Float64Array(this._historyCount)
+    const oldest = (this._historyHead + this._historySize - this._historyCount) % this._historySize
+    for (let k = 0; k < this._historyCount; k++) {
+      const slot = (oldest + k) % this._historySize
+      values[k] = this._history[slot * METRIC_COUNT + index] ?? 0
+    }
+    return values
+  }
+
+  /**
+   * 直近の履歴のヒストグラム
+   * @param metric 対象の計測値
+   * @param binCount 区間数
+   */
+  public histogram(metric: TickMetric, binCount: number): TickMetricHistogram {
+    const values = this.history(metric)
+    const counts = new Array<number>(Math.max(1, Math.floor(binCount))).fill(0)
+    if (values.length === 0) {
+      return { min: 0, max: 0, counts }
+    }
+
+    let min = Infinity
+    let max = -Infinity
+    values.forEach(value => {
+      min = Math.min(min, value)
+      max = Math.max(max, value)
+    })
+    const width = (max - min) / counts.length
+    values.forEach(value => {
+      const bin = width > 0 ? Math.min(counts.length - 1, Math.floor((value - min) / width)) : 0
+      counts[bin] = (counts[bin] ?? 0) + 1
+    })
+    return { min, max, counts }
+  }
+
+  /** 直近の履歴の要約 */
+  public summarize(metric: TickMetric): TickMetricSummary {
+    const sorted = this.history(metric).sort()
+    const count = sorted.length
+    if (count === 0) {
+      return { last: 0, mean: 0, min: 0, max: 0, p50: 0, p95: 0, total: this.total(metric) }
+    }
+    const percentile = (ratio: number): number =>
+      sorted[Math.min(count - 1, Math.floor(ratio * count))] ?? 0
+    return {
+      last: this.last(metric),
+      mean: sorted.reduce((sum, value) => sum + value, 0) / count,
+      min: sorted[0] ?? 0,
+      max: sorted[count - 1] ?? 0,
+      p50: percentile(0.5),
+      p95: percentile(0.95),
+      total: this.total(metric),
+    }
+  }
+
+  /** 全フェーズ・カウンタの要約 */
+  public snapshot(): TickInstrumentationSnapshot {
+    const phases = {} as Record<TickPhase, TickMetricSummary>
+    TICK_PHASES.forEach(phase => {
+      phases[phase] = this.summarize(phase)
+    })
+    const counters = {} as Record<TickCounter, TickMetricSummary>
+    TICK_COUNTERS.forEach(counter => {
+      counters[counter] = this.summarize(counter)
+    })
+    return { ticks: this._ticks, windowSize: this._historyCount, phases, counters }
+  }
+
+  /** 累計と履歴を破棄する */
+  public reset(): void {
+    this._current.fill(0)
+    this._totals.fill(0)
+    this._historyHead = 0
+    this._historyCount = 0
+    this._ticks = 0
+  }
+}
@@ -0,0 +1,100 @@
+/**
+ * CompiledInstructionExecutor テスト
+ */
+
+import { CompiledInstructionExecutor } from "./vm-compiled-executor"
+import { InstructionExecutor } from "./vm-executor"
+import { VMState } from "./vm-state"
+import { VMUnitPortNone } from "./vm-unit-port"
+
+// 再現性のある疑似乱数（線形合同法）
+const createRandom = (seed: number): (() => number) => {
+  let state = seed
+  return () => {
+    state = (state * 1664525 + 1013904223) >>> 0
+    return state
+  }
+}
+
+const snapshotOf = (vm: VMState) => ({
+  programCounter: vm.programCounter,
+  stackPointer: vm.stackPointer,
+  zeroFlag: vm.zeroFlag,
+  carryFlag: vm.carryFlag,
+  registers: [vm.getRegister("A"), vm.getRegister("B"), vm.getRegister("C"), vm.getRegister("D")],
+  memory: Array.from(vm.readMemoryBlock(0, vm.memorySize)),
+})
+
+describe("CompiledInstructionExecutor", () => {
+  test.each([1, 2, 3, 4, 5])(
+    "ランダムなプログラムでリファレンス実装と同じ結果・サイクル数になる（seed=%i）",
+    seed => {
+      const random = createRandom(seed)
+      const reference = new VMState(256)
+      for (let address = 0; address < reference.memorySize; address++) {
+        reference.writeMemory8(address, random() & 0xff)
+      }
+      reference.setRegister("A", random())
+      reference.setRegister("B", random())
+      const compiled = reference.clone()
+
+      for (let i = 0; i < 2000; i++) {
+        const expected = InstructionExecutor.step(reference)
+        const actual = CompiledInstructionExecutor.step(compiled)
+
+        expect(actual).toEqual(expected)
+        expect(snapshotOf(compiled)).toEqual(snapshotOf(reference))
+      }
+    }
+  )
+
+  test("メモリが書き換えられるまでコンパイル結果を再利用する", () => {
+    const vm = new VMState(64)
+    vm.writeMemory8(0, 0x10) // INC_A
+
+    const first = CompiledInstructionExecutor.fetch(vm)
+    expect(CompiledInstructionExecutor.fetch(vm)).toBe(first)
+
+    vm.writeMemory8(0, 0x11) // INC_B
+    const second = CompiledInstructionExecutor.fetch(vm)
+    expect(second).not.toBe(first)
+    expect(second.decoded.mnemonic).toBe("INC_B")
+  })
+
+  test("自己書き換えしたコードは書き換え後の命令として実行される", () => {
+    const vm = new VMState(64)
+    vm.setRegister("A", 0x10)
+    vm.writeMemory8(0, 0x00) // NOP0
+    vm.writeMemory8(1, 0x41) // STORE_A -1 （アドレス0をINC_Aに書き換える）
+    vm.writeMemory8(2, 0xff)
+    vm.writeMemory8(3, 0xff)
+    vm.writeMemory8(4, 0x60) // JMP -4 （アドレス0へ戻る）
+    vm.writeMemory8(5, 0xfc)
+    vm.writeMemory8(6, 0xff)
+
+    CompiledInstructionExecutor.step(vm) // NOP0
+    CompiledInstructionExecutor.step(vm) // STORE_A
+    CompiledInstructionExecutor.step(vm) // JMP
+    const result = CompiledInstructionExecutor.step(vm)
+
+    expect(result.executed.mnemonic).toBe("INC_A")
+    expect(vm.getRegister("A")).toBe(0x11)
+  })
+
+  test("runはリファレンス実装と同じサイクル数を消費する", () => {
+    const random = createRandom(42)
+    const reference = new VMState(128)
+    for (let address = 0; address < reference.memorySize; address++) {
+      reference.writeMemory8(address, random() & 0xff)
+    }
+    const compiled = reference.clone()
+
+    for (let tick = 0; tick < 50; tick++) {
+      const expected = InstructionExecutor.run(reference, 10, VMUnitPortNone)
+      const actual = CompiledInstructionExecutor.run(compiled, 10, VMUnitPortNone)
+
+      expect(actual).toBe(expected)
+      expect(snapshotOf(compiled)).toEqual(snapshotOf(reference))
+    }
+  })
+})
@@ -0,0 +1,414 @@
+/**
+ * Synthetica Script VM クロージャコンパイル実行エンジン
+ *
+ * アドレスごとのデコード結果を専用のクロージャに変換してVMStateにキャッシュし、
+ * 実行時のニーモニック文字列による分岐を省く。レジスタは数値インデックスで参照する。
+ * キャッシュはデコード済み命令と同じく、命令を構成するメモリの書き換えで破棄される。
+ * 実行結果とサイクル数はInstructionExecutor（リファレンス実装）と一致させる
+ */
+
+import { REGISTER_NAMES, RegisterName, VMState } from "./vm-state"
+import { InstructionDecoder } from "./vm-decoder"
+import { DecodedInstruction } from "./vm-decoded-instructions"
+import { ExecutionResult, InstructionExecutor } from "./vm-executor"
+import { VMUnitPort, VMUnitPortNone } from "./vm-unit-port"
+
+/** コンパイル済み命令の実行関数（PCの更新まで行う） */
+export type CompiledHandler = (vm: VMState, unitPort: VMUnitPort) => ExecutionResult
+
+/** コンパイル済み命令 */
+export type CompiledInstruction = {
+  readonly decoded: DecodedInstruction
+  readonly execute: CompiledHandler
+}
+
+const A = REGISTER_NAMES.A
+const B = REGISTER_NAMES.B
+const C = REGISTER_NAMES.C
+const D = REGISTER_NAMES.D
+
+const registerIndexOf = (register: RegisterName): number => REGISTER_NAMES[register]
+
+/** 実行中に例外が発生した場合の結果（InstructionExecutor.executeと同じ形式） */
+const failureOf = (error: unknown): ExecutionResult => ({
+  case: "failure",
+  failureReason: `${error as string | Error}`,
+  cycles: 1,
+})
+
+/** デコード結果を実行関数に変換する */
+const compile = (decoded: DecodedInstruction): CompiledHandler => {
+  const length = decoded.length
+  const success: ExecutionResult = { case: "success", cycles: decoded.cycles }
+  const jumped: ExecutionResult = { case: "success", cycles: decoded.conditionalCycles }
+
+  // 実行後にPCを命令長だけ進める命令
+  const sequential =
+    (operation: (vm: VMState) => void): CompiledHandler =>
+    vm => {
+      operation(vm)
+      vm.advancePC(length)
+      return success
+    }
+
+  // PC相対の条件分岐
+  const branch =
+    (offset: number, condition: (vm: VMState) => boolean): CompiledHandler =>
+    vm => {
+      if (condition(vm)) {
+        vm.programCounter = vm.programCounter + offset
+        return jumped
+      }
+      vm.advancePC(length)
+      return success
+    }
+
+  const move = (destination: number, source: number): CompiledHandler =>
+    sequential(vm => vm.setRegisterAt(destination, vm.getRegisterAt(source)))
+
+  const increment = (register: number): CompiledHandler =>
+    sequential(vm => {
+      const result = vm.getRegisterAt(register) + 1
+      vm.setRegisterAt(register, result)
+      vm.updateZeroFlag(result)
+      vm.updateCarryFlagAdd(result)
+    })
+
+  const decrement = (register: number): CompiledHandler =>
+    sequential(vm => {
+      const value = vm.getRegisterAt(register)
+      vm.updateCarryFlagSub(value, 1)
+      const result = value - 1
+      vm.setRegisterAt(register, result)
+      vm.updateZeroFlag(result)
+    })
+
+  // 結果をAに格納し、キャリーフラグをクリアする論理演算
+  const logical = (operation: (a: number, b: number) => number): CompiledHandler =>
+    sequential(vm => {
+      const result = operation(vm.getRegisterAt(A), vm.getRegisterAt(B))
+      vm.setRegisterAt(A, result)
+      vm.updateZeroFlag(result)
+      vm.carryFlag = false
+    })
+
+  const push = (register: number): CompiledHandler =>
+    sequential(vm => vm.push16(vm.getRegisterAt(register)))
+
+  const pop = (register: number): CompiledHandler =>
+    sequential(vm => vm.setRegisterAt(register, vm.pop16()))
+
+  const conditionalMove = (
+    condition: (vm: VMState) => boolean,
+    destination: RegisterName,
+    source: RegisterName
+  ): CompiledHandler => {
+    const destinationIndex = registerIndexOf(destination)
+    const sourceIndex = registerIndexOf(source)
+    return sequential(vm => {
+      if (condition(vm)) {
+        vm.setRegisterAt(destinationIndex, vm.getRegisterAt(sourceIndex))
+      }
+    })
+  }
+
+  switch (decoded.mnemonic) {
+    case "NOP":
+    case "INVALID":
+    case "NOP0":
+    case "NOP1":
+    case "NOP5":
+      return vm => {
+        vm.advancePC(length)
+        return success
+      }
+
+    case "XCHG":
+      return sequential(vm => {
+        const a = vm.getRegisterAt(A)
+        vm.setRegisterAt(A, vm.getRegisterAt(B))
+        vm.setRegisterAt(B, a)
+      })
+
+    case "MOV_AB":
+      return move(B, A)
+    case "MOV_AD":
+      return move(D, A)
+    case "MOV_BA":
+      return move(A, B)
+    case "MOV_DA":
+      return move(A, D)
+    case "MOV_BC":
+      return move(C, B)
+    case "MOV_CB":
+      return move(B, C)
+    case "MOV_AC":
+      return move(C, A)
+    case "MOV_CA":
+      return move(A, C)
+    case "MOV_CD":
+      return move(D, C)
+    case "MOV_DC":
+      return move(C, D)
+    case "MOV_SP":
+      return sequential(vm => vm.setRegisterAt(A, vm.stackPointer))
+    case "SET_SP":
+      return sequential(vm => {
+        vm.stackPointer = vm.getRegisterAt(A)
+      })
+
+    case "INC_A":
+      return increment(A)
+    case "INC_B":
+      return increment(B)
+    case "INC_C":
+      return increment(C)
+    case "INC_D":
+      return increment(D)
+    case "DEC_A":
+      return decrement(A)
+    case "DEC_B":
+      return decrement(B)
+    case "DEC_C":
+      return decrement(C)
+    case "DEC_D":
+      return decrement(D)
+
+    case "ADD_AB":
+      return sequential(vm => {
+        const result = vm.getRegisterAt(A) + vm.getRegisterAt(B)
+        vm.setRegisterAt(A, result)
+        vm.updateZeroFlag(result)
+        vm.updateCarryFlagAdd(result)
+      })
+    case "SUB_AB":
+      return sequential(vm => {
+        const a = vm.getRegisterAt(A)
+        const b = vm.getRegisterAt(B)
+        const result = a - b
+        vm.setRegisterAt(A, result)
+        vm.updateZeroFlag(result)
+        vm.updateCarryFlagSub(a, b)
+      })
+    case "CMP_AB":
+      return sequential(vm => {
+        const a = vm.getRegisterAt(A)
+        const b = vm.getRegisterAt(B)
+        vm.updateZeroFlag(a - b)
+        vm.updateCarryFlagSub(a, b)
+      })
+    case "MUL_AB":
+      return logical((a, b) => (a * b) & 0xffff)
+    case "XOR_AB":
+      return logical((a, b) => a ^ b)
+    case "AND_AB":
+      return logical((a, b) => a & b)
+    case "OR_AB":
+      return logical((a, b) => a | b)
+    case "NOT_A":
+      return logical(a => ~a)
+
+    case "PUSH_A":
+      return push(A)
+    case "PUSH_B":
+      return push(B)
+    case "PUSH_C":
+      return push(C)
+    case "PUSH_D":
+      return push(D)
+    case "POP_A":
+      return pop(A)
+    case "POP_B":
+      return pop(B)
+    case "POP_C":
+      return pop(C)
+    case "POP_D":
+      return pop(D)
+
+    case "LOAD_A": {
+      const offset = decoded.operand.offset16
+      return sequential(vm => vm.setRegisterAt(A, vm.readMemory8(vm.programCounter + offset)))
+    }
+    case "STORE_A": {
+      const offset = decoded.operand.offset16
+      return sequential(vm =>
+        vm.writeMemory8(vm.programCounter + offset, vm.getRegisterAt(A) & 0xff)
+      )
+    }
+    case "LOAD_A_W": {
+      const offset = decoded.operand.offset16
+      return sequential(vm => vm.setRegisterAt(A, vm.readMemory16(vm.programCounter + offset)))
+    }
+    case "STORE_A_W": {
+      const offset = decoded.operand.offset16
+      return sequential(vm => vm.writeMemory16(vm.programCounter + offset, vm.getRegisterAt(A)))
+    }
+    case "LOAD_IND": {
+      const offset = decoded.operand.offset16
+      return sequential(vm =>
+        vm.setRegisterAt(A, vm.readMemory8((vm.getRegisterAt(B) + offset) & 0xffff))
+      )
+    }
+    case "STORE_IND": {
+      const offset = decoded.operand.offset16
+      return sequential(vm =>
+        vm.writeMemory8((vm.getRegisterAt(B) + offset) & 0xffff, vm.getRegisterAt(A) & 0xff)
+      )
+    }
+    case "LOAD_REG": {
+      const register = registerIndexOf(decoded.operand.register)
+      return sequential(vm => vm.setRegisterAt(A, vm.readMemory8(vm.getRegisterAt(register))))
+    }
+    case "STORE_REG": {
+      const register = registerIndexOf(decoded.operand.register)
+      return sequential(vm =>
+        vm.writeMemory8(vm.getRegisterAt(register), vm.getRegisterAt(A) & 0xff)
+      )
+    }
+    case "LOAD_ABS": {
+      const address = decoded.operand.address16
+      return sequential(vm => vm.setRegisterAt(A, vm.readMemory8(address)))
+    }
+    case "STORE_ABS": {
+      const address = decoded.operand.address16
+      return sequential(vm => vm.writeMemory8(address, vm.getRegisterAt(A) & 0xff))
+    }
+    case "LOAD_ABS_W": {
+      const address = decoded.operand.address16
+      return sequential(vm => vm.setRegisterAt(A, vm.readMemory16(address)))
+    }
+    case "STORE_ABS_W": {
+      const address = decoded.operand.address16
+      return sequential(vm => vm.writeMemory16(address, vm.getRegisterAt(A)))
+    }
+    case "LOAD_IMM": {
+      const immediate = decoded.operand.immediate16
+      return sequential(vm => vm.setRegisterAt(A, immediate))
+    }
+    case "LOAD_IMM_B": {
+      const immediate = decoded.operand.immediate16
+      return sequential(vm => vm.setRegisterAt(B, immediate))
+    }
+
+    case "JMP":
+      return branch(decoded.operand.offset16, () => true)
+    case "JZ":
+      return branch(decoded.operand.offset16, vm => vm.zeroFlag)
+    case "JNZ":
+      return branch(decoded.operand.offset16, vm => !vm.zeroFlag)
+    case "JC":
+      return branch(decoded.operand.offset16, vm => vm.carryFlag)
+    case "JNC":
+      return branch(decoded.operand.offset16, vm => !vm.carryFlag)
+    case "JGE":
+      return branch(decoded.operand.offset16, vm => !vm.carryFlag || vm.zeroFlag)
+    case "JL":
+      return branch(decoded.operand.offset16, vm => vm.carryFlag && !vm.zeroFlag)
+    case "JLE":
+      return branch(decoded.operand.offset16, vm => vm.carryFlag || vm.zeroFlag)
+    case "JG":
+      return branch(decoded.operand.offset16, vm => !vm.carryFlag && !vm.zeroFlag)
+    case "JMP_IND": {
+      const register = registerIndexOf(decoded.operand.register)
+      return vm => {
+        vm.programCounter = vm.getRegisterAt(register)
+        return jumped
+      }
+    }
+    case "JMP_ABS": {
+      const address = decoded.operand.address16
+      return vm => {
+        vm.programCounter = address
+        return jumped
+      }
+    }
+    case "CALL": {
+      const offset = decoded.operand.offset16
+      return vm => {
+        vm.setRegisterAt(C, vm.programCounter + length)
+        vm.programCounter = vm.programCounter + offset
+        return jumped
+      }
+    }
+    case "RET":
+      return vm => {
+        vm.programCounter = vm.getRegisterAt(C)
+        return jumped
+      }
+
+    case "CMOV_Z":
+      return conditionalMove(
+        vm => vm.zeroFlag,
+        decoded.operand.destinationRegister,
+        decoded.operand.sourceRegister
+      )
+    case "CMOV_NZ":
+      return conditionalMove(
+        vm => !vm.zeroFlag,
+        decoded.operand.destinationRegister,
+        decoded.operand.sourceRegister
+      )
+    case "CMOV_C":
+      return conditionalMove(
+        vm => vm.carryFlag,
+        decoded.operand.destinationRegister,
+        decoded.operand.sourceRegister
+      )
+    case "CMOV_NC":
+      return conditionalMove(
+        vm => !vm.carryFlag,
+        decoded.operand.destinationRegister,
+        decoded.operand.sourceRegister
+      )
+
+    default:
+      // ユニット操作・シフト・除算・未実装命令はリファレンス実装に委ねる
+      return (vm, unitPort) => InstructionExecutor.execute(vm, decoded, unitPort)
+  }
+}
+
+/** クロージャコンパイル実行エンジン */
+export const CompiledInstructionExecutor = {
+  /** PC位置のコンパイル済み命令を取得（キャッシュになければデコードしてコンパイルする） */
+  fetch(vm: VMState): CompiledInstruction {
+    const cached = vm.getCompiledInstruction(vm.programCounter)
+    if (cached !== undefined) {
+      return cached
+    }
+
+    const decoded = InstructionDecoder.decode(vm)
+    const compiled: CompiledInstruction = { decoded, execute: compile(decoded) }
+    vm.setCompiledInstruction(compiled)
+    return compiled
+  },
+
+  execute(vm: VMState, compiled: CompiledInstruction, unitPort: VMUnitPort): ExecutionResult {
+    try {
+      return compiled.execute(vm, unitPort)
+    } catch (error) {
+      return failureOf(error)
+    }
+  },
+
+  step(
+    vm: VMState,
+    unitPort: VMUnitPort = VMUnitPortNone
+  ): ExecutionResult & { executed: DecodedInstruction } {
+    const compiled = this.fetch(vm)
+    return {
+      ...this.execute(vm, compiled, unitPort),
+      executed: compiled.decoded,
+    }
+  },
+
+  /** 結果オブジェクトを生成せずにmaxCycles以上を消費するまで実行する */
+  run(vm: VMState, maxCycles: number, unitPort: VMUnitPort): number {
+    let totalCycles = 0
+
+    while (totalCycles < maxCycles) {
+      totalCycles += this.execute(vm, this.fetch(vm), unitPort).cycles
+    }
+
+    return totalCycles
+  },
+}
@@ -1,5 +1,6 @@
 import { VMState } from "./vm-state"
 import { InstructionDecoder } from "./vm-decoder"
+import { InstructionExecutor } from "./vm-executor"
 
 // 各命令が正常にデコードされるかの検証は vm-instructions.test.ts の各命令の動作検証に含まれるので、ここでは基本的な命令型ごとのデコードの検証のみを行う
 
@@ -247,4 +248,60 @@ describe("InstructionDecoder", () => {
       expect(decoded.operand.immediate16).toEqual(0xcdab)
     })
   })
+
+  describe("デコードキャッシュ", () => {
+    test("書き換えられていないアドレスは前回のデコード結果を返す", () => {
+      vm.writeMemory8(0, 0x40) // LOAD_A
+      vm.writeMemory8(1, 0x12)
+      vm.writeMemory8(2, 0x34)
+
+      const first = InstructionDecoder.decodeCached(vm)
+      const second = InstructionDecoder.decodeCached(vm)
+
+      expect(second).toBe(first)
+    })
+
+    test("オペランドの書き換えでデコード結果が破棄される", () => {
+      vm.writeMemory8(0, 0x40) // LOAD_A
+      vm.writeMemory8(1, 0x12)
+      vm.writeMemory8(2, 0x34)
+      InstructionDecoder.decodeCached(vm)
+
+      vm.writeMemory8(2, 0x00)
+      const decoded = InstructionDecoder.decodeCached(vm)
+
+      if (decoded.mnemonic !== "LOAD_A") {
+        expect(decoded.mnemonic).toBe("LOAD_A")
+        fail()
+      }
+      expect(decoded.operand.offset16).toBe(0x0012)
+    })
+
+    test("メモリ配列を直接取得するとデコード結果が破棄される", () => {
+      InstructionDecoder.decodeCached(vm) // NOP0
+
+      vm.getMemoryArray()[0] = 0x10 // INC_A
+
+      expect(InstructionDecoder.decodeCached(vm).mnemonic).toBe("INC_A")
+    })
+
+    test("自己書き換えしたコードは書き換え後の命令として実行される", () => {
+      vm.setRegister("A", 0x10)
+      vm.writeMemory8(0, 0x00) // NOP0
+      vm.writeMemory8(1, 0x41) // STORE_A -1 （アドレス0をINC_Aに書き換える）
+      vm.writeMemory8(2, 0xff)
+      vm.writeMemory8(3, 0xff)
+      vm.writeMemory8(4, 0x60) // JMP -4
+      vm.writeMemory8(5, 0xfc)
+      vm.writeMemory8(6, 0xff)
+
+      expect(InstructionExecutor.step(vm).executed.mnemonic).toBe("NOP0")
+      InstructionExecutor.step(vm)
+      InstructionExecutor.step(vm)
+      expect(vm.programCounter).toBe(0)
+
+      expect(InstructionExecutor.step(vm).executed.mnemonic).toBe("INC_A")
+      expect(vm.getRegister("A")).toBe(0x11)
+    })
+  })
 })
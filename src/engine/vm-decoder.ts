@@ -20,7 +20,16 @@ export class InstructionDecoder {
    * @returns デコード結果
    */
   public static decode(vm: VMState): DecodedInstruction {
-    const address = vm.programCounter
+    return this.decodeAt(vm, vm.programCounter)
+  }
+
+  /**
+   * 指定アドレスから命令をデコード
+   * @param vm VM状態
+   * @param address 命令のアドレス
+   * @returns デコード結果
+   */
+  public static decodeAt(vm: VMState, address: number): DecodedInstruction {
     const opcode = vm.readMemory8(address)
     const instruction = getInstruction(opcode)
 
@@ -224,6 +233,23 @@ export class InstructionDecoder {
     }
   }
 
+  /**
+   * 現在のPCから命令をデコード（VM状態のキャッシュを利用）
+   * 同じアドレスのメモリが書き換えられていなければ前回のデコード結果を返す
+   * @param vm VM状態
+   * @returns デコード結果
+   */
+  public static decodeCached(vm: VMState): DecodedInstruction {
+    const cached = vm.getDecodedInstruction(vm.programCounter)
+    if (cached !== undefined) {
+      return cached
+    }
+
+    const decoded = this.decode(vm)
+    vm.setDecodedInstruction(decoded)
+    return decoded
+  }
+
   /**
    * 命令のフォーマット済み文字列を生成
    * @param _decoded デコード結果
@@ -930,7 +930,7 @@ export const InstructionExecutor = {
     vm: VMState,
     unitPort: VMUnitPort = VMUnitPortNone
   ): ExecutionResult & { executed: DecodedInstruction } {
-    const decoded = InstructionDecoder.decode(vm)
+    const decoded = InstructionDecoder.decodeCached(vm)
     return {
       ...this.execute(vm, decoded, unitPort),
       executed: decoded,
@@ -0,0 +1,166 @@
+/**
+ * JitInstructionExecutor テスト
+ */
+
+import { JIT_HOT_THRESHOLD, JitInstructionExecutor } from "./vm-jit-executor"
+import { InstructionExecutor } from "./vm-executor"
+import { VMState } from "./vm-state"
+import { VMUnitPortNone } from "./vm-unit-port"
+import { InstructionDecoder } from "./vm-decoder"
+
+// 再現性のある疑似乱数（線形合同法）
+const createRandom = (seed: number): (() => number) => {
+  let state = seed
+  return () => {
+    state = (state * 1664525 + 1013904223) >>> 0
+    return state
+  }
+}
+
+const snapshotOf = (vm: VMState) => ({
+  programCounter: vm.programCounter,
+  stackPointer: vm.stackPointer,
+  zeroFlag: vm.zeroFlag,
+  carryFlag: vm.carryFlag,
+  registers: [vm.getRegister("A"), vm.getRegister("B"), vm.getRegister("C"), vm.getRegister("D")],
+  memory: Array.from(vm.readMemoryBlock(0, vm.memorySize)),
+})
+
+const createVM = (memorySize: number, program: number[]): VMState => {
+  const vm = new VMState(memorySize)
+  program.forEach((byte, address) => vm.writeMemory8(address, byte))
+  return vm
+}
+
+/** 両方の実装をtickごとに同じ予算で実行し、状態とサイクル数を比較する */
+const expectSameExecution = (reference: VMState, ticks: number, cyclesPerTick: number): void => {
+  const jit = reference.clone()
+  for (let tick = 0; tick < ticks; tick++) {
+    const expected = InstructionExecutor.run(reference, cyclesPerTick, VMUnitPortNone)
+    const actual = JitInstructionExecutor.run(jit, cyclesPerTick, VMUnitPortNone)
+
+    expect(actual).toBe(expected)
+    expect(snapshotOf(jit)).toEqual(snapshotOf(reference))
+  }
+}
+
+describe("JitInstructionExecutor", () => {
+  // カウンタループ: AがBに達するまでINC_Aを繰り返し、達したらAを0に戻す
+  const counterLoop = [
+    0x10, // INC_A
+    0x1e, // CMP_AB
+    0x62, // JNZ -2
+    0xfe,
+    0xff,
+    0xe0, // LOAD_IMM 0
+    0x00,
+    0x00,
+    0x00,
+    0x00,
+    0x60, // JMP -10
+    0xf6,
+    0xff,
+  ]
+
+  test.each([1, 2, 3, 7, 10, 100])(
+    "ループはサイクル予算の境界を含めてリファレンス実装と一致する（%i cycles/tick）",
+    cyclesPerTick => {
+      const vm = createVM(64, counterLoop)
+      vm.setRegister("B", 50)
+
+      expectSameExecution(vm, 200, cyclesPerTick)
+    }
+  )
+
+  test.each([1, 2, 3, 4, 5, 6, 7, 8])(
+    "ランダムなプログラムでリファレンス実装と同じ結果・サイクル数になる（seed=%i）",
+    seed => {
+      const random = createRandom(seed)
+      const vm = new VMState(64)
+      for (let address = 0; address < vm.memorySize; address++) {
+        vm.writeMemory8(address, random() & 0xff)
+      }
+      vm.setRegister("A", random())
+      vm.setRegister("B", random())
+
+      expectSameExecution(vm, 100, 1 + (seed % 5) * 7)
+    }
+  )
+
+  test("ブロック内のコードを書き換えると書き換え後の命令が実行される", () => {
+    // STORE_A +3 でアドレス3（INC_Bの位置）を書き換えた後、JMPで先頭へ戻る
+    const vm = createVM(64, [
+      0x41, // STORE_A +3（アドレス3）
+      0x03,
+      0x00,
+      0x11, // INC_B（実行中にAの値で上書きされる）
+      0x60, // JMP -4
+      0xfc,
+      0xff,
+    ])
+    vm.setRegister("A", 0x11) // INC_B のまま書き込み続ける
+
+    expectSameExecution(vm, 20, JIT_HOT_THRESHOLD)
+
+    vm.setRegister("A", 0x12) // INC_C に書き換える
+    expectSameExecution(vm, 20, JIT_HOT_THRESHOLD)
+  })
+
+  test("実行中のメモリ配列の直接書き換えを検出する", () => {
+    const reference = createVM(64, counterLoop)
+    reference.setRegister("B", 0xffff)
+    const jit = reference.clone()
+
+    InstructionExecutor.run(reference, 500, VMUnitPortNone)
+    JitInstructionExecutor.run(jit, 500, VMUnitPortNone)
+
+    reference.getMemoryArray()[0] = 0x11 // INC_B
+    jit.getMemoryArray()[0] = 0x11
+
+    expect(JitInstructionExecutor.run(jit, 100, VMUnitPortNone)).toBe(
+      InstructionExecutor.run(reference, 100, VMUnitPortNone)
+    )
+    expect(snapshotOf(jit)).toEqual(snapshotOf(reference))
+  })
+
+  test("ブロックを生成できない命令は書き換えられるまで生成を試みない", () => {
+    // SHL（ブロックに含められない）とJMPのループ
+    const reference = createVM(64, [
+      0xc2, // SHL
+      0x00,
+      0x00,
+      0x00,
+      0x00,
+      0x60, // JMP -5
+      0xfb,
+      0xff,
+    ])
+    reference.setRegister("A", 1)
+    const jit = reference.clone()
+    const decodeAt = jest.spyOn(InstructionDecoder, "decodeAt")
+
+    try {
+      JitInstructionExecutor.run(jit, JIT_HOT_THRESHOLD * 20, VMUnitPortNone)
+      const decodeCount = decodeAt.mock.calls.length
+
+      // 先頭の命令は変わらないため、生成もデコードも行われない
+      JitInstructionExecutor.run(jit, JIT_HOT_THRESHOLD * 200, VMUnitPortNone)
+      expect(decodeAt.mock.calls.length).toBe(decodeCount)
+    } finally {
+      decodeAt.mockRestore()
+    }
+
+    // ブロックに含められる命令（NOP5）に書き換えた後はリファレンス実装と一致する
+    InstructionExecutor.run(reference, JIT_HOT_THRESHOLD * 20, VMUnitPortNone)
+    InstructionExecutor.run(reference, JIT_HOT_THRESHOLD * 200, VMUnitPortNone)
+    expect(snapshotOf(jit)).toEqual(snapshotOf(reference))
+    reference.writeMemory8(0, 0xf0)
+    jit.writeMemory8(0, 0xf0)
+    for (let tick = 0; tick < 40; tick++) {
+      expect(JitInstructionExecutor.run(jit, JIT_HOT_THRESHOLD, VMUnitPortNone)).toBe(
+        InstructionExecutor.run(reference, JIT_HOT_THRESHOLD, VMUnitPortNone)
+      )
+    }
+    expect(snapshotOf(jit)).toEqual(snapshotOf(reference))
+  })
+})
@@ -0,0 +1,598 @@
+/**
+ * Synthetica Script VM 基本ブロックJIT実行エンジン
+ *
+ * 実行回数が閾値を超えたアドレスから分岐命令までの基本ブロックを
+ * JavaScript関数に変換して実行する。レジスタとフラグはローカル変数に載せ、
+ * ブロック内で後続の命令に上書きされるフラグは計算しない。
+ * ブロックの先頭へ戻る分岐は、サイクル予算の範囲内で生成した関数の中で繰り返す。
+ * 以下の場合はクロージャコンパイル実行エンジン（1命令ずつの実行）に戻る
+ * - ユニット操作など、ブロックに含められない命令
+ * - ブロック自身のコードを書き換えるメモリ書き込み（書き込んだ命令の直後で抜ける）
+ * - ブロック全体を実行するとサイクル予算の境界を越える場合
+ * 実行結果とサイクル数はInstructionExecutor（リファレンス実装）と一致させる
+ */
+
+import { RegisterName, VMState } from "./vm-state"
+import { InstructionDecoder } from "./vm-decoder"
+import { DecodedInstruction } from "./vm-decoded-instructions"
+import { ExecutionResult } from "./vm-executor"
+import { CompiledInstructionExecutor } from "./vm-compiled-executor"
+import type { CompiledInstruction } from "./vm-compiled-executor"
+import { VMUnitPort, VMUnitPortNone } from "./vm-unit-port"
+
+/** ブロックを生成するまでの実行回数 */
+export const JIT_HOT_THRESHOLD = 32
+
+/** 1ブロックに含める最大命令数 */
+export const JIT_MAX_BLOCK_INSTRUCTIONS = 32
+
+/** 生成したブロック */
+type JitBlock = {
+  /** 生成時のコード（実行前に一致を確認する） */
+  readonly code: Uint8Array
+  /** 最後の命令より前の命令のサイクル数合計 */
+  readonly cyclesBeforeLast: number
+  /**
+   * ブロックを実行し、消費したサイクル数を返す
+   * 先頭へ戻る分岐は、残りのサイクル予算でブロック全体を実行できる限りブロック内で繰り返す
+   */
+  readonly run: (vm: VMState, remainingCycles: number) => number
+}
+
+/** VMごとのJIT状態 */
+type JitState = {
+  readonly heat: Uint8Array
+  readonly blocks: (JitBlock | undefined)[]
+  /**
+   * ブロックを生成できなかったアドレスの、その時点のコンパイル済み命令
+   * VM側のキャッシュと同じものが残っている間（デコード済み命令と同時に破棄されるまで）は
+   * 先頭の命令が変わっていないため、再び生成を試みない
+   */
+  readonly uncompilable: (CompiledInstruction | undefined)[]
+}
+
+type FlagUsage = {
+  readonly reads: boolean
+  readonly writes: boolean
+}
+
+const jitStates = new WeakMap<VMState, JitState>()
+
+const jitStateOf = (vm: VMState): JitState => {
+  let state = jitStates.get(vm)
+  if (state == null) {
+    state = {
+      heat: new Uint8Array(vm.memorySize),
+      blocks: new Array<JitBlock | undefined>(vm.memorySize),
+      uncompilable: new Array<CompiledInstruction | undefined>(vm.memorySize),
+    }
+    jitStates.set(vm, state)
+  }
+  return state
+}
+
+/** 生成コード上のレジスタ変数名 */
+const REGISTER_VARIABLES: Readonly<Record<RegisterName, string>> = {
+  A: "a",
+  B: "b",
+  C: "c",
+  D: "d",
+}
+
+/** ブロック終端となる分岐命令の分岐条件（無条件分岐はnull） */
+const BRANCH_CONDITIONS: Readonly<Record<string, string | null>> = {
+  JMP: null,
+  JZ: "z",
+  JNZ: "!z",
+  JC: "cf",
+  JNC: "!cf",
+  JGE: "!cf || z",
+  JL: "cf && !z",
+  JLE: "cf || z",
+  JG: "!cf && !z",
+  JMP_IND: null,
+  JMP_ABS: null,
+  CALL: null,
+  RET: null,
+}
+
+/** ゼロ・キャリーフラグを両方更新する命令 */
+const FLAG_WRITING_MNEMONICS = new Set([
+  "INC_A",
+  "INC_B",
+  "INC_C",
+  "INC_D",
+  "DEC_A",
+  "DEC_B",
+  "DEC_C",
+  "DEC_D",
+  "ADD_AB",
+  "SUB_AB",
+  "CMP_AB",
+  "MUL_AB",
+  "XOR_AB",
+  "AND_AB",
+  "OR_AB",
+  "NOT_A",
+])
+
+/** メモリに書き込む命令（ブロック自身を書き換えた場合にブロックを抜ける） */
+const MEMORY_WRITING_MNEMONICS = new Set([
+  "PUSH_A",
+  "PUSH_B",
+  "PUSH_C",
+  "PUSH_D",
+  "STORE_A",
+  "STORE_A_W",
+  "STORE_IND",
+  "STORE_REG",
+  "STORE_IND_REG",
+  "STORE_ABS",
+  "STORE_ABS_W",
+])
+
+const isBranch = (decoded: DecodedInstruction): boolean => decoded.mnemonic in BRANCH_CONDITIONS
+
+const flagUsageOf = (decoded: DecodedInstruction): FlagUsage => {
+  if (FLAG_WRITING_MNEMONICS.has(decoded.mnemonic)) {
+    return { reads: false, writes: true }
+  }
+  const condition = BRANCH_CONDITIONS[decoded.mnemonic] ?? null
+  if (decoded.mnemonic.startsWith("CMOV_") || condition != null) {
+    return { reads: true, writes: false }
+  }
+  return { reads: false, writes: false }
+}
+
+/** 基本ブロックのコード生成 */
+class BlockCompiler {
+  private readonly _lines: string[] = []
+  private readonly _start: number
+  private readonly _end: number
+  private readonly _memorySize: number
+  private readonly _cyclesBeforeLast: number
+
+  public constructor(start: number, end: number, memorySize: number, cyclesBeforeLast: number) {
+    this._start = start
+    this._end = end
+    this._memorySize = memorySize
+    this._cyclesBeforeLast = cyclesBeforeLast
+  }
+
+  /** 生成したJavaScriptの関数本体 */
+  public body(): string {
+    return [
+      "let a = vm.getRegisterAt(0), b = vm.getRegisterAt(1)",
+      "let c = vm.getRegisterAt(2), d = vm.getRegisterAt(3)",
+      "let z = vm.zeroFlag, cf = vm.carryFlag",
+      "let used = 0",
+      "for (;;) {",
+      ...this._lines,
+      "}",
+    ].join("\n")
+  }
+
+  /** ブロックを抜ける（状態を書き戻し、PCを設定してサイクル数を返す） */
+  public exit(programCounter: string, cycles: number): string {
+    return [
+      "vm.setRegisterAt(0, a); vm.setRegisterAt(1, b)",
+      "vm.setRegisterAt(2, c); vm.setRegisterAt(3, d)",
+      "vm.zeroFlag = z; vm.carryFlag = cf",
+      `vm.programCounter = ${programCounter}`,
+      `return used + ${cycles}`,
+    ].join("\n")
+  }
+
+  public emit(line: string): void {
+    this._lines.push(line)
+  }
+
+  /**
+   * 命令のコードを生成する
+   * @param decoded デコード結果
+   * @param cyclesBefore この命令より前のサイクル数合計
+   * @param liveAfter この命令の直後にフラグの値が必要か
+   */
+  public emitInstruction(
+    decoded: DecodedInstruction,
+    cyclesBefore: number,
+    liveAfter: boolean
+  ): void {
+    const address = decoded.address
+    const next = (address + decoded.length) % this._memorySize
+    const cycles = cyclesBefore + decoded.cycles
+    const jumpCycles = cyclesBefore + decoded.conditionalCycles
+    const setFlags = (zero: string, carry: string): string =>
+      liveAfter ? `z = ${zero}; cf = ${carry}` : ""
+    // 書き込み先がブロック内であれば、この命令の直後でブロックを抜ける
+    const checkWrite = (...targets: string[]): string => {
+      const hits = targets.map(t => `((${t}) >= ${this._start} && (${t}) < ${this._end})`)
+      return `if (${hits.join(" || ")}) {\n${this.exit(`${next}`, cycles)}\n}`
+    }
+    const size = this._memorySize
+    const r = (register: RegisterName): string => REGISTER_VARIABLES[register]
+
+    switch (decoded.mnemonic) {
+      case "NOP":
+      case "NOP0":
+      case "NOP1":
+      case "NOP5":
+        return
+      case "XCHG":
+        this.emit("{ const t = a; a = b; b = t }")
+        return
+      case "MOV_AB":
+        this.emit("b = a")
+        return
+      case "MOV_AD":
+        this.emit("d = a")
+        return
+      case "MOV_BA":
+        this.emit("a = b")
+        return
+      case "MOV_DA":
+        this.emit("a = d")
+        return
+      case "MOV_BC":
+        this.emit("c = b")
+        return
+      case "MOV_CB":
+        this.emit("b = c")
+        return
+      case "MOV_AC":
+        this.emit("c = a")
+        return
+      case "MOV_CA":
+        this.emit("a = c")
+        return
+      case "MOV_CD":
+        this.emit("d = c")
+        return
+      case "MOV_DC":
+        this.emit("c = d")
+        return
+      case "MOV_SP":
+        this.emit("a = vm.stackPointer & 0xffff")
+        return
+      case "SET_SP":
+        this.emit("vm.stackPointer = a")
+        return
+
+      case "INC_A":
+      case "INC_B":
+      case "INC_C":
+      case "INC_D": {
+        const v = r(decoded.mnemonic.slice(4) as RegisterName)
+        const flags = setFlags(`${v} === 0`, "t > 0xffff")
+        this.emit(`{ const t = ${v} + 1; ${v} = t & 0xffff; ${flags} }`)
+        return
+      }
+      case "DEC_A":
+      case "DEC_B":
+      case "DEC_C":
+      case "DEC_D": {
+        const v = r(decoded.mnemonic.slice(4) as RegisterName)
+        const flags = setFlags(`${v} === 0`, "t")
+        this.emit(`{ const t = ${v} < 1; ${v} = (${v} - 1) & 0xffff; ${flags} }`)
+        return
+      }
+      case "ADD_AB":
+        this.emit(`{ const t = a + b; a = t & 0xffff; ${setFlags("a === 0", "t > 0xffff")} }`)
+        return
+      case "SUB_AB":
+        this.emit(`{ const t = a < b; a = (a - b) & 0xffff; ${setFlags("a === 0", "t")} }`)
+        return
+      case "CMP_AB":
+        this.emit(setFlags("((a - b) & 0xffff) === 0", "a < b"))
+        return
+      case "MUL_AB":
+        this.emit(`a = (a * b) & 0xffff; ${setFlags("a === 0", "false")}`)
+        return
+      case "XOR_AB":
+        this.emit(`a = (a ^ b) & 0xffff; ${setFlags("a === 0", "false")}`)
+        return
+      case "AND_AB":
+        this.emit(`a = (a & b) & 0xffff; ${setFlags("a === 0", "false")}`)
+        return
+      case "OR_AB":
+        this.emit(`a = (a | b) & 0xffff; ${setFlags("a === 0", "false")}`)
+        return
+      case "NOT_A":
+        this.emit(`a = ~a & 0xffff; ${setFlags("a === 0", "false")}`)
+        return
+
+      case "PUSH_A":
+      case "PUSH_B":
+      case "PUSH_C":
+      case "PUSH_D": {
+        const v = r(decoded.mnemonic.slice(5) as RegisterName)
+        const check = checkWrite("w", `(w + 1) % ${size}`)
+        this.emit(`{ vm.push16(${v}); const w = vm.stackPointer; ${check} }`)
+        return
+      }
+      case "POP_A":
+      case "POP_B":
+      case "POP_C":
+      case "POP_D": {
+        const v = r(decoded.mnemonic.slice(4) as RegisterName)
+        this.emit(`${v} = vm.pop16() & 0xffff`)
+        return
+      }
+
+      case "LOAD_A":
+        this.emit(`a = vm.readMemory8(${address + decoded.operand.offset16})`)
+        return
+      case "STORE_A":
+        this.emitStore8(`${address + decoded.operand.offset16}`, checkWrite)
+        return
+      case "LOAD_A_W":
+        this.emit(`a = vm.readMemory16(${address + decoded.operand.offset16})`)
+        return
+      case "STORE_A_W":
+        this.emitStore16(`${address + decoded.operand.offset16}`, checkWrite)
+        return
+      case "LOAD_IND":
+        this.emit(`a = vm.readMemory8((b + ${decoded.operand.offset16}) & 0xffff)`)
+        return
+      case "STORE_IND":
+        this.emitStore8(`(b + ${decoded.operand.offset16}) & 0xffff`, checkWrite)
+        return
+      case "LOAD_REG":
+        this.emit(`a = vm.readMemory8(${r(decoded.operand.register)})`)
+        return
+      case "STORE_REG":
+        this.emitStore8(r(decoded.operand.register), checkWrite)
+        return
+      case "LOAD_IND_REG":
+        this.emit(`a = vm.readMemory8(vm.readMemory16(${decoded.operand.address16}))`)
+        return
+      case "STORE_IND_REG":
+        this.emitStore8(`vm.readMemory16(${decoded.operand.address16})`, checkWrite)
+        return
+      case "LOAD_ABS":
+        this.emit(`a = vm.readMemory8(${decoded.operand.address16})`)
+        return
+      case "STORE_ABS":
+        this.emitStore8(`${decoded.operand.address16}`, checkWrite)
+        return
+      case "LOAD_ABS_W":
+        this.emit(`a = vm.readMemory16(${decoded.operand.address16})`)
+        return
+      case "STORE_ABS_W":
+        this.emitStore16(`${decoded.operand.address16}`, checkWrite)
+        return
+      case "LOAD_IMM":
+        this.emit(`a = ${decoded.operand.immediate16 & 0xffff}`)
+        return
+      case "LOAD_IMM_B":
+        this.emit(`b = ${decoded.operand.immediate16 & 0xffff}`)
+        return
+
+      case "CMOV_Z":
+      case "CMOV_NZ":
+      case "CMOV_C":
+      case "CMOV_NC": {
+        const condition = { CMOV_Z: "z", CMOV_NZ: "!z", CMOV_C: "cf", CMOV_NC: "!cf" }[
+          decoded.mnemonic
+        ]
+        const destination = r(decoded.operand.destinationRegister)
+        this.emit(`if (${condition}) { ${destination} = ${r(decoded.operand.sourceRegister)} }`)
+        return
+      }
+
+      case "JMP":
+      case "JZ":
+      case "JNZ":
+      case "JC":
+      case "JNC":
+      case "JG":
+      case "JLE":
+      case "JGE":
+      case "JL": {
+        const target = address + decoded.operand.offset16
+        const jumped =
+          target === this._start ? this.loopBack(jumpCycles) : this.exit(`${target}`, jumpCycles)
+        const condition = BRANCH_CONDITIONS[decoded.mnemonic] ?? null
+        if (condition == null) {
+          this.emit(jumped)
+        } else {
+          this.emit(`if (${condition}) {\n${jumped}\n}`)
+          this.emit(this.exit(`${next}`, cycles))
+        }
+        return
+      }
+      case "JMP_IND":
+        this.emit(this.exit(r(decoded.operand.register), jumpCycles))
+        return
+      case "JMP_ABS":
+        this.emit(this.exit(`${decoded.operand.address16}`, jumpCycles))
+        return
+      case "CALL":
+        this.emit(`c = ${(address + decoded.length) & 0xffff}`)
+        this.emit(this.exit(`${address + decoded.operand.offset16}`, jumpCycles))
+        return
+      case "RET":
+        this.emit(this.exit("c", jumpCycles))
+        return
+
+      default:
+        throw new Error(`${decoded.mnemonic} cannot be compiled`)
+    }
+  }
+
+  /** ブロックの先頭へ戻る（予算が足りなければ先頭を指してブロックを抜ける） */
+  private loopBack(cycles: number): string {
+    return [
+      `used += ${cycles}`,
+      `if (used + ${this._cyclesBeforeLast} < remainingCycles) {`,
+      "continue",
+      "}",
+      this.exit(`${this._start}`, 0),
+    ].join("\n")
+  }
+
+  private emitStore8(target: string, checkWrite: (...targets: string[]) => string): void {
+    const size = this._memorySize
+    this.emit(`{ const w = ${target}; vm.writeMemory8(w, a & 0xff); ${checkWrite(`w % ${size}`)} }`)
+  }
+
+  private emitStore16(target: string, checkWrite: (...targets: string[]) => string): void {
+    const size = this._memorySize
+    const check = checkWrite(`w % ${size}`, `(w + 1) % ${size}`)
+    this.emit(`{ const w = ${target}; vm.writeMemory16(w, a); ${check} }`)
+  }
+}
+
+/** ブロックに含められる命令か */
+const isCompilable = (decoded: DecodedInstruction): boolean => {
+  switch (decoded.mnemonic) {
+    case "INVALID":
+    case "UNIT_MEM_READ":
+    case "UNIT_MEM_WRITE":
+    case "UNIT_MEM_READ_REG":
+    case "UNIT_MEM_WRITE_REG":
+    case "UNIT_EXISTS":
+    case "SEARCH_F":
+    case "SEARCH_B":
+    case "SEARCH_F_MAX":
+    case "SEARCH_B_MAX":
+    case "ADD_E32":
+    case "SUB_E32":
+    case "CMP_E32":
+    case "SHR_E10":
+    case "SHL_E10":
+    case "DIV_AB":
+    case "SHL":
+    case "SHR":
+    case "SAR":
+      return false
+    default:
+      return true
+  }
+}
+
+/**
+ * 指定アドレスから始まる基本ブロックを生成する
+ * @returns 先頭の命令がブロックに含められない場合null
+ */
+const compileBlock = (vm: VMState, start: number): JitBlock | null => {
+  const instructions: DecodedInstruction[] = []
+  let address = start
+
+  while (instructions.length < JIT_MAX_BLOCK_INSTRUCTIONS) {
+    const decoded = InstructionDecoder.decodeAt(vm, address)
+    // メモリ末尾で折り返す命令はブロックに含めない
+    if (!isCompilable(decoded) || address + decoded.length > vm.memorySize) {
+      break
+    }
+    instructions.push(decoded)
+    address += decoded.length
+    if (isBranch(decoded) || address >= vm.memorySize) {
+      break
+    }
+  }
+
+  if (instructions.length === 0) {
+    return null
+  }
+
+  // 後ろから辿り、後続の命令に上書きされるまで読まれないフラグの計算を省く
+  // ブロックの出口（末尾・メモリ書き込み後）ではフラグを書き戻すため常に必要
+  const liveAfter: boolean[] = new Array<boolean>(instructions.length)
+  let live = true
+  for (let i = instructions.length - 1; i >= 0; i--) {
+    const decoded = instructions[i]
+    if (decoded == null) {
+      continue
+    }
+    if (MEMORY_WRITING_MNEMONICS.has(decoded.mnemonic)) {
+      live = true
+    }
+    liveAfter[i] = live
+    const usage = flagUsageOf(decoded)
+    live = usage.reads || (live && !usage.writes)
+  }
+
+  const totalCycles = instructions.reduce((sum, decoded) => sum + decoded.cycles, 0)
+  const cyclesBeforeLast = totalCycles - (instructions[instructions.length - 1]?.cycles ?? 0)
+  const compiler = new BlockCompiler(start, address, vm.memorySize, cyclesBeforeLast)
+  let cycles = 0
+  instructions.forEach((decoded, i) => {
+    compiler.emitInstruction(decoded, cycles, liveAfter[i] ?? true)
+    cycles += decoded.cycles
+  })
+
+  const last = instructions[instructions.length - 1]
+  if (last != null && !isBranch(last)) {
+    compiler.emit(compiler.exit(`${address % vm.memorySize}`, cycles))
+  }
+
+  // eslint-disable-next-line @typescript-eslint/no-implied-eval
+  const run = new Function("vm", "remainingCycles", compiler.body()) as JitBlock["run"]
+
+  return {
+    code: vm.readMemoryBlock(start, address - start),
+    cyclesBeforeLast,
+    run,
+  }
+}
+
+/** 基本ブロックJIT実行エンジン */
+export const JitInstructionExecutor = {
+  /** 1命令ずつ実行する（デバッグ用。ブロックは使用しない） */
+  step(
+    vm: VMState,
+    unitPort: VMUnitPort = VMUnitPortNone
+  ): ExecutionResult & { executed: DecodedInstruction } {
+    return CompiledInstructionExecutor.step(vm, unitPort)
+  },
+
+  /** maxCycles以上を消費するまで実行する */
+  run(vm: VMState, maxCycles: number, unitPort: VMUnitPort): number {
+    const { heat, blocks, uncompilable } = jitStateOf(vm)
+    let totalCycles = 0
+
+    while (totalCycles < maxCycles) {
+      const programCounter = vm.programCounter
+      let block = blocks[programCounter]
+
+      if (block != null && !vm.matchesMemory(programCounter, block.code)) {
+        // コードが書き換えられたブロックは破棄する
+        blocks[programCounter] = undefined
+        block = undefined
+      }
+
+      // ブロックを生成できなかった命令は、書き換えられるまで実行回数を数えない
+      const rejected = uncompilable[programCounter]
+      if (
+        block == null &&
+        (rejected == null || rejected !== vm.getCompiledInstruction(programCounter))
+      ) {
+        const count = (heat[programCounter] ?? 0) + 1
+        if (count >= JIT_HOT_THRESHOLD) {
+          heat[programCounter] = 0
+          block = compileBlock(vm, programCounter) ?? undefined
+          blocks[programCounter] = block
+          uncompilable[programCounter] =
+            block == null ? CompiledInstructionExecutor.fetch(vm) : undefined
+        } else {
+          heat[programCounter] = count
+        }
+      }
+
+      // ブロックの最後の命令まで予算内で実行できる場合のみブロックを使う
+      if (block != null && totalCycles + block.cyclesBeforeLast < maxCycles) {
+        totalCycles += block.run(vm, maxCycles - totalCycles)
+        continue
+      }
+
+      totalCycles += CompiledInstructionExecutor.execute(
+        vm,
+        CompiledInstructionExecutor.fetch(vm),
+        unitPort
+      ).cycles
+    }
+
+    return totalCycles
+  },
+}
@@ -2,6 +2,9 @@
  * Synthetica Script VM の状態管理
  */
 
+import type { DecodedInstruction } from "./vm-decoded-instructions"
+import type { CompiledInstruction } from "./vm-compiled-executor"
+
 /** レジスタ名 */
 export const REGISTER_NAMES = {
   A: 0,
@@ -22,6 +25,12 @@ export const FLAG_NAMES = {
 /** フラグ名の型 */
 export type FlagName = keyof typeof FLAG_NAMES
 
+/**
+ * 命令の最大バイト長
+ * メモリ書き込み時、この範囲内の手前のアドレスから始まるデコード済み命令を無効化する
+ */
+export const MAX_INSTRUCTION_LENGTH = 5
+
 /** VM状態 */
 export class VMState {
   /** プログラムカウンタ（16bit） */
@@ -43,6 +52,12 @@ export class VMState {
   /** メモリサイズ */
   private readonly _memorySize: number
 
+  /** アドレスごとのデコード済み命令（未使用の間はnull） */
+  private _decodedInstructions: (DecodedInstruction | undefined)[] | null = null
+
+  /** アドレスごとのコンパイル済み命令（未使用の間はnull） */
+  private _compiledInstructions: (CompiledInstruction | undefined)[] | null = null
+
   /** プログラムカウンタ取得 */
   public get programCounter(): number {
     return this._programCounter
@@ -109,11 +124,58 @@ export class VMState {
     this._registers = new Uint16Array(4) // A, B, C, D
   }
 
-  /** メモリ配列取得（直接アクセス用） */
+  /**
+   * メモリ配列取得（直接アクセス用）
+   * 取得した配列経由で書き換えられる可能性があるため、デコード済み・コンパイル済み命令は全て破棄する
+   */
   public getMemoryArray(): Uint8Array {
+    this._decodedInstructions = null
+    this._compiledInstructions = null
     return this._memory
   }
 
+  /**
+   * デコード済み命令を取得
+   * @param address 命令のアドレス
+   * @returns キャッシュされていない場合undefined
+   */
+  public getDecodedInstruction(address: number): DecodedInstruction | undefined {
+    return this._decodedInstructions?.[address]
+  }
+
+  /**
+   * デコード済み命令をキャッシュ
+   * 命令を構成するメモリが書き換えられると破棄される
+   * @param decoded デコード結果
+   */
+  public setDecodedInstruction(decoded: DecodedInstruction): void {
+    if (this._decodedInstructions == null) {
+      this._decodedInstructions = new Array<DecodedInstruction | undefined>(this._memorySize)
+    }
+    this._decodedInstructions[decoded.address] = decoded
+  }
+
+  /**
+   * コンパイル済み命令を取得
+   * @param address 命令のアドレス
+   * @returns キャッシュされていない場合undefined
+   */
+  public getCompiledInstruction(address: number): CompiledInstruction | undefined {
+    return this._compiledInstructions?.[address]
+  }
+
+  /**
+   * コンパイル済み命令をキャッシュ
+   * デコード済み命令と同じく、命令を構成するメモリが書き換えられると破棄される
+   * @param compiled コンパイル結果
+   */
+  public setCompiledInstruction(compiled: CompiledInstruction): void {
+    if (this._compiledInstructions == null) {
+      this._compiledInstructions = new Array<CompiledInstruction | undefined>(this._memorySize)
+    }
+    this._compiledInstructions[compiled.decoded.address] = compiled
+  }
+
   /**
    * レジスタ読み取り
    * @param register レジスタ名
@@ -123,6 +185,24 @@ export class VMState {
     return this._registers[REGISTER_NAMES[register]] ?? 0
   }
 
+  /**
+   * レジスタ読み取り（インデックス指定）
+   * @param index レジスタ番号（REGISTER_NAMESの値）
+   * @returns レジスタ値（16bit）
+   */
+  public getRegisterAt(index: number): number {
+    return this._registers[index] ?? 0
+  }
+
+  /**
+   * レジスタ書き込み（インデックス指定）
+   * @param index レジスタ番号（REGISTER_NAMESの値）
+   * @param value 値（16bitマスクされる）
+   */
+  public setRegisterAt(index: number, value: number): void {
+    this._registers[index] = value & 0xffff
+  }
+
   /**
    * レジスタ書き込み
    * @param register レジスタ名
@@ -148,7 +228,9 @@ export class VMState {
    * @param value 値（8bitマスクされる）
    */
   public writeMemory8(address: number, value: number): void {
-    this._memory[address % this._memorySize] = value & 0xff
+    const wrapped = address % this._memorySize
+    this._memory[wrapped] = value & 0xff
+    this.invalidateDecodedInstructions(wrapped)
   }
 
   /**
@@ -187,6 +269,24 @@ export class VMState {
     return result
   }
 
+  /**
+   * メモリ内容の比較
+   * @param address 開始アドレス（範囲がメモリ末尾を越える場合は不一致とする）
+   * @param data 比較するデータ
+   * @returns 全バイトが一致する場合true
+   */
+  public matchesMemory(address: number, data: Uint8Array): boolean {
+    if (address < 0 || address + data.length > this._memorySize) {
+      return false
+    }
+    for (let i = 0; i < data.length; i++) {
+      if (this._memory[address + i] !== data[i]) {
+        return false
+      }
+    }
+    return true
+  }
+
   /**
    * メモリブロック書き込み
    * @param address 開始アドレス
@@ -277,6 +377,30 @@ export class VMState {
     this._carryFlag = false
     this._registers.fill(0)
     this._memory.fill(0)
+    this._decodedInstructions = null
+    this._compiledInstructions = null
+  }
+
+  /**
+   * 書き換えたアドレスを含み得るデコード済み・コンパイル済み命令を破棄する
+   * @param address 書き換えたアドレス（ラップ済み）
+   */
+  private invalidateDecodedInstructions(address: number): void {
+    const decoded = this._decodedInstructions
+    const compiled = this._compiledInstructions
+    if ((decoded == null && compiled == null) || address < 0) {
+      return
+    }
+
+    for (let offset = 0; offset < MAX_INSTRUCTION_LENGTH; offset++) {
+      const start = (address - offset + this._memorySize) % this._memorySize
+      if (decoded != null) {
+        decoded[start] = undefined
+      }
+      if (compiled != null) {
+        compiled[start] = undefined
+      }
+    }
   }
 
   /**
@@ -1,4 +1,4 @@
-import { Assembler, Computer, Hull, ObjectId, Unit, UnitType } from "../types/game"
+import { Computer, Hull, ObjectId, Unit, UnitType } from "../types/game"
 import { VMUnitMemoryAccessor } from "./vm-unit-memory-accessor"
 
 /**
@@ -23,91 +23,103 @@ export const VMUnitPortNone: VMUnitPort = {
   },
 }
 
-type UnitMap = { HULL: Hull[]; ASSEMBLER: Assembler[]; COMPUTER: Computer[] }
-
-export class VMPhysicalUnitPort implements VMUnitPort {
-  private readonly _connectedUnits: UnitMap
-
-  public constructor(computer: Computer, getUnitById: (unitId: ObjectId) => Unit | null) {
-    /**
-     1. docs/spec-v3/circuit-connection-specification.md
-
-  - ユニットインデックス (行75-78):
-    - 各ユニット種別ごとに0から始まるインデックス
-    - 同一HULL内でのみ有効
-    - ユニット削除時もインデックスは保持（歯抜け状態を許容）
-  - ユニット指定方法 (行80-93):
-    - 上位4bit: ユニット種別（0x0=HULL, 0x4=ASSEMBLER, 0xC=COMPUTER）
-    - 下位4bit: インデックス（0-15）
-    - 例: ASSEMBLER[2] = 0x42、COMPUTER[1] = 0xC1
-
-  2. docs/spec-v3/synthetica-script.md
-
-  - VM命令でのユニット指定 (行235-254, 1027-1033):
-    - UNIT_MEM_READ/WRITE命令の第2バイトでユニット指定
-    - 上位4bit=種別、下位4bit=インデックス
-    - 自己参照時はCOMPUTER[0]が常に自身を示す
-     */
-    this._connectedUnits = {
-      HULL: [],
-      ASSEMBLER: [],
-      COMPUTER: [],
-    }
-
-    this._connectedUnits = { HULL: [], ASSEMBLER: [], COMPUTER: [] }
-    this.recursivelyGetConnectedUnits(computer, this._connectedUnits, [], getUnitById)
-  }
+/**
+ * COMPUTERから回路接続されたユニットの種別ごとのインデックス表（ユニットIDで保持）
+ * 各種別のインデックス0から探索順に並び、COMPUTER[0]は常に起点のCOMPUTER自身となる
+ */
+export type CircuitTopology = {
+  readonly HULL: ObjectId[]
+  readonly ASSEMBLER: ObjectId[]
+  readonly COMPUTER: ObjectId[]
+}
 
-  private recursivelyGetConnectedUnits(
-    unit: Unit,
-    connectedUnits: UnitMap,
-    unitIds: ObjectId[],
-    getUnitById: (unitId: ObjectId) => Unit | null
-  ): void {
-    unitIds.push(unit.id)
-
-    switch (unit.type) {
-      case "HULL":
-        connectedUnits[unit.type].push(unit)
-        break
-      case "ASSEMBLER":
-        connectedUnits[unit.type].push(unit)
-        break
-      case "COMPUTER":
-        connectedUnits[unit.type].push(unit)
-        break
-      default: {
-        // eslint-disable-next-line @typescript-eslint/no-unused-vars
-        const _: never = unit
-        break
-      }
-    }
+/**
+ * COMPUTERを起点に回路接続されたユニットを探索してインデックス表を作成する
+ *
+ * 1. docs/spec-v3/circuit-connection-specification.md
+ *
+ * - ユニットインデックス (行75-78):
+ *   - 各ユニット種別ごとに0から始まるインデックス
+ *   - 同一HULL内でのみ有効
+ *   - ユニット削除時もインデックスは保持（歯抜け状態を許容）
+ * - ユニット指定方法 (行80-93):
+ *   - 上位4bit: ユニット種別（0x0=HULL, 0x4=ASSEMBLER, 0xC=COMPUTER）
+ *   - 下位4bit: インデックス（0-15）
+ *   - 例: ASSEMBLER[2] = 0x42、COMPUTER[1] = 0xC1
+ *
+ * 2. docs/spec-v3/synthetica-script.md
+ *
+ * - VM命令でのユニット指定 (行235-254, 1027-1033):
+ *   - UNIT_MEM_READ/WRITE命令の第2バイトでユニット指定
+ *   - 上位4bit=種別、下位4bit=インデックス
+ *   - 自己参照時はCOMPUTER[0]が常に自身を示す
+ *
+ * @param computer 起点のCOMPUTER
+ * @param getUnitById ユニット取得関数
+ * @param referencedIds 探索中に参照したユニットID（存在しなかったものを含む）の書き込み先
+ */
+export const buildCircuitTopology = (
+  computer: Computer,
+  getUnitById: (unitId: ObjectId) => Unit | null,
+  referencedIds?: Set<ObjectId>
+): CircuitTopology => {
+  const topology: CircuitTopology = { HULL: [], ASSEMBLER: [], COMPUTER: [] }
+  const visitedIds: ObjectId[] = []
+
+  const visit = (unit: Unit): void => {
+    visitedIds.push(unit.id)
+    referencedIds?.add(unit.id)
+    topology[unit.type].push(unit.id)
 
     if (unit.parentHullId == null) {
       return
     }
 
+    referencedIds?.add(unit.parentHullId)
     const hull = getUnitById(unit.parentHullId) as Hull | null
     if (hull == null) {
       return
     }
 
     hull.attachedUnitIds.forEach(unitId => {
-      if (unitIds.includes(unitId)) {
+      if (visitedIds.includes(unitId)) {
         return
       }
+      referencedIds?.add(unitId)
       const attachedUnit = getUnitById(unitId)
       if (attachedUnit == null) {
         return
       }
-      this.recursivelyGetConnectedUnits(attachedUnit, connectedUnits, unitIds, getUnitById)
+      visit(attachedUnit)
     })
 
-    this.recursivelyGetConnectedUnits(hull, connectedUnits, unitIds, getUnitById)
+    visit(hull)
+  }
+
+  visit(computer)
+  return topology
+}
+
+export class VMPhysicalUnitPort implements VMUnitPort {
+  private readonly _topology: CircuitTopology
+  private readonly _getUnitById: (unitId: ObjectId) => Unit | null
+
+  /**
+   * @param computer 起点のCOMPUTER
+   * @param getUnitById ユニット取得関数（アクセスのたびにIDからユニットを解決する）
+   * @param topology 作成済みのインデックス表（省略時は探索して作成する）
+   */
+  public constructor(
+    computer: Computer,
+    getUnitById: (unitId: ObjectId) => Unit | null,
+    topology: CircuitTopology = buildCircuitTopology(computer, getUnitById)
+  ) {
+    this._topology = topology
+    this._getUnitById = getUnitById
   }
 
   public read(unitType: UnitType, unitIndex: number, memoryIndex: number): number {
-    const unit = this._connectedUnits[unitType][unitIndex]
+    const unit = this.unitAt(unitType, unitIndex)
     if (unit == null) {
       return 0xff
     }
@@ -115,7 +127,7 @@ export class VMPhysicalUnitPort implements VMUnitPort {
   }
 
   public write(unitType: UnitType, unitIndex: number, memoryIndex: number, value: number): void {
-    const unit = this._connectedUnits[unitType][unitIndex]
+    const unit = this.unitAt(unitType, unitIndex)
     if (unit == null) {
       return
     }
@@ -123,6 +135,14 @@ export class VMPhysicalUnitPort implements VMUnitPort {
   }
 
   public exists(unitType: UnitType, unitIndex: number): boolean {
-    return this._connectedUnits[unitType][unitIndex] != null
+    return this.unitAt(unitType, unitIndex) != null
+  }
+
+  private unitAt(unitType: UnitType, unitIndex: number): Unit | null {
+    const unitId = this._topology[unitType][unitIndex]
+    if (unitId == null) {
+      return null
+    }
+    return this._getUnitById(unitId)
   }
 }
@@ -0,0 +1,107 @@
+/**
+ * 世界の構造変更のコマンドバッファのテスト
+ */
+
+import { WorldCommandBuffer } from "./world-command-buffer"
+import { WorldStateManager } from "./world-state"
+import type { GameObject, ObjectId } from "@/types/game"
+import { Vec2 } from "@/utils/vec2"
+
+const createEnergy = (manager: WorldStateManager, x: number, energy = 50): GameObject => ({
+  id: manager.generateObjectId(),
+  type: "ENERGY",
+  position: Vec2.create(x, 0),
+  velocity: Vec2.create(0, 0),
+  radius: 5,
+  energy,
+  mass: energy,
+})
+
+describe("WorldCommandBuffer", () => {
+  test("反映するまでストアは変更されない", () => {
+    const manager = new WorldStateManager(1000, 800)
+    const existing = createEnergy(manager, 0)
+    manager.addObject(existing)
+    const commands = new WorldCommandBuffer()
+
+    commands.spawn(createEnergy(manager, 100))
+    commands.despawn(existing.id)
+    expect(commands.isEmpty).toBe(false)
+    expect(manager.state.objects.size).toBe(1)
+
+    manager.commit(commands)
+
+    expect(commands.isEmpty).toBe(true)
+    expect(manager.state.objects.size).toBe(1)
+    expect(manager.getObject(existing.id)).toBeUndefined()
+    expect(manager.getObjectsInRange(100, 0, 10)).toHaveLength(1)
+  })
+
+  test("IDと格納位置で指定した削除は重複を除いてまとめて反映する", () => {
+    const manager = new WorldStateManager(1000, 800)
+    const objects = [0, 1, 2, 3, 4].map(i => createEnergy(manager, i * 100))
+    for (const obj of objects) {
+      manager.addObject(obj)
+    }
+    const commands = new WorldCommandBuffer()
+
+    commands.despawnAt(3)
+    commands.despawnAt(1)
+    commands.despawn(objects[1]?.id as ObjectId)
+    commands.despawn(objects[4]?.id as ObjectId)
+    manager.commit(commands)
+
+    expect(manager.removedObjectCount).toBe(3)
+    const remainingIds = Array.from(manager.state.objects.values(), obj => obj.id)
+    expect(remainingIds.sort((a, b) => a - b)).toEqual([objects[0]?.id, objects[2]?.id])
+  })
+
+  test("置き換えは最後に記録したものを反映し、削除したものは置き換え・追加しない", () => {
+    const manager = new WorldStateManager(1000, 800)
+    const kept = createEnergy(manager, 0)
+    const removed = createEnergy(manager, 100)
+    manager.addObject(kept)
+    manager.addObject(removed)
+    const commands = new WorldCommandBuffer()
+
+    commands.update({ ...kept, energy: 10 })
+    commands.update({ ...kept, energy: 20, position: Vec2.create(500, 0) })
+    commands.update({ ...removed, energy: 30 })
+    commands.despawn(removed.id)
+    const cancelled = createEnergy(manager, 200)
+    commands.spawn(cancelled)
+    commands.despawn(cancelled.id)
+    manager.commit(commands)
+
+    expect(manager.getObject(kept.id)?.energy).toBe(20)
+    expect(manager.getObjectsInRange(500, 0, 10).map(obj => obj.id)).toEqual([kept.id])
+    expect(manager.getObject(removed.id)).toBeUndefined()
+    expect(manager.getObject(cancelled.id)).toBeUndefined()
+    expect(manager.state.objects.size).toBe(1)
+  })
+
+  test("追加は記録順に末尾へまとめて書き込み、空間インデックスへ登録する", () => {
+    const manager = new WorldStateManager(1000, 800)
+    const existing = createEnergy(manager, 0)
+    manager.addObject(existing)
+    const commands = new WorldCommandBuffer()
+
+    // ストアの初期容量を超える数を一度に追加する
+    const spawned = Array.from({ length: 300 }, (_, i) => createEnergy(manager, (i % 10) * 100))
+    for (const obj of spawned) {
+      commands.spawn(obj)
+    }
+    // 格納済みのIDの追加は置き換えとして扱う
+    commands.spawn({ ...existing, position: Vec2.create(900, 400) })
+    manager.commit(commands)
+
+    expect(manager.state.objects.size).toBe(301)
+    expect(manager.addedObjectCount).toBe(301)
+    expect(spawned.map(obj => manager.entities.indexOf(obj.id))).toEqual(
+      spawned.map((_, i) => i + 1)
+    )
+    expect(manager.getObjectsInRange(300, 0, 10)).toHaveLength(30)
+    expect(manager.getObjectsInRange(900, 400, 10).map(obj => obj.id)).toEqual([existing.id])
+    expect(manager.getObjectsInRange(0, 0, 10)).toHaveLength(30)
+  })
+})
@@ -0,0 +1,78 @@
+/**
+ * 世界の構造変更のコマンドバッファ
+ *
+ * tick内の各システムはオブジェクトの追加・削除・置き換えを直接行わず、このバッファに記録する。
+ * 記録した変更はフェーズの間に WorldStateManager.commit でまとめて反映するため、
+ * 処理中の列挙や格納位置（エネルギー粒子の列など）はフェーズの終わりまで有効なまま保たれる。
+ * バッファは単なる記録なので、並行に処理するフェーズではそれぞれのバッファに記録し、順に反映すればよい
+ */
+
+import type { GameObject, ObjectId } from "@/types/game"
+
+export class WorldCommandBuffer {
+  private readonly _spawns: GameObject[] = []
+  private readonly _despawnIds: ObjectId[] = []
+  private readonly _despawnIndices: number[] = []
+  private readonly _updates = new Map<ObjectId, GameObject>()
+
+  /** 記録した変更がないか */
+  public get isEmpty(): boolean {
+    return (
+      this._spawns.length === 0 &&
+      this._despawnIds.length === 0 &&
+      this._despawnIndices.length === 0 &&
+      this._updates.size === 0
+    )
+  }
+
+  /** 追加するオブジェクト（記録順） */
+  public get spawns(): readonly GameObject[] {
+    return this._spawns
+  }
+
+  /** IDで指定した削除 */
+  public get despawnIds(): readonly ObjectId[] {
+    return this._despawnIds
+  }
+
+  /** ストア上の格納位置で指定した削除（記録時点の格納位置） */
+  public get despawnIndices(): readonly number[] {
+    return this._despawnIndices
+  }
+
+  /** 置き換えるオブジェクト（同じIDは最後に記録したもの） */
+  public get updates(): ReadonlyMap<ObjectId, GameObject> {
+    return this._updates
+  }
+
+  /** オブジェクトの追加を記録 */
+  public spawn(obj: GameObject): void {
+    this._spawns.push(obj)
+  }
+
+  /** IDで指定したオブジェクトの削除を記録 */
+  public despawn(id: ObjectId): void {
+    this._despawnIds.push(id)
+  }
+
+  /**
+   * ストア上の格納位置で指定したオブジェクトの削除を記録
+   * 格納位置は反映までに構造の変更がないことを前提とする（tick内の変更はすべてバッファを通す）
+   */
+  public despawnAt(index: number): void {
+    this._despawnIndices.push(index)
+  }
+
+  /** オブジェクトの置き換え（値の変更の反映）を記録 */
+  public update(obj: GameObject): void {
+    this._updates.set(obj.id, obj)
+  }
+
+  /** 記録をすべて破棄する */
+  public clear(): void {
+    this._spawns.length = 0
+    this._despawnIds.length = 0
+    this._despawnIndices.length = 0
+    this._updates.clear()
+  }
+}
@@ -1,8 +1,13 @@
 import { ObjectId } from "../types/game"
 import { DebugComputerVMSystem } from "./computer-vm-system"
+import { TICK_COUNTERS, TICK_PHASES, TickInstrumentation } from "./tick-instrumentation"
+import type { TickInstrumentationSnapshot } from "./tick-instrumentation"
 
 export class WorldDebugger {
-  public constructor(private readonly _computerVMSystem: DebugComputerVMSystem) {}
+  public constructor(
+    private readonly _computerVMSystem: DebugComputerVMSystem,
+    private readonly _instrumentation: TickInstrumentation | null
+  ) {}
 
   public setSelectedHull(hullId: ObjectId | null): void {
     this._computerVMSystem.selectedHullId = hullId
@@ -10,4 +15,32 @@ export class WorldDebugger {
       console.log(`[${this.constructor.name}] HULLを選択: #${hullId}`)
     }
   }
+
+  /** tick処理の計測値の要約を取得（計測が無効な場合はnull） */
+  public getTickInstrumentation(): TickInstrumentationSnapshot | null {
+    return this._instrumentation?.snapshot() ?? null
+  }
+
+  /** tick処理の計測値の要約をコンソールに出力 */
+  public logTickInstrumentation(): void {
+    const snapshot = this.getTickInstrumentation()
+    if (snapshot == null) {
+      console.log(`[${this.constructor.name}] tick処理の計測は無効です`)
+      return
+    }
+
+    const lines = [
+      `[${this.constructor.name}] 直近${snapshot.windowSize}tick（累計${snapshot.ticks}tick）`,
+      ...TICK_PHASES.map(phase => {
+        const { mean, p95, max } = snapshot.phases[phase]
+        const ms = (value: number) => `${value.toFixed(3)}ms`
+        return `${phase}: mean ${ms(mean)}, p95 ${ms(p95)}, max ${ms(max)}`
+      }),
+      ...TICK_COUNTERS.map(counter => {
+        const { mean, max, total } = snapshot.counters[counter]
+        return `${counter}: mean ${mean.toFixed(1)}, max ${max}, total ${total}`
+      }),
+    ]
+    console.log(lines.join("\n"))
+  }
 }
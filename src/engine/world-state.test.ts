@@ -25,7 +25,7 @@ describe("WorldStateManager", () => {
       expect(state.objects.size).toBe(0)
       expect(state.energySources.size).toBe(0)
       expect(state.forceFields.size).toBe(0)
-      expect(state.spatialIndex.size).toBe(0)
+      expect(manager.broadphase.count).toBe(0)
       expect(state.parameters).toEqual(DEFAULT_PARAMETERS)
     })
 
@@ -165,6 +165,32 @@ describe("WorldStateManager", () => {
       const fakeId = 999 as ObjectId
       expect(() => manager.removeObject(fakeId)).not.toThrow()
     })
+
+    test("格納位置の列で指定したオブジェクトをまとめて削除できる", () => {
+      const ids = [0, 1, 2, 3].map(i => {
+        const obj: GameObject = {
+          id: manager.generateObjectId(),
+          type: "ENERGY",
+          position: Vec2.create(i * 100, 0),
+          velocity: Vec2.create(0, 0),
+          radius: 5,
+          energy: 50,
+          mass: 50,
+        }
+        manager.addObject(obj)
+        return obj.id
+      })
+
+      manager.removeObjectsAt(Int32Array.of(0, 2), 2)
+
+      expect(manager.state.objects.size).toBe(2)
+      expect(manager.getObject(ids[0] as ObjectId)).toBeUndefined()
+      expect(manager.getObject(ids[2] as ObjectId)).toBeUndefined()
+      expect(manager.removedObjectCount).toBe(2)
+      // 空間インデックスからも削除される
+      expect(manager.getObjectsInRange(0, 0, 10)).toHaveLength(0)
+      expect(manager.getObjectsInRange(300, 0, 10).map(obj => obj.id)).toEqual([ids[3]])
+    })
   })
 
   describe("エネルギーソース管理", () => {
@@ -219,10 +245,9 @@ describe("WorldStateManager", () => {
       manager.addObject(obj)
 
       // セルサイズ100なので、(150,250)は(1,2)のセルに入る
-      const cellKey = `1,2`
-      const cell = manager.state.spatialIndex.get(cellKey)
-      expect(cell).toBeDefined()
-      expect(cell?.objects.has(obj.id)).toBe(true)
+      const debugInfo = manager.broadphase.getDebugInfo()
+      expect(debugInfo.totalObjects).toBe(1)
+      expect(debugInfo.cellOccupancy.get(`1,2`)).toBe(1)
     })
 
     test("オブジェクト削除時に空間インデックスから削除される", () => {
@@ -237,12 +262,50 @@ describe("WorldStateManager", () => {
       }
 
       manager.addObject(obj)
-      const cellKey = `1,2`
-      expect(manager.state.spatialIndex.get(cellKey)?.objects.has(obj.id)).toBe(true)
+      expect(manager.broadphase.getDebugInfo().cellOccupancy.get(`1,2`)).toBe(1)
 
       manager.removeObject(obj.id)
-      // 空のセルは削除される
-      expect(manager.state.spatialIndex.has(cellKey)).toBe(false)
+      const debugInfo = manager.broadphase.getDebugInfo()
+      expect(debugInfo.totalObjects).toBe(0)
+      expect(debugInfo.cellOccupancy.has(`1,2`)).toBe(false)
+    })
+
+    test("オブジェクト更新で位置が変わるとセルが付け替えられる", () => {
+      const obj: GameObject = {
+        id: manager.generateObjectId(),
+        type: "ENERGY",
+        position: Vec2.create(150, 250),
+        velocity: Vec2.create(0, 0),
+        radius: 5,
+        energy: 50,
+        mass: 50,
+      }
+
+      manager.addObject(obj)
+      manager.updateObject({ ...obj, position: Vec2.create(450, 50) })
+
+      const debugInfo = manager.broadphase.getDebugInfo()
+      expect(debugInfo.totalObjects).toBe(1)
+      expect(debugInfo.cellOccupancy.has(`1,2`)).toBe(false)
+      expect(debugInfo.cellOccupancy.get(`4,0`)).toBe(1)
+    })
+
+    test("物理演算で移動したオブジェクトも検索できる", () => {
+      const obj: GameObject = {
+        id: manager.generateObjectId(),
+        type: "ENERGY",
+        position: Vec2.create(95, 50),
+        velocity: Vec2.create(10, 0),
+        radius: 5,
+        energy: 50,
+        mass: 50,
+      }
+
+      manager.addObject(obj)
+      manager.updatePhysics(1.0)
+
+      expect(manager.broadphase.getDebugInfo().cellOccupancy.get(`1,0`)).toBe(1)
+      expect(manager.getObjectsInRange(obj.position.x, 50, 1)).toEqual([obj])
     })
 
     test("範囲内のオブジェクトを取得できる", () => {
@@ -308,14 +371,28 @@ describe("WorldStateManager", () => {
       manager.addObject(obj1)
       manager.addObject(obj2)
 
-      // インデックスをクリアして再構築
-      manager.state.spatialIndex.clear()
-      expect(manager.state.spatialIndex.size).toBe(0)
-
       manager.rebuildSpatialIndex()
-      expect(manager.state.spatialIndex.size).toBe(2)
-      expect(manager.state.spatialIndex.get(`0,0`)?.objects.has(obj1.id)).toBe(true)
-      expect(manager.state.spatialIndex.get(`2,2`)?.objects.has(obj2.id)).toBe(true)
+      const debugInfo = manager.broadphase.getDebugInfo()
+      expect(debugInfo.totalObjects).toBe(2)
+      expect(debugInfo.cellOccupancy.get(`0,0`)).toBe(1)
+      expect(debugInfo.cellOccupancy.get(`2,2`)).toBe(1)
+    })
+
+    test("世界境界をまたいで範囲内のオブジェクトを取得できる", () => {
+      const obj: GameObject = {
+        id: manager.generateObjectId(),
+        type: "ENERGY",
+        position: Vec2.create(worldWidth - 5, 100),
+        velocity: Vec2.create(0, 0),
+        radius: 5,
+        energy: 50,
+        mass: 50,
+      }
+
+      manager.addObject(obj)
+
+      expect(manager.getObjectsInRange(5, 100, 10)).toEqual([obj])
+      expect(manager.getObjectsInRange(30, 100, 10)).toEqual([])
     })
   })
 
@@ -355,7 +432,7 @@ describe("WorldStateManager", () => {
       }
 
       manager.addObject(obj)
-      expect(manager.state.spatialIndex.get(`0,0`)?.objects.has(obj.id)).toBe(true)
+      expect(manager.broadphase.getDebugInfo().cellOccupancy.get(`0,0`)).toBe(1)
     })
 
     test("負の位置の場合の空間インデックス", () => {
@@ -370,8 +447,8 @@ describe("WorldStateManager", () => {
       }
 
       manager.addObject(obj)
-      // -150/100 = -1.5 → floor = -2, -250/100 = -2.5 → floor = -3
-      expect(manager.state.spatialIndex.get(`-2,-3`)?.objects.has(obj.id)).toBe(true)
+      // トーラス境界でラップされ(850,550)として(8,5)のセルに入る
+      expect(manager.broadphase.getDebugInfo().cellOccupancy.get(`8,5`)).toBe(1)
     })
 
     test("非常に大きな範囲でのオブジェクト検索", () => {
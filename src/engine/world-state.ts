@@ -11,8 +11,15 @@ import type {
   DirectionalForceField,
 } from "@/types/game"
 import { PhysicsEngine, DEFAULT_PHYSICS_PARAMETERS } from "./physics-engine"
-import type { PhysicsParameters } from "./physics-engine"
+import type { PhysicsParameters, PhysicsUpdateResult } from "./physics-engine"
 import { HeatSystem } from "./heat-system"
+import { ENTITY_KIND, EntityStore } from "./entity-store"
+import { EnergyParticleSystem } from "./energy-particle-system"
+import { Broadphase } from "./broadphase"
+import { CircuitTopologyCache } from "./circuit-topology-cache"
+import type { WorldCommandBuffer } from "./world-command-buffer"
+import { shortestVector } from "@/utils/torus-math"
+import { isHull, isUnit } from "@/utils/type-guards"
 import { getGameLawParameters } from "@/config/game-law-parameters"
 
 /** デフォルトのワールドパラメータを生成 */
@@ -31,36 +38,109 @@ export const createDefaultParameters = (): WorldParameters => {
 /** デフォルトパラメータ（互換性のために残す） */
 export const DEFAULT_PARAMETERS: WorldParameters = createDefaultParameters()
 
-/** 空間ハッシュグリッドのセルサイズ */
+/** 空間インデックス（ブロードフェーズ）のセルサイズ */
 export const SPATIAL_CELL_SIZE = 100
 
+/** 置き換えの前後で回路の接続関係（所属HULL・固定ユニット）が変わったか */
+const hasConnectionChanged = (previous: GameObject, next: GameObject): boolean => {
+  if (!isUnit(previous) || !isUnit(next)) {
+    return isUnit(previous) !== isUnit(next)
+  }
+  if (previous.parentHullId !== next.parentHullId) {
+    return true
+  }
+  if (!isHull(previous) || !isHull(next)) {
+    return false
+  }
+  const previousIds = previous.attachedUnitIds
+  const nextIds = next.attachedUnitIds
+  return (
+    previousIds !== nextIds &&
+    (previousIds.length !== nextIds.length || previousIds.some((id, i) => id !== nextIds[i]))
+  )
+}
+
 export class WorldStateManager {
   private readonly _state: WorldState
+  private readonly _entities: EntityStore
+  private readonly _broadphase: Broadphase
+  private readonly _circuitTopology: CircuitTopologyCache
   private readonly _physicsEngine: PhysicsEngine
+  private readonly _energyParticles: EnergyParticleSystem
   private readonly _heatSystem: HeatSystem
+  private _queryBuffer = new Int32Array(64)
+  private _addedObjectCount = 0
+  private _removedObjectCount = 0
+  /** コマンドバッファの反映で削除・置き換える格納位置（反映ごとに使い回す） */
+  private readonly _commitIndices: number[] = []
+  /** コマンドバッファの反映で末尾へ追加するオブジェクト（反映ごとに使い回す） */
+  private readonly _commitSpawns: GameObject[] = []
+  /** コマンドバッファの反映で削除したID（反映ごとに使い回す） */
+  private readonly _commitRemovedIds = new Set<ObjectId>()
 
   /** 現在の状態を取得 */
   public get state(): Readonly<WorldState> {
     return this._state
   }
   
+  /** オブジェクトの列データを保持するエンティティストア */
+  public get entities(): EntityStore {
+    return this._entities
+  }
+
+  /** 全オブジェクトを登録した空間インデックス */
+  public get broadphase(): Broadphase {
+    return this._broadphase
+  }
+
+  /**
+   * エネルギー粒子システム
+   * 粒子の列は次に集め直すまで有効。ストアの列へ直接書き込んだ場合は invalidate すること
+   */
+  public get energyParticles(): EnergyParticleSystem {
+    return this._energyParticles
+  }
+
   /** 熱システムを取得 */
   public get heatSystem(): HeatSystem {
     return this._heatSystem
   }
 
+  /**
+   * COMPUTERごとの回路トポロジーのキャッシュ
+   * ユニットの追加・削除・接続関係を変える置き換えで該当部分が破棄される
+   */
+  public get circuitTopology(): CircuitTopologyCache {
+    return this._circuitTopology
+  }
+
+  /** 起動からの累計オブジェクト追加数 */
+  public get addedObjectCount(): number {
+    return this._addedObjectCount
+  }
+
+  /** 起動からの累計オブジェクト削除数 */
+  public get removedObjectCount(): number {
+    return this._removedObjectCount
+  }
+
   public constructor(width: number, height: number, parameters?: Partial<WorldParameters>) {
     const defaultParams = createDefaultParameters()
     const finalParams = { ...defaultParams, ...parameters }
-    
+
+    this._entities = new EntityStore()
+    this._broadphase = new Broadphase(this._entities, SPATIAL_CELL_SIZE, width, height)
+    this._circuitTopology = new CircuitTopologyCache(unitId => {
+      const obj = this._entities.get(unitId)
+      return obj != null && isUnit(obj) ? obj : null
+    })
     this._state = {
       width,
       height,
       tick: 0,
-      objects: new Map(),
+      objects: this._entities,
       energySources: new Map(),
       forceFields: new Map(),
-      spatialIndex: new Map(),
       parameters: finalParams,
       nextObjectId: 1,
     }
@@ -77,6 +157,7 @@ export class WorldStateManager {
       },
     }
     this._physicsEngine = new PhysicsEngine(SPATIAL_CELL_SIZE, width, height, physicsParams)
+    this._energyParticles = new EnergyParticleSystem(width, height, physicsParams)
     
     // 熱システムの初期化
     // グリッドサイズを世界サイズから計算（1グリッド = 10ユニット）
@@ -91,26 +172,118 @@ export class WorldStateManager {
   }
 
   public addObject(obj: GameObject): void {
-    this._state.objects.set(obj.id, obj)
-    this.updateSpatialIndex(obj)
+    this._entities.add(obj)
+    this._broadphase.insert(this._entities.indexOf(obj.id))
+    this.onObjectAdded(obj)
   }
 
   public removeObject(id: ObjectId): void {
-    const obj = this._state.objects.get(id)
-    if (obj != null) {
-      this.removeSpatialIndex(obj)
-      this._state.objects.delete(id)
+    const index = this._entities.indexOf(id)
+    if (index >= 0) {
+      this.removeObjectAt(index)
+    }
+  }
+
+  /**
+   * 格納位置の列で指定したオブジェクトをまとめて削除
+   * 格納位置の大きい順に削除するため、削除による詰め直しで未処理の格納位置は変わらない
+   * @param indices ストア上の格納位置（昇順・重複なし）
+   * @param count 削除数
+   */
+  public removeObjectsAt(indices: ArrayLike<number>, count: number): void {
+    for (let k = count - 1; k >= 0; k--) {
+      this.removeObjectAt(indices[k] ?? -1)
     }
   }
 
+  /**
+   * コマンドバッファに記録した構造の変更をまとめて反映し、バッファを空にする
+   * 削除 → 置き換え → 追加 の順に反映する。削除は格納位置の昇順に並べて重複を除き、
+   * 大きい順に詰める。置き換えはストアへ書き込んだ後に空間インデックスをまとめて付け替え、
+   * 追加は容量を一度だけ確保して末尾へまとめて書き込み、空間インデックスへまとめて登録する。
+   * 削除したオブジェクトの置き換え・追加は反映しない
+   * @param commands コマンドバッファ
+   */
+  public commit(commands: WorldCommandBuffer): void {
+    if (commands.isEmpty) {
+      return
+    }
+
+    // 削除する格納位置を集める（IDは削除前に格納位置へ変換する）
+    const indices = this._commitIndices
+    const removedIds = this._commitRemovedIds
+    indices.length = 0
+    removedIds.clear()
+    for (const index of commands.despawnIndices) {
+      if (index >= 0 && index < this._entities.count) {
+        indices.push(index)
+      }
+    }
+    for (const id of commands.despawnIds) {
+      removedIds.add(id)
+      const index = this._entities.indexOf(id)
+      if (index >= 0) {
+        indices.push(index)
+      }
+    }
+    indices.sort((a, b) => a - b)
+
+    let removedCount = 0
+    for (const index of indices) {
+      if (removedCount > 0 && indices[removedCount - 1] === index) {
+        continue
+      }
+      indices[removedCount] = index
+      removedCount++
+      const obj = this._entities.objectAt(index)
+      if (obj != null) {
+        removedIds.add(obj.id)
+      }
+    }
+    this.removeObjectsAt(indices, removedCount)
+
+    // 置き換え（格納済みのIDの追加も置き換えとして扱う）。格納位置は追加で変わらない
+    const spawns = this._commitSpawns
+    indices.length = 0
+    spawns.length = 0
+    for (const obj of commands.updates.values()) {
+      const index = removedIds.has(obj.id) ? -1 : this.replaceObject(obj)
+      if (index >= 0) {
+        indices.push(index)
+      }
+    }
+    for (const obj of commands.spawns) {
+      if (removedIds.has(obj.id)) {
+        continue
+      }
+      if (this._entities.indexOf(obj.id) < 0) {
+        spawns.push(obj)
+        continue
+      }
+      const index = this.replaceObject(obj)
+      if (index >= 0) {
+        indices.push(index)
+      }
+    }
+    this._broadphase.updateMany(indices, indices.length)
+
+    const start = this._entities.count
+    this._entities.addAll(spawns)
+    this._broadphase.insertRange(start, this._entities.count)
+    for (const obj of spawns) {
+      this.onObjectAdded(obj)
+    }
+
+    spawns.length = 0
+    commands.clear()
+  }
+
   /** オブジェクトを更新 */
   public updateObject(obj: GameObject): void {
-    const oldObj = this._state.objects.get(obj.id)
-    if (oldObj != null) {
-      // 空間インデックスを更新
-      this.removeSpatialIndex(oldObj)
-      this._state.objects.set(obj.id, obj)
-      this.updateSpatialIndex(obj)
+    const index = this.replaceObject(obj)
+    if (index >= 0) {
+      // 所属セルが変わった場合のみ空間インデックスを付け替える
+      this._broadphase.update(index)
     }
   }
 
@@ -149,85 +322,77 @@ export class WorldStateManager {
     // 物理演算パラメータはゲーム法則パラメータから取得されるため、ここでは更新しない
   }
 
-  /** 空間インデックスを更新 */
-  public updateSpatialIndex(obj: GameObject): void {
-    // 古いセルから削除
-    this.removeSpatialIndex(obj)
-
-    // 新しいセルに追加
-    const cellKey = this.getCellKey(obj.position.x, obj.position.y)
-    let cell = this._state.spatialIndex.get(cellKey)
-    if (cell == null) {
-      cell = { objects: new Set() }
-      this._state.spatialIndex.set(cellKey, cell)
-    }
-    cell.objects.add(obj.id)
-  }
+  /**
+   * 指定範囲内のオブジェクトを取得
+   * トーラス境界を考慮し、半径rangeの円と重なるオブジェクトを返す
+   */
+  public getObjectsInRange(x: number, y: number, range: number): GameObject[] {
+    const objects: GameObject[] = []
+    const entities = this._entities
+    const center = { x, y }
+
+    const count = this.queryBroadphase(x, y, range)
+    for (let k = 0; k < count; k++) {
+      const index = this._queryBuffer[k] ?? -1
+      const obj = entities.objectAt(index)
+      if (obj == null) {
+        continue
+      }
 
-  /** 空間インデックスから削除 */
-  private removeSpatialIndex(obj: GameObject): void {
-    const cellKey = this.getCellKey(obj.position.x, obj.position.y)
-    const cell = this._state.spatialIndex.get(cellKey)
-    if (cell != null) {
-      cell.objects.delete(obj.id)
-      if (cell.objects.size === 0) {
-        this._state.spatialIndex.delete(cellKey)
+      const delta = shortestVector(center, obj.position, this._state.width, this._state.height)
+      const reach = range + (entities.radius[index] ?? 0)
+      if (delta.x * delta.x + delta.y * delta.y <= reach * reach) {
+        objects.push(obj)
       }
     }
-  }
 
-  /** セルキーを生成 */
-  private getCellKey(x: number, y: number): string {
-    const cellX = Math.floor(x / SPATIAL_CELL_SIZE)
-    const cellY = Math.floor(y / SPATIAL_CELL_SIZE)
-    return `${cellX},${cellY}`
+    return objects
   }
 
-  /** 指定範囲内のオブジェクトを取得 */
-  public getObjectsInRange(x: number, y: number, range: number): GameObject[] {
-    const objects: GameObject[] = []
-    const cellRange = Math.ceil(range / SPATIAL_CELL_SIZE)
-
-    const centerCellX = Math.floor(x / SPATIAL_CELL_SIZE)
-    const centerCellY = Math.floor(y / SPATIAL_CELL_SIZE)
-
-    // 範囲内のセルをチェック
-    for (let dx = -cellRange; dx <= cellRange; dx++) {
-      for (let dy = -cellRange; dy <= cellRange; dy++) {
-        const cellX = centerCellX + dx
-        const cellY = centerCellY + dy
-        const cellKey = `${cellX},${cellY}`
-
-        const cell = this._state.spatialIndex.get(cellKey)
-        if (cell != null) {
-          for (const objId of cell.objects) {
-            const obj = this._state.objects.get(objId)
-            if (obj != null) {
-              objects.push(obj)
-            }
-          }
-        }
-      }
-    }
+  /**
+   * 指定範囲と重なりうるオブジェクトの格納位置を取得
+   * ブロードフェーズの検索結果の候補をそのまま返すため、範囲外のオブジェクトも含む
+   * @returns 格納位置の配列（次の検索まで有効）
+   */
+  public getIndicesNearPosition(x: number, y: number, range: number): Int32Array {
+    return this._queryBuffer.subarray(0, this.queryBroadphase(x, y, range))
+  }
 
-    return objects
+  /**
+   * エネルギー粒子の列を取得
+   * 前回集めてからエネルギーオブジェクトの追加・削除・置き換えがなければストアを走査し直さない
+   */
+  public gatherEnergyParticles(): EnergyParticleSystem {
+    this._energyParticles.gather(this._entities)
+    return this._energyParticles
   }
 
   /** 全オブジェクトの空間インデックスを再構築 */
   public rebuildSpatialIndex(): void {
-    this._state.spatialIndex.clear()
-    for (const obj of this._state.objects.values()) {
-      this.updateSpatialIndex(obj)
-    }
+    this._broadphase.rebuild()
   }
 
   /**
    * 物理演算を実行
+   * エネルギーオブジェクトは汎用の物理演算から除外し、エネルギー粒子システムで更新する
    * @param deltaTime 時間ステップ
-   * @returns 物理演算の結果
+   * @returns 物理演算の結果（処理したオブジェクト数はエネルギー粒子を含む）
    */
-  public updatePhysics(deltaTime: number): ReturnType<PhysicsEngine["update"]> {
-    return this._physicsEngine.update(this._state.objects, this._state.forceFields, deltaTime)
+  public updatePhysics(deltaTime: number): PhysicsUpdateResult {
+    // ブロードフェーズの更新はユニットの物理演算の後にまとめて行う
+    const particleCount = this._energyParticles.integrate(
+      this._entities,
+      this._state.forceFields,
+      deltaTime
+    )
+    const result = this._physicsEngine.updateEntities(
+      this._entities,
+      this._state.forceFields,
+      deltaTime,
+      this._broadphase,
+      ENTITY_KIND.ENERGY
+    )
+    return { ...result, objectCount: result.objectCount + particleCount }
   }
 
   /**
@@ -245,8 +410,9 @@ export class WorldStateManager {
     return this._physicsEngine.detectCollisionsAtPosition(
       position,
       radius,
-      this._state.objects,
-      excludeId
+      this._entities,
+      excludeId,
+      this._broadphase
     )
   }
 
@@ -258,5 +424,63 @@ export class WorldStateManager {
   public addHeatToCell(position: { x: number; y: number }, heat: number): void {
     this._heatSystem.addHeatAt(position, heat)
   }
-  
+
+  /** 追加したオブジェクトの記録と、依存する情報の無効化 */
+  private onObjectAdded(obj: GameObject): void {
+    this._addedObjectCount++
+    if (obj.type === "ENERGY") {
+      this._energyParticles.invalidate()
+    }
+    if (isUnit(obj)) {
+      this._circuitTopology.invalidateUnit(obj)
+    }
+  }
+
+  /**
+   * ストア上のオブジェクトを置き換える（空間インデックスは付け替えない）
+   * @param obj 置き換えるオブジェクト
+   * @returns 置き換えた格納位置。格納されていない場合は-1
+   */
+  private replaceObject(obj: GameObject): number {
+    const previous = this._entities.get(obj.id)
+    if (previous != null && hasConnectionChanged(previous, obj)) {
+      if (isUnit(previous)) {
+        this._circuitTopology.invalidateUnit(previous)
+      }
+      if (isUnit(obj)) {
+        this._circuitTopology.invalidateUnit(obj)
+      }
+    }
+    if (obj.type === "ENERGY" || previous?.type === "ENERGY") {
+      this._energyParticles.invalidate()
+    }
+    return this._entities.replace(obj) ? this._entities.indexOf(obj.id) : -1
+  }
+
+  private removeObjectAt(index: number): void {
+    const obj = this._entities.objectAt(index)
+    if (obj == null) {
+      return
+    }
+    if (isUnit(obj)) {
+      this._circuitTopology.invalidateUnit(obj)
+    }
+    // 格納位置が詰められる前に登録解除する。詰め直しで粒子の格納位置も変わりうる
+    this._broadphase.remove(index)
+    this._entities.removeAt(index)
+    this._energyParticles.invalidate()
+    this._removedObjectCount++
+  }
+
+  /** ブロードフェーズを検索し、結果を検索バッファに書き込む */
+  private queryBroadphase(x: number, y: number, range: number): number {
+    const count = this._broadphase.getNearbyObjectsAtPosition(x, y, range, this._queryBuffer)
+    if (count <= this._queryBuffer.length) {
+      return count
+    }
+
+    // バッファが足りない場合は拡張して再検索
+    this._queryBuffer = new Int32Array(Math.max(count, this._queryBuffer.length * 2))
+    return this._broadphase.getNearbyObjectsAtPosition(x, y, range, this._queryBuffer)
+  }
 }
@@ -0,0 +1,288 @@
+/**
+ * Worker内での世界の実行・描画用スナップショット テスト
+ */
+
+import { World } from "./world"
+import type { WorldConfig } from "./world"
+import {
+  RENDER_FLAG_ATTACHED,
+  RENDER_OBJECT_TYPES,
+  findRenderSnapshotHullAt,
+  queryRenderSnapshotRect,
+  renderSnapshotViews,
+  writeRenderSnapshot,
+} from "./render-snapshot"
+import { WorldWorkerClient, WorldWorkerHost } from "./world-worker"
+import type { WorldWorkerRequest, WorldWorkerResponse } from "./world-worker"
+import { SELF_REPLICATOR_PRESET } from "./presets/self-replicator-preset"
+import { getGameLawParameters } from "@/config/game-law-parameters"
+import type { ObjectId } from "@/types/game"
+import { isHull } from "@/utils/type-guards"
+import { Vec2 as Vec2Utils } from "@/utils/vec2"
+
+const CONFIG: WorldConfig = {
+  width: 400,
+  height: 300,
+  quiet: true,
+  parameters: { energySourceCount: 3 },
+  defaultAgentPresets: [
+    { preset: SELF_REPLICATOR_PRESET, position: Vec2Utils.create(100, 150) },
+    { preset: SELF_REPLICATOR_PRESET, position: Vec2Utils.create(300, 150) },
+  ],
+}
+
+/** オブジェクトの増えない世界（スナップショットの領域が足りなくならない） */
+const STATIC_CONFIG: WorldConfig = {
+  width: 400,
+  height: 300,
+  quiet: true,
+  parameters: { energySourceCount: 0 },
+  defaultAgentPresets: [],
+}
+
+/** HostとClientを直接つないだ組（転送した領域を記録する） */
+const connect = (config: WorldConfig = CONFIG) => {
+  const responses: WorldWorkerResponse[] = []
+  const released: ArrayBuffer[] = []
+  const scheduled: (() => void)[] = []
+  const host = new WorldWorkerHost(
+    message => responses.push(message),
+    callback => scheduled.push(callback)
+  )
+  const client = new WorldWorkerClient(
+    {
+      postMessage: (message: WorldWorkerRequest, transfer: ArrayBuffer[]) => {
+        released.push(...transfer)
+        host.handleMessage(message)
+      },
+      terminate: () => undefined,
+    },
+    config,
+    { ticksPerFrame: 3, targetFPS: 60, isPaused: false },
+    getGameLawParameters()
+  )
+  return { host, client, responses, released, scheduled }
+}
+
+describe("描画用スナップショット", () => {
+  test("オブジェクト・HULLの接続ユニット・熱グリッドを書き込む", () => {
+    const world = new World(CONFIG)
+    world.heatSystem.addHeat(3, 4, 500)
+    for (let tick = 0; tick < 5; tick++) {
+      world.tick()
+    }
+
+    const snapshot = writeRenderSnapshot(world, null)
+    const { objects, attachments, heat } = renderSnapshotViews(snapshot)
+    const expected = Array.from(world.state.objects.values())
+
+    expect(snapshot.tick).toBe(5)
+    expect(snapshot.objectCount).toBe(expected.length)
+    expect(Array.from(heat)).toEqual(Array.from(world.heatSystem.heatValues))
+    expect(snapshot.forceFields).toHaveLength(world.state.forceFields.size)
+    expect(snapshot.energySources).toHaveLength(world.state.energySources.size)
+
+    expected.forEach((obj, index) => {
+      expect(objects.id[index]).toBe(obj.id)
+      expect(RENDER_OBJECT_TYPES[objects.type[index] ?? -1]).toBe(obj.type)
+      expect(objects.x[index]).toBe(obj.position.x)
+      expect(objects.y[index]).toBe(obj.position.y)
+      expect(objects.radius[index]).toBe(obj.radius)
+      if (!isHull(obj)) {
+        return
+      }
+      const start = objects.attachStart[index] ?? 0
+      const attachedIds = Array.from(
+        attachments.subarray(start, start + (objects.attachCount[index] ?? 0))
+      ).map(unit => objects.id[unit])
+      expect(attachedIds).toEqual(obj.attachedUnitIds)
+      attachments.subarray(start, start + attachedIds.length).forEach(unit => {
+        expect((objects.flags[unit] ?? 0) & RENDER_FLAG_ATTACHED).toBe(RENDER_FLAG_ATTACHED)
+      })
+    })
+  })
+
+  test("足りる領域は再利用し、足りない場合は新たに確保する", () => {
+    const world = new World(CONFIG)
+    const first = writeRenderSnapshot(world, null)
+    expect(writeRenderSnapshot(world, first.buffer).buffer).toBe(first.buffer)
+    expect(writeRenderSnapshot(world, new ArrayBuffer(8)).buffer).not.toBe(first.buffer)
+  })
+
+  test("オブジェクトを格子順に並べ、各オブジェクトを1度ずつ含む", () => {
+    const world = new World(CONFIG)
+    for (let tick = 0; tick < 30; tick++) {
+      world.tick()
+    }
+    const snapshot = writeRenderSnapshot(world, null)
+    const { objects, cellStart, cellObjects } = renderSnapshotViews(snapshot)
+    const cellWidth = snapshot.width / snapshot.gridWidth
+    const cellHeight = snapshot.height / snapshot.gridHeight
+
+    expect(Array.from(cellObjects).sort((a, b) => a - b)).toEqual(
+      Array.from({ length: snapshot.objectCount }, (_, index) => index)
+    )
+    for (let cell = 0; cell < snapshot.gridWidth * snapshot.gridHeight; cell++) {
+      for (let k = cellStart[cell] ?? 0; k < (cellStart[cell + 1] ?? 0); k++) {
+        const index = cellObjects[k] ?? 0
+        const cellX = Math.min(
+          snapshot.gridWidth - 1,
+          Math.floor((objects.x[index] ?? 0) / cellWidth)
+        )
+        const cellY = Math.min(
+          snapshot.gridHeight - 1,
+          Math.floor((objects.y[index] ?? 0) / cellHeight)
+        )
+        expect(cellY * snapshot.gridWidth + cellX).toBe(cell)
+      }
+    }
+  })
+
+  test("矩形と重なるオブジェクトを集め、世界の外にはみ出した部分は反対側として扱う", () => {
+    const world = new World(CONFIG)
+    for (let tick = 0; tick < 30; tick++) {
+      world.tick()
+    }
+    const snapshot = writeRenderSnapshot(world, null)
+    const views = renderSnapshotViews(snapshot)
+    const { objects } = views
+    const insideOf = (left: number, top: number, right: number, bottom: number): number[] =>
+      Array.from({ length: snapshot.objectCount }, (_, index) => index).filter(index => {
+        const x = objects.x[index] ?? 0
+        const y = objects.y[index] ?? 0
+        return x >= left && x <= right && y >= top && y <= bottom
+      })
+
+    const found = queryRenderSnapshotRect(
+      snapshot,
+      views,
+      { left: 50, top: 100, right: 150, bottom: 200 },
+      []
+    )
+    expect(found).toEqual(expect.arrayContaining(insideOf(50, 100, 150, 200)))
+    expect(found.length).toBeLessThan(snapshot.objectCount)
+
+    // 左端をはみ出した部分は右端の列
+    const wrapped = queryRenderSnapshotRect(
+      snapshot,
+      views,
+      { left: -60, top: 0, right: 10, bottom: 300 },
+      [1, 2, 3]
+    )
+    expect(wrapped).toEqual(expect.arrayContaining(insideOf(340, 0, 400, 300)))
+    expect(wrapped).toEqual(expect.arrayContaining(insideOf(0, 0, 10, 300)))
+    expect(new Set(wrapped).size).toBe(wrapped.length)
+
+    // 世界より広い範囲では全オブジェクトを1度ずつ含む
+    const all = queryRenderSnapshotRect(
+      snapshot,
+      views,
+      { left: -1000, top: -1000, right: 2000, bottom: 2000 },
+      []
+    )
+    expect(all.sort((a, b) => a - b)).toEqual(insideOf(-Infinity, -Infinity, Infinity, Infinity))
+  })
+
+  test("指定位置を含むHULLを探す", () => {
+    const world = new World(CONFIG)
+    const snapshot = writeRenderSnapshot(world, null)
+    const hull = Array.from(world.state.objects.values()).find(isHull)
+    if (hull == null) {
+      throw new Error("HULLがありません")
+    }
+
+    const index = findRenderSnapshotHullAt(snapshot, hull.position.x + 1, hull.position.y)
+    expect(renderSnapshotViews(snapshot).objects.id[index]).toBe(hull.id)
+    expect(findRenderSnapshotHullAt(snapshot, 200, 20)).toBe(-1)
+  })
+})
+
+describe("Worker内での世界の実行", () => {
+  test("1フレームごとに指定tick数進め、スナップショットを送る", () => {
+    const { host, client, responses, scheduled } = connect()
+
+    expect(scheduled).toHaveLength(1)
+    expect(host.runFrame()).toBe(3)
+    expect(responses).toHaveLength(1)
+
+    client.handleMessage(responses[0]!)
+    expect(client.snapshot?.tick).toBe(3)
+  })
+
+  test("2つの領域を交互に使い、返却されるまでは送信を見送って世界だけを進める", () => {
+    const { host, client, responses, released } = connect()
+
+    host.runFrame()
+    host.runFrame()
+    host.runFrame()
+    // 返却前は2回分のみ送る
+    expect(responses.map(response => response.snapshot.tick)).toEqual([3, 6])
+
+    // 2つ目を受け取ると1つ目の領域が返却され、次のフレームで再利用される
+    client.handleMessage(responses[0]!)
+    client.handleMessage(responses[1]!)
+    expect(released).toEqual([responses[0]!.snapshot.buffer])
+
+    host.runFrame()
+    expect(responses).toHaveLength(3)
+    expect(responses[2]!.snapshot.tick).toBe(12)
+    expect(responses[2]!.snapshot.buffer).toBe(responses[0]!.snapshot.buffer)
+  })
+
+  test("描画が遅れても世界は進み続け、返却のたびに最新の状態を2つの領域で送る", () => {
+    const { host, client, responses, released } = connect(STATIC_CONFIG)
+
+    // 受け取られないまま4フレーム進めると、送るのは2回分のみで世界は12tickまで進む
+    for (let frame = 0; frame < 4; frame++) {
+      expect(host.runFrame()).toBe(3)
+    }
+    expect(responses.map(response => response.snapshot.tick)).toEqual([3, 6])
+    client.handleMessage(responses[0]!)
+    expect(released).toHaveLength(0)
+
+    // 受け取るたびに前の領域が返却され、次のフレームで最新の状態を送る
+    for (let cycle = 0; cycle < 5; cycle++) {
+      const latest = responses[responses.length - 1]!
+      const before = responses.length
+      client.handleMessage(latest)
+      expect(client.snapshot).toBe(latest.snapshot)
+
+      host.runFrame()
+      expect(responses).toHaveLength(before + 1)
+      expect(responses[before]!.snapshot.tick).toBe(15 + cycle * 3)
+      expect(responses[before]!.snapshot.buffer).toBe(released[released.length - 1])
+    }
+
+    // 返却されるのは受け取り済みの領域のみで、使う領域は2つのまま
+    expect(released).toHaveLength(5)
+    expect(new Set(responses.map(response => response.snapshot.buffer)).size).toBe(2)
+
+    // 受け取らなければ再び送信を見送る
+    host.runFrame()
+    expect(responses).toHaveLength(7)
+  })
+
+  test("一時停止中は進めず、状態が変わった場合のみ送る", () => {
+    const { host, client, responses } = connect()
+    client.updateSettings({ isPaused: true })
+
+    expect(host.runFrame()).toBe(0)
+    expect(responses).toHaveLength(1)
+    client.handleMessage(responses[0]!)
+
+    host.runFrame()
+    expect(responses).toHaveLength(1)
+
+    client.addForceField({
+      id: 900 as ObjectId,
+      type: "SPIRAL",
+      position: Vec2Utils.create(200, 150),
+      radius: 100,
+      strength: 5,
+    })
+    host.runFrame()
+    expect(responses).toHaveLength(2)
+    expect(responses[1]!.snapshot.tick).toBe(0)
+    expect(responses[1]!.snapshot.forceFields.map(field => field.id)).toContain(900)
+  })
+})
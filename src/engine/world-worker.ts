@@ -0,0 +1,209 @@
+/**
+ * Worker内での世界の実行
+ *
+ * WorldWorkerHostはWorker内で世界を進め、一定間隔で描画用スナップショットを送る。
+ * WorldWorkerClientはメインスレッド側で最新のスナップショットを保持し、操作をWorkerへ送る。
+ * スナップショットの領域は2つを交互に使う（ダブルバッファ）。送った領域はメインスレッドが
+ * 次のスナップショットを受け取った時点で返却されるため、両方が返却待ちの間は送信を見送り、
+ * 世界だけを進める。そのため描画が追いつかなくても世界の進行は止まらない
+ */
+
+import type { DirectionalForceField, ObjectId } from "@/types/game"
+import type { GameLawParameters } from "@/config/game-law-parameters"
+import { setGameLawParameters } from "@/config/game-law-parameters"
+import { World } from "./world"
+import type { WorldConfig } from "./world"
+import { writeRenderSnapshot } from "./render-snapshot"
+import type { RenderSnapshot } from "./render-snapshot"
+
+/** Worker内で使える世界の設定（全ての項目がプレーンなデータのため、そのまま送れる） */
+export type WorldWorkerConfig = WorldConfig
+
+/** 世界の進め方 */
+export type WorldWorkerSettings = {
+  /** 1フレームあたりのtick数 */
+  readonly ticksPerFrame: number
+  /** 1秒あたりのフレーム数 */
+  readonly targetFPS: number
+  readonly isPaused: boolean
+}
+
+/** メインスレッドからWorkerへのメッセージ */
+export type WorldWorkerRequest =
+  | {
+      readonly type: "init"
+      readonly config: WorldWorkerConfig
+      readonly settings: WorldWorkerSettings
+      /** ゲーム法則パラメータ（Worker内のモジュールはメインスレッドと共有されないため送る） */
+      readonly lawParameters: GameLawParameters
+    }
+  | { readonly type: "settings"; readonly settings: Partial<WorldWorkerSettings> }
+  | { readonly type: "addForceField"; readonly field: DirectionalForceField }
+  | { readonly type: "selectHull"; readonly hullId: ObjectId | null }
+  /** 描画を終えたスナップショットの領域の返却 */
+  | { readonly type: "release"; readonly buffer: ArrayBuffer }
+
+/** Workerからメインスレッドへのメッセージ */
+export type WorldWorkerResponse = { readonly type: "snapshot"; readonly snapshot: RenderSnapshot }
+
+/** スナップショットの領域の数 */
+const SNAPSHOT_BUFFER_COUNT = 2
+
+/**
+ * Worker側の世界の実行
+ */
+export class WorldWorkerHost {
+  private _world: World | null = null
+  private _settings: WorldWorkerSettings = { ticksPerFrame: 1, targetFPS: 60, isPaused: false }
+  /** 送信に使える領域（nullは未確保） */
+  private readonly _freeBuffers: (ArrayBuffer | null)[] = Array.from(
+    { length: SNAPSHOT_BUFFER_COUNT },
+    () => null
+  )
+  /** 前回のスナップショットの送信後に状態が変わったか */
+  private _dirty = true
+  private _running = false
+
+  /**
+   * @param _post メインスレッドへの送信（transferの領域は送信後に使えなくなる）
+   * @param _schedule 次のフレームの予約
+   */
+  public constructor(
+    private readonly _post: (message: WorldWorkerResponse, transfer: ArrayBuffer[]) => void,
+    private readonly _schedule: (callback: () => void, delayMs: number) => void = (
+      callback,
+      delayMs
+    ) => {
+      setTimeout(callback, delayMs)
+    }
+  ) {}
+
+  /** メインスレッドからのメッセージを処理する */
+  public handleMessage(message: WorldWorkerRequest): void {
+    switch (message.type) {
+      case "init":
+        setGameLawParameters(message.lawParameters)
+        this._world = new World(message.config)
+        this._settings = message.settings
+        this._dirty = true
+        if (!this._running) {
+          this._running = true
+          this._schedule(() => this.loop(), 0)
+        }
+        return
+      case "settings":
+        this._settings = { ...this._settings, ...message.settings }
+        return
+      case "addForceField":
+        this._world?.addForceField(message.field)
+        this._dirty = true
+        return
+      case "selectHull":
+        this._world?.debugger?.setSelectedHull(message.hullId)
+        return
+      case "release":
+        if (this._freeBuffers.length < SNAPSHOT_BUFFER_COUNT) {
+          this._freeBuffers.push(message.buffer)
+        }
+        return
+    }
+  }
+
+  /**
+   * 1フレーム分進め、送信できる領域があればスナップショットを送る
+   * @returns 進めたtick数
+   */
+  public runFrame(): number {
+    const world = this._world
+    if (world == null) {
+      return 0
+    }
+
+    const { ticksPerFrame, isPaused } = this._settings
+    const ticks = isPaused ? 0 : Math.max(0, Math.floor(ticksPerFrame))
+    for (let i = 0; i < ticks; i++) {
+      world.tick()
+    }
+    if (ticks > 0) {
+      this._dirty = true
+    }
+
+    if (this._dirty && this._freeBuffers.length > 0) {
+      const snapshot = writeRenderSnapshot(world, this._freeBuffers.pop() ?? null)
+      this._post({ type: "snapshot", snapshot }, [snapshot.buffer])
+      this._dirty = false
+    }
+    return ticks
+  }
+
+  private loop(): void {
+    const startTime = performance.now()
+    this.runFrame()
+    const frameTime = 1000 / Math.max(1, this._settings.targetFPS)
+    this._schedule(() => this.loop(), Math.max(0, frameTime - (performance.now() - startTime)))
+  }
+}
+
+/** Worker（Web Worker / worker_threads）のうちクライアントが使う操作 */
+export type WorldWorkerHandle = {
+  postMessage: (message: WorldWorkerRequest, transfer: ArrayBuffer[]) => void
+  terminate: () => unknown
+}
+
+/**
+ * メインスレッド側の世界の操作
+ * Workerからのメッセージは handleMessage に渡す
+ */
+export class WorldWorkerClient {
+  private _snapshot: RenderSnapshot | null = null
+
+  /** 最新のスナップショット（まだ受け取っていない場合はnull） */
+  public get snapshot(): RenderSnapshot | null {
+    return this._snapshot
+  }
+
+  /**
+   * @param _worker Worker（エントリポイントはWorldWorkerHostへメッセージを渡す）
+   * @param config 世界の設定
+   * @param settings 世界の進め方
+   * @param lawParameters ゲーム法則パラメータ
+   */
+  public constructor(
+    private readonly _worker: WorldWorkerHandle,
+    config: WorldWorkerConfig,
+    settings: WorldWorkerSettings,
+    lawParameters: GameLawParameters
+  ) {
+    this._worker.postMessage({ type: "init", config, settings, lawParameters }, [])
+  }
+
+  /** Workerからのメッセージを処理する */
+  public handleMessage(message: WorldWorkerResponse): void {
+    // 描画は受け取ったフレーム内で終わるため、前のスナップショットの領域は返却できる
+    const previous = this._snapshot
+    this._snapshot = message.snapshot
+    if (previous != null) {
+      this._worker.postMessage({ type: "release", buffer: previous.buffer }, [previous.buffer])
+    }
+  }
+
+  /** 世界の進め方を変更する */
+  public updateSettings(settings: Partial<WorldWorkerSettings>): void {
+    this._worker.postMessage({ type: "settings", settings }, [])
+  }
+
+  /** 力場を追加する */
+  public addForceField(field: DirectionalForceField): void {
+    this._worker.postMessage({ type: "addForceField", field }, [])
+  }
+
+  /** デバッガーに選択中のHULLを通知する */
+  public selectHull(hullId: ObjectId | null): void {
+    this._worker.postMessage({ type: "selectHull", hullId }, [])
+  }
+
+  /** Workerを終了する */
+  public terminate(): void {
+    this._worker.terminate()
+  }
+}
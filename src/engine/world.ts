@@ -8,7 +8,14 @@ import { HullEnergyManager } from "./hull-energy-manager"
 import { EnergySourceManager } from "./energy-source-manager"
 import { EnergyCollector } from "./energy-collector"
 import { EnergyDecaySystem } from "./energy-decay-system"
-import { ComputerVMSystem, DebugComputerVMSystem } from "./computer-vm-system"
+import type { EnergyCoalescingParameters } from "./energy-coalescing-system"
+import { DEFAULT_COALESCING_PARAMETERS, EnergyCoalescingSystem } from "./energy-coalescing-system"
+import type { EnergyDensityFieldParameters } from "./energy-density-field"
+import { DEFAULT_DENSITY_FIELD_PARAMETERS, EnergyDensityField } from "./energy-density-field"
+import { ENTITY_KIND } from "./entity-store"
+import { HeatDepositBuffer } from "./heat-deposit-buffer"
+import { WorldCommandBuffer } from "./world-command-buffer"
+import { ComputerVMSystem, DebugComputerVMSystem, VMExecutionMode } from "./computer-vm-system"
 import { AgentFactory } from "./agent-factory"
 import type {
   GameObject,
@@ -21,14 +28,16 @@ import type {
   Unit,
   Assembler,
   Vec2,
-  ObjectId,
 } from "@/types/game"
+import type { EnergyParticleBatch } from "./energy-particle-system"
 import type { HeatSystem } from "./heat-system"
-import { isHull, isEnergyObject } from "@/utils/type-guards"
+import { HEAT_TILE_SIZE } from "./heat-system"
+import { isHull, isEnergyObject, isComputer } from "@/utils/type-guards"
 import { Vec2 as Vec2Utils } from "@/utils/vec2"
 
 import type { AgentPresetPlacement } from "./presets/types"
 import { WorldDebugger } from "./world-debugger"
+import { TickInstrumentation } from "./tick-instrumentation"
 
 export type WorldConfig = {
   width: number
@@ -36,10 +45,32 @@ export type WorldConfig = {
   parameters?: Partial<WorldParameters>
   defaultAgentPresets?: readonly AgentPresetPlacement[]
   debugMode?: boolean
+  /** COMPUTERのVM実行方式（省略時はinterpreter） */
+  vmExecutionMode?: VMExecutionMode
+  /** tick処理の計測を行うか（省略時は有効） */
+  instrumentation?: boolean
+  /** 初期化時のログ出力を抑制するか（ヘッドレス実行用） */
+  quiet?: boolean
+  /**
+   * エネルギーソースの配置・出力に使う乱数（[0, 1)、省略時はMath.random）
+   * シード付きの乱数を渡すと、同じ設定から同じ経過を再現できる
+   */
+  random?: () => number
+  /**
+   * 格子内の遅いエネルギーオブジェクトの統合（指定した場合のみ有効。{} でデフォルトパラメータを使う）
+   */
+  energyCoalescing?: Partial<EnergyCoalescingParameters>
+  /**
+   * エネルギー密度場（指定した場合はエネルギーソースの出力をオブジェクトではなく密度場に置く）
+   * 非常に大きな世界向け。{} でデフォルトパラメータを使う
+   */
+  energyDensityField?: Partial<EnergyDensityFieldParameters>
 }
 
 export class World {
   public readonly debugger: WorldDebugger | null
+  /** tick処理の計測（instrumentation: false 指定時はnull） */
+  public readonly instrumentation: TickInstrumentation | null
 
   private readonly _stateManager: WorldStateManager
   private readonly _objectFactory: ObjectFactory
@@ -47,7 +78,14 @@ export class World {
   private readonly _energySourceManager: EnergySourceManager
   private readonly _energyCollector: EnergyCollector
   private readonly _energyDecaySystem: EnergyDecaySystem
+  private readonly _energyCoalescingSystem: EnergyCoalescingSystem | null
+  private readonly _energyDensityField: EnergyDensityField | null
+  /** エネルギーの崩壊による熱の累積（tickごとに使い回す） */
+  private readonly _heatDeposits: HeatDepositBuffer
+  /** tick内の構造変更の記録（フェーズの間にまとめて反映する） */
+  private readonly _commands = new WorldCommandBuffer()
   private readonly _computerVMSystem: ComputerVMSystem
+  private readonly _random: () => number
 
   /** ワールド状態を取得 */
   public get state() {
@@ -59,7 +97,14 @@ export class World {
     return this._stateManager.heatSystem
   }
 
+  /** エネルギー密度場を取得（密度場を使わない場合はnull） */
+  public get energyDensityField(): EnergyDensityField | null {
+    return this._energyDensityField
+  }
+
   public constructor(config: WorldConfig) {
+    this._random = config.random ?? Math.random
+
     // 状態管理の初期化
     this._stateManager = new WorldStateManager(config.width, config.height, config.parameters)
 
@@ -70,7 +115,12 @@ export class World {
     this._hullEnergyManager = new HullEnergyManager()
 
     // エネルギーソース管理の初期化
-    this._energySourceManager = new EnergySourceManager(config.width, config.height)
+    this._energySourceManager = new EnergySourceManager(
+      config.width,
+      config.height,
+      undefined,
+      this._random
+    )
 
     // エネルギー収集システムの初期化
     this._energyCollector = new EnergyCollector(config.width, config.height)
@@ -78,15 +128,42 @@ export class World {
     // エネルギー崩壊システムの初期化
     this._energyDecaySystem = new EnergyDecaySystem()
 
+    // エネルギー統合システムの初期化
+    this._energyCoalescingSystem =
+      config.energyCoalescing == null
+        ? null
+        : new EnergyCoalescingSystem(config.width, config.height, {
+            ...DEFAULT_COALESCING_PARAMETERS,
+            ...config.energyCoalescing,
+          })
+
+    // 熱の累積バッファの初期化
+    const heatSystem = this._stateManager.heatSystem
+    this._heatDeposits = new HeatDepositBuffer(heatSystem.width * heatSystem.height)
+
+    // エネルギー密度場の初期化
+    this._energyDensityField =
+      config.energyDensityField == null
+        ? null
+        : new EnergyDensityField(config.width, config.height, {
+            ...DEFAULT_DENSITY_FIELD_PARAMETERS,
+            ...config.energyDensityField,
+          })
+
+    // tick処理の計測
+    this.instrumentation = config.instrumentation === false ? null : new TickInstrumentation()
+
     // ComputerVMシステムの初期化（デバッグモードに応じて切り替え）
     if (config.debugMode === true) {
-      const debugVMSystem = new DebugComputerVMSystem()
-      this.debugger = new WorldDebugger(debugVMSystem)
+      const debugVMSystem = new DebugComputerVMSystem(config.vmExecutionMode)
+      this.debugger = new WorldDebugger(debugVMSystem, this.instrumentation)
       this._computerVMSystem = debugVMSystem
-      console.log("[World] デバッグモードで起動")
+      if (config.quiet !== true) {
+        console.log("[World] デバッグモードで起動")
+      }
     } else {
       this.debugger = null
-      this._computerVMSystem = new ComputerVMSystem()
+      this._computerVMSystem = new ComputerVMSystem(config.vmExecutionMode)
     }
 
     this.initialize(config)
@@ -102,6 +179,9 @@ export class World {
       this.placeDefaultAgents(config.defaultAgentPresets)
     }
 
+    if (config.quiet === true) {
+      return
+    }
     console.log(`World initialized: ${config.width}x${config.height}`)
     console.log(`Energy sources: ${this._stateManager.state.energySources.size}`)
     console.log(`Initial objects: ${this._stateManager.state.objects.size}`)
@@ -130,11 +210,11 @@ export class World {
     const height = this._stateManager.state.height
 
     for (let i = 0; i < params.energySourceCount; i++) {
-      const position = Vec2Utils.create(Math.random() * width, Math.random() * height)
+      const position = Vec2Utils.create(this._random() * width, this._random() * height)
 
       const energyPerTick =
         params.energySourceMinRate +
-        Math.random() * (params.energySourceMaxRate - params.energySourceMinRate)
+        this._random() * (params.energySourceMaxRate - params.energySourceMinRate)
 
       const source: EnergySource = {
         id: this._stateManager.generateObjectId(),
@@ -146,6 +226,15 @@ export class World {
     }
   }
 
+  /**
+   * エネルギー粒子の列（描画用スナップショットなど、一括で読み出す処理向け）
+   * 呼び出しごとにエンティティストアから集め直し、次の呼び出しまで有効
+   */
+  public gatherEnergyParticles(): EnergyParticleBatch {
+    this._stateManager.energyParticles.invalidate()
+    return this._stateManager.gatherEnergyParticles()
+  }
+
   public updateParameters(params: Partial<WorldParameters>): void {
     this._stateManager.updateParameters(params)
   }
@@ -193,11 +282,18 @@ export class World {
   public tick(): void {
     // ticksPerFrame回数分のtickを実行
     const ticksPerFrame = this._stateManager.state.parameters.ticksPerFrame
+    const instrumentation = this.instrumentation
     for (let i = 0; i < ticksPerFrame; i++) {
       this._stateManager.incrementTick()
+      instrumentation?.beginTick()
+      // tick外でのオブジェクトへの書き込みを反映するため、粒子の列はtickごとに集め直す
+      this._stateManager.energyParticles.invalidate()
+      const addedObjectCount = this._stateManager.addedObjectCount
+      const removedObjectCount = this._stateManager.removedObjectCount
 
       // 物理演算の実行（1tick = 1時間単位）
-      this._stateManager.updatePhysics(1.0)
+      const physicsResult = this._stateManager.updatePhysics(1.0)
+      instrumentation?.endPhase("physics")
 
       // エネルギーシステムの更新
       this.updateEnergySystem()
@@ -207,6 +303,20 @@ export class World {
 
       // 熱システムの更新
       this.updateHeatSystem()
+
+      if (instrumentation != null) {
+        instrumentation.count("objectsProcessed", physicsResult.objectCount)
+        instrumentation.count("collisionPairs", physicsResult.collisionCount)
+        instrumentation.count(
+          "objectsAllocated",
+          this._stateManager.addedObjectCount - addedObjectCount
+        )
+        instrumentation.count(
+          "objectsRemoved",
+          this._stateManager.removedObjectCount - removedObjectCount
+        )
+        instrumentation.endTick()
+      }
     }
   }
 
@@ -214,100 +324,191 @@ export class World {
   private updateEnergySystem(): void {
     // エネルギーソースからの生成
     this.generateEnergyFromSources()
+    this.commitCommands()
+    this.instrumentation?.endPhase("energyGeneration")
+
+    // 格子内の遅いエネルギーオブジェクトの統合
+    this.coalesceEnergyObjects()
+    this.commitCommands()
+    this.instrumentation?.endPhase("energyCoalescing")
+
+    // エネルギー密度場の移流・拡散
+    this._energyDensityField?.step(this._stateManager.state.forceFields)
+    this.instrumentation?.endPhase("energyField")
 
     // エネルギーの自然崩壊
     this.processEnergyDecay()
+    this.commitCommands()
+    this.instrumentation?.endPhase("energyDecay")
 
     // HULLによるエネルギー収集
     this.collectEnergyForHulls()
+    this.commitCommands()
+    this.instrumentation?.endPhase("energyCollection")
+  }
+
+  /** 記録した構造変更をまとめて反映 */
+  private commitCommands(): void {
+    this._stateManager.commit(this._commands)
   }
 
   /** エネルギーソースからエネルギーを生成 */
   private generateEnergyFromSources(): void {
+    const field = this._energyDensityField
     for (const source of this._stateManager.state.energySources.values()) {
+      // 密度場を使う場合は出力をソースの位置のセルに置く
+      if (field != null) {
+        field.deposit(source.position, source.energyPerTick)
+        continue
+      }
+
       const result = this._energySourceManager.generateEnergy(source, () =>
         this._stateManager.generateObjectId()
       )
 
       // 生成されたエネルギーオブジェクトを追加
       for (const energyObj of result.generatedObjects) {
-        this._stateManager.addObject(energyObj)
+        this._commands.spawn(energyObj)
+      }
+    }
+  }
+
+  /** 格子ごとの上限を超えた遅いエネルギーオブジェクトを統合 */
+  private coalesceEnergyObjects(): void {
+    if (this._energyCoalescingSystem == null) {
+      return
+    }
+
+    // 種別の列からエネルギーオブジェクトを抽出
+    const entities = this._stateManager.entities
+    const energyObjects: EnergyObject[] = []
+    for (let index = 0; index < entities.count; index++) {
+      if (entities.kind[index] !== ENTITY_KIND.ENERGY) {
+        continue
+      }
+      const obj = entities.objectAt(index)
+      if (obj != null && isEnergyObject(obj)) {
+        energyObjects.push(obj)
       }
     }
+
+    // エネルギー量・運動量は統合先に移るため熱は発生しない
+    const result = this._energyCoalescingSystem.coalesce(energyObjects)
+    for (const id of result.removedIds) {
+      this._commands.despawn(id)
+    }
+    for (const merged of result.mergedObjects) {
+      this._commands.update(merged)
+    }
   }
 
   /** HULLのエネルギー収集処理 */
   private collectEnergyForHulls(): void {
+    // 種別の列からHULLを抽出
+    const entities = this._stateManager.entities
     const hulls: Hull[] = []
-    const energyObjectsMap = new Map<EnergyObject["id"], EnergyObject>()
-
-    // HULLとエネルギーオブジェクトを分類
-    for (const obj of this._stateManager.state.objects.values()) {
-      if (isHull(obj)) {
+    for (let index = 0; index < entities.count; index++) {
+      if (entities.kind[index] !== ENTITY_KIND.HULL) {
+        continue
+      }
+      const obj = entities.objectAt(index)
+      if (obj != null && isHull(obj)) {
         hulls.push(obj)
-      } else if (isEnergyObject(obj)) {
-        energyObjectsMap.set(obj.id, obj)
       }
     }
 
-    // 各HULLのエネルギー収集
+    if (hulls.length === 0) {
+      return
+    }
+
+    // 各HULLの収集範囲内のエネルギー粒子を空間インデックスから取得して収集する。
+    // 削除で格納位置が変わるため、収集済みの粒子は印を付けて全HULLの処理後にまとめて削除する
+    const particles = this._stateManager.gatherEnergyParticles()
+    const claimed = new Uint8Array(particles.count)
+    const collected = new Int32Array(particles.count)
+    const candidates: number[] = []
+    const field = this._energyDensityField
     for (const hull of hulls) {
-      const result = this._energyCollector.collectEnergy(hull, energyObjectsMap)
+      const collectionRadius = this._energyCollector.getCollectionRadius(hull)
+      const { x, y } = hull.position
+      const nearby = this._stateManager.getIndicesNearPosition(x, y, collectionRadius)
+      candidates.length = 0
+      for (let k = 0; k < nearby.length; k++) {
+        const particle = particles.particleAt(nearby[k] ?? -1)
+        if (particle >= 0 && claimed[particle] !== 1) {
+          candidates.push(particle)
+        }
+      }
 
-      if (result.collectedIds.length > 0) {
-        // HULLにエネルギーを追加
-        const energyResult = this._hullEnergyManager.addEnergy(hull, result.totalEnergy)
+      const result =
+        candidates.length === 0
+          ? { count: 0, totalEnergy: 0 }
+          : this._energyCollector.collectParticles(
+              hull,
+              particles,
+              candidates,
+              candidates.length,
+              collected
+            )
+
+      // エネルギー密度場からは粒子で収集した分を除いた残り容量まで収集する
+      const fieldEnergy =
+        field == null ? 0 : this._energyCollector.collectFromField(hull, field, result.totalEnergy)
+      const totalEnergy = result.totalEnergy + fieldEnergy
+      if (totalEnergy === 0) {
+        continue
+      }
 
-        // HULLを更新
-        this._stateManager.updateObject(energyResult.updatedHull)
+      // HULLにエネルギーを追加
+      const energyResult = this._hullEnergyManager.addEnergy(hull, totalEnergy)
+      this._commands.update(energyResult.updatedHull)
 
-        // 収集されたエネルギーオブジェクトを削除
-        for (const id of result.collectedIds) {
-          this._stateManager.removeObject(id)
-          // Mapからも削除
-          energyObjectsMap.delete(id)
-        }
+      // 収集されたエネルギーオブジェクトを削除
+      for (let k = 0; k < result.count; k++) {
+        const particle = collected[k] ?? 0
+        claimed[particle] = 1
+        this._commands.despawnAt(particles.index[particle] ?? -1)
       }
     }
   }
 
   /** エネルギーの自然崩壊処理 */
   private processEnergyDecay(): void {
-    const energyObjectsMap = new Map<EnergyObject["id"], EnergyObject>()
-
-    // エネルギーオブジェクトを抽出
-    for (const obj of this._stateManager.state.objects.values()) {
-      if (obj.type === "ENERGY") {
-        const energyObj = obj as EnergyObject
-        energyObjectsMap.set(energyObj.id, energyObj)
-      }
-    }
-
-    // 崩壊処理
-    const decayResult = this._energyDecaySystem.processDecay(energyObjectsMap)
-
-    // 完全に崩壊したオブジェクトを削除（熱を発生）
-    for (const id of decayResult.removedIds) {
-      const obj = this._stateManager.getObject(id)
-      if (obj != null) {
-        const energyObj = obj as EnergyObject
-        // 削除前に熱を発生させる（オブジェクトが持っていた全エネルギー）
-        this._stateManager.addHeatToCell(obj.position, energyObj.energy)
-        this._stateManager.removeObject(id)
+    const entities = this._stateManager.entities
+    const particles = this._stateManager.gatherEnergyParticles()
+
+    // 崩壊後のエネルギー量を粒子の列に書き込む
+    this._energyDecaySystem.processDecayBatch(particles)
+
+    // 崩壊した分の熱はセルごとに累積してまとめて加える
+    const heatSystem = this._stateManager.heatSystem
+    const deposits = this._heatDeposits
+    for (let k = 0; k < particles.count; k++) {
+      const index = particles.index[k] ?? 0
+      const remaining = particles.energy[k] ?? 0
+
+      // 崩壊した分の熱を発生（完全に崩壊した場合はオブジェクトが持っていた全エネルギー）
+      const position = { x: particles.positionX[k] ?? 0, y: particles.positionY[k] ?? 0 }
+      const decayAmount = (entities.energy[index] ?? 0) - Math.max(0, remaining)
+      deposits.add(heatSystem.cellIndexAt(position), decayAmount)
+
+      if (remaining <= 0) {
+        // 完全に崩壊したオブジェクトを削除
+        this._commands.despawnAt(index)
+      } else {
+        // 粒子の列は集め直さずに続けて使うため、ストアと同じ値を書き込む
+        entities.energy[index] = remaining
+        entities.mass[index] = remaining // 質量も同時に更新
+        entities.writeBackEnergy(index)
+        particles.mass[k] = remaining
       }
     }
+    heatSystem.applyDeposits(deposits)
 
-    // 部分的に崩壊したオブジェクトを更新（熱を発生）
-    for (const [id, updatedObj] of decayResult.updatedObjects.entries()) {
-      const originalObj = this._stateManager.getObject(id)
-      if (originalObj != null) {
-        // 崩壊した分の熱を発生
-        const decayAmount = (originalObj as EnergyObject).energy - updatedObj.energy
-        this._stateManager.addHeatToCell(originalObj.position, decayAmount)
-        // オブジェクトを更新
-        this._stateManager.updateObject(updatedObj)
-      }
-    }
+    // エネルギー密度場のセルごとの崩壊
+    this._energyDensityField?.decay(this._energyDecaySystem, (position, heat) =>
+      this._stateManager.addHeatToCell(position, heat)
+    )
   }
 
   /** ユニットシステムの更新 */
@@ -316,49 +517,53 @@ export class World {
 
     // COMPUTERユニットのVM実行
     this.executeComputerVMs()
+    this.instrumentation?.endPhase("vm")
   }
 
   /** COMPUTERユニットのVM実行 */
   private executeComputerVMs(): void {
-    const objects = this._stateManager.getAllObjects()
-
-    const units = new Map<ObjectId, Unit>()
+    // 種別の列からCOMPUTERを抽出（VM実行中のオブジェクト更新で格納位置が変わり得るため先に集める）
+    const entities = this._stateManager.entities
     const computers: Computer[] = []
-
-    objects.forEach(obj => {
-      switch (obj.type) {
-        case "HULL":
-        case "ASSEMBLER":
-          units.set(obj.id, obj as Unit)
-          break
-        case "COMPUTER":
-          units.set(obj.id, obj as Computer)
-          computers.push(obj as Computer)
-          break
-        case "ENERGY":
-          break
-        default: {
-          // const _: never = obj // なぜかエラーとなる
-          break
-        }
+    for (let index = 0; index < entities.count; index++) {
+      if (entities.kind[index] !== ENTITY_KIND.COMPUTER) {
+        continue
       }
-    })
+      const obj = entities.objectAt(index)
+      if (obj != null && isComputer(obj)) {
+        computers.push(obj)
+      }
+    }
 
+    // 回路トポロジーはキャッシュから取得し、接続関係が変わった場合のみ再探索される
+    const circuitTopology = this._stateManager.circuitTopology
+    let cycles = 0
     computers.forEach(computer => {
-      this._computerVMSystem.executeVM(computer, unitId => units.get(unitId) ?? null)
+      cycles += this._computerVMSystem.executeVM(computer, circuitTopology.getUnitPort(computer))
     })
+    this.instrumentation?.count("vmCycles", cycles)
   }
 
   /** 熱システムの更新 */
   private updateHeatSystem(): void {
+    const heatSystem = this._stateManager.heatSystem
+    this.instrumentation?.count(
+      "heatCellsTouched",
+      heatSystem.activeTileCount * HEAT_TILE_SIZE * HEAT_TILE_SIZE
+    )
+
     // 熱拡散の計算（セルオートマトン）
-    this._stateManager.heatSystem.updateDiffusion()
+    heatSystem.updateDiffusion()
+    this.instrumentation?.endPhase("heatDiffusion")
 
     // 放熱処理
-    this._stateManager.heatSystem.updateRadiation()
+    heatSystem.updateRadiation()
+    this.instrumentation?.endPhase("heatRadiation")
 
     // 熱によるダメージ処理
     this.applyHeatDamage()
+    this.commitCommands()
+    this.instrumentation?.endPhase("heatDamage")
   }
 
   /** 熱によるダメージをユニットに適用 */
@@ -394,11 +599,11 @@ export class World {
           unit.energy = Math.min(unit.energy, unit.currentEnergy)
 
           // オブジェクトを更新
-          this._stateManager.updateObject(unit)
+          this._commands.update(unit)
 
           // ユニットが破壊された場合
           if (unit.currentEnergy === 0) {
-            this._stateManager.removeObject(unit.id)
+            this._commands.despawn(unit.id)
 
             // 破壊による熱の追加（エネルギーの10%が熱に変換）
             const heatGenerated = Math.floor(unit.buildEnergy * 0.1)
@@ -0,0 +1,19 @@
+/**
+ * 世界を実行するWorkerのエントリポイント
+ *
+ * 例:
+ *   const worker = new Worker(new URL("./world.worker.ts", import.meta.url))
+ *   const client = new WorldWorkerClient(worker, config, settings, getGameLawParameters())
+ *   worker.onmessage = event => client.handleMessage(event.data)
+ */
+
+import { WorldWorkerHost } from "./world-worker"
+import type { WorldWorkerRequest } from "./world-worker"
+
+const host = new WorldWorkerHost((message, transfer) => {
+  self.postMessage(message, { transfer })
+})
+
+self.onmessage = (event: MessageEvent<WorldWorkerRequest>) => {
+  host.handleMessage(event.data)
+}
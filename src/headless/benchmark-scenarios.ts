@@ -0,0 +1,62 @@
+/**
+ * ベンチマークスイートのシナリオ
+ *
+ * サブシステムごとの負荷を切り分けられるよう、負荷の偏ったシナリオを用意する。
+ * 結果をコミット間で比較するため、シナリオの内容を変更する場合は名前も変える
+ */
+
+import type { HeadlessScenario } from "./headless-scenario"
+
+/** エネルギー粒子の大量配置（物理・エネルギー崩壊・熱への変換） */
+export const ENERGY_FLOOD_SCENARIO: HeadlessScenario = {
+  name: "energy-flood",
+  width: 2000,
+  height: 2000,
+  ticks: 200,
+  seed: 1,
+  parameters: { energySourceCount: 50 },
+  energyParticles: { count: 20000, amount: 10 },
+}
+
+/** 自己複製エージェント1,000体（VM・回路アクセス・HULLのエネルギー収集） */
+export const SELF_REPLICATORS_1K_SCENARIO: HeadlessScenario = {
+  name: "self-replicators-1k",
+  width: 1600,
+  height: 1600,
+  ticks: 200,
+  seed: 1,
+  parameters: { energySourceCount: 20 },
+  vmExecutionMode: "jit",
+  selfReplicators: 1000,
+}
+
+/** 自己複製エージェント10,000体 */
+export const SELF_REPLICATORS_10K_SCENARIO: HeadlessScenario = {
+  name: "self-replicators-10k",
+  width: 5000,
+  height: 5000,
+  ticks: 50,
+  seed: 1,
+  parameters: { energySourceCount: 100 },
+  vmExecutionMode: "jit",
+  selfReplicators: 10000,
+}
+
+/** 毎tickランダムな位置に大量の熱を加える（熱拡散・放熱・熱ダメージ） */
+export const HEAT_STORM_SCENARIO: HeadlessScenario = {
+  name: "heat-storm",
+  width: 2000,
+  height: 2000,
+  ticks: 200,
+  seed: 1,
+  parameters: { energySourceCount: 0 },
+  selfReplicators: 100,
+  heatStorm: { spotsPerTick: 200, heatPerSpot: 500 },
+}
+
+export const BENCHMARK_SCENARIOS: readonly HeadlessScenario[] = [
+  ENERGY_FLOOD_SCENARIO,
+  SELF_REPLICATORS_1K_SCENARIO,
+  SELF_REPLICATORS_10K_SCENARIO,
+  HEAT_STORM_SCENARIO,
+]
@@ -0,0 +1,53 @@
+/**
+ * ヘッドレス実行のコマンドライン テスト
+ */
+
+import { parseHeadlessCliArgs } from "./headless-cli"
+
+describe("ヘッドレス実行のコマンドライン", () => {
+  test("省略時はベンチマークスイートを既定の設定で実行する", () => {
+    expect(parseHeadlessCliArgs([])).toEqual({
+      scenarioPaths: [],
+      only: [],
+      ticks: null,
+      label: null,
+      outputPath: null,
+      help: false,
+    })
+  })
+
+  test("オプションを読み込む", () => {
+    const options = parseHeadlessCliArgs([
+      "--scenario",
+      "a.json",
+      "--scenario",
+      "b.json",
+      "--only",
+      "heat-storm",
+      "--ticks",
+      "20",
+      "--label",
+      "baseline",
+      "--output",
+      "out.json",
+    ])
+
+    expect(options).toEqual({
+      scenarioPaths: ["a.json", "b.json"],
+      only: ["heat-storm"],
+      ticks: 20,
+      label: "baseline",
+      outputPath: "out.json",
+      help: false,
+    })
+    expect(parseHeadlessCliArgs(["--help"]).help).toBe(true)
+  })
+
+  test("不正な引数はエラーになる", () => {
+    expect(() => parseHeadlessCliArgs(["--ticks", "0"])).toThrow("--ticks")
+    expect(() => parseHeadlessCliArgs(["--ticks", "1.5"])).toThrow("--ticks")
+    expect(() => parseHeadlessCliArgs(["--label"])).toThrow("--label")
+    expect(() => parseHeadlessCliArgs(["--output", "--help"])).toThrow("--output")
+    expect(() => parseHeadlessCliArgs(["--seed", "1"])).toThrow("--seed")
+  })
+})
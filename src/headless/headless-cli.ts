@@ -0,0 +1,153 @@
+/**
+ * ヘッドレス実行のコマンドライン
+ *
+ * `yarn bench [オプション]`（scripts/headless.js）でNode上（描画なし）で実行する。
+ * シナリオごとの要約を標準エラー出力に、結果のJSONを標準出力に書き出すため、
+ * 標準出力はそのままファイルや他のツールに渡せる
+ */
+
+import { execSync } from "child_process"
+import { readFileSync, writeFileSync } from "fs"
+import { BENCHMARK_SCENARIOS } from "./benchmark-scenarios"
+import { parseHeadlessScenario } from "./headless-scenario"
+import type { HeadlessScenario } from "./headless-scenario"
+import { formatRunResult, runBenchmarkSuite } from "./headless-runner"
+
+export const HEADLESS_CLI_USAGE = `使い方: yarn bench [オプション]
+
+  --scenario <path>  シナリオJSONファイルを実行する（複数指定可。省略時はベンチマークスイート）
+  --only <name>      ベンチマークスイートから名前の一致するシナリオのみ実行する（複数指定可）
+  --ticks <n>        シナリオのtick数を上書きする
+  --label <label>    結果の識別名（省略時は現在のコミットハッシュ）
+  --output <path>    結果のJSONをファイルにも書き出す
+  --help             この説明を表示する`
+
+/** コマンドラインの指定内容 */
+export type HeadlessCliOptions = {
+  readonly scenarioPaths: readonly string[]
+  readonly only: readonly string[]
+  readonly ticks: number | null
+  readonly label: string | null
+  readonly outputPath: string | null
+  readonly help: boolean
+}
+
+/**
+ * コマンドライン引数を解釈する
+ * @param args process.argv.slice(2)
+ */
+export const parseHeadlessCliArgs = (args: readonly string[]): HeadlessCliOptions => {
+  const scenarioPaths: string[] = []
+  const only: string[] = []
+  let ticks: number | null = null
+  let label: string | null = null
+  let outputPath: string | null = null
+  let help = false
+
+  for (let i = 0; i < args.length; i++) {
+    const arg = args[i] ?? ""
+    if (arg === "--help") {
+      help = true
+      continue
+    }
+
+    const value = args[i + 1]
+    if (value == null || value.startsWith("--")) {
+      throw new Error(`${arg} には値が必要です`)
+    }
+    i++
+
+    switch (arg) {
+      case "--scenario":
+        scenarioPaths.push(value)
+        break
+      case "--only":
+        only.push(value)
+        break
+      case "--ticks": {
+        const parsed = Number(value)
+        if (!Number.isInteger(parsed) || parsed <= 0) {
+          throw new Error(`--ticks は正の整数である必要があります: ${value}`)
+        }
+        ticks = parsed
+        break
+      }
+      case "--label":
+        label = value
+        break
+      case "--output":
+        outputPath = value
+        break
+      default:
+        throw new Error(`未対応のオプション: ${arg}`)
+    }
+  }
+
+  return { scenarioPaths, only, ticks, label, outputPath, help }
+}
+
+/** 実行するシナリオを決める */
+const loadScenarios = (options: HeadlessCliOptions): readonly HeadlessScenario[] => {
+  if (options.scenarioPaths.length > 0) {
+    return options.scenarioPaths.map(path =>
+      parseHeadlessScenario(JSON.parse(readFileSync(path, "utf8")))
+    )
+  }
+  if (options.only.length === 0) {
+    return BENCHMARK_SCENARIOS
+  }
+
+  return options.only.map(name => {
+    const scenario = BENCHMARK_SCENARIOS.find(candidate => candidate.name === name)
+    if (scenario == null) {
+      const names = BENCHMARK_SCENARIOS.map(candidate => candidate.name).join(", ")
+      throw new Error(`ベンチマークスイートにないシナリオ: ${name}（${names}）`)
+    }
+    return scenario
+  })
+}
+
+const resolveLabel = (options: HeadlessCliOptions): string => {
+  if (options.label != null) {
+    return options.label
+  }
+  try {
+    return execSync("git rev-parse --short HEAD", { encoding: "utf8" }).trim()
+  } catch {
+    return "unknown"
+  }
+}
+
+/**
+ * コマンドラインから実行する
+ * @param args process.argv.slice(2)
+ * @returns 終了コード
+ */
+export const runHeadlessCli = (args: readonly string[]): number => {
+  let options: HeadlessCliOptions
+  try {
+    options = parseHeadlessCliArgs(args)
+  } catch (error) {
+    console.error(`${error instanceof Error ? error.message : String(error)}\n`)
+    console.error(HEADLESS_CLI_USAGE)
+    return 2
+  }
+  if (options.help) {
+    console.log(HEADLESS_CLI_USAGE)
+    return 0
+  }
+
+  const report = runBenchmarkSuite(
+    loadScenarios(options),
+    resolveLabel(options),
+    options.ticks != null ? { ticks: options.ticks } : {}
+  )
+  report.results.forEach(result => console.error(formatRunResult(result)))
+
+  const json = `${JSON.stringify(report, null, 2)}\n`
+  if (options.outputPath != null) {
+    writeFileSync(options.outputPath, json)
+  }
+  process.stdout.write(json)
+  return 0
+}
@@ -0,0 +1,97 @@
+/**
+ * ヘッドレス実行 テスト
+ */
+
+import { runBenchmarkSuite, runHeadlessScenario } from "./headless-runner"
+import {
+  buildScenarioWorld,
+  createScenarioRandom,
+  parseHeadlessScenario,
+} from "./headless-scenario"
+import type { HeadlessScenario } from "./headless-scenario"
+
+describe("ヘッドレス実行", () => {
+  const scenario: HeadlessScenario = {
+    name: "small",
+    width: 400,
+    height: 400,
+    ticks: 5,
+    seed: 3,
+    parameters: { energySourceCount: 2 },
+    vmExecutionMode: "jit",
+    selfReplicators: 4,
+    energyParticles: { count: 20, amount: 10 },
+    heatStorm: { spotsPerTick: 3, heatPerSpot: 100 },
+  }
+
+  test("指定tick数を実行してフェーズ別の時間を集計する", () => {
+    const result = runHeadlessScenario(scenario)
+
+    expect(result.scenario).toBe("small")
+    expect(result.ticks).toBe(5)
+    // HULL・ASSEMBLER・COMPUTER×4体 + エネルギー粒子
+    expect(result.initialObjectCount).toBe(4 * 3 + 20)
+    const { physics, energy, vm, heat } = result.phases
+    expect(physics.share + energy.share + vm.share + heat.share).toBeCloseTo(1)
+    expect(result.counters.objectsProcessed).toBeGreaterThan(0)
+  })
+
+  test("tick数を上書きできる", () => {
+    const report = runBenchmarkSuite([scenario], "test", { ticks: 2 })
+
+    expect(report.label).toBe("test")
+    expect(report.results.map(result => result.ticks)).toEqual([2])
+    expect(() => JSON.stringify(report)).not.toThrow()
+  })
+
+  test("JSONのシナリオを検証して読み込む", () => {
+    const parsed = parseHeadlessScenario(JSON.parse(JSON.stringify(scenario)))
+    expect(parsed).toEqual(scenario)
+
+    expect(() => parseHeadlessScenario({ ...scenario, ticks: -1 })).toThrow("ticks")
+    expect(() => parseHeadlessScenario({ ...scenario, vmExecutionMode: "native" })).toThrow()
+  })
+
+  test("エネルギー統合・密度場の設定を読み込む", () => {
+    const withEnergyModes = {
+      ...scenario,
+      energyCoalescing: { maxObjectsPerCell: 4 },
+      energyDensityField: { cellSize: 40, diffusionRate: 0.1 },
+    }
+    expect(parseHeadlessScenario(JSON.parse(JSON.stringify(withEnergyModes)))).toEqual(
+      withEnergyModes
+    )
+
+    expect(() =>
+      parseHeadlessScenario({ ...scenario, energyCoalescing: { maxObjects: 4 } })
+    ).toThrow("energyCoalescing.maxObjects")
+    expect(() =>
+      parseHeadlessScenario({ ...scenario, energyDensityField: { cellSize: "40" } })
+    ).toThrow("cellSize")
+
+    const world = buildScenarioWorld(withEnergyModes, createScenarioRandom(1))
+    expect(world.energyDensityField).not.toBeNull()
+  })
+
+  test("同じシードからは同じ経過になる", () => {
+    const run = () => {
+      const world = buildScenarioWorld(scenario, createScenarioRandom(scenario.seed ?? 1))
+      for (let tick = 0; tick < 10; tick++) {
+        world.tick()
+      }
+      return {
+        sources: Array.from(world.state.energySources.values()),
+        objects: Array.from(world.state.objects.values()).map(object => ({
+          type: object.type,
+          position: object.position,
+          energy: object.energy,
+        })),
+        heat: Array.from(world.heatSystem.heatValues),
+      }
+    }
+
+    const first = run()
+    expect(first.sources.length).toBe(2)
+    expect(run()).toEqual(first)
+  })
+})
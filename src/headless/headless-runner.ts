@@ -0,0 +1,132 @@
+/**
+ * ヘッドレスシミュレーション実行
+ *
+ * 描画・UIを介さずにシナリオのWorldを指定tick数だけ最速で進め、
+ * ticks/secとフェーズ別（物理・エネルギー・VM・熱）の処理時間を計測する
+ */
+
+import { TICK_COUNTERS, TICK_PHASE_GROUPS } from "@/engine/tick-instrumentation"
+import type { TickCounter, TickPhaseGroup } from "@/engine/tick-instrumentation"
+import { applyScenarioEvents, buildScenarioWorld, createScenarioRandom } from "./headless-scenario"
+import type { HeadlessScenario } from "./headless-scenario"
+
+/** フェーズ別の計測結果 */
+export type PhaseTiming = {
+  readonly totalMs: number
+  /** 1tickあたりの平均（ミリ秒） */
+  readonly perTickMs: number
+  /** フェーズ合計に対する割合（0〜1） */
+  readonly share: number
+}
+
+/** 1シナリオの実行結果 */
+export type HeadlessRunResult = {
+  readonly scenario: string
+  readonly ticks: number
+  /** 初期化を除くtick実行の所要時間（ミリ秒） */
+  readonly elapsedMs: number
+  readonly ticksPerSecond: number
+  /** World構築の所要時間（ミリ秒） */
+  readonly setupMs: number
+  readonly phases: Readonly<Record<TickPhaseGroup, PhaseTiming>>
+  /** カウンタの累計 */
+  readonly counters: Readonly<Record<TickCounter, number>>
+  readonly initialObjectCount: number
+  readonly finalObjectCount: number
+}
+
+/** ベンチマークスイートの実行結果（コミット間の比較用にJSONで保存する） */
+export type BenchmarkReport = {
+  readonly label: string
+  readonly createdAt: string
+  readonly results: readonly HeadlessRunResult[]
+}
+
+const PHASE_GROUPS: readonly TickPhaseGroup[] = ["physics", "energy", "vm", "heat"]
+
+export type HeadlessRunOptions = {
+  /** シナリオのtick数を上書きする */
+  readonly ticks?: number
+  /** 現在時刻（ミリ秒）を返す関数 */
+  readonly now?: () => number
+}
+
+/**
+ * シナリオを実行して計測結果を返す
+ * @param scenario 実行するシナリオ
+ * @param options 実行オプション
+ */
+export const runHeadlessScenario = (
+  scenario: HeadlessScenario,
+  options: HeadlessRunOptions = {}
+): HeadlessRunResult => {
+  const now = options.now ?? (() => performance.now())
+  const ticks = options.ticks ?? scenario.ticks
+  const random = createScenarioRandom(scenario.seed ?? 1)
+
+  const setupStartedAt = now()
+  const world = buildScenarioWorld(scenario, random)
+  const setupMs = now() - setupStartedAt
+  const initialObjectCount = world.state.objects.size
+
+  const startedAt = now()
+  for (let tick = 0; tick < ticks; tick++) {
+    applyScenarioEvents(world, scenario, random)
+    world.tick()
+  }
+  const elapsedMs = now() - startedAt
+
+  const instrumentation = world.instrumentation
+  const groupTotalMs = (group: TickPhaseGroup): number =>
+    TICK_PHASE_GROUPS[group].reduce((sum, phase) => sum + (instrumentation?.total(phase) ?? 0), 0)
+  const phaseTotalMs = PHASE_GROUPS.reduce((sum, group) => sum + groupTotalMs(group), 0)
+  const phases = {} as Record<TickPhaseGroup, PhaseTiming>
+  PHASE_GROUPS.forEach(group => {
+    const totalMs = groupTotalMs(group)
+    phases[group] = {
+      totalMs,
+      perTickMs: ticks > 0 ? totalMs / ticks : 0,
+      share: phaseTotalMs > 0 ? totalMs / phaseTotalMs : 0,
+    }
+  })
+  const counters = {} as Record<TickCounter, number>
+  TICK_COUNTERS.forEach(counter => {
+    counters[counter] = instrumentation?.total(counter) ?? 0
+  })
+
+  return {
+    scenario: scenario.name,
+    ticks,
+    elapsedMs,
+    ticksPerSecond: elapsedMs > 0 ? (ticks * 1000) / elapsedMs : 0,
+    setupMs,
+    phases,
+    counters,
+    initialObjectCount,
+    finalObjectCount: world.state.objects.size,
+  }
+}
+
+/**
+ * 複数のシナリオを順に実行する
+ * @param scenarios 実行するシナリオ
+ * @param label 結果の識別名（コミットハッシュなど）
+ * @param options 実行オプション
+ */
+export const runBenchmarkSuite = (
+  scenarios: readonly HeadlessScenario[],
+  label: string,
+  options: HeadlessRunOptions = {}
+): BenchmarkReport => ({
+  label,
+  createdAt: new Date().toISOString(),
+  results: scenarios.map(scenario => runHeadlessScenario(scenario, options)),
+})
+
+/** 実行結果を1行ずつの要約にする */
+export const formatRunResult = (result: HeadlessRunResult): string => {
+  const phases = PHASE_GROUPS.map(
+    phase => `${phase} ${(result.phases[phase].share * 100).toFixed(1)}%`
+  ).join(", ")
+  return `${result.scenario}: ${result.ticksPerSecond.toFixed(1)} ticks/sec (${phases})`
+}
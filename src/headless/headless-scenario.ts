@@ -0,0 +1,263 @@
+/**
+ * ヘッドレス実行のシナリオ定義
+ *
+ * 描画なしでWorldを構築・実行するための初期配置と、tickごとに発生させるイベントを記述する。
+ * シナリオはJSONファイルからも読み込めるよう、プレーンなデータのみで構成する
+ */
+
+import { World } from "@/engine/world"
+import type { VMExecutionMode } from "@/engine/computer-vm-system"
+import type { EnergyCoalescingParameters } from "@/engine/energy-coalescing-system"
+import type { EnergyDensityFieldParameters } from "@/engine/energy-density-field"
+import type { AgentPresetPlacement } from "@/engine/presets/types"
+import { SELF_REPLICATOR_PRESET } from "@/engine/presets/self-replicator-preset"
+import type { WorldParameters } from "@/types/game"
+import { Vec2 as Vec2Utils } from "@/utils/vec2"
+
+/** 初期配置するエネルギー粒子 */
+export type EnergyParticleSpec = {
+  readonly count: number
+  readonly amount: number
+}
+
+/** tickごとにランダムな位置へ熱を加える */
+export type HeatStormSpec = {
+  readonly spotsPerTick: number
+  readonly heatPerSpot: number
+}
+
+export type HeadlessScenario = {
+  readonly name: string
+  readonly width: number
+  readonly height: number
+  /** 実行するtick数 */
+  readonly ticks: number
+  /** 乱数シード（配置・イベント位置のほか、Worldのエネルギーソースの配置・出力にも使う） */
+  readonly seed?: number
+  readonly parameters?: Partial<WorldParameters>
+  readonly vmExecutionMode?: VMExecutionMode
+  /** WorldConfig.energyCoalescing（指定した場合のみ有効） */
+  readonly energyCoalescing?: Partial<EnergyCoalescingParameters>
+  /** WorldConfig.energyDensityField（指定した場合のみ有効） */
+  readonly energyDensityField?: Partial<EnergyDensityFieldParameters>
+  /** 格子状に配置するSELF_REPLICATOR_PRESETの数 */
+  readonly selfReplicators?: number
+  readonly energyParticles?: EnergyParticleSpec
+  readonly heatStorm?: HeatStormSpec
+}
+
+const VM_EXECUTION_MODES: readonly VMExecutionMode[] = ["interpreter", "compiled", "jit"]
+
+/** 再現性のある疑似乱数（線形合同法、[0, 1)） */
+export const createScenarioRandom = (seed: number): (() => number) => {
+  let state = seed >>> 0
+  return () => {
+    state = (state * 1664525 + 1013904223) >>> 0
+    return state / 0x100000000
+  }
+}
+
+const isRecord = (value: unknown): value is Record<string, unknown> =>
+  typeof value === "object" && value != null && !Array.isArray(value)
+
+const readNumber = (source: Record<string, unknown>, key: string, path: string): number => {
+  const value = source[key]
+  if (typeof value !== "number" || !Number.isFinite(value) || value < 0) {
+    throw new Error(`${path}${key} は0以上の数値である必要があります`)
+  }
+  return value
+}
+
+const readOptionalNumber = (
+  source: Record<string, unknown>,
+  key: string,
+  path: string
+): number | null => (source[key] == null ? null : readNumber(source, key, path))
+
+/**
+ * 数値のみを持つパラメータオブジェクトを読み込む（未知のキーはエラー）
+ * @param keys 指定できるキー
+ */
+const readNumberFields = <Key extends string>(
+  value: unknown,
+  keys: readonly Key[],
+  path: string
+): Partial<Record<Key, number>> => {
+  if (!isRecord(value)) {
+    throw new Error(`${path} はオブジェクトである必要があります`)
+  }
+  const result: Partial<Record<Key, number>> = {}
+  for (const key of Object.keys(value)) {
+    const known = keys.find(candidate => candidate === key)
+    if (known == null) {
+      throw new Error(`${path}.${key} は未対応のパラメータです`)
+    }
+    result[known] = readNumber(value, key, `${path}.`)
+  }
+  return result
+}
+
+const COALESCING_KEYS: readonly (keyof EnergyCoalescingParameters)[] = [
+  "cellSize",
+  "maxObjectsPerCell",
+  "maxSpeed",
+]
+
+const DENSITY_FIELD_KEYS: readonly (keyof EnergyDensityFieldParameters)[] = [
+  "cellSize",
+  "diffusionRate",
+  "advectionScale",
+]
+
+/**
+ * JSONから読み込んだ値をシナリオとして検証する
+ * @param value JSON.parseの結果
+ */
+export const parseHeadlessScenario = (value: unknown): HeadlessScenario => {
+  if (!isRecord(value)) {
+    throw new Error("シナリオはオブジェクトである必要があります")
+  }
+
+  const name = value["name"]
+  if (typeof name !== "string" || name.length === 0) {
+    throw new Error("name は空でない文字列である必要があります")
+  }
+
+  const vmExecutionMode = value["vmExecutionMode"]
+  if (vmExecutionMode != null && !VM_EXECUTION_MODES.some(mode => mode === vmExecutionMode)) {
+    throw new Error(`未対応のvmExecutionMode: ${String(vmExecutionMode)}`)
+  }
+
+  const parameters = value["parameters"]
+  if (parameters != null && !isRecord(parameters)) {
+    throw new Error("parameters はオブジェクトである必要があります")
+  }
+
+  const energyParticles = value["energyParticles"]
+  if (energyParticles != null && !isRecord(energyParticles)) {
+    throw new Error("energyParticles はオブジェクトである必要があります")
+  }
+
+  const heatStorm = value["heatStorm"]
+  if (heatStorm != null && !isRecord(heatStorm)) {
+    throw new Error("heatStorm はオブジェクトである必要があります")
+  }
+
+  const seed = readOptionalNumber(value, "seed", "")
+  const selfReplicators = readOptionalNumber(value, "selfReplicators", "")
+  const energyCoalescing =
+    value["energyCoalescing"] == null
+      ? null
+      : readNumberFields(value["energyCoalescing"], COALESCING_KEYS, "energyCoalescing")
+  const energyDensityField =
+    value["energyDensityField"] == null
+      ? null
+      : readNumberFields(value["energyDensityField"], DENSITY_FIELD_KEYS, "energyDensityField")
+
+  return {
+    name,
+    width: readNumber(value, "width", ""),
+    height: readNumber(value, "height", ""),
+    ticks: readNumber(value, "ticks", ""),
+    ...(seed != null ? { seed } : {}),
+    ...(parameters != null ? { parameters: parameters as Partial<WorldParameters> } : {}),
+    ...(vmExecutionMode != null ? { vmExecutionMode: vmExecutionMode as VMExecutionMode } : {}),
+    ...(energyCoalescing != null ? { energyCoalescing } : {}),
+    ...(energyDensityField != null ? { energyDensityField } : {}),
+    ...(selfReplicators != null ? { selfReplicators } : {}),
+    ...(energyParticles != null
+      ? {
+          energyParticles: {
+            count: readNumber(energyParticles, "count", "energyParticles."),
+            amount: readNumber(energyParticles, "amount", "energyParticles."),
+          },
+        }
+      : {}),
+    ...(heatStorm != null
+      ? {
+          heatStorm: {
+            spotsPerTick: readNumber(heatStorm, "spotsPerTick", "heatStorm."),
+            heatPerSpot: readNumber(heatStorm, "heatPerSpot", "heatStorm."),
+          },
+        }
+      : {}),
+  }
+}
+
+/** 自己複製エージェントを格子状に並べる配置 */
+const createSelfReplicatorPlacements = (
+  scenario: HeadlessScenario,
+  count: number
+): AgentPresetPlacement[] => {
+  const columns = Math.ceil(Math.sqrt((count * scenario.width) / scenario.height))
+  const rows = Math.ceil(count / columns)
+  const spacingX = scenario.width / columns
+  const spacingY = scenario.height / rows
+
+  const placements: AgentPresetPlacement[] = []
+  for (let i = 0; i < count; i++) {
+    const column = i % columns
+    const row = Math.floor(i / columns)
+    placements.push({
+      preset: SELF_REPLICATOR_PRESET,
+      position: Vec2Utils.create((column + 0.5) * spacingX, (row + 0.5) * spacingY),
+    })
+  }
+  return placements
+}
+
+/**
+ * シナリオの初期状態でWorldを構築する
+ * tick数を正確に数えるためticksPerFrameは1に固定する
+ * @param scenario シナリオ
+ * @param random 配置に使う乱数（Worldの乱数としても使う）
+ */
+export const buildScenarioWorld = (scenario: HeadlessScenario, random: () => number): World => {
+  const selfReplicators = scenario.selfReplicators ?? 0
+  const world = new World({
+    width: scenario.width,
+    height: scenario.height,
+    parameters: { ...scenario.parameters, ticksPerFrame: 1 },
+    quiet: true,
+    random,
+    ...(scenario.vmExecutionMode != null ? { vmExecutionMode: scenario.vmExecutionMode } : {}),
+    ...(scenario.energyCoalescing != null ? { energyCoalescing: scenario.energyCoalescing } : {}),
+    ...(scenario.energyDensityField != null
+      ? { energyDensityField: scenario.energyDensityField }
+      : {}),
+    ...(selfReplicators > 0
+      ? { defaultAgentPresets: createSelfReplicatorPlacements(scenario, selfReplicators) }
+      : {}),
+  })
+
+  const particles = scenario.energyParticles
+  if (particles != null) {
+    for (let i = 0; i < particles.count; i++) {
+      const position = Vec2Utils.create(random() * scenario.width, random() * scenario.height)
+      world.createEnergyObject(position, particles.amount)
+    }
+  }
+
+  return world
+}
+
+/**
+ * tick開始前のシナリオイベントを適用する
+ * @param world 対象のWorld
+ * @param scenario シナリオ
+ * @param random イベント位置に使う乱数
+ */
+export const applyScenarioEvents = (
+  world: World,
+  scenario: HeadlessScenario,
+  random: () => number
+): void => {
+  const storm = scenario.heatStorm
+  if (storm == null) {
+    return
+  }
+  for (let i = 0; i < storm.spotsPerTick; i++) {
+    const position = Vec2Utils.create(random() * scenario.width, random() * scenario.height)
+    world.heatSystem.addHeatAt(position, storm.heatPerSpot)
+  }
+}
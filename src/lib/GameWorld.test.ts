@@ -37,7 +37,9 @@ jest.mock("../engine", () => ({
       forceFields: new Map(),
     },
     heatSystem: {
-      heatGrid: [],
+      width: 0,
+      height: 0,
+      heatValues: new Float64Array(0),
     },
     tick: jest.fn(),
     addForceField: jest.fn(),
@@ -47,10 +49,9 @@ jest.mock("../engine", () => ({
 // heat-map-rendererのモック
 jest.mock("./heat-map-renderer", () => ({
   HeatMapRenderer: jest.fn().mockImplementation(() => ({
-    graphics: {
-      clear: jest.fn(),
-      fill: jest.fn(),
-      rect: jest.fn(),
+    container: {
+      addChild: jest.fn(),
+      removeChildren: jest.fn(),
     },
     visible: false,
     alpha: 0.7,
@@ -64,6 +65,7 @@ jest.mock("./render-utils", () => ({
   drawEnergySource: jest.fn(),
   drawForceField: jest.fn(),
   drawObject: jest.fn(),
+  drawSnapshotObject: jest.fn(),
 }))
 
 describe("GameWorld", () => {
@@ -1,32 +1,63 @@
 import * as PIXI from "pixi.js"
-import { World, WorldConfig } from "@/engine"
-import type { DirectionalForceField, GameObject } from "@/types/game"
-import { drawEnergySource, drawForceField, drawObject } from "./render-utils"
+import {
+  RENDER_OBJECT_TYPES,
+  World,
+  WorldConfig,
+  findRenderSnapshotHullAt,
+  renderSnapshotViews,
+  writeRenderSnapshot,
+} from "@/engine"
+import type {
+  RenderSnapshot,
+  RenderSnapshotViews,
+  TickPhaseGroup,
+  WorldWorkerClient,
+  WorldWorkerSettings,
+} from "@/engine"
+import type { DirectionalForceField, GameObject, ObjectId } from "@/types/game"
 import { HeatMapRenderer } from "./heat-map-renderer"
-import { ObjectSelectionManager } from "./object-selection-manager"
 import { HullInfoRenderer } from "./hull-info-renderer"
-import { isHull } from "@/utils/type-guards"
+import { WorldSceneRenderer } from "./world-scene-renderer"
+import type { RenderView } from "./world-scene-renderer"
 
 /**
  * ゲーム世界の基本クラス
  * 新しいエンジンへのブリッジとして機能
+ *
+ * 世界はメインスレッドで実行するか、Worker内で実行する（WorldWorkerClientを渡した場合）。
+ * どちらの場合も描画は描画用スナップショットから行う。描画オブジェクトはフレームをまたいで保持し、
+ * 毎フレーム作り直さない（WorldSceneRenderer）
  */
 export class GameWorld {
-  private readonly _world: World
+  /** メインスレッドで実行する世界（Worker内で実行する場合はnull） */
+  private readonly _world: World | null
+  private readonly _client: WorldWorkerClient | null
+  private readonly _width: number
+  private readonly _height: number
   private readonly _heatMapRenderer: HeatMapRenderer
-  private readonly _selectionManager: ObjectSelectionManager
   private readonly _hullInfoRenderer: HullInfoRenderer
+  /** 描画オブジェクトを保持する世界の描画（最初の描画時に作成する） */
+  private _scene: WorldSceneRenderer | null = null
+  private _sceneContainer: PIXI.Container | null = null
+  /** 直近に描画したスナップショット */
+  private _snapshot: RenderSnapshot | null = null
+  private _selectedHullId: ObjectId | null = null
 
   public get tickCount(): number {
-    return this._world.state.tick
+    return this._world?.state.tick ?? this._client?.snapshot?.tick ?? 0
   }
 
   public get width(): number {
-    return this._world.state.width
+    return this._width
   }
 
   public get height(): number {
-    return this._world.state.height
+    return this._height
+  }
+
+  /** Worker内で世界を実行しているか（その場合、tickはWorkerが進める） */
+  public get isRunningInWorker(): boolean {
+    return this._client != null
   }
 
   /** 熱マップの表示状態を取得 */
@@ -34,15 +65,20 @@ export class GameWorld {
     return this._heatMapRenderer.visible
   }
 
-  public constructor(config: WorldConfig) {
+  /**
+   * @param config 世界の設定
+   * @param client Worker内で実行する場合、その世界の操作（configと同じ設定で初期化したもの）
+   */
+  public constructor(config: WorldConfig, client?: WorldWorkerClient) {
+    this._width = config.width
+    this._height = config.height
+
     // 熱マップレンダラーの初期化
     this._heatMapRenderer = new HeatMapRenderer(10) // 1グリッド = 10ピクセル
 
     // ワールドの初期化（デモ用設定を含む）
-    this._world = new World(config)
-
-    // 選択マネージャーの初期化
-    this._selectionManager = new ObjectSelectionManager(this._world.state.objects)
+    this._client = client ?? null
+    this._world = client == null ? new World(config) : null
 
     // HULL情報レンダラーの初期化
     this._hullInfoRenderer = new HullInfoRenderer()
@@ -50,66 +86,73 @@ export class GameWorld {
 
   /** ゲームオブジェクトの総数を取得 */
   public getObjectCount(): number {
-    return this._world.state.objects.size
+    return this._world?.state.objects.size ?? this._client?.snapshot?.objectCount ?? 0
   }
 
-  public renderPixi(container: PIXI.Container): void {
-    // コンテナをクリア
-    container.removeChildren()
-
-    // 熱マップレイヤーを追加（一番下に描画）
-    const heatSystem = this._world.heatSystem
-    this._heatMapRenderer.update(heatSystem)
-    container.addChild(this._heatMapRenderer.graphics)
-
-    // 世界の境界線を描画
-    const border = new PIXI.Graphics()
-    border.rect(0, 0, this.width, this.height)
-    border.stroke({ width: 1, color: 0x666666 })
-    container.addChild(border)
-
-    // 力場を描画（デザイン仕様: rgba(173,216,230,0.2)）
-    for (const field of this._world.state.forceFields.values()) {
-      const fieldGraphics = new PIXI.Graphics()
-
-      drawForceField(fieldGraphics, field)
-
-      container.addChild(fieldGraphics)
+  /**
+   * 直近のtick処理時間（サブシステム別の平均、ミリ秒）
+   * tick処理の計測が無効な場合はnull
+   */
+  public getTickPhaseTimes(): Readonly<Record<TickPhaseGroup, number>> | null {
+    if (this._world == null) {
+      return this._client?.snapshot?.phaseTimes ?? null
     }
-
-    // エネルギーソースを描画（デザイン仕様: #FFB700、太陽型）
-    for (const source of this._world.state.energySources.values()) {
-      const sourceGraphics = new PIXI.Graphics()
-      drawEnergySource(sourceGraphics, source)
-
-      container.addChild(sourceGraphics)
+    const instrumentation = this._world.instrumentation
+    if (instrumentation == null) {
+      return null
+    }
+    return {
+      physics: instrumentation.groupMean("physics"),
+      energy: instrumentation.groupMean("energy"),
+      vm: instrumentation.groupMean("vm"),
+      heat: instrumentation.groupMean("heat"),
     }
+  }
 
-    // ゲームオブジェクトを描画（デザイン仕様準拠）
-    for (const obj of this._world.state.objects.values()) {
-      const objGraphics = new PIXI.Graphics()
+  /**
+   * 描画する
+   * @param container 描画先のコンテナ
+   * @param view 表示範囲とズーム（指定した場合は範囲内のみを、ズームに応じた詳細度で描画する）
+   */
+  public renderPixi(container: PIXI.Container, view?: RenderView): void {
+    const snapshot =
+      this._world != null
+        ? writeRenderSnapshot(this._world, this._snapshot?.buffer ?? null)
+        : (this._client?.snapshot ?? null)
+    this._snapshot = snapshot
+    if (snapshot == null) {
+      // Workerから最初のスナップショットが届くまでは描画しない
+      return
+    }
+    const views = renderSnapshotViews(snapshot)
+    const scene = this.sceneFor(container)
 
-      // drawObjectを使用して描画
-      drawObject(objGraphics, obj, id => this._world.state.objects.get(id))
+    // 熱マップを更新（一番下に描画）
+    this._heatMapRenderer.update({ width: snapshot.heatWidth, heatValues: views.heat })
 
-      objGraphics.x = obj.position.x
-      objGraphics.y = obj.position.y
-      container.addChild(objGraphics)
-    }
+    // 境界線・力場・エネルギーソース・ゲームオブジェクトを更新
+    scene.update(snapshot, views, view ?? null)
 
-    // HULL情報ウィンドウを描画（最前面）
-    container.addChild(this._hullInfoRenderer.container)
+    // 選択中のHULL情報を更新
+    this.updateHullInfo(snapshot, views)
   }
 
-  /** 1tick進める */
+  /** 1tick進める（Worker内で実行している場合はWorkerが進めるため何もしない） */
   public tick(): void {
-    this._world.tick()
+    this._world?.tick()
+  }
 
-    // 選択マネージャーのオブジェクトを更新
-    this._selectionManager.updateObjects(this._world.state.objects)
+  /** Worker内で実行している世界の進め方を変更する */
+  public updateWorkerSettings(settings: Partial<WorldWorkerSettings>): void {
+    this._client?.updateSettings(settings)
+  }
 
-    // 選択中のHULL情報を更新
-    this.updateHullInfo()
+  /** 描画オブジェクトを破棄し、Worker内で実行している場合はWorkerを終了する */
+  public dispose(): void {
+    this._scene?.destroy()
+    this._scene = null
+    this._sceneContainer = null
+    this._client?.terminate()
   }
 
   /** 熱マップの表示状態を切り替え */
@@ -129,62 +172,102 @@ export class GameWorld {
 
   /** 力場を追加 */
   public addForceField(field: DirectionalForceField): void {
-    this._world.addForceField(field)
+    if (this._world != null) {
+      this._world.addForceField(field)
+    } else {
+      this._client?.addForceField(field)
+    }
   }
 
   /**
    * 指定位置のオブジェクトを選択
+   * 現状はHULLのみ選択可能。選択中のHULLを再度クリックした場合、何もない場所をクリックした場合は選択解除
    * @param worldX ワールドX座標
    * @param worldY ワールドY座標
    */
   public selectObjectAt(worldX: number, worldY: number): void {
-    const worldPosition = { x: worldX, y: worldY }
-    const screenPosition = { x: worldX, y: worldY } // ワールド座標と同じ
-
-    const selected = this._selectionManager.selectObjectAt(worldPosition, screenPosition)
+    const snapshot = this._snapshot
+    const index = snapshot == null ? -1 : findRenderSnapshotHullAt(snapshot, worldX, worldY)
+    const hullId =
+      snapshot == null || index < 0
+        ? null
+        : ((renderSnapshotViews(snapshot).objects.id[index] ?? 0) as ObjectId)
+    this._selectedHullId = hullId === this._selectedHullId ? null : hullId
 
     // デバッガーに選択状態を通知
-    const computerDebugger = this._world.debugger
-    if (computerDebugger != null) {
-      if (selected != null && isHull(selected)) {
-        computerDebugger.setSelectedHull(selected.id)
-      } else {
-        computerDebugger.setSelectedHull(null)
-      }
+    if (this._world != null) {
+      this._world.debugger?.setSelectedHull(this._selectedHullId)
+    } else {
+      this._client?.selectHull(this._selectedHullId)
     }
 
-    if (selected != null && isHull(selected)) {
+    if (snapshot != null && this._selectedHullId != null) {
       // HULLが選択された場合、情報を表示
-      this.updateHullInfo()
+      this.updateHullInfo(snapshot, renderSnapshotViews(snapshot))
     } else {
       // 選択解除
       this._hullInfoRenderer.hide()
     }
   }
 
+  /**
+   * 描画先のコンテナに対応する世界の描画を取得する
+   * 初回（描画先が変わった場合）はコンテナの中身を作り直す
+   */
+  private sceneFor(container: PIXI.Container): WorldSceneRenderer {
+    if (this._scene != null && this._sceneContainer === container) {
+      return this._scene
+    }
+    this._scene?.destroy()
+    const scene = new WorldSceneRenderer(this._width, this._height)
+    container.removeChildren()
+    // 熱マップ（最背面）、世界、HULL情報ウィンドウ（最前面）の順に重ねる
+    container.addChild(
+      this._heatMapRenderer.container,
+      scene.container,
+      this._hullInfoRenderer.container
+    )
+    this._scene = scene
+    this._sceneContainer = container
+    return scene
+  }
+
   /**
    * 選択中のHULL情報を更新
+   * 選択中のHULLが存在しなくなった場合は選択解除
    */
-  private updateHullInfo(): void {
-    const selectedInfo = this._selectionManager.getSelectedObject()
+  private updateHullInfo(snapshot: RenderSnapshot, views: RenderSnapshotViews): void {
+    const { objects, attachments } = views
+    const hullId = this._selectedHullId
+    const index = hullId == null ? -1 : objects.id.indexOf(hullId)
 
-    if (selectedInfo == null || !isHull(selectedInfo.object)) {
+    if (hullId == null || index < 0 || index >= snapshot.objectCount) {
+      this._selectedHullId = null
       this._hullInfoRenderer.hide()
       return
     }
 
-    const hull = selectedInfo.object
-
     // 接続されているユニットを取得
-    const units: GameObject[] = []
-    for (const unitId of hull.attachedUnitIds) {
-      const unit = this._world.state.objects.get(unitId)
-      if (unit != null) {
-        units.push(unit)
+    const units: Pick<GameObject, "type" | "mass">[] = []
+    const start = objects.attachStart[index] ?? 0
+    const end = start + (objects.attachCount[index] ?? 0)
+    for (let k = start; k < end; k++) {
+      const unit = attachments[k] ?? -1
+      const type = RENDER_OBJECT_TYPES[objects.type[unit] ?? -1]
+      if (type != null) {
+        units.push({ type, mass: objects.mass[unit] ?? 0 })
       }
     }
 
     // HULL情報を更新して表示
-    this._hullInfoRenderer.update(hull, units, hull.position)
+    this._hullInfoRenderer.update(
+      {
+        id: hullId,
+        storedEnergy: objects.storedEnergy[index] ?? 0,
+        capacity: objects.capacity[index] ?? 0,
+      },
+      units,
+      { x: objects.x[index] ?? 0, y: objects.y[index] ?? 0 }
+    )
   }
 }
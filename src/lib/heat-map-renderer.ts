@@ -4,21 +4,36 @@
  */
 
 import * as PIXI from "pixi.js"
-import type { HeatSystem } from "@/engine/heat-system"
+import { HeatPixelBuffer, heatColor } from "./heat-pixel-buffer"
+
+/** 描画する熱グリッド（HeatSystem、または描画用スナップショットの熱グリッド） */
+export type HeatGridView = {
+  readonly width: number
+  readonly heatValues: Float64Array
+}
 
 /**
  * 熱マップレンダラー
  * 熱グリッドを赤系の色の濃淡で表示
+ *
+ * 1セルを1画素としたテクスチャに書き込み、セルの大きさに拡大して表示する。
+ * テクスチャは行方向の帯に分かれており、色が変わったセルを含む帯のみ再転送する。
+ * そのため描画の負荷は図形の数ではなく、変化したセルの数に比例する
  */
 export class HeatMapRenderer {
-  private readonly _graphics: PIXI.Graphics
+  private readonly _container: PIXI.Container
   private readonly _cellSize: number
+  private readonly _cellHeight: number
   private _visible = false
   private _alpha = 0.7
-
-  /** グラフィックスオブジェクトを取得 */
-  public get graphics(): PIXI.Graphics {
-    return this._graphics
+  /** 画素データ（最初の更新時・グリッドの大きさが変わった時に作成する） */
+  private _pixels: HeatPixelBuffer | null = null
+  /** 帯ごとのテクスチャの画素データ */
+  private _bandSources: PIXI.BufferImageSource[] = []
+
+  /** 表示用のコンテナを取得 */
+  public get container(): PIXI.Container {
+    return this._container
   }
 
   /** 表示状態を取得 */
@@ -29,108 +44,84 @@ export class HeatMapRenderer {
   /** 表示状態を設定 */
   public set visible(value: boolean) {
     this._visible = value
-    this._graphics.visible = value
+    this._container.visible = value
   }
 
   /** 透明度を設定（0.0～1.0） */
   public set alpha(value: number) {
     this._alpha = Math.max(0, Math.min(1, value))
-    this._graphics.alpha = this._alpha
+    this._container.alpha = this._alpha
   }
 
   /**
    * @param cellSize 1セルのピクセルサイズ（デフォルト: 10）
+   * @param cellHeight 1セルの高さ（幅と異なる場合）
    */
-  public constructor(cellSize = 10) {
-    this._graphics = new PIXI.Graphics()
+  public constructor(cellSize = 10, cellHeight = cellSize) {
+    this._container = new PIXI.Container()
     this._cellSize = cellSize
-    this._graphics.visible = false
+    this._cellHeight = cellHeight
+    this._container.visible = false
   }
 
   /**
    * 熱マップを更新
-   * @param heatSystem 熱システム
+   * 非表示の間は更新しない
+   * @param heatGrid 熱グリッド
    * @param maxHeat 最大熱量（色の正規化用）
    */
-  public update(heatSystem: HeatSystem, maxHeat = 500): void {
-    this._graphics.clear()
-
-    if (!this._visible) {
+  public update(heatGrid: HeatGridView, maxHeat = 500): void {
+    if (!this._visible || heatGrid.width <= 0) {
       return
     }
 
-    const heatGrid = heatSystem.heatGrid
-
-    for (let y = 0; y < heatGrid.length; y++) {
-      const row = heatGrid[y]
-      if (row === undefined) {
-        continue
-      }
-
-      for (let x = 0; x < row.length; x++) {
-        const heat = row[x] ?? 0
-        if (heat <= 0) {
-          continue
-        }
-
-        // 熱量を色に変換
-        const color = this.heatToColor(heat, maxHeat)
-
-        // セルを描画
-        this._graphics.fill(color)
-        this._graphics.rect(x * this._cellSize, y * this._cellSize, this._cellSize, this._cellSize)
-      }
+    const pixels = this.pixelsFor(heatGrid.width, heatGrid.heatValues.length / heatGrid.width)
+    for (const band of pixels.update(heatGrid.heatValues, maxHeat)) {
+      this._bandSources[band]?.update()
     }
   }
 
   /**
-   * 熱量を色に変換
-   * @param heat 熱量
-   * @param maxHeat 最大熱量
-   * @returns RGB色コード
+   * リソースを破棄
    */
-  private heatToColor(heat: number, maxHeat: number): number {
-    // 熱量を0-1に正規化
-    const normalized = Math.min(1, heat / maxHeat)
-
-    // 色の計算（黒→暗赤→赤→橙→黄）
-    let r: number, g: number, b: number
-
-    if (normalized < 0.25) {
-      // 黒→暗赤（0-0.25）
-      const t = normalized * 4
-      r = Math.floor(128 * t)
-      g = 0
-      b = 0
-    } else if (normalized < 0.5) {
-      // 暗赤→赤（0.25-0.5）
-      const t = (normalized - 0.25) * 4
-      r = Math.floor(128 + 127 * t)
-      g = 0
-      b = 0
-    } else if (normalized < 0.75) {
-      // 赤→橙（0.5-0.75）
-      const t = (normalized - 0.5) * 4
-      r = 255
-      g = Math.floor(165 * t)
-      b = 0
-    } else {
-      // 橙→黄（0.75-1.0）
-      const t = (normalized - 0.75) * 4
-      r = 255
-      g = Math.floor(165 + 90 * t)
-      b = Math.floor(100 * t)
+  public destroy(): void {
+    this.destroyBands()
+    this._container.destroy()
+  }
+
+  /** グリッドの大きさに合った画素データを取得する（大きさが変わった場合はテクスチャを作り直す） */
+  private pixelsFor(width: number, height: number): HeatPixelBuffer {
+    if (this._pixels != null && this._pixels.width === width && this._pixels.height === height) {
+      return this._pixels
     }
 
-    // RGB値を16進数に変換
-    return (r << 16) | (g << 8) | b
+    this.destroyBands()
+    const pixels = new HeatPixelBuffer(width, height)
+    for (let band = 0; band < pixels.bandCount; band++) {
+      const { start, rows } = pixels.bandRows(band)
+      const source = new PIXI.BufferImageSource({
+        resource: pixels.bandPixels(band),
+        width,
+        height: rows,
+        format: "rgba8unorm",
+        scaleMode: "nearest",
+      })
+      const sprite = new PIXI.Sprite(new PIXI.Texture({ source }))
+      sprite.y = start * this._cellHeight
+      sprite.scale.set(this._cellSize, this._cellHeight)
+      this._container.addChild(sprite)
+      this._bandSources.push(source)
+    }
+    this._pixels = pixels
+    return pixels
   }
 
-  /**
-   * リソースを破棄
-   */
-  public destroy(): void {
-    this._graphics.destroy()
+  private destroyBands(): void {
+    this._container
+      .removeChildren()
+      .forEach(child => child.destroy({ texture: true, textureSource: true }))
+    this._bandSources = []
+    this._pixels = null
   }
 }
 
@@ -151,31 +142,7 @@ export const createHeatMapLegend = (width = 200, height = 20, maxHeat = 500): PI
     const heat = (i / steps) * maxHeat
     const normalized = heat / maxHeat
 
-    let r: number, g: number, b: number
-
-    if (normalized < 0.25) {
-      const t = normalized * 4
-      r = Math.floor(128 * t)
-      g = 0
-      b = 0
-    } else if (normalized < 0.5) {
-      const t = (normalized - 0.25) * 4
-      r = Math.floor(128 + 127 * t)
-      g = 0
-      b = 0
-    } else if (normalized < 0.75) {
-      const t = (normalized - 0.5) * 4
-      r = 255
-      g = Math.floor(165 * t)
-      b = 0
-    } else {
-      const t = (normalized - 0.75) * 4
-      r = 255
-      g = Math.floor(165 + 90 * t)
-      b = Math.floor(100 * t)
-    }
-
-    const color = (r << 16) | (g << 8) | b
+    const color = heatColor(normalized)
     graphics.fill(color)
     graphics.rect(i, 0, 1, height)
   }
@@ -0,0 +1,62 @@
+/**
+ * 熱マップの画素データ テスト
+ */
+
+import { HEAT_COLOR_LEVELS, HeatPixelBuffer, heatColor, heatColorLevel } from "./heat-pixel-buffer"
+
+/** セルの画素（RGBA） */
+const pixelAt = (buffer: HeatPixelBuffer, cell: number): number[] =>
+  Array.from(buffer.pixels.subarray(cell * 4, cell * 4 + 4))
+
+describe("熱マップの画素データ", () => {
+  test("熱量0以下は透明、それ以外は段階に丸め、最大熱量以上は最も明るい色になる", () => {
+    expect(heatColorLevel(0, 500)).toBe(0)
+    expect(heatColorLevel(-1, 500)).toBe(0)
+    expect(heatColorLevel(0.001, 500)).toBe(1)
+    expect(heatColorLevel(500, 500)).toBe(HEAT_COLOR_LEVELS)
+    expect(heatColorLevel(10000, 500)).toBe(HEAT_COLOR_LEVELS)
+  })
+
+  test("セルの色をRGBAで書き込む", () => {
+    const buffer = new HeatPixelBuffer(4, 3)
+    const heat = new Float64Array(12)
+    heat[5] = 500
+    heat[6] = 0.001
+    buffer.update(heat, 500)
+
+    expect(pixelAt(buffer, 0)).toEqual([0, 0, 0, 0])
+    // 最大熱量は黄（heatColor(1)）
+    const yellow = heatColor(1)
+    expect(pixelAt(buffer, 5)).toEqual([
+      (yellow >> 16) & 0xff,
+      (yellow >> 8) & 0xff,
+      yellow & 0xff,
+      255,
+    ])
+    // わずかな熱は不透明な黒
+    expect(pixelAt(buffer, 6)).toEqual([0, 0, 0, 255])
+  })
+
+  test("色の段階が変わったセルを含む帯のみを書き換えたものとして返す", () => {
+    const width = 10
+    const buffer = new HeatPixelBuffer(width, 10, 4)
+    expect(buffer.bandCount).toBe(3)
+    expect(buffer.bandRows(2)).toEqual({ start: 8, rows: 2 })
+    expect(buffer.bandPixels(2).length).toBe(2 * width * 4)
+
+    const heat = new Float64Array(width * 10)
+    expect(buffer.update(heat, 500)).toEqual([])
+
+    heat[1 * width + 3] = 100
+    heat[9 * width + 9] = 100
+    expect(buffer.update(heat, 500)).toEqual([0, 2])
+
+    // 同じ段階に収まる変化は書き換えない
+    heat[1 * width + 3] = 100.01
+    expect(buffer.update(heat, 500)).toEqual([])
+
+    heat[9 * width + 9] = 0
+    expect(buffer.update(heat, 500)).toEqual([2])
+    expect(pixelAt(buffer, 9 * width + 9)).toEqual([0, 0, 0, 0])
+  })
+})
@@ -0,0 +1,166 @@
+/**
+ * 熱マップの画素データ
+ * 熱グリッドの1セルを1画素（RGBA）として書き込む。熱量は色の段階に丸め、段階が変わったセルのみ
+ * 書き換える。グリッドは行方向の帯に分け、書き換えた帯だけを再転送できるようにする
+ */
+
+/** 色の段階数（熱量0以下は段階0・透明、それ以外は1〜HEAT_COLOR_LEVELS） */
+export const HEAT_COLOR_LEVELS = 256
+
+/**
+ * 正規化した熱量（0〜1）の色（黒→暗赤→赤→橙→黄）
+ * @param normalized 正規化した熱量
+ * @returns RGB色コード
+ */
+export const heatColor = (normalized: number): number => {
+  let r: number, g: number, b: number
+
+  if (normalized < 0.25) {
+    // 黒→暗赤（0-0.25）
+    const t = normalized * 4
+    r = Math.floor(128 * t)
+    g = 0
+    b = 0
+  } else if (normalized < 0.5) {
+    // 暗赤→赤（0.25-0.5）
+    const t = (normalized - 0.25) * 4
+    r = Math.floor(128 + 127 * t)
+    g = 0
+    b = 0
+  } else if (normalized < 0.75) {
+    // 赤→橙（0.5-0.75）
+    const t = (normalized - 0.5) * 4
+    r = 255
+    g = Math.floor(165 * t)
+    b = 0
+  } else {
+    // 橙→黄（0.75-1.0）
+    const t = (normalized - 0.75) * 4
+    r = 255
+    g = Math.floor(165 + 90 * t)
+    b = Math.floor(100 * t)
+  }
+
+  return (r << 16) | (g << 8) | b
+}
+
+/**
+ * 熱量の色の段階
+ * @param heat 熱量
+ * @param maxHeat 最大熱量（これ以上は最も明るい色）
+ */
+export const heatColorLevel = (heat: number, maxHeat: number): number => {
+  if (!(heat > 0)) {
+    return 0
+  }
+  const normalized = Math.min(1, heat / maxHeat)
+  return 1 + Math.min(HEAT_COLOR_LEVELS - 1, Math.floor(normalized * HEAT_COLOR_LEVELS))
+}
+
+/**
+ * 色の段階ごとの画素値（RGBAのバイト順をリトルエンディアンのUint32で表したもの）
+ * 段階0は透明
+ */
+const createHeatPalette = (): Uint32Array => {
+  const palette = new Uint32Array(HEAT_COLOR_LEVELS + 1)
+  for (let level = 1; level <= HEAT_COLOR_LEVELS; level++) {
+    const color = heatColor((level - 1) / (HEAT_COLOR_LEVELS - 1))
+    const r = (color >> 16) & 0xff
+    const g = (color >> 8) & 0xff
+    const b = color & 0xff
+    palette[level] = ((0xff << 24) | (b << 16) | (g << 8) | r) >>> 0
+  }
+  return palette
+}
+
+const HEAT_PALETTE = createHeatPalette()
+
+/**
+ * 熱マップの画素データ
+ */
+export class HeatPixelBuffer {
+  /** RGBAの画素データ（width×height×4バイト） */
+  private readonly _pixels: Uint8Array
+  private readonly _words: Uint32Array
+  /** セルごとの書き込み済みの色の段階 */
+  private readonly _levels: Uint16Array
+  private readonly _bandCount: number
+
+  public get pixels(): Uint8Array {
+    return this._pixels
+  }
+
+  public get bandCount(): number {
+    return this._bandCount
+  }
+
+  /**
+   * @param width グリッドの幅
+   * @param height グリッドの高さ
+   * @param bandHeight 帯の行数
+   */
+  public constructor(
+    public readonly width: number,
+    public readonly height: number,
+    public readonly bandHeight = 32
+  ) {
+    this._pixels = new Uint8Array(width * height * 4)
+    this._words = new Uint32Array(this._pixels.buffer)
+    this._levels = new Uint16Array(width * height)
+    this._bandCount = Math.ceil(height / bandHeight)
+  }
+
+  /**
+   * 帯の先頭行と行数
+   * @param band 帯の番号
+   */
+  public bandRows(band: number): { start: number; rows: number } {
+    const start = band * this.bandHeight
+    return { start, rows: Math.min(this.bandHeight, this.height - start) }
+  }
+
+  /**
+   * 帯の画素データ（pixelsの一部を参照する）
+   * @param band 帯の番号
+   */
+  public bandPixels(band: number): Uint8Array {
+    const { start, rows } = this.bandRows(band)
+    return this._pixels.subarray(start * this.width * 4, (start + rows) * this.width * 4)
+  }
+
+  /**
+   * 熱グリッドを書き込む（色の段階が変わったセルのみ）
+   * @param heatValues 熱グリッド（width×height）
+   * @param maxHeat 最大熱量（色の正規化用）
+   * @returns 書き換えた帯の番号（昇順）
+   */
+  public update(heatValues: Float64Array, maxHeat: number): number[] {
+    const changedBands: number[] = []
+    const bandCells = this.bandHeight * this.width
+    const levels = this._levels
+    const words = this._words
+    const cellCount = Math.min(heatValues.length, levels.length)
+    // heatColorLevelを展開したもの（セル数に比例する唯一の処理のため）
+    const scale = HEAT_COLOR_LEVELS / maxHeat
+    const maxLevel = HEAT_COLOR_LEVELS - 1
+
+    for (let band = 0; band < this._bandCount; band++) {
+      const end = Math.min(cellCount, (band + 1) * bandCells)
+      let changed = false
+      for (let cell = band * bandCells; cell < end; cell++) {
+        const heat = heatValues[cell] ?? 0
+        const level = heat > 0 ? 1 + Math.min(maxLevel, Math.floor(heat * scale)) : 0
+        if (level === levels[cell]) {
+          continue
+        }
+        levels[cell] = level
+        words[cell] = HEAT_PALETTE[level] ?? 0
+        changed = true
+      }
+      if (changed) {
+        changedBands.push(band)
+      }
+    }
+    return changedBands
+  }
+}
@@ -151,11 +151,15 @@ export class HullInfoRenderer {
 
   /**
    * HULL情報を更新して表示
-   * @param hull HULLオブジェクト
+   * @param hull HULLオブジェクト（描画用スナップショットから表示する場合は必要な値のみ）
    * @param units 接続されているユニット
    * @param position 表示位置（ワールド座標）
    */
-  public update(hull: Hull, units: GameObject[], position: { x: number; y: number }): void {
+  public update(
+    hull: Pick<Hull, "id" | "storedEnergy" | "capacity">,
+    units: readonly Pick<GameObject, "type" | "mass">[],
+    position: { x: number; y: number }
+  ): void {
     // 位置を設定（オブジェクト位置を左上とする）
     this._container.x = position.x
     this._container.y = position.y
@@ -2,7 +2,7 @@
  * オブジェクト選択状態の管理
  */
 
-import type { GameObject, ObjectId, Hull } from "@/types/game"
+import type { GameObject, ObjectCollection, ObjectId, Hull } from "@/types/game"
 import type { Vec2 } from "@/types/game"
 import { isHull } from "@/utils/type-guards"
 
@@ -20,17 +20,17 @@ export type SelectedObjectInfo = {
  */
 export class ObjectSelectionManager {
   private _selectedObjectId: ObjectId | null = null
-  private _objects: Map<ObjectId, GameObject>
+  private _objects: ObjectCollection
   private _screenPosition: Vec2 | null = null
 
-  public constructor(objects: Map<ObjectId, GameObject>) {
+  public constructor(objects: ObjectCollection) {
     this._objects = objects
   }
 
   /**
    * オブジェクトマップを更新
    */
-  public updateObjects(objects: Map<ObjectId, GameObject>): void {
+  public updateObjects(objects: ObjectCollection): void {
     this._objects = objects
     
     // 選択中のオブジェクトが削除されていたらクリア
@@ -128,7 +128,10 @@ export class ObjectSelectionManager {
  * @param units 接続されているユニット
  * @returns 使用容量のパーセンテージ
  */
-export const calculateHullUsage = (hull: Hull, units: GameObject[]): number => {
+export const calculateHullUsage = (
+  hull: Pick<Hull, "storedEnergy" | "capacity">,
+  units: readonly Pick<GameObject, "mass">[]
+): number => {
   // 格納エネルギー
   let usedCapacity = hull.storedEnergy
 
@@ -158,7 +161,7 @@ export const formatEnergy = (energy: number): string => {
  * @param units ユニット配列
  * @returns 種別ごとのカウント
  */
-export const countUnitTypes = (units: GameObject[]): Map<string, number> => {
+export const countUnitTypes = (units: readonly Pick<GameObject, "type">[]): Map<string, number> => {
   const counts = new Map<string, number>()
   
   for (const unit of units) {
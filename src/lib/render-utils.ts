@@ -12,14 +12,24 @@ import type {
   Hull,
   DirectionalForceField,
   EnergySource,
+  ObjectType,
 } from "@/types/game"
 import { calculateEnergySourceSize, calculateUnitRadius } from "../engine/object-factory"
-import { isAssembler, isComputer, isHull } from "../utils/type-guards"
+import { isAssembler, isComputer } from "../utils/type-guards"
+import {
+  RENDER_FLAG_ASSEMBLING,
+  RENDER_FLAG_ATTACHED,
+  RENDER_OBJECT_TYPES,
+} from "../engine/render-snapshot"
+import type { RenderSnapshotViews } from "../engine/render-snapshot"
 
 const RenderingParameters = {
   world: {
     backgroundColor: 0x101010,
   },
+  energy: {
+    color: 0xffd700,
+  },
   independentUnit: {
     strokeWidth: 4,
   },
@@ -27,6 +37,7 @@ const RenderingParameters = {
     strokeWidth: 3,
   },
   hull: {
+    glyphColor: 0xa9a9a9,
     strokeColor: 0x2c3e50,
     damagedColor: 0xff0000,
   },
@@ -154,6 +165,197 @@ export const calculatePillShapeSize = (capacity: number): { width: number; heigh
   }
 }
 
+/**
+ * エネルギーオブジェクトを描画（デザイン仕様: #FFD700、小さな円形）
+ * @param graphics 描画先のGraphicsオブジェクト
+ * @param radius 半径
+ */
+export const drawEnergyObject = (graphics: PIXI.Graphics, radius: number): void => {
+  graphics.circle(0, 0, radius)
+  graphics.fill(RenderingParameters.energy.color)
+}
+
+/** パーティクルのテクスチャの半径（ピクセル） */
+export const PARTICLE_TEXTURE_RADIUS = 16
+
+/**
+ * パーティクル（エネルギーオブジェクト、縮小表示時の簡略図形）用の白い円のテクスチャを作成
+ * パーティクルはこのテクスチャを半径に合わせて拡大縮小し、objectGlyphTintで着色する
+ */
+export const createParticleTexture = (): PIXI.Texture => {
+  const radius = PARTICLE_TEXTURE_RADIUS
+  const canvas = document.createElement("canvas")
+  canvas.width = radius * 2
+  canvas.height = radius * 2
+  const context = canvas.getContext("2d")
+  if (context != null) {
+    context.fillStyle = "#ffffff"
+    context.beginPath()
+    context.arc(radius, radius, radius, 0, Math.PI * 2)
+    context.fill()
+  }
+  return PIXI.Texture.from(canvas)
+}
+
+/**
+ * 縮小表示時の簡略図形（パーティクル）の色
+ * @param type オブジェクトの種類
+ */
+export const objectGlyphTint = (type: ObjectType): number => {
+  switch (type) {
+    case "ENERGY":
+      return RenderingParameters.energy.color
+    case "HULL":
+      return RenderingParameters.hull.glyphColor
+    case "ASSEMBLER":
+      return RenderingParameters.assembler.strokeColor
+    case "COMPUTER":
+      return RenderingParameters.computer.color
+  }
+}
+
+/** HULLの損傷表示の段階数（同じ段階のHULLは同じ形状を共有する） */
+const HULL_DAMAGE_STEPS = 16
+
+/**
+ * HULLの損傷表示（縁の赤み）の不透明度
+ * HPが7割を下回ると表示し、HULL_DAMAGE_STEPS段階に丸める
+ * @param buildEnergy HULLの構成エネルギー
+ * @param currentEnergy HULLの現在のエネルギー
+ */
+export const hullDamageAlpha = (buildEnergy: number, currentEnergy: number): number => {
+  const healthRatio = currentEnergy / buildEnergy
+  if (healthRatio < 0.7) {
+    return Math.round((1 - healthRatio) * HULL_DAMAGE_STEPS) / HULL_DAMAGE_STEPS
+  }
+  return 0
+}
+
+/**
+ * HULLと固定されているユニットを描画（デザイン仕様v2: #A9A9A9、pill shape）
+ * @param graphics 描画先のGraphicsオブジェクト
+ * @param buildEnergy HULLの構成エネルギー
+ * @param currentEnergy HULLの現在のエネルギー
+ * @param computerBuildEnergies 固定されているCOMPUTERの構成エネルギー
+ * @param assemblerBuildEnergies 固定されているASSEMBLERの構成エネルギー（描画順）
+ */
+export const drawHull = (
+  graphics: PIXI.Graphics,
+  buildEnergy: number,
+  currentEnergy: number,
+  computerBuildEnergies: readonly number[],
+  assemblerBuildEnergies: readonly number[]
+): void => {
+  const hullRadius = calculateUnitRadius(buildEnergy)
+
+  graphics.circle(0, 0, hullRadius)
+  graphics.fill(RenderingParameters.world.backgroundColor)
+  graphics.stroke({
+    width: RenderingParameters.independentUnit.strokeWidth,
+    color: RenderingParameters.hull.strokeColor,
+  })
+
+  // HP減少時は縁に赤み
+  const damageAlpha = hullDamageAlpha(buildEnergy, currentEnergy)
+  if (damageAlpha > 0) {
+    graphics.circle(0, 0, hullRadius)
+    graphics.stroke({
+      width: RenderingParameters.independentUnit.strokeWidth,
+      color: RenderingParameters.hull.damagedColor,
+      alpha: damageAlpha,
+    })
+  }
+
+  // HULL内のCOMPUTERを描画
+  const [totalComputerBuildEnergy, computerRadius] = ((): [number, number] => {
+    const totalBuildEnergy = computerBuildEnergies.reduce((result, current) => result + current, 0)
+    if (totalBuildEnergy <= 0) {
+      return [0, 0]
+    }
+    return [totalBuildEnergy, calculateUnitRadius(totalBuildEnergy)]
+  })()
+
+  if (totalComputerBuildEnergy > 0) {
+    graphics.circle(0, 0, computerRadius)
+    graphics.fill(RenderingParameters.computer.color)
+  }
+
+  // HULL内のASSEMBLERを描画
+  let currentAngle = 0
+  const fillableMaxBuildEnergy = buildEnergy - totalComputerBuildEnergy
+  if (fillableMaxBuildEnergy > 0) {
+    assemblerBuildEnergies.forEach(assemblerBuildEnergy => {
+      const buildEnergyRatio = assemblerBuildEnergy / fillableMaxBuildEnergy
+      const startAngle = currentAngle
+      const endAngle = startAngle + buildEnergyRatio * Math.PI * 2
+
+      // 扇形を描画（同じGraphicsに描き、形状を共有できるようにする）
+      const innerRadius =
+        computerRadius === 0 ? 5 : computerRadius + RenderingParameters.attachedUnit.strokeWidth
+      drawSector(
+        graphics,
+        0,
+        0,
+        hullRadius - RenderingParameters.independentUnit.strokeWidth,
+        startAngle,
+        endAngle,
+        innerRadius
+      )
+      graphics.stroke({
+        width: RenderingParameters.attachedUnit.strokeWidth,
+        color: RenderingParameters.assembler.strokeColor,
+        alpha: 1,
+      })
+      graphics.fill(RenderingParameters.assembler.fillColor)
+
+      currentAngle = endAngle
+
+      // TODO:活動中のインジケータ描画
+    })
+  }
+
+  // TODO: 接続しているHULLを描画する
+}
+
+/**
+ * HULLに固定されていないASSEMBLERを描画（デザイン仕様v2: #FF8C00、角丸長方形）
+ * @param graphics 描画先のGraphicsオブジェクト
+ * @param radius 半径
+ * @param isAssembling 活動中か
+ */
+export const drawIndependentAssembler = (
+  graphics: PIXI.Graphics,
+  radius: number,
+  isAssembling: boolean
+): void => {
+  const size = radius * 2
+
+  // 角丸長方形を描画
+  graphics.roundRect(-size / 2, -size / 2, size, size, 5)
+  graphics.stroke({
+    width: RenderingParameters.independentUnit.strokeWidth,
+    color: RenderingParameters.assembler.strokeColor,
+    alpha: 1,
+  })
+  graphics.fill(RenderingParameters.assembler.fillColor)
+
+  // 活動中はドットを描く
+  if (isAssembling) {
+    graphics.circle(0, 0, radius / 3)
+    graphics.fill({ color: 0xf3b449, alpha: 1 })
+  }
+}
+
+/**
+ * HULLに固定されていないCOMPUTERを描画（デザイン仕様v2: #00BFFF、円形）
+ * @param graphics 描画先のGraphicsオブジェクト
+ * @param radius 半径
+ */
+export const drawIndependentComputer = (graphics: PIXI.Graphics, radius: number): void => {
+  graphics.circle(0, 0, radius)
+  graphics.fill(RenderingParameters.computer.color)
+}
+
 /**
  * ゲームオブジェクトを描画
  * @param graphics 描画先のGraphicsオブジェクト
@@ -167,161 +369,64 @@ export const drawObject = (
 ): void => {
   switch (gameObject.type) {
     case "ENERGY": {
-      // エネルギーオブジェクト（デザイン仕様: #FFD700、小さな円形）
-      graphics.circle(0, 0, gameObject.radius)
-      graphics.fill(0xffd700)
+      drawEnergyObject(graphics, gameObject.radius)
       return
     }
 
     case "HULL": {
-      // HULL（デザイン仕様v2: #A9A9A9、pill shape）
       const hull = gameObject as Hull
-      const hullRadius = calculateUnitRadius(hull.buildEnergy)
-
-      graphics.circle(0, 0, hullRadius)
-      graphics.fill(RenderingParameters.world.backgroundColor)
-      graphics.stroke({
-        width: RenderingParameters.independentUnit.strokeWidth,
-        color: RenderingParameters.hull.strokeColor,
-      })
 
-      // HP減少時は縁に赤み
-      const healthRatio = hull.currentEnergy / hull.buildEnergy
-      if (healthRatio < 0.7) {
-        graphics.circle(0, 0, hullRadius)
-        graphics.stroke({
-          width: RenderingParameters.independentUnit.strokeWidth,
-          color: RenderingParameters.hull.damagedColor,
-          alpha: 1 - healthRatio,
-        })
-      }
-
-      if (hull.attachedUnitIds.length <= 0 || getUnit == null) {
-        return
-      }
-
-      // 固定されているユニットを描画
+      // 固定されているユニット
       const attachedAssemblers: Assembler[] = []
       const attachedComputers: Computer[] = []
-      const attachedHulls: Hull[] = []
-
-      hull.attachedUnitIds.forEach(unitId => {
-        const unit = getUnit(unitId)
-        if (unit == null) {
-          return
-        }
-
-        if (isAssembler(unit)) {
-          attachedAssemblers.push(unit)
-          return
-        }
-        if (isComputer(unit)) {
-          attachedComputers.push(unit)
-          return
-        }
-        if (isHull(unit)) {
-          attachedHulls.push(unit)
-          return
-        }
-      })
-
-      // HULL内のCOMPUTERを描画
-      const [totalComputerBuildEnergy, computerRadius] = ((): [number, number] => {
-        const totalBuildEnergy = attachedComputers.reduce(
-          (result, current) => result + current.buildEnergy,
-          0
-        )
-        if (totalBuildEnergy <= 0) {
-          return [0, 0]
-        }
-        return [totalBuildEnergy, calculateUnitRadius(totalBuildEnergy)]
-      })()
 
-      if (totalComputerBuildEnergy > 0) {
-        graphics.circle(0, 0, computerRadius)
-        graphics.fill(RenderingParameters.computer.color)
-      }
-
-      // HULL内のASSEMBLERを描画
-      let currentAngle = 0
-      const fillableMaxBuildEnergy = hull.buildEnergy - totalComputerBuildEnergy
-      if (fillableMaxBuildEnergy > 0) {
-        attachedAssemblers.forEach(assembler => {
-          const buildEnergyRatio = assembler.buildEnergy / fillableMaxBuildEnergy
-          const startAngle = currentAngle
-          const endAngle = startAngle + buildEnergyRatio * Math.PI * 2
-
-          // 扇形を描画
-          const sectorGraphics = new PIXI.Graphics()
-          const innerRadius =
-            computerRadius === 0 ? 5 : computerRadius + RenderingParameters.attachedUnit.strokeWidth
-          drawSector(
-            sectorGraphics,
-            0,
-            0,
-            hullRadius - RenderingParameters.independentUnit.strokeWidth,
-            startAngle,
-            endAngle,
-            innerRadius
-          )
-          sectorGraphics.stroke({
-            width: RenderingParameters.attachedUnit.strokeWidth,
-            color: RenderingParameters.assembler.strokeColor,
-            alpha: 1,
-          })
-          sectorGraphics.fill(RenderingParameters.assembler.fillColor)
-
-          currentAngle = endAngle
-
-          if (assembler.isAssembling) {
-            // TODO:活動中のインジケータ描画
+      if (getUnit != null) {
+        hull.attachedUnitIds.forEach(unitId => {
+          const unit = getUnit(unitId)
+          if (unit == null) {
+            return
           }
 
-          graphics.addChild(sectorGraphics)
+          if (isAssembler(unit)) {
+            attachedAssemblers.push(unit)
+            return
+          }
+          if (isComputer(unit)) {
+            attachedComputers.push(unit)
+            return
+          }
         })
       }
 
-      // TODO: 接続しているHULLを描画する
+      drawHull(
+        graphics,
+        hull.buildEnergy,
+        hull.currentEnergy,
+        attachedComputers.map(computer => computer.buildEnergy),
+        attachedAssemblers.map(assembler => assembler.buildEnergy)
+      )
       return
     }
 
     case "ASSEMBLER": {
-      // ASSEMBLER（デザイン仕様v2: #FF8C00、角丸長方形）
       const assembler = gameObject as Assembler
-      const size = gameObject.radius * 2
 
       // HULLに固定されていない場合のみネイティブデザインを描画
+      // HULLに固定されている場合はHULL側で描画される
       if (assembler.parentHullId === undefined) {
-        // 角丸長方形を描画
-        graphics.roundRect(-size / 2, -size / 2, size, size, 5)
-        graphics.stroke({
-          width: RenderingParameters.independentUnit.strokeWidth,
-          color: RenderingParameters.assembler.strokeColor,
-          alpha: 1,
-        })
-        graphics.fill(RenderingParameters.assembler.fillColor)
-
-        // 活動中はドットを描く
-        if (assembler.isAssembling) {
-          graphics.circle(0, 0, gameObject.radius / 3)
-          graphics.fill({ color: 0xf3b449, alpha: 1 })
-        }
+        drawIndependentAssembler(graphics, gameObject.radius, assembler.isAssembling)
       }
-      // HULLに固定されている場合はHULL側で描画される
       break
     }
 
     case "COMPUTER": {
-      // COMPUTER（デザイン仕様v2: #00BFFF、円形）
       const computer = gameObject as Computer
 
       // HULLに固定されていない場合のみネイティブデザインを描画
+      // HULLに固定されている場合はHULL側で描画される
       if (computer.parentHullId === undefined) {
-        // 円形を描画
-        graphics.circle(0, 0, gameObject.radius)
-        graphics.fill(RenderingParameters.computer.color)
+        drawIndependentComputer(graphics, gameObject.radius)
       }
-      // HULLに固定されている場合はHULL側で描画される
       break
     }
 
@@ -334,6 +439,125 @@ export const drawObject = (
   }
 }
 
+/**
+ * 描画用スナップショットのオブジェクトを描画（drawObjectと同じ描画）
+ * @param graphics 描画先のGraphicsオブジェクト
+ * @param views スナップショットの数値データ
+ * @param index オブジェクト位置
+ */
+export const drawSnapshotObject = (
+  graphics: PIXI.Graphics,
+  views: RenderSnapshotViews,
+  index: number
+): void => {
+  const { objects, attachments } = views
+  const type = RENDER_OBJECT_TYPES[objects.type[index] ?? -1]
+  const radius = objects.radius[index] ?? 0
+  const flags = objects.flags[index] ?? 0
+  const isAttached = (flags & RENDER_FLAG_ATTACHED) !== 0
+
+  switch (type) {
+    case "ENERGY":
+      drawEnergyObject(graphics, radius)
+      return
+
+    case "HULL": {
+      const computerBuildEnergies: number[] = []
+      const assemblerBuildEnergies: number[] = []
+      const start = objects.attachStart[index] ?? 0
+      const end = start + (objects.attachCount[index] ?? 0)
+      for (let k = start; k < end; k++) {
+        const unit = attachments[k] ?? -1
+        const unitType = RENDER_OBJECT_TYPES[objects.type[unit] ?? -1]
+        if (unitType === "ASSEMBLER") {
+          assemblerBuildEnergies.push(objects.buildEnergy[unit] ?? 0)
+        } else if (unitType === "COMPUTER") {
+          computerBuildEnergies.push(objects.buildEnergy[unit] ?? 0)
+        }
+      }
+      drawHull(
+        graphics,
+        objects.buildEnergy[index] ?? 0,
+        objects.energy[index] ?? 0,
+        computerBuildEnergies,
+        assemblerBuildEnergies
+      )
+      return
+    }
+
+    case "ASSEMBLER":
+      if (!isAttached) {
+        drawIndependentAssembler(graphics, radius, (flags & RENDER_FLAG_ASSEMBLING) !== 0)
+      }
+      return
+
+    case "COMPUTER":
+      if (!isAttached) {
+        drawIndependentComputer(graphics, radius)
+      }
+      return
+
+    default:
+      return
+  }
+}
+
+/**
+ * 描画用スナップショットのオブジェクトの描画内容を表すキー（drawSnapshotObjectで何も描かない場合はnull）
+ * キーが同じオブジェクトは同じ形状になるため、描き直さずに形状を共有できる
+ * @param views スナップショットの数値データ
+ * @param index オブジェクト位置
+ */
+export const snapshotObjectShapeKey = (
+  views: RenderSnapshotViews,
+  index: number
+): string | null => {
+  const { objects, attachments } = views
+  const radius = objects.radius[index] ?? 0
+  const flags = objects.flags[index] ?? 0
+  const isAttached = (flags & RENDER_FLAG_ATTACHED) !== 0
+
+  switch (RENDER_OBJECT_TYPES[objects.type[index] ?? -1]) {
+    case "ENERGY":
+      return `E:${radius}`
+
+    case "HULL": {
+      const buildEnergy = objects.buildEnergy[index] ?? 0
+      let key = `H:${buildEnergy}:${hullDamageAlpha(buildEnergy, objects.energy[index] ?? 0)}`
+      const start = objects.attachStart[index] ?? 0
+      const end = start + (objects.attachCount[index] ?? 0)
+      for (let k = start; k < end; k++) {
+        const unit = attachments[k] ?? -1
+        key += `:${objects.type[unit] ?? -1}/${objects.buildEnergy[unit] ?? 0}`
+      }
+      return key
+    }
+
+    case "ASSEMBLER":
+      return isAttached ? null : `A:${radius}:${flags & RENDER_FLAG_ASSEMBLING}`
+
+    case "COMPUTER":
+      return isAttached ? null : `C:${radius}`
+
+    default:
+      return null
+  }
+}
+
+/**
+ * エネルギーソースの描画内容を表すキー
+ * @param source エネルギーソース
+ */
+export const energySourceShapeKey = (source: EnergySource): string =>
+  `${source.position.x}:${source.position.y}:${source.energyPerTick}`
+
+/**
+ * 方向性力場の描画内容を表すキー
+ * @param forceField 方向性力場
+ */
+export const forceFieldShapeKey = (forceField: DirectionalForceField): string =>
+  `${forceField.type}:${forceField.position.x}:${forceField.position.y}:${forceField.radius}`
+
 /**
  * エネルギーソースを描画
  * @param graphics 描画先のGraphicsオブジェクト
@@ -343,7 +567,7 @@ export const drawEnergySource = (graphics: PIXI.Graphics, source: EnergySource):
   const size = calculateEnergySourceSize(source)
   const halfSize = size / 2
   graphics.roundRect(source.position.x - halfSize, source.position.y - halfSize, size, size, 2)
-  graphics.fill({ color: 0xffd700, alpha: 0.8 })
+  graphics.fill({ color: RenderingParameters.energy.color, alpha: 0.8 })
 }
 
 /**
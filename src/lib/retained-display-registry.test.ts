@@ -0,0 +1,110 @@
+/**
+ * 描画オブジェクトの保持 テスト
+ */
+
+import { RetainedDisplayRegistry } from "./retained-display-registry"
+import type { ObjectId } from "@/types/game"
+
+type FakeDisplay = { readonly serial: number; destroyed: boolean }
+
+/** 生成・表示への出し入れを記録する保持 */
+const createRegistry = (maxPoolSize?: number) => {
+  const attached = new Set<FakeDisplay>()
+  let created = 0
+  const registry = new RetainedDisplayRegistry<FakeDisplay>(
+    {
+      create: () => ({ serial: created++, destroyed: false }),
+      attach: display => attached.add(display),
+      detach: display => attached.delete(display),
+      destroy: display => {
+        display.destroyed = true
+      },
+    },
+    maxPoolSize
+  )
+  return { registry, attached, createdCount: () => created }
+}
+
+const id = (value: number): ObjectId => value as ObjectId
+
+describe("描画オブジェクトの保持", () => {
+  test("同じオブジェクトには同じ描画オブジェクトを返し、キーが変わった場合のみ描き直す", () => {
+    const { registry, attached } = createRegistry()
+
+    registry.beginFrame()
+    const first = registry.acquire(id(1), "A")
+    expect(first.needsRedraw).toBe(true)
+    registry.endFrame()
+
+    registry.beginFrame()
+    const second = registry.acquire(id(1), "A")
+    expect(second.display).toBe(first.display)
+    expect(second.needsRedraw).toBe(false)
+    registry.endFrame()
+
+    registry.beginFrame()
+    expect(registry.acquire(id(1), "B").needsRedraw).toBe(true)
+    registry.endFrame()
+
+    expect(attached.size).toBe(1)
+  })
+
+  test("参照されなかった描画オブジェクトは表示から外してプールへ戻し、次に現れたオブジェクトに使う", () => {
+    const { registry, attached, createdCount } = createRegistry()
+
+    registry.beginFrame()
+    const removed = registry.acquire(id(1), "A").display
+    registry.acquire(id(2), "A")
+    registry.endFrame()
+
+    registry.beginFrame()
+    registry.acquire(id(2), "A")
+    expect(registry.endFrame()).toBe(1)
+    expect(attached.has(removed)).toBe(false)
+    expect(registry.size).toBe(1)
+    expect(registry.pooledCount).toBe(1)
+
+    registry.beginFrame()
+    registry.acquire(id(2), "A")
+    const reused = registry.acquire(id(3), "A")
+    registry.endFrame()
+
+    // キーが同じでも、使い回した描画オブジェクトは描き直す
+    expect(reused.display).toBe(removed)
+    expect(reused.needsRedraw).toBe(true)
+    expect(attached.has(removed)).toBe(true)
+    expect(createdCount()).toBe(2)
+  })
+
+  test("プールの上限を超えた描画オブジェクトは破棄する", () => {
+    const { registry } = createRegistry(1)
+
+    registry.beginFrame()
+    const first = registry.acquire(id(1)).display
+    const second = registry.acquire(id(2)).display
+    registry.endFrame()
+
+    registry.beginFrame()
+    expect(registry.endFrame()).toBe(2)
+    expect(registry.pooledCount).toBe(1)
+    expect([first.destroyed, second.destroyed].filter(destroyed => destroyed)).toHaveLength(1)
+  })
+
+  test("clearで表示中・プール中の描画オブジェクトをすべて破棄する", () => {
+    const { registry, attached } = createRegistry()
+
+    registry.beginFrame()
+    const pooled = registry.acquire(id(1)).display
+    registry.endFrame()
+    registry.beginFrame()
+    const shown = registry.acquire(id(2)).display
+    registry.endFrame()
+
+    registry.clear()
+    expect(pooled.destroyed).toBe(true)
+    expect(shown.destroyed).toBe(true)
+    expect(attached.size).toBe(0)
+    expect(registry.size).toBe(0)
+    expect(registry.pooledCount).toBe(0)
+  })
+})
@@ -0,0 +1,134 @@
+/**
+ * 描画オブジェクトの保持
+ * ObjectIdごとに描画オブジェクトを保持し、フレームをまたいで使い続ける。
+ * フレーム内で参照されなかったもの（世界から消えたオブジェクト）は表示から外してプールへ戻し、
+ * 次に現れたオブジェクトに使い回す
+ */
+
+import type { ObjectId } from "@/types/game"
+import { ObjectPool } from "@/utils/object-pool"
+import type { Poolable } from "@/utils/object-pool"
+
+/** 描画オブジェクトの生成・表示への出し入れ */
+export type RetainedDisplayHooks<T> = {
+  /** 描画オブジェクトを作成する */
+  readonly create: () => T
+  /** 描画オブジェクトを表示に加える */
+  readonly attach: (display: T) => void
+  /** 描画オブジェクトを表示から外す */
+  readonly detach: (display: T) => void
+  /** プールに入りきらない描画オブジェクトを破棄する */
+  readonly destroy: (display: T) => void
+}
+
+/** 保持している描画オブジェクト */
+export class RetainedDisplay<T> implements Poolable {
+  /** 描画内容を表すキー（変わった場合に描き直す） */
+  public key: string | null = null
+  /** 最後に参照されたフレーム */
+  public frame = -1
+  /** 今回のフレームで描き直しが必要か（新たに割り当てた場合、キーが変わった場合） */
+  public needsRedraw = true
+
+  public constructor(public readonly display: T) {}
+
+  public reset(): void {
+    this.key = null
+    this.frame = -1
+    this.needsRedraw = true
+  }
+}
+
+/**
+ * ObjectIdごとの描画オブジェクトの保持
+ * 1フレームの描画は beginFrame → acquire（表示するオブジェクトごと） → endFrame の順に呼ぶ
+ */
+export class RetainedDisplayRegistry<T> {
+  private readonly _entries = new Map<ObjectId, RetainedDisplay<T>>()
+  private readonly _pool: ObjectPool<RetainedDisplay<T>>
+  private _frame = 0
+
+  /** 表示中の描画オブジェクトの数 */
+  public get size(): number {
+    return this._entries.size
+  }
+
+  /** プールで待機している描画オブジェクトの数 */
+  public get pooledCount(): number {
+    return this._pool.size
+  }
+
+  /**
+   * @param _hooks 描画オブジェクトの生成・表示への出し入れ
+   * @param _maxPoolSize プールに残す描画オブジェクトの上限（超えた分は破棄する）
+   */
+  public constructor(
+    private readonly _hooks: RetainedDisplayHooks<T>,
+    private readonly _maxPoolSize = 10000
+  ) {
+    this._pool = new ObjectPool(() => new RetainedDisplay(this._hooks.create()), 0, _maxPoolSize)
+  }
+
+  /** フレームの描画を開始する */
+  public beginFrame(): void {
+    this._frame++
+  }
+
+  /**
+   * オブジェクトの描画オブジェクトを取得する（なければプールから割り当てて表示に加える）
+   * @param id オブジェクトID
+   * @param key 描画内容を表すキー
+   */
+  public acquire(id: ObjectId, key: string | null = null): RetainedDisplay<T> {
+    let entry = this._entries.get(id)
+    if (entry == null) {
+      entry = this._pool.acquire()
+      this._hooks.attach(entry.display)
+      this._entries.set(id, entry)
+      entry.needsRedraw = true
+    } else {
+      entry.needsRedraw = entry.key !== key
+    }
+    entry.key = key
+    entry.frame = this._frame
+    return entry
+  }
+
+  /**
+   * フレームの描画を終了し、このフレームで参照されなかった描画オブジェクトをプールへ戻す
+   * @returns プールへ戻した数
+   */
+  public endFrame(): number {
+    let recycled = 0
+    this._entries.forEach((entry, id) => {
+      if (entry.frame === this._frame) {
+        return
+      }
+      this._entries.delete(id)
+      this.recycle(entry)
+      recycled++
+    })
+    return recycled
+  }
+
+  /** 表示中・プール中の描画オブジェクトをすべて破棄する */
+  public clear(): void {
+    this._entries.forEach(entry => {
+      this._hooks.detach(entry.display)
+      this._hooks.destroy(entry.display)
+    })
+    this._entries.clear()
+    while (this._pool.size > 0) {
+      this._hooks.destroy(this._pool.acquire().display)
+    }
+  }
+
+  private recycle(entry: RetainedDisplay<T>): void {
+    this._hooks.detach(entry.display)
+    if (this._pool.size < this._maxPoolSize) {
+      this._pool.release(entry)
+    } else {
+      this._hooks.destroy(entry.display)
+    }
+  }
+}
@@ -0,0 +1,81 @@
+/**
+ * 形状の共有 テスト
+ */
+
+import { SharedShapeCache } from "./shared-shape-cache"
+
+type FakeShape = { readonly key: string }
+
+const createCache = (maxIdleCount?: number) => {
+  const destroyed: string[] = []
+  let created = 0
+  const cache = new SharedShapeCache<FakeShape>(shape => destroyed.push(shape.key), maxIdleCount)
+  const acquire = (key: string): FakeShape =>
+    cache.acquire(key, () => {
+      created++
+      return { key }
+    })
+  return { cache, acquire, destroyed, createdCount: () => created }
+}
+
+describe("形状の共有", () => {
+  test("同じキーでは作成済みの形状を共有する", () => {
+    const { cache, acquire, createdCount } = createCache()
+
+    const first = acquire("H:100")
+    const second = acquire("H:100")
+    const other = acquire("H:200")
+
+    expect(second).toBe(first)
+    expect(other).not.toBe(first)
+    expect(createdCount()).toBe(2)
+    expect(cache.size).toBe(2)
+  })
+
+  test("参照がなくなった形状は残しておき、再び参照された場合は作り直さない", () => {
+    const { cache, acquire, destroyed, createdCount } = createCache()
+
+    const shape = acquire("A:10:0")
+    acquire("A:10:0")
+    cache.release("A:10:0")
+    expect(cache.idleCount).toBe(0)
+    cache.release("A:10:0")
+    expect(cache.idleCount).toBe(1)
+
+    expect(acquire("A:10:0")).toBe(shape)
+    expect(cache.idleCount).toBe(0)
+    expect(createdCount()).toBe(1)
+    expect(destroyed).toEqual([])
+  })
+
+  test("参照されていない形状が上限を超えた場合、最も長く参照されていないものから破棄する", () => {
+    const { cache, acquire, destroyed } = createCache(2)
+
+    for (const key of ["a", "b", "c", "d"]) {
+      acquire(key)
+    }
+    cache.release("b")
+    cache.release("a")
+    cache.release("d")
+    expect(destroyed).toEqual(["b"])
+
+    // 参照中の形状は上限を超えても破棄しない
+    expect(cache.size).toBe(3)
+    cache.release("c")
+    expect(destroyed).toEqual(["b", "a"])
+    expect(cache.idleCount).toBe(2)
+  })
+
+  test("clearで参照中のものを含めてすべて破棄する", () => {
+    const { cache, acquire, destroyed } = createCache()
+
+    acquire("a")
+    acquire("b")
+    cache.release("b")
+    cache.clear()
+
+    expect(destroyed.sort()).toEqual(["a", "b"])
+    expect(cache.size).toBe(0)
+    expect(cache.idleCount).toBe(0)
+  })
+})
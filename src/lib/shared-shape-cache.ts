@@ -0,0 +1,97 @@
+/**
+ * 形状の共有
+ * 描画内容を表すキーごとに作成済みの形状（GraphicsContextなど）を1つだけ持ち、同じキーの
+ * オブジェクトの間で共有する。自己複製で増えた同じ構成のエージェントは、形状を作り直さずに
+ * 参照するだけで描画できる。
+ * 参照されなくなった形状はすぐには破棄せず、上限までは再び使われるのを待つ
+ */
+
+/** 共有している形状 */
+type SharedShape<T> = {
+  readonly shape: T
+  references: number
+}
+
+/**
+ * キーごとの形状の共有（参照数で管理する）
+ */
+export class SharedShapeCache<T> {
+  private readonly _shapes = new Map<string, SharedShape<T>>()
+  /** 参照されていない形状のキー（古い順） */
+  private readonly _idleKeys = new Set<string>()
+
+  /** 保持している形状の数 */
+  public get size(): number {
+    return this._shapes.size
+  }
+
+  /** 参照されていない形状の数 */
+  public get idleCount(): number {
+    return this._idleKeys.size
+  }
+
+  /**
+   * @param _destroy 形状の破棄
+   * @param _maxIdleCount 参照されていない形状を残す上限（超えた分は古いものから破棄する）
+   */
+  public constructor(
+    private readonly _destroy: (shape: T) => void,
+    private readonly _maxIdleCount = 256
+  ) {}
+
+  /**
+   * キーの形状を参照する（なければ作成する）
+   * 参照をやめる際は同じキーで release を呼ぶ
+   * @param key 描画内容を表すキー
+   * @param create 形状の作成
+   */
+  public acquire(key: string, create: () => T): T {
+    let entry = this._shapes.get(key)
+    if (entry == null) {
+      entry = { shape: create(), references: 0 }
+      this._shapes.set(key, entry)
+    }
+    if (entry.references === 0) {
+      this._idleKeys.delete(key)
+    }
+    entry.references++
+    return entry.shape
+  }
+
+  /**
+   * キーの形状の参照をやめる
+   * @param key acquireに渡したキー
+   */
+  public release(key: string): void {
+    const entry = this._shapes.get(key)
+    if (entry == null || entry.references === 0) {
+      return
+    }
+    entry.references--
+    if (entry.references > 0) {
+      return
+    }
+
+    this._idleKeys.add(key)
+    if (this._idleKeys.size <= this._maxIdleCount) {
+      return
+    }
+    // 最も長く参照されていない形状を破棄する
+    const oldestKey = this._idleKeys.values().next().value
+    if (oldestKey != null) {
+      this._idleKeys.delete(oldestKey)
+      const oldest = this._shapes.get(oldestKey)
+      this._shapes.delete(oldestKey)
+      if (oldest != null) {
+        this._destroy(oldest.shape)
+      }
+    }
+  }
+
+  /** すべての形状を破棄する（参照中のものを含む） */
+  public clear(): void {
+    this._shapes.forEach(entry => this._destroy(entry.shape))
+    this._shapes.clear()
+    this._idleKeys.clear()
+  }
+}
@@ -0,0 +1,402 @@
+/**
+ * 世界の描画（保持型）
+ *
+ * 描画オブジェクトをObjectIdごとに保持し、フレームごとには位置と、描画内容が変わったものの
+ * 描き直しだけを行う。消えたオブジェクトの描画オブジェクトはプールへ戻して使い回す。
+ * エネルギーオブジェクトは数が多いため、ParticleContainerのパーティクルとしてまとめて描画する。
+ * ユニットの形状（GraphicsContext）は描画内容を表すキーごとに1つだけ作り、同じ構成のオブジェクトで共有する
+ *
+ * 表示範囲が与えられた場合は、スナップショットの格子から範囲内のオブジェクトのみを取り出して描画する。
+ * また、ズームに応じて描画の詳細度を切り替える（詳細 → 簡略図形 → 格子ごとの密度）。
+ * そのため1フレームの負荷は世界全体のオブジェクト数ではなく、画面に映る範囲で決まる
+ */
+
+import * as PIXI from "pixi.js"
+import type { ObjectId, Vec2 } from "@/types/game"
+import {
+  RENDER_FLAG_ATTACHED,
+  RENDER_OBJECT_TYPES,
+  queryRenderSnapshotRect,
+} from "../engine/render-snapshot"
+import type { RenderRect, RenderSnapshot, RenderSnapshotViews } from "../engine/render-snapshot"
+import { calculateEnergySourceSize } from "../engine/object-factory"
+import { HeatMapRenderer } from "./heat-map-renderer"
+import { RetainedDisplayRegistry } from "./retained-display-registry"
+import { SharedShapeCache } from "./shared-shape-cache"
+import {
+  PARTICLE_TEXTURE_RADIUS,
+  createParticleTexture,
+  drawEnergySource,
+  drawForceField,
+  drawSnapshotObject,
+  energySourceShapeKey,
+  forceFieldShapeKey,
+  objectGlyphTint,
+  snapshotObjectShapeKey,
+} from "./render-utils"
+
+/** 表示範囲（世界座標）とズーム */
+export type RenderView = RenderRect & {
+  readonly zoom: number
+}
+
+/**
+ * 描画の詳細度
+ * full: ユニットの詳細な形状
+ * glyph: 種類ごとの色の円（パーティクル）
+ * density: 格子ごとのオブジェクト数
+ */
+export type RenderDetail = "full" | "glyph" | "density"
+
+/** 詳細な形状で描画する最小のズーム */
+const FULL_DETAIL_MIN_ZOOM = 0.5
+/** 簡略図形で描画する最小のズーム（これより縮小した場合は密度を表示する） */
+const GLYPH_MIN_ZOOM = 0.2
+/** 簡略図形の画面上の最小半径（ピクセル） */
+const GLYPH_MIN_SCREEN_RADIUS = 1.5
+
+/**
+ * ズームに応じた描画の詳細度
+ * @param zoom ズームレベル
+ */
+export const renderDetailForZoom = (zoom: number): RenderDetail => {
+  if (zoom >= FULL_DETAIL_MIN_ZOOM) {
+    return "full"
+  }
+  return zoom >= GLYPH_MIN_ZOOM ? "glyph" : "density"
+}
+
+const ENERGY_TYPE = RENDER_OBJECT_TYPES.indexOf("ENERGY")
+
+/** 円が矩形と重なるか（表示範囲が与えられない場合は常に重なる） */
+const isCircleInView = (view: RenderRect | null, position: Vec2, radius: number): boolean =>
+  view == null ||
+  (position.x + radius >= view.left &&
+    position.x - radius <= view.right &&
+    position.y + radius >= view.top &&
+    position.y - radius <= view.bottom)
+
+/** Graphicsを消去して描き直す */
+const redraw = (graphics: PIXI.Graphics, draw: (graphics: PIXI.Graphics) => void): void => {
+  graphics.clear()
+  draw(graphics)
+}
+
+/** 共有する形状を作成する */
+const createSharedContext = (draw: (graphics: PIXI.Graphics) => void): PIXI.GraphicsContext => {
+  const context = new PIXI.GraphicsContext()
+  const graphics = new PIXI.Graphics(context)
+  draw(graphics)
+  // 作成に使ったGraphicsのみ破棄する（共有する形状は破棄しない）
+  graphics.destroy()
+  return context
+}
+
+/** レイヤーに出し入れするGraphicsの保持 */
+const createGraphicsRegistry = (
+  layer: PIXI.Container,
+  onDetach?: (graphics: PIXI.Graphics) => void
+): RetainedDisplayRegistry<PIXI.Graphics> =>
+  new RetainedDisplayRegistry<PIXI.Graphics>({
+    create: () => new PIXI.Graphics(),
+    attach: graphics => layer.addChild(graphics),
+    detach: graphics => {
+      layer.removeChild(graphics)
+      onDetach?.(graphics)
+    },
+    destroy: graphics => graphics.destroy(),
+  })
+
+/**
+ * 世界の描画
+ * 境界線・力場・エネルギーソース・パーティクル・その他のオブジェクト・密度の順に重ねる
+ */
+export class WorldSceneRenderer {
+  private readonly _container = new PIXI.Container()
+  private readonly _particleLayer: PIXI.ParticleContainer
+  private readonly _densityLayer: PIXI.Container
+  private readonly _particleTexture: PIXI.Texture
+  private readonly _forceFields: RetainedDisplayRegistry<PIXI.Graphics>
+  private readonly _energySources: RetainedDisplayRegistry<PIXI.Graphics>
+  private readonly _objects: RetainedDisplayRegistry<PIXI.Graphics>
+  private readonly _particles: RetainedDisplayRegistry<PIXI.Particle>
+  /** ユニットの形状の共有 */
+  private readonly _shapes = new SharedShapeCache<PIXI.GraphicsContext>(context =>
+    context.destroy()
+  )
+  /** 形状を参照しているGraphicsと、その形状のキー */
+  private readonly _shapeKeys = new Map<PIXI.Graphics, string>()
+  /** 形状を参照していないGraphicsの形状（何も描かない） */
+  private readonly _emptyContext = new PIXI.GraphicsContext()
+  /** 格子ごとの密度の表示（最初に密度を表示する際に作成する） */
+  private _density: HeatMapRenderer | null = null
+  private _densityCounts = new Float64Array(0)
+  /** 表示範囲内のオブジェクト位置（毎フレーム使い回す） */
+  private readonly _visibleIndices: number[] = []
+  /** このフレームで表示から外したパーティクル */
+  private readonly _detachedParticles = new Set<PIXI.Particle>()
+  /** パーティクルの増減・大きさ・色の変更があったか（位置以外の変更はParticleContainerへの通知が必要） */
+  private _particlesChanged = false
+
+  /** 描画先のコンテナ */
+  public get container(): PIXI.Container {
+    return this._container
+  }
+
+  /** 表示中の描画オブジェクトの数（パーティクルを含む） */
+  public get displayCount(): number {
+    return (
+      this._forceFields.size + this._energySources.size + this._objects.size + this._particles.size
+    )
+  }
+
+  /**
+   * @param width 世界の幅
+   * @param height 世界の高さ
+   */
+  public constructor(width: number, height: number) {
+    const border = new PIXI.Graphics()
+    border.rect(0, 0, width, height)
+    border.stroke({ width: 1, color: 0x666666 })
+
+    const forceFieldLayer = new PIXI.Container()
+    const energySourceLayer = new PIXI.Container()
+    const objectLayer = new PIXI.Container()
+    this._densityLayer = new PIXI.Container()
+    this._particleTexture = createParticleTexture()
+    this._particleLayer = new PIXI.ParticleContainer({
+      dynamicProperties: { position: true, vertex: false, rotation: false, color: false },
+    })
+    // ParticleContainerは子から範囲を計算しないため、世界全体を範囲とする
+    this._particleLayer.boundsArea = new PIXI.Rectangle(0, 0, width, height)
+
+    this._container.addChild(
+      border,
+      forceFieldLayer,
+      energySourceLayer,
+      this._particleLayer,
+      objectLayer,
+      this._densityLayer
+    )
+
+    this._forceFields = createGraphicsRegistry(forceFieldLayer)
+    this._energySources = createGraphicsRegistry(energySourceLayer)
+    this._objects = createGraphicsRegistry(objectLayer, graphics => this.releaseShape(graphics))
+    this._particles = new RetainedDisplayRegistry<PIXI.Particle>({
+      create: () =>
+        new PIXI.Particle({ texture: this._particleTexture, anchorX: 0.5, anchorY: 0.5 }),
+      attach: particle => {
+        this._particleLayer.particleChildren.push(particle)
+        this._particlesChanged = true
+      },
+      // 1つずつ取り除くと配列の詰め直しが重なるため、フレームの最後にまとめて取り除く
+      detach: particle => {
+        this._detachedParticles.add(particle)
+        this._particlesChanged = true
+      },
+      destroy: () => undefined,
+    })
+  }
+
+  /**
+   * スナップショットの内容に合わせて描画オブジェクトを更新する
+   * @param snapshot 描画用スナップショット
+   * @param views スナップショットの数値データ
+   * @param view 表示範囲とズーム（nullの場合は世界全体を詳細に描画する）
+   */
+  public update(
+    snapshot: RenderSnapshot,
+    views: RenderSnapshotViews,
+    view: RenderView | null = null
+  ): void {
+    const detail = view == null ? "full" : renderDetailForZoom(view.zoom)
+
+    // 力場を描画（デザイン仕様: rgba(173,216,230,0.2)）
+    this._forceFields.beginFrame()
+    for (const field of snapshot.forceFields) {
+      if (!isCircleInView(view, field.position, field.radius)) {
+        continue
+      }
+      const entry = this._forceFields.acquire(field.id, forceFieldShapeKey(field))
+      if (entry.needsRedraw) {
+        redraw(entry.display, graphics => drawForceField(graphics, field))
+      }
+    }
+    this._forceFields.endFrame()
+
+    // エネルギーソースを描画（デザイン仕様: #FFB700、太陽型）
+    this._energySources.beginFrame()
+    for (const source of snapshot.energySources) {
+      if (!isCircleInView(view, source.position, calculateEnergySourceSize(source))) {
+        continue
+      }
+      const entry = this._energySources.acquire(source.id, energySourceShapeKey(source))
+      if (entry.needsRedraw) {
+        redraw(entry.display, graphics => drawEnergySource(graphics, source))
+      }
+    }
+    this._energySources.endFrame()
+
+    // ゲームオブジェクトを描画（デザイン仕様準拠）
+    // 密度を表示する場合は個々のオブジェクトを描画しない（保持していた描画オブジェクトはプールへ戻る）
+    this._objects.beginFrame()
+    this._particles.beginFrame()
+    if (detail !== "density") {
+      const visible =
+        view == null ? null : queryRenderSnapshotRect(snapshot, views, view, this._visibleIndices)
+      const count = visible == null ? snapshot.objectCount : visible.length
+      for (let k = 0; k < count; k++) {
+        const index = visible == null ? k : (visible[k] ?? 0)
+        if (detail === "full") {
+          this.updateObject(views, index)
+        } else {
+          this.updateGlyph(views, index, view?.zoom ?? 1)
+        }
+      }
+    }
+    this._objects.endFrame()
+    this._particles.endFrame()
+    this.flushParticles()
+
+    this.updateDensity(snapshot, views, detail === "density")
+  }
+
+  /** 描画オブジェクト・テクスチャを破棄する */
+  public destroy(): void {
+    this._forceFields.clear()
+    this._energySources.clear()
+    this._objects.clear()
+    this._particles.clear()
+    this._shapes.clear()
+    this._emptyContext.destroy()
+    this._density?.destroy()
+    this._container.destroy({ children: true })
+    this._particleTexture.destroy(true)
+  }
+
+  /** オブジェクトを詳細な形状で描画する（エネルギーオブジェクトはパーティクル） */
+  private updateObject(views: RenderSnapshotViews, index: number): void {
+    const { objects } = views
+    const x = objects.x[index] ?? 0
+    const y = objects.y[index] ?? 0
+    const radius = objects.radius[index] ?? 0
+    if (objects.type[index] === ENERGY_TYPE) {
+      this.updateParticle(views, index, radius)
+      return
+    }
+
+    // HULLに固定されているユニットはHULL側で描画されるため、描画オブジェクトを持たない
+    const key = snapshotObjectShapeKey(views, index)
+    if (key == null) {
+      return
+    }
+    const entry = this._objects.acquire((objects.id[index] ?? 0) as ObjectId, key)
+    const graphics = entry.display
+    if (entry.needsRedraw) {
+      this.releaseShape(graphics)
+      graphics.context = this._shapes.acquire(key, () =>
+        createSharedContext(target => drawSnapshotObject(target, views, index))
+      )
+      this._shapeKeys.set(graphics, key)
+    }
+    if (graphics.x !== x || graphics.y !== y) {
+      graphics.position.set(x, y)
+    }
+  }
+
+  /** オブジェクトを種類ごとの色の円で描画する（画面上で小さくなりすぎないよう拡大する） */
+  private updateGlyph(views: RenderSnapshotViews, index: number, zoom: number): void {
+    if (((views.objects.flags[index] ?? 0) & RENDER_FLAG_ATTACHED) !== 0) {
+      return
+    }
+    const radius = Math.max(views.objects.radius[index] ?? 0, GLYPH_MIN_SCREEN_RADIUS / zoom)
+    this.updateParticle(views, index, radius)
+  }
+
+  /** オブジェクトのパーティクルを更新する */
+  private updateParticle(views: RenderSnapshotViews, index: number, radius: number): void {
+    const { objects } = views
+    const type = RENDER_OBJECT_TYPES[objects.type[index] ?? -1] ?? "ENERGY"
+    // 種類をキーとし、種類が変わった場合（使い回した場合を含む）に色を付け直す
+    const entry = this._particles.acquire((objects.id[index] ?? 0) as ObjectId, type)
+    const particle = entry.display
+    if (entry.needsRedraw) {
+      particle.tint = objectGlyphTint(type)
+      this._particlesChanged = true
+    }
+    const scale = radius / PARTICLE_TEXTURE_RADIUS
+    if (particle.scaleX !== scale) {
+      particle.scaleX = scale
+      particle.scaleY = scale
+      this._particlesChanged = true
+    }
+    particle.x = objects.x[index] ?? 0
+    particle.y = objects.y[index] ?? 0
+  }
+
+  /** 格子ごとのオブジェクト数を表示する（表示しない場合は隠すのみ） */
+  private updateDensity(
+    snapshot: RenderSnapshot,
+    views: RenderSnapshotViews,
+    isVisible: boolean
+  ): void {
+    if (this._density == null) {
+      if (!isVisible) {
+        return
+      }
+      this._density = new HeatMapRenderer(
+        snapshot.width / snapshot.gridWidth,
+        snapshot.height / snapshot.gridHeight
+      )
+      this._density.alpha = 1
+      this._densityLayer.addChild(this._density.container)
+    }
+    this._density.visible = isVisible
+    if (!isVisible) {
+      return
+    }
+
+    const cellCount = snapshot.gridWidth * snapshot.gridHeight
+    if (this._densityCounts.length !== cellCount) {
+      this._densityCounts = new Float64Array(cellCount)
+    }
+    let maxCount = 1
+    for (let cell = 0; cell < cellCount; cell++) {
+      const count = (views.cellStart[cell + 1] ?? 0) - (views.cellStart[cell] ?? 0)
+      this._densityCounts[cell] = count
+      maxCount = Math.max(maxCount, count)
+    }
+    this._density.update({ width: snapshot.gridWidth, heatValues: this._densityCounts }, maxCount)
+  }
+
+  /** Graphicsが参照している形状の参照をやめる */
+  private releaseShape(graphics: PIXI.Graphics): void {
+    const key = this._shapeKeys.get(graphics)
+    if (key == null) {
+      return
+    }
+    this._shapes.release(key)
+    this._shapeKeys.delete(graphics)
+    graphics.context = this._emptyContext
+  }
+
+  /** 表示から外したパーティクルを取り除き、変更をParticleContainerへ通知する */
+  private flushParticles(): void {
+    if (this._detachedParticles.size > 0) {
+      const children = this._particleLayer.particleChildren
+      let length = 0
+      for (const particle of children) {
+        if (!this._detachedParticles.has(particle as PIXI.Particle)) {
+          children[length] = particle
+          length++
+        }
+      }
+      children.length = length
+      this._detachedParticles.clear()
+    }
+    if (this._particlesChanged) {
+      this._particleLayer.update()
+      this._particlesChanged = false
+    }
+  }
+}
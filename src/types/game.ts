@@ -181,9 +181,12 @@ export type SpiralForceField = {
 /** 方向性力場 */
 export type DirectionalForceField = LinearForceField | RadialForceField | SpiralForceField
 
-/** 空間ハッシュグリッドのセル */
-export type SpatialCell = {
-  objects: Set<ObjectId>
+/** ゲームオブジェクトの読み取り用コレクション */
+export type ObjectCollection = {
+  readonly size: number
+  get(id: ObjectId): GameObject | undefined
+  has(id: ObjectId): boolean
+  values(): Iterable<GameObject>
 }
 
 /** ゲーム世界の状態 */
@@ -191,10 +194,9 @@ export type WorldState = {
   width: number
   height: number
   tick: number
-  objects: Map<ObjectId, GameObject>
+  objects: ObjectCollection
   energySources: Map<ObjectId, EnergySource>
   forceFields: Map<ObjectId, DirectionalForceField>
-  spatialIndex: Map<string, SpatialCell>
   parameters: WorldParameters
   nextObjectId: number
 }
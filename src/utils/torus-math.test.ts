@@ -9,6 +9,15 @@ describe("torus-math", () => {
   const worldWidth = 100
   const worldHeight = 80
 
+  describe("wrapCoordinate", () => {
+    test("範囲内の座標はそのまま、範囲外の座標はラップして返す", () => {
+      expect(TorusMath.wrapCoordinate(50, worldWidth)).toBe(50)
+      expect(TorusMath.wrapCoordinate(120, worldWidth)).toBe(20)
+      expect(TorusMath.wrapCoordinate(-10, worldWidth)).toBe(90)
+      expect(TorusMath.wrapCoordinate(worldWidth, worldWidth)).toBe(0)
+    })
+  })
+
   describe("wrapPosition", () => {
     test("世界内の座標はそのまま返す", () => {
       const pos: Vec2 = { x: 50, y: 40 }
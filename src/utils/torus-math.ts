@@ -6,21 +6,18 @@
 import type { Vec2 } from "@/types/game"
 import { Vec2 as Vec2Utils } from "./vec2"
 
-/** トーラス世界での位置の正規化 */
-export const wrapPosition = (position: Vec2, worldWidth: number, worldHeight: number): Vec2 => {
-  let x = position.x % worldWidth
-  let y = position.y % worldHeight
-
-  if (x < 0) {
-    x += worldWidth
-  }
-  if (y < 0) {
-    y += worldHeight
-  }
-
-  return { x, y }
+/** トーラス世界での座標（1軸）の正規化 */
+export const wrapCoordinate = (value: number, size: number): number => {
+  const wrapped = value % size
+  return wrapped < 0 ? wrapped + size : wrapped
 }
 
+/** トーラス世界での位置の正規化 */
+export const wrapPosition = (position: Vec2, worldWidth: number, worldHeight: number): Vec2 => ({
+  x: wrapCoordinate(position.x, worldWidth),
+  y: wrapCoordinate(position.y, worldHeight),
+})
+
 /** トーラス世界での最短距離ベクトル（aからbへ） */
 export const shortestVector = (a: Vec2, b: Vec2, worldWidth: number, worldHeight: number): Vec2 => {
   let dx = b.x - a.x